@@ -0,0 +1,203 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "PatternRecognizer.hpp"
+
+#include <til/hash.h>
+
+#include "../../types/inc/GlyphWidth.hpp"
+
+namespace
+{
+    // A bitmap for each of the two character classes in UrlPattern.
+    // They're only defined for ASCII as all other characters are in neither class.
+    struct AsciiSet
+    {
+        constexpr AsciiSet(const std::string_view& chars) noexcept
+        {
+            for (const auto ch : chars)
+            {
+                bits[static_cast<uint8_t>(ch) / 64] |= uint64_t{ 1 } << (static_cast<uint8_t>(ch) % 64);
+            }
+        }
+
+        constexpr bool contains(const wchar_t ch) const noexcept
+        {
+            return ch < 128 && (bits[ch / 64] & (uint64_t{ 1 } << (ch % 64))) != 0;
+        }
+
+        uint64_t bits[2]{};
+    };
+
+    // [-A-Za-z0-9+&@#/%?=~_|$!:,.;]
+    constexpr AsciiSet urlChars{ "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-+&@#/%?=~_|$!:,.;" };
+    // [A-Za-z0-9+&@#/%=~_|$]
+    constexpr AsciiSet urlEndChars{ "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+&@#/%=~_|$" };
+}
+
+PatternRecognizer::PatternRecognizer(const std::wstring_view& pattern) :
+    _pattern{ pattern }
+{
+    if (pattern != UrlPattern)
+    {
+        _regex = std::make_shared<const std::wregex>(_pattern);
+    }
+}
+
+const std::wstring& PatternRecognizer::GetPattern() const noexcept
+{
+    return _pattern;
+}
+
+// Routine Description:
+// - Returns whether a match could possibly span across the boundary between the two given characters.
+//   If it returns false, the text before and after the boundary can be passed to FindMatches() separately.
+// Arguments:
+// - before - The last character before the boundary
+// - after - The first character after the boundary
+// Return Value:
+// - false if the two halves can be matched independently.
+bool PatternRecognizer::CanMatchAcross(const wchar_t before, const wchar_t after) const noexcept
+{
+    if (_regex)
+    {
+        // We know nothing about arbitrary regular expressions.
+        return true;
+    }
+
+    // A URL consists only of URL characters. The only other way the text before the
+    // boundary can influence a match after it is through the leading \b assertion.
+    return _IsUrlChar(after) && (_IsUrlChar(before) || _IsWordChar(before));
+}
+
+// Routine Description:
+// - Finds all non-overlapping matches of the pattern in the given text,
+//   just like std::wsregex_iterator would.
+// - The results are cached, so that calling this function again
+//   with the same text is only as expensive as hashing it.
+// Arguments:
+// - text - The text to search through
+// Return Value:
+// - The column ranges of all matches. The reference is valid until the next call.
+const std::vector<PatternRecognizer::Match>& PatternRecognizer::FindMatches(const std::wstring_view& text) const
+{
+    if (const auto it = _cache.find(text); it != _cache.end())
+    {
+        return it->second;
+    }
+
+    std::vector<std::pair<size_t, size_t>> ranges;
+    if (_regex)
+    {
+        const auto end = std::wcregex_iterator{};
+        for (auto it = std::wcregex_iterator{ text.data(), text.data() + text.size(), *_regex }; it != end; ++it)
+        {
+            const auto begin = gsl::narrow_cast<size_t>(it->position());
+            ranges.emplace_back(begin, begin + gsl::narrow_cast<size_t>(it->length()));
+        }
+    }
+    else
+    {
+        _FindUrls(text, ranges);
+    }
+
+    // The columns are measured incrementally from the end of the previous match,
+    // so that the text is only measured once in total.
+    std::vector<Match> matches;
+    matches.reserve(ranges.size());
+    size_t offset = 0;
+    til::CoordType column = 0;
+    for (const auto& [begin, end] : ranges)
+    {
+        column += gsl::narrow_cast<til::CoordType>(MeasureGlyphColumns(text.substr(offset, begin - offset)));
+        const auto matchBegin = column;
+        column += gsl::narrow_cast<til::CoordType>(MeasureGlyphColumns(text.substr(begin, end - begin)));
+        matches.emplace_back(Match{ matchBegin, column });
+        offset = end;
+    }
+
+    if (_cache.size() >= CacheLimit)
+    {
+        _cache.clear();
+    }
+    return _cache.emplace(text, std::move(matches)).first->second;
+}
+
+size_t PatternRecognizer::CacheHasher::operator()(const std::wstring_view& text) const noexcept
+{
+    return til::hash(text);
+}
+
+bool PatternRecognizer::_IsUrlChar(const wchar_t ch) noexcept
+{
+    return urlChars.contains(ch);
+}
+
+bool PatternRecognizer::_IsUrlEndChar(const wchar_t ch) noexcept
+{
+    return urlEndChars.contains(ch);
+}
+
+// The definition of \w as used by std::wregex for the \b assertion.
+bool PatternRecognizer::_IsWordChar(const wchar_t ch) noexcept
+{
+    return iswalnum(ch) || ch == L'_';
+}
+
+// Routine Description:
+// - Finds all matches of UrlPattern in the given text, without a regex engine.
+// - Every URL contains "://" right after its scheme, which is a substring that's rare and cheap
+//   to search for. Once found, the scheme in front of it and the rest of the URL are checked.
+// Arguments:
+// - text - The text to search through
+// - ranges - Receives the begin and past-the-end offset of each match
+void PatternRecognizer::_FindUrls(const std::wstring_view& text, std::vector<std::pair<size_t, size_t>>& ranges)
+{
+    static constexpr std::wstring_view separator{ L"://" };
+    static constexpr std::wstring_view schemes[]{ L"https", L"http", L"file", L"ftp" };
+
+    size_t pos = 0;
+    for (auto sep = text.find(separator); sep != std::wstring_view::npos; sep = text.find(separator, sep + separator.size()))
+    {
+        // (https?|ftp|file) - at most one of them can end right at the separator.
+        size_t begin = std::wstring_view::npos;
+        for (const auto& scheme : schemes)
+        {
+            if (sep >= pos + scheme.size() && text.substr(sep - scheme.size(), scheme.size()) == scheme)
+            {
+                begin = sep - scheme.size();
+                break;
+            }
+        }
+
+        // \b - the scheme starts with a word character, so the preceding one must not be one.
+        if (begin == std::wstring_view::npos || (begin != 0 && _IsWordChar(til::at(text, begin - 1))))
+        {
+            continue;
+        }
+
+        // [...]*[...] - consume as many URL characters as possible and then backtrack
+        // until the last character is one of the ones that are allowed at the end.
+        const auto tail = sep + separator.size();
+        auto end = tail;
+        while (end < text.size() && _IsUrlChar(til::at(text, end)))
+        {
+            ++end;
+        }
+        while (end > tail && !_IsUrlEndChar(til::at(text, end - 1)))
+        {
+            --end;
+        }
+        if (end == tail)
+        {
+            continue;
+        }
+
+        ranges.emplace_back(begin, end);
+        pos = end;
+        // The next match can't start before the end of this one.
+        // Any separator within this match is skipped by the find() below.
+        sep = end - separator.size();
+    }
+}
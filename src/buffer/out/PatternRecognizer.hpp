@@ -0,0 +1,64 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- PatternRecognizer.hpp
+
+Abstract:
+- A pattern that's compiled once and can then be matched against the text in
+  the buffer any number of times. See TextBuffer::GetPatterns().
+- The built-in URL pattern isn't handed to std::wregex at all. It's matched by
+  a hand-written scanner which also tells TextBuffer where the text can be split
+  into pieces that can be matched independently of each other. Together with
+  the result cache this means that only rows that changed need to be rescanned.
+--*/
+
+#pragma once
+
+#include <regex>
+
+class PatternRecognizer final
+{
+public:
+    // The pattern used to detect URLs. Passing this exact string to the constructor
+    // will result in the faster, specialized scanner being used.
+    static constexpr std::wstring_view UrlPattern{ LR"(\b(https?|ftp|file)://[-A-Za-z0-9+&@#/%?=~_|$!:,.;]*[A-Za-z0-9+&@#/%=~_|$])" };
+
+    // The start and past-the-end column of a match, relative to the start of the text.
+    struct Match
+    {
+        til::CoordType begin = 0;
+        til::CoordType end = 0;
+    };
+
+    explicit PatternRecognizer(const std::wstring_view& pattern);
+
+    const std::wstring& GetPattern() const noexcept;
+    bool CanMatchAcross(const wchar_t before, const wchar_t after) const noexcept;
+    const std::vector<Match>& FindMatches(const std::wstring_view& text) const;
+
+private:
+    struct CacheHasher
+    {
+        using is_transparent = int;
+
+        size_t operator()(const std::wstring_view& text) const noexcept;
+    };
+
+    // Caching more than a couple screens worth of text isn't useful, because
+    // GetPatterns() is only ever called for the viewport or the rows around it.
+    static constexpr size_t CacheLimit = 1024;
+
+    static bool _IsUrlChar(const wchar_t ch) noexcept;
+    static bool _IsUrlEndChar(const wchar_t ch) noexcept;
+    static bool _IsWordChar(const wchar_t ch) noexcept;
+    static void _FindUrls(const std::wstring_view& text, std::vector<std::pair<size_t, size_t>>& ranges);
+
+    std::wstring _pattern;
+    // nullptr if the pattern is UrlPattern.
+    std::shared_ptr<const std::wregex> _regex;
+
+    // Maps a piece of text to the matches within it.
+    mutable std::unordered_map<std::wstring, std::vector<Match>, CacheHasher, std::equal_to<>> _cache;
+};
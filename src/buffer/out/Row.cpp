@@ -29,6 +29,46 @@ constexpr OutIt iota_n_mut(OutIt dest, Diff count, T& val)
     return dest;
 }
 
+// Same as iota_n, but specialized for _charOffsets. ROW::WriteAsciiRun() regularly
+// fills an entire row worth of offsets at once, where vectorization pays off.
+static uint16_t* iota_n_offsets(uint16_t* dest, size_t count, uint16_t val) noexcept
+{
+#pragma warning(push)
+#pragma warning(disable : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
+#pragma warning(disable : 26490) // Don't use reinterpret_cast (type.1).
+#ifdef __AVX2__
+    if (count >= 16)
+    {
+        const auto increment = _mm256_set1_epi16(16);
+        auto offsets = _mm256_add_epi16(_mm256_set1_epi16(val), _mm256_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+        for (; count >= 16; count -= 16, dest += 16)
+        {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest), offsets);
+            offsets = _mm256_add_epi16(offsets, increment);
+        }
+        val = gsl::narrow_cast<uint16_t>(_mm256_extract_epi16(offsets, 0));
+    }
+#elif _M_AMD64
+    if (count >= 8)
+    {
+        const auto increment = _mm_set1_epi16(8);
+        auto offsets = _mm_add_epi16(_mm_set1_epi16(val), _mm_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7));
+        for (; count >= 8; count -= 8, dest += 8)
+        {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dest), offsets);
+            offsets = _mm_add_epi16(offsets, increment);
+        }
+        val = gsl::narrow_cast<uint16_t>(_mm_extract_epi16(offsets, 0));
+    }
+#endif
+    for (; count; --count, ++dest, ++val)
+    {
+        *dest = val;
+    }
+    return dest;
+#pragma warning(pop)
+}
+
 // Same as std::fill, but purpose-built for very small `last - first`
 // where a trivial loop outperforms vectorization.
 template<typename FwdIt, typename T>
@@ -68,15 +108,20 @@ constexpr OutIt copy_n_small(InIt first, Diff count, OutIt dest)
 // Routine Description:
 // - constructor
 // Arguments:
+// - attrTable - the table of the owning TextBuffer that the row's attributes are interned in
+// - bufferGeneration - the generation counter of the owning TextBuffer. See _markChanged().
 // - rowWidth - the width of the row, cell elements
 // - fillAttribute - the default text attribute
 // Return Value:
 // - constructed object
-ROW::ROW(wchar_t* charsBuffer, uint16_t* charOffsetsBuffer, uint16_t rowWidth, const TextAttribute& fillAttribute) :
+ROW::ROW(TextAttributeTable& attrTable, uint64_t& bufferGeneration, wchar_t* charsBuffer, uint16_t* charOffsetsBuffer, uint16_t rowWidth, const TextAttribute& fillAttribute) :
     _charsBuffer{ charsBuffer },
+    _charOffsetsBuffer{ charOffsetsBuffer },
     _chars{ charsBuffer, rowWidth },
     _charOffsets{ charOffsetsBuffer, ::base::strict_cast<size_t>(rowWidth) + 1u },
-    _attr{ rowWidth, fillAttribute },
+    _attrTable{ &attrTable },
+    _attr{ rowWidth, attrTable.Intern(fillAttribute) },
+    _bufferGeneration{ &bufferGeneration },
     _columnCount{ rowWidth }
 {
     if (_chars.data())
@@ -85,22 +130,42 @@ ROW::ROW(wchar_t* charsBuffer, uint16_t* charOffsetsBuffer, uint16_t rowWidth, c
     }
 }
 
+// Routine Description:
+// - constructs an empty row without any backing buffers. Call Resize() to give it some.
+// Arguments:
+// - attrTable - the table of the owning TextBuffer that the row's attributes are interned in
+// - bufferGeneration - the generation counter of the owning TextBuffer. See _markChanged().
+ROW::ROW(TextAttributeTable& attrTable, uint64_t& bufferGeneration) noexcept :
+    _attrTable{ &attrTable },
+    _bufferGeneration{ &bufferGeneration }
+{
+}
+
 void swap(ROW& lhs, ROW& rhs) noexcept
 {
     std::swap(lhs._charsBuffer, rhs._charsBuffer);
+    std::swap(lhs._charOffsetsBuffer, rhs._charOffsetsBuffer);
     std::swap(lhs._charsHeap, rhs._charsHeap);
     std::swap(lhs._chars, rhs._chars);
     std::swap(lhs._charOffsets, rhs._charOffsets);
+    std::swap(lhs._attrTable, rhs._attrTable);
     std::swap(lhs._attr, rhs._attr);
+    std::swap(lhs._bufferGeneration, rhs._bufferGeneration);
+    std::swap(lhs._generation, rhs._generation);
     std::swap(lhs._columnCount, rhs._columnCount);
     std::swap(lhs._lineRendition, rhs._lineRendition);
     std::swap(lhs._wrapForced, rhs._wrapForced);
     std::swap(lhs._doubleBytePadded, rhs._doubleBytePadded);
+    std::swap(lhs._frozenData, rhs._frozenData);
 }
 
 void ROW::SetWrapForced(const bool wrap) noexcept
 {
-    _wrapForced = wrap;
+    if (_wrapForced != wrap)
+    {
+        _wrapForced = wrap;
+        _markChanged();
+    }
 }
 
 bool ROW::WasWrapForced() const noexcept
@@ -110,7 +175,11 @@ bool ROW::WasWrapForced() const noexcept
 
 void ROW::SetDoubleBytePadded(const bool doubleBytePadded) noexcept
 {
-    _doubleBytePadded = doubleBytePadded;
+    if (_doubleBytePadded != doubleBytePadded)
+    {
+        _doubleBytePadded = doubleBytePadded;
+        _markChanged();
+    }
 }
 
 bool ROW::WasDoubleBytePadded() const noexcept
@@ -120,7 +189,11 @@ bool ROW::WasDoubleBytePadded() const noexcept
 
 void ROW::SetLineRendition(const LineRendition lineRendition) noexcept
 {
-    _lineRendition = lineRendition;
+    if (_lineRendition != lineRendition)
+    {
+        _lineRendition = lineRendition;
+        _markChanged();
+    }
 }
 
 LineRendition ROW::GetLineRendition() const noexcept
@@ -128,6 +201,26 @@ LineRendition ROW::GetLineRendition() const noexcept
     return _lineRendition;
 }
 
+// Rows update their generation themselves whenever they're modified (see _markChanged()).
+// The TextBuffer only sets it for rows it moves to another offset. See TextBuffer::GetRowGeneration().
+void ROW::SetGeneration(const uint64_t generation) noexcept
+{
+    _generation = generation;
+}
+
+uint64_t ROW::GetGeneration() const noexcept
+{
+    return _generation;
+}
+
+// Routine Description:
+// - gives the row a new generation from the owning TextBuffer's counter.
+//   Every method that modifies the contents or flags of the row must call this.
+void ROW::_markChanged() noexcept
+{
+    _generation = ++*_bufferGeneration;
+}
+
 // Routine Description:
 // - Sets all properties of the ROW to default values
 // Arguments:
@@ -138,11 +231,15 @@ void ROW::Reset(const TextAttribute& attr)
 {
     _charsHeap.reset();
     _chars = { _charsBuffer, _columnCount };
-    _attr = { _columnCount, attr };
+    // A frozen row doesn't need to be thawed if it gets overwritten anyways.
+    _charOffsets = { _charOffsetsBuffer, ::base::strict_cast<size_t>(_columnCount) + 1u };
+    _frozenData.reset();
+    _attr = { _columnCount, _attrTable->Intern(attr) };
     _lineRendition = LineRendition::SingleWidth;
     _wrapForced = false;
     _doubleBytePadded = false;
     _init();
+    _markChanged();
 }
 
 void ROW::_init() noexcept
@@ -206,6 +303,7 @@ void ROW::Resize(wchar_t* charsBuffer, uint16_t* charOffsetsBuffer, uint16_t row
     }
 
     _charsBuffer = charsBuffer;
+    _charOffsetsBuffer = charOffsetsBuffer;
     _charsHeap = std::move(charsHeap);
     _chars = chars;
     _charOffsets = charOffsets;
@@ -215,18 +313,60 @@ void ROW::Resize(wchar_t* charsBuffer, uint16_t* charOffsetsBuffer, uint16_t row
     // since there's no trailing item that could be extended.
     if (_attr.empty())
     {
-        _attr = { rowWidth, fillAttribute };
+        _attr = { rowWidth, _attrTable->Intern(fillAttribute) };
     }
     else
     {
         _attr.resize_trailing_extent(rowWidth);
     }
+
+    _markChanged();
 }
 
-void ROW::TransferAttributes(const til::small_rle<TextAttribute, uint16_t, 1>& attr, til::CoordType newWidth)
+// Routine Description:
+// - copies the attributes of another, possibly differently sized row (for instance from another TextBuffer)
+// Arguments:
+// - source - the row to copy the attributes from
+// - newWidth - the width of this row; the last attribute run is extended or truncated to fit
+void ROW::TransferAttributes(const ROW& source, til::CoordType newWidth)
 {
-    _attr = attr;
+    if (_attrTable == source._attrTable)
+    {
+        _attr = source._attr;
+    }
+    else
+    {
+        _attr = decltype(_attr){ _internRuns(*source._attrTable, source._attr.runs()) };
+    }
     _attr.resize_trailing_extent(gsl::narrow<uint16_t>(newWidth));
+    _markChanged();
+}
+
+// Routine Description:
+// - interns the attributes of runs from another table into ours.
+// Arguments:
+// - sourceTable - the table the IDs in `runs` refer to
+// - runs - the runs to translate
+// Return Value:
+// - the same runs with IDs from our table
+ROW::AttrRuns ROW::_internRuns(const TextAttributeTable& sourceTable, const AttrRuns& runs) const
+{
+    AttrRuns result;
+    for (;;)
+    {
+        // Interning may compact our table, which renumbers the IDs we collected so far,
+        // because they aren't stored in a row yet. It's rare enough to simply start over.
+        const auto epoch = _attrTable->Epoch();
+        result.clear();
+        for (const auto& run : runs)
+        {
+            result.emplace_back(_attrTable->Intern(sourceTable.Get(run.value)), run.length);
+        }
+        if (epoch == _attrTable->Epoch())
+        {
+            return result;
+        }
+    }
 }
 
 // Routine Description:
@@ -258,6 +398,8 @@ OutputCellIterator ROW::WriteCells(OutputCellIterator it, const til::CoordType c
     // If we're given a right-side column limit, use it. Otherwise, the write limit is the final column index available in the char row.
     const auto finalColumnInRow = limitRight.value_or(size() - 1);
 
+    _markChanged();
+
     auto currentColor = it->TextAttr();
     uint16_t colorUses = 0;
     auto colorStarts = gsl::narrow_cast<uint16_t>(columnBegin);
@@ -278,7 +420,7 @@ OutputCellIterator ROW::WriteCells(OutputCellIterator it, const til::CoordType c
             {
                 // Otherwise, commit this color into the run and save off the new one.
                 // Now commit the new color runs into the attr row.
-                _attr.replace(colorStarts, currentIndex, currentColor);
+                _attr.replace(colorStarts, currentIndex, _attrTable->Intern(currentColor));
                 currentColor = it->TextAttr();
                 colorUses = 1;
                 colorStarts = currentIndex;
@@ -354,21 +496,271 @@ OutputCellIterator ROW::WriteCells(OutputCellIterator it, const til::CoordType c
     // Now commit the final color into the attr row
     if (colorUses)
     {
-        _attr.replace(colorStarts, currentIndex, currentColor);
+        _attr.replace(colorStarts, currentIndex, _attrTable->Intern(currentColor));
     }
 
     return it;
 }
 
+// Routine Description:
+// - writes the leading printable ASCII characters of the given text to the row and stops at
+//   the first character that isn't one (or at the end of the row). Printable ASCII is always
+//   exactly 1 column wide, so unlike WriteCells() this doesn't need to go through
+//   OutputCellIterator and measure each glyph, which makes it a lot faster for the common case.
+//   The text is copied into the row in bulk and the given attribute is applied to all written
+//   columns as a single run. Callers write the rest of the text with WriteGlyphRuns().
+// Arguments:
+// - columnBegin - column in row to start writing at
+// - chars - the text to write
+// - attr - the attribute to apply to the written columns
+// - wrap - change the wrap flag if we hit the end of the row while writing. See WriteCells().
+// - limitRight - right inclusive column ID for the last write in this row. (optional, will just write to the end of row if nullopt)
+// Return Value:
+// - the number of characters (and thus columns) that were written to this row.
+til::CoordType ROW::WriteAsciiRun(const til::CoordType columnBegin, const std::wstring_view& chars, const TextAttribute& attr, const std::optional<bool> wrap, const std::optional<til::CoordType> limitRight)
+{
+    THROW_HR_IF(E_INVALIDARG, columnBegin < 0 || columnBegin >= size());
+    THROW_HR_IF(E_INVALIDARG, limitRight.value_or(0) >= size());
+
+    // If we're given a right-side column limit, use it. Otherwise, the write limit is the final column index available in the char row.
+    const auto finalColumnInRow = limitRight.value_or(size() - 1);
+    if (columnBegin > finalColumnInRow || chars.empty())
+    {
+        return 0;
+    }
+
+    const auto colBeg = gsl::narrow_cast<uint16_t>(columnBegin);
+
+    // Only the characters that fit into the row are checked, right before they're copied.
+    const auto available = std::min<size_t>(chars.size(), gsl::narrow_cast<size_t>(finalColumnInRow) + 1u - colBeg);
+    size_t printable = 0;
+    for (; printable < available; ++printable)
+    {
+        const auto wch = til::at(chars, printable);
+        if (wch < L' ' || wch > L'~')
+        {
+            break;
+        }
+    }
+    if (!printable)
+    {
+        return 0;
+    }
+
+    _markChanged();
+
+    const auto colEnd = gsl::narrow_cast<uint16_t>(colBeg + printable);
+    const uint16_t count = colEnd - colBeg;
+
+    // Safety:
+    // * colBeg is now [0, _columnCount)
+    // * colEnd is now (colBeg, _columnCount]
+
+    // This is the same range extension that ReplaceCharacters() does: Any wide glyphs
+    // we partially overwrite at the start or end of the run are replaced with whitespace.
+    // See ReplaceCharacters() for a detailed explanation.
+    uint16_t colExtBeg = colBeg;
+    const uint16_t chExtBeg = _uncheckedCharOffset(colExtBeg);
+    for (; colExtBeg != 0 && _uncheckedIsTrailer(colExtBeg); --colExtBeg)
+    {
+    }
+
+    uint16_t colExtEnd = colEnd;
+    for (; _uncheckedIsTrailer(colExtEnd); ++colExtEnd)
+    {
+    }
+    const uint16_t chExtEnd = _uncheckedCharOffset(colExtEnd);
+
+    const uint16_t leadingSpaces = colBeg - colExtBeg;
+    const uint16_t trailingSpaces = colExtEnd - colEnd;
+    const size_t chExtEndNew = count + leadingSpaces + trailingSpaces + chExtBeg;
+
+    // In the common case of overwriting narrow text with narrow text this is a no-op.
+    if (chExtEndNew != chExtEnd)
+    {
+        _resizeChars(colExtEnd, chExtBeg, chExtEnd, chExtEndNew);
+    }
+
+    {
+        auto it = _chars.begin() + chExtBeg;
+        it = fill_n_small(it, leadingSpaces, L' ');
+        it = std::copy_n(chars.begin(), count, it);
+        it = fill_n_small(it, trailingSpaces, L' ');
+    }
+    // Since every column in [colExtBeg, colExtEnd) is now exactly 1 wchar_t
+    // wide, the offsets form a single, uninterrupted sequence.
+    iota_n_offsets(&til::at(_charOffsets, colExtBeg), colExtEnd - colExtBeg, chExtBeg);
+
+    _attr.replace(colBeg, colEnd, _attrTable->Intern(attr));
+
+    // Same as in WriteCells(): (un)set the wrap status if we just filled the last column.
+    if (wrap.has_value() && colEnd - 1 == finalColumnInRow)
+    {
+        SetWrapForced(*wrap);
+    }
+
+    return count;
+}
+
+// Routine Description:
+// - writes text that has already been measured with MeasureGlyphRuns() to the row.
+//   This is the equivalent of WriteCells() for arbitrary text with a single attribute,
+//   but it neither goes through OutputCellIterator nor looks up the width of each glyph.
+//   Like WriteAsciiRun() the text is copied into the row in bulk.
+// - Same as WriteCells(), a wide glyph that would start in the last column isn't
+//   written. The column is padded with whitespace and marked as double byte padded.
+// Arguments:
+// - columnBegin - column in row to start writing at
+// - chars - the text to write
+// - runs - the measured glyphs of (at least a prefix of) chars
+// - attr - the attribute to apply to the written columns
+// - columnsWritten - receives the number of columns the written glyphs occupy, not counting any padding.
+// - wrap - change the wrap flag if we hit the end of the row while writing. See WriteCells().
+// - limitRight - right inclusive column ID for the last write in this row. (optional, will just write to the end of row if nullopt)
+// Return Value:
+// - the number of characters that were written to this row.
+size_t ROW::WriteGlyphRuns(const til::CoordType columnBegin, const std::wstring_view& chars, const std::span<const GlyphRun> runs, const TextAttribute& attr, til::CoordType& columnsWritten, const std::optional<bool> wrap, const std::optional<til::CoordType> limitRight)
+{
+    THROW_HR_IF(E_INVALIDARG, columnBegin < 0 || columnBegin >= size());
+    THROW_HR_IF(E_INVALIDARG, limitRight.value_or(0) >= size());
+
+    columnsWritten = 0;
+
+    // If we're given a right-side column limit, use it. Otherwise, the write limit is the final column index available in the char row.
+    const auto finalColumnInRow = limitRight.value_or(size() - 1);
+    if (columnBegin > finalColumnInRow || chars.empty())
+    {
+        return 0;
+    }
+
+    // Find out how many glyphs fit into the row.
+    const auto colBeg = gsl::narrow_cast<uint16_t>(columnBegin);
+    const auto colLimit = gsl::narrow_cast<size_t>(finalColumnInRow) + 1 - colBeg;
+    size_t glyphCols = 0;
+    size_t glyphChars = 0;
+    size_t runCount = 0;
+    size_t lastRunGlyphs = 0;
+    bool padded = false;
+
+    for (const auto& run : runs)
+    {
+        const auto available = (colLimit - glyphCols) / run.glyphWidth;
+        const auto glyphs = std::min({ run.glyphCount, available, (chars.size() - glyphChars) / run.glyphLength });
+        glyphCols += glyphs * run.glyphWidth;
+        glyphChars += glyphs * run.glyphLength;
+        runCount++;
+        lastRunGlyphs = glyphs;
+
+        if (glyphs != run.glyphCount)
+        {
+            // A wide glyph in the last column doesn't fit. See WriteCells().
+            padded = run.glyphWidth == 2 && colLimit - glyphCols == 1 && glyphChars + run.glyphLength <= chars.size();
+            break;
+        }
+    }
+
+    const auto colEnd = gsl::narrow_cast<uint16_t>(colBeg + glyphCols + padded);
+    if (colEnd == colBeg)
+    {
+        return 0;
+    }
+
+    _markChanged();
+
+    // Safety:
+    // * colBeg is now [0, _columnCount)
+    // * colEnd is now (colBeg, _columnCount]
+
+    // This is the same range extension that ReplaceCharacters() does: Any wide glyphs
+    // we partially overwrite at the start or end of the run are replaced with whitespace.
+    // See ReplaceCharacters() for a detailed explanation.
+    uint16_t colExtBeg = colBeg;
+    const uint16_t chExtBeg = _uncheckedCharOffset(colExtBeg);
+    for (; colExtBeg != 0 && _uncheckedIsTrailer(colExtBeg); --colExtBeg)
+    {
+    }
+
+    uint16_t colExtEnd = colEnd;
+    for (; _uncheckedIsTrailer(colExtEnd); ++colExtEnd)
+    {
+    }
+    const uint16_t chExtEnd = _uncheckedCharOffset(colExtEnd);
+
+    // The padding column (if any) is filled with whitespace just like the trailing extension.
+    const uint16_t leadingSpaces = colBeg - colExtBeg;
+    const uint16_t trailingSpaces = gsl::narrow_cast<uint16_t>(colExtEnd - colEnd + padded);
+    const size_t chExtEndNew = glyphChars + leadingSpaces + trailingSpaces + chExtBeg;
+
+    if (chExtEndNew != chExtEnd)
+    {
+        _resizeChars(colExtEnd, chExtBeg, chExtEnd, chExtEndNew);
+    }
+
+    {
+        auto it = _chars.begin() + chExtBeg;
+        it = fill_n_small(it, leadingSpaces, L' ');
+        it = std::copy_n(chars.begin(), glyphChars, it);
+        it = fill_n_small(it, trailingSpaces, L' ');
+    }
+    {
+        auto chPos = chExtBeg;
+        auto it = _charOffsets.begin() + colExtBeg;
+
+        it = iota_n_mut(it, leadingSpaces, chPos);
+
+        for (size_t i = 0; i < runCount; ++i)
+        {
+            const auto& run = til::at(runs, i);
+            const auto glyphs = i + 1 == runCount ? lastRunGlyphs : run.glyphCount;
+
+            if (run.glyphWidth == 1 && run.glyphLength == 1)
+            {
+                it = iota_n_mut(it, glyphs, chPos);
+                continue;
+            }
+
+            for (size_t j = 0; j < glyphs; ++j)
+            {
+                *it++ = chPos;
+                if (run.glyphWidth == 2)
+                {
+                    *it++ = gsl::narrow_cast<uint16_t>(chPos | CharOffsetsTrailer);
+                }
+                chPos = gsl::narrow_cast<uint16_t>(chPos + run.glyphLength);
+            }
+        }
+
+        it = iota_n_mut(it, trailingSpaces, chPos);
+    }
+
+    _attr.replace(colBeg, colEnd, _attrTable->Intern(attr));
+
+    if (padded)
+    {
+        SetDoubleBytePadded(true);
+    }
+
+    // Same as in WriteCells(): (un)set the wrap status if we just filled the last column.
+    if (wrap.has_value() && colEnd - 1 == finalColumnInRow)
+    {
+        SetWrapForced(*wrap);
+    }
+
+    columnsWritten = gsl::narrow_cast<til::CoordType>(glyphCols);
+    return glyphChars;
+}
+
 bool ROW::SetAttrToEnd(const til::CoordType columnBegin, const TextAttribute attr)
 {
-    _attr.replace(_clampedColumnInclusive(columnBegin), _attr.size(), attr);
+    _attr.replace(_clampedColumnInclusive(columnBegin), _attr.size(), _attrTable->Intern(attr));
+    _markChanged();
     return true;
 }
 
 void ROW::ReplaceAttributes(const til::CoordType beginIndex, const til::CoordType endIndex, const TextAttribute& newAttr)
 {
-    _attr.replace(_clampedColumnInclusive(beginIndex), _clampedColumnInclusive(endIndex), newAttr);
+    _attr.replace(_clampedColumnInclusive(beginIndex), _clampedColumnInclusive(endIndex), _attrTable->Intern(newAttr));
+    _markChanged();
 }
 
 void ROW::ReplaceCharacters(til::CoordType columnBegin, til::CoordType width, const std::wstring_view& chars)
@@ -381,6 +773,8 @@ void ROW::ReplaceCharacters(til::CoordType columnBegin, til::CoordType width, co
         return;
     }
 
+    _markChanged();
+
     // Safety:
     // * colBeg is now [0, _columnCount)
     // * colEnd is now (colBeg, _columnCount]
@@ -458,6 +852,136 @@ void ROW::ReplaceCharacters(til::CoordType columnBegin, til::CoordType width, co
     }
 }
 
+// Routine Description:
+// - Copies the glyphs and attributes in the columns [sourceBegin, sourceEnd) of another row
+//   into this row, starting at columnBegin. This is a lot faster than copying glyph by glyph,
+//   because the text and char offsets are copied in bulk and the attributes as runs.
+// - Wide glyphs in the source that are cut off by either end of the range aren't copied.
+//   Wide glyphs in this row that are partially overwritten are replaced with whitespace.
+// Arguments:
+// - columnBegin - column in this row to start writing at
+// - source - the row to copy from. It may not be this row.
+// - sourceBegin - first column in the source row to copy
+// - sourceEnd - past-the-end column in the source row to copy
+// Return Value:
+// - the number of columns that were copied.
+til::CoordType ROW::CopyRangeFrom(const til::CoordType columnBegin, const ROW& source, const til::CoordType sourceBegin, const til::CoordType sourceEnd)
+{
+    auto srcBeg = source._clampedColumnInclusive(sourceBegin);
+    auto srcEnd = source._clampedColumnInclusive(sourceEnd);
+    const auto colBeg = _clampedColumnInclusive(columnBegin);
+
+    // Clip the range to what fits into this row and
+    // then shrink it until it starts and ends on glyph boundaries.
+    srcEnd = gsl::narrow_cast<uint16_t>(std::min<size_t>(srcEnd, size_t{ srcBeg } + (_columnCount - colBeg)));
+    for (; srcBeg < srcEnd && source._uncheckedIsTrailer(srcBeg); ++srcBeg)
+    {
+    }
+    for (; srcEnd > srcBeg && source._uncheckedIsTrailer(srcEnd); --srcEnd)
+    {
+    }
+    if (srcBeg >= srcEnd)
+    {
+        return 0;
+    }
+
+    _markChanged();
+
+    const uint16_t count = srcEnd - srcBeg;
+    const uint16_t colEnd = colBeg + count;
+    const auto srcChBeg = source._uncheckedCharOffset(srcBeg);
+    const auto srcChEnd = source._uncheckedCharOffset(srcEnd);
+
+    // Safety:
+    // * colBeg is now [0, _columnCount)
+    // * colEnd is now (colBeg, _columnCount]
+
+    // This is the same range extension that ReplaceCharacters() does: Any wide glyphs
+    // we partially overwrite at the start or end of the range are replaced with whitespace.
+    // See ReplaceCharacters() for a detailed explanation.
+    uint16_t colExtBeg = colBeg;
+    const uint16_t chExtBeg = _uncheckedCharOffset(colExtBeg);
+    for (; colExtBeg != 0 && _uncheckedIsTrailer(colExtBeg); --colExtBeg)
+    {
+    }
+
+    uint16_t colExtEnd = colEnd;
+    for (; _uncheckedIsTrailer(colExtEnd); ++colExtEnd)
+    {
+    }
+    const uint16_t chExtEnd = _uncheckedCharOffset(colExtEnd);
+
+    const uint16_t leadingSpaces = colBeg - colExtBeg;
+    const uint16_t trailingSpaces = colExtEnd - colEnd;
+    const size_t chExtEndNew = (srcChEnd - srcChBeg) + leadingSpaces + trailingSpaces + chExtBeg;
+
+    if (chExtEndNew != chExtEnd)
+    {
+        _resizeChars(colExtEnd, chExtBeg, chExtEnd, chExtEndNew);
+    }
+
+    {
+        auto it = _chars.begin() + chExtBeg;
+        it = fill_n_small(it, leadingSpaces, L' ');
+        it = std::copy_n(source._chars.begin() + srcChBeg, srcChEnd - srcChBeg, it);
+        it = fill_n_small(it, trailingSpaces, L' ');
+    }
+    {
+        auto chPos = chExtBeg;
+        auto it = _charOffsets.begin() + colExtBeg;
+
+        it = iota_n_mut(it, leadingSpaces, chPos);
+
+        // The source offsets only need to be rebased onto our own string. The
+        // trailer flag is preserved, since it's not affected by the subtraction.
+        const auto rebase = gsl::narrow_cast<uint16_t>(chPos - srcChBeg);
+        it = std::transform(source._charOffsets.begin() + srcBeg, source._charOffsets.begin() + srcEnd, it, [=](const uint16_t offset) noexcept {
+            return gsl::narrow_cast<uint16_t>(offset + rebase);
+        });
+        chPos = gsl::narrow_cast<uint16_t>(chPos + (srcChEnd - srcChBeg));
+
+        it = iota_n_mut(it, trailingSpaces, chPos);
+    }
+
+    CopyAttributesFrom(colBeg, source, srcBeg, srcEnd);
+    return count;
+}
+
+// Routine Description:
+// - Copies the attributes in the columns [sourceBegin, sourceEnd) of another row into this
+//   row, starting at columnBegin. The runs are sliced out of the source and inserted as a whole.
+// Arguments:
+// - columnBegin - column in this row to start writing at
+// - source - the row to copy from
+// - sourceBegin - first column in the source row to copy
+// - sourceEnd - past-the-end column in the source row to copy. Clipped to fit into this row.
+void ROW::CopyAttributesFrom(const til::CoordType columnBegin, const ROW& source, const til::CoordType sourceBegin, const til::CoordType sourceEnd)
+{
+    const auto srcBeg = source._clampedColumnInclusive(sourceBegin);
+    const auto colBeg = _clampedColumnInclusive(columnBegin);
+    const auto srcEnd = gsl::narrow_cast<uint16_t>(std::min<size_t>(source._clampedColumnInclusive(sourceEnd), size_t{ srcBeg } + (_columnCount - colBeg)));
+    if (srcBeg >= srcEnd)
+    {
+        return;
+    }
+
+    _markChanged();
+
+    const auto colEnd = gsl::narrow_cast<uint16_t>(colBeg + (srcEnd - srcBeg));
+    const auto slice = source._attr.slice(srcBeg, srcEnd);
+
+    if (_attrTable == source._attrTable)
+    {
+        const auto& runs = slice.runs();
+        _attr.replace(colBeg, colEnd, { runs.data(), runs.size() });
+    }
+    else
+    {
+        const auto runs = _internRuns(*source._attrTable, slice.runs());
+        _attr.replace(colBeg, colEnd, { runs.data(), runs.size() });
+    }
+}
+
 // This function represents the slow path of ReplaceCharacters(),
 // as it reallocates the backing buffer and shifts the char offsets.
 // The parameters are difficult to explain, but their names are identical to
@@ -495,14 +1019,26 @@ void ROW::_resizeChars(uint16_t colExtEnd, uint16_t chExtBeg, uint16_t chExtEnd,
     }
 }
 
-const til::small_rle<TextAttribute, uint16_t, 1>& ROW::Attributes() const noexcept
+TextAttribute ROW::GetAttrByColumn(const til::CoordType column) const
 {
-    return _attr;
+    return _attrTable->Get(_attr.at(_clampedUint16(column)));
 }
 
-TextAttribute ROW::GetAttrByColumn(const til::CoordType column) const
+// Returns an iterator positioned at the run of attributes that contains the given column.
+// Its Begin() may thus be less than `column`. It's falsy if the column is past the end of the row.
+ROW::AttrRunIterator ROW::AttrRunAt(const til::CoordType column) const noexcept
 {
-    return _attr.at(_clampedUint16(column));
+    const auto& runs = _attr.runs();
+    auto it = runs.begin();
+    const auto end = runs.end();
+    til::CoordType begin = 0;
+
+    for (; it != end && begin + it->length <= column; ++it)
+    {
+        begin += it->length;
+    }
+
+    return { it, end, _attrTable, begin };
 }
 
 std::vector<uint16_t> ROW::GetHyperlinks() const
@@ -510,14 +1046,307 @@ std::vector<uint16_t> ROW::GetHyperlinks() const
     std::vector<uint16_t> ids;
     for (const auto& run : _attr.runs())
     {
-        if (run.value.IsHyperlink())
+        const auto& attr = _attrTable->Get(run.value);
+        if (attr.IsHyperlink())
         {
-            ids.emplace_back(run.value.GetHyperlinkId());
+            ids.emplace_back(attr.GetHyperlinkId());
         }
     }
     return ids;
 }
 
+// Routine Description:
+// - marks the attribute IDs used by this row as live. See TextAttributeTable::Compact().
+// Arguments:
+// - live - a flag for each ID in the table
+void ROW::MarkAttributes(std::vector<bool>& live) const
+{
+    for (const auto& run : _attr.runs())
+    {
+        live.at(run.value) = true;
+    }
+}
+
+// Routine Description:
+// - updates the attribute IDs after the table got compacted. See TextAttributeTable::Compact().
+// Arguments:
+// - remap - the new ID for each old ID
+void ROW::RemapAttributes(const std::vector<TextAttributeTable::id_type>& remap)
+{
+    // Compaction preserves the relative order of IDs and never maps two live IDs
+    // onto the same one. The runs thus stay the same, only their values change.
+    decltype(_attr)::container runs(_attr.runs());
+    for (auto& run : runs)
+    {
+        run.value = remap.at(run.value);
+    }
+    _attr = decltype(_attr){ std::move(runs) };
+}
+
+const wchar_t* ROW::BackingBuffer() const noexcept
+{
+    return _charsBuffer;
+}
+
+bool ROW::IsFrozen() const noexcept
+{
+    return _frozenData != nullptr;
+}
+
+// Routine Description:
+// - returns the number of bytes the compressed text of a frozen row occupies on the heap.
+size_t ROW::FrozenSize() const noexcept
+{
+    if (!_frozenData)
+    {
+        return 0;
+    }
+
+    FrozenHeader header;
+    memcpy(&header, _frozenData.get(), sizeof(header));
+    return header.size;
+}
+
+// Routine Description:
+// - compresses the text of this row into a heap allocation, so that the owning TextBuffer can release
+//   the memory backing _charsBuffer and _charOffsetsBuffer until Thaw() is called. Attributes and row
+//   flags are already stored compactly and are unaffected. While frozen, the row reads as blank.
+// - The compressed data consists of a FrozenHeader, the text and the char offsets. Trailing whitespace
+//   is implied by the width of the row. The offsets are omitted if they're simply 0, 1, 2, ...
+//   (= 1 char per column, which is the most common case). The text is a sequence of tokens:
+//   * 0x00-0x7F: an ASCII character
+//   * 0x80-0xBF: the next character repeated 3-66 times. It's either an ASCII character or 0xC0
+//     followed by a little-endian UTF-16 code unit.
+//   * 0xC0-0xFF: 1-64 little-endian UTF-16 code units follow
+//   Each column's offset is then stored as a byte, with the most significant bit being
+//   CharOffsetsTrailer and the rest the increase over the previous column's offset.
+//   Increases of 0x7F and more are stored as 0x7F followed by a little-endian uint16_t.
+// Arguments:
+// - scratch - a buffer for the compressed data, so that it doesn't need to be reallocated for every row
+// - blankChars - read-only blanks for _chars while frozen, at least as long as the row is wide
+// - blankOffsets - read-only offsets for _charOffsets while frozen, at least 1 longer than the row is wide
+// Return Value:
+// - FrozenSize()
+size_t ROW::Freeze(std::vector<uint8_t>& scratch, std::span<wchar_t> blankChars, std::span<uint16_t> blankOffsets)
+{
+    if (_frozenData)
+    {
+        return FrozenSize();
+    }
+
+    uint16_t columns = _columnCount;
+    for (; columns != 0; --columns)
+    {
+        const size_t col = columns - 1u;
+        const auto beg = _uncheckedCharOffset(col);
+        if (_uncheckedIsTrailer(col) || _uncheckedCharOffset(col + 1) - beg != 1 || _uncheckedChar(beg) != L' ')
+        {
+            break;
+        }
+    }
+
+    const auto charCount = _uncheckedCharOffset(columns);
+    auto hasOffsets = false;
+    for (uint16_t col = 0; col < columns; ++col)
+    {
+        if (til::at(_charOffsets, col) != col)
+        {
+            hasOffsets = true;
+            break;
+        }
+    }
+
+    const auto putByte = [&](const auto value) {
+        scratch.emplace_back(gsl::narrow_cast<uint8_t>(value));
+    };
+    const auto putUnit = [&](const uint16_t value) {
+        putByte(value);
+        putByte(value >> 8);
+    };
+
+    scratch.clear();
+    scratch.resize(sizeof(FrozenHeader));
+
+    const auto text = _chars.first(charCount);
+    const auto repeatCount = [&](size_t i) {
+        const auto ch = til::at(text, i);
+        size_t count = 1;
+        for (; i + count < text.size() && count < 66 && til::at(text, i + count) == ch; ++count)
+        {
+        }
+        return count;
+    };
+
+    for (size_t i = 0; i < text.size();)
+    {
+        const auto ch = til::at(text, i);
+
+        if (const auto count = repeatCount(i); count >= 3)
+        {
+            putByte(0x80 + count - 3);
+            if (ch < 0x80)
+            {
+                putByte(ch);
+            }
+            else
+            {
+                putByte(0xC0);
+                putUnit(ch);
+            }
+            i += count;
+        }
+        else if (ch < 0x80)
+        {
+            putByte(ch);
+            i++;
+        }
+        else
+        {
+            // A literal run of non-ASCII chars, up to the next ASCII char or repetition.
+            const auto token = scratch.size();
+            putByte(0xC0);
+            size_t count = 0;
+            for (; i < text.size() && count < 64 && til::at(text, i) >= 0x80; ++i, ++count)
+            {
+                if (count != 0 && repeatCount(i) >= 3)
+                {
+                    break;
+                }
+                putUnit(til::at(text, i));
+            }
+            til::at(scratch, token) = gsl::narrow_cast<uint8_t>(0xC0 + count - 1);
+        }
+    }
+
+    if (hasOffsets)
+    {
+        uint16_t previous = 0;
+        for (uint16_t col = 0; col < columns; ++col)
+        {
+            const auto offset = til::at(_charOffsets, col);
+            const uint16_t current = offset & CharOffsetsMask;
+            const uint16_t increase = current - previous;
+            const uint8_t trailer = (offset & CharOffsetsTrailer) ? 0x80 : 0;
+            previous = current;
+
+            if (increase < 0x7F)
+            {
+                putByte(trailer | increase);
+            }
+            else
+            {
+                putByte(trailer | 0x7F);
+                putUnit(increase);
+            }
+        }
+    }
+
+    const FrozenHeader header{
+        .size = gsl::narrow<uint32_t>(scratch.size()),
+        .columns = columns,
+        .charCount = charCount,
+        .hasOffsets = hasOffsets,
+    };
+    memcpy(scratch.data(), &header, sizeof(header));
+
+    auto data = std::make_unique_for_overwrite<uint8_t[]>(scratch.size());
+    memcpy(data.get(), scratch.data(), scratch.size());
+
+    _charsHeap.reset();
+    _chars = blankChars.first(_columnCount);
+    _charOffsets = blankOffsets.first(::base::strict_cast<size_t>(_columnCount) + 1u);
+    _frozenData = std::move(data);
+    _markChanged();
+    return header.size;
+}
+
+// Routine Description:
+// - decompresses the text that was stored by Freeze() back into the row's own buffers.
+//   The owning TextBuffer must not have released their memory for good.
+void ROW::Thaw()
+{
+    if (!_frozenData)
+    {
+        return;
+    }
+
+    FrozenHeader header;
+    memcpy(&header, _frozenData.get(), sizeof(header));
+
+    const std::span<const uint8_t> data{ _frozenData.get(), header.size };
+    size_t pos = sizeof(header);
+    const auto getByte = [&]() {
+        return til::at(data, pos++);
+    };
+    const auto getUnit = [&]() {
+        const uint16_t lo = getByte();
+        const uint16_t hi = getByte();
+        return gsl::narrow_cast<uint16_t>(lo | hi << 8);
+    };
+
+    const uint16_t trailingWhitespace = _columnCount - header.columns;
+    std::unique_ptr<wchar_t[]> charsHeap;
+    std::span chars{ _charsBuffer, _columnCount };
+    const std::span charOffsets{ _charOffsetsBuffer, ::base::strict_cast<size_t>(_columnCount) + 1u };
+    if (const size_t capacity = size_t{ header.charCount } + trailingWhitespace; capacity > _columnCount)
+    {
+        charsHeap = std::make_unique_for_overwrite<wchar_t[]>(capacity);
+        chars = { charsHeap.get(), capacity };
+    }
+
+    {
+        auto it = chars.begin();
+        for (const auto end = it + header.charCount; it != end;)
+        {
+            const auto token = getByte();
+            if (token < 0x80)
+            {
+                *it++ = token;
+            }
+            else if (token < 0xC0)
+            {
+                const auto first = getByte();
+                const wchar_t ch = first == 0xC0 ? getUnit() : first;
+                it = std::fill_n(it, token - 0x80 + 3, ch);
+            }
+            else
+            {
+                for (auto count = token - 0xC0 + 1; count; --count)
+                {
+                    *it++ = getUnit();
+                }
+            }
+        }
+        std::fill_n(it, trailingWhitespace, L' ');
+    }
+    {
+        auto it = charOffsets.begin();
+        if (header.hasOffsets)
+        {
+            uint16_t offset = 0;
+            for (uint16_t col = 0; col < header.columns; ++col)
+            {
+                const auto byte = getByte();
+                const uint16_t increase = byte & 0x7F;
+                offset = gsl::narrow_cast<uint16_t>(offset + (increase == 0x7F ? getUnit() : increase));
+                *it++ = gsl::narrow_cast<uint16_t>(offset | ((byte & 0x80) ? CharOffsetsTrailer : 0));
+            }
+        }
+        else
+        {
+            it = iota_n(it, header.columns, uint16_t{ 0 });
+        }
+        // The _charOffsets array is 1 wider than the row, storing the past-the-end index into _chars.
+        iota_n(it, trailingWhitespace + 1u, header.charCount);
+    }
+
+    _charsHeap = std::move(charsHeap);
+    _chars = chars;
+    _charOffsets = charOffsets;
+    _frozenData.reset();
+    _markChanged();
+}
+
 uint16_t ROW::size() const noexcept
 {
     return _columnCount;
@@ -624,6 +1453,35 @@ std::wstring_view ROW::GetText() const noexcept
     return { _chars.data(), _charSize() };
 }
 
+// Returns the column of the glyph that contains the character at the given offset into GetText().
+// If the glyph is wide, the column of its leading half is returned.
+// Offsets past the end of the text return size().
+til::CoordType ROW::GetLeadingColumnAtCharOffset(const ptrdiff_t offset) const noexcept
+{
+    // _charOffsets is sorted (ignoring the CharOffsetsTrailer flag), so we can
+    // binary search for the last column that starts at or before `offset`.
+    size_t lo = 0;
+    size_t hi = _columnCount;
+    while (lo < hi)
+    {
+        const auto mid = (lo + hi + 1) / 2;
+        // Safety: mid is (lo, hi] and thus [1, _columnCount].
+        if (_uncheckedCharOffset(mid) <= offset)
+        {
+            lo = mid;
+        }
+        else
+        {
+            hi = mid - 1;
+        }
+    }
+    // Safety: lo is [0, _columnCount].
+    for (; lo != 0 && _uncheckedIsTrailer(lo); --lo)
+    {
+    }
+    return gsl::narrow_cast<til::CoordType>(lo);
+}
+
 DelimiterClass ROW::DelimiterClassAt(til::CoordType column, const std::wstring_view& wordDelimiters) const noexcept
 {
     const auto col = _clampedColumn(column);
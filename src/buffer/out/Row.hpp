@@ -27,6 +27,8 @@ Revision History:
 #include "LineRendition.hpp"
 #include "OutputCell.hpp"
 #include "OutputCellIterator.hpp"
+#include "TextAttributeTable.hpp"
+#include "../../types/inc/convert.hpp"
 
 class TextBuffer;
 
@@ -40,8 +42,98 @@ enum class DelimiterClass
 class ROW final
 {
 public:
+    // Iterates over the TextAttribute of each column, by looking
+    // up the IDs stored in the row in its TextAttributeTable.
+    class AttrIterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = TextAttribute;
+        using difference_type = ptrdiff_t;
+        using pointer = const TextAttribute*;
+        using reference = const TextAttribute&;
+        using id_iterator = til::small_rle<TextAttributeTable::id_type, uint16_t, 1>::const_iterator;
+
+        AttrIterator(id_iterator it, const TextAttributeTable* table) noexcept :
+            _it{ std::move(it) },
+            _table{ table }
+        {
+        }
+
+        reference operator*() const noexcept { return _table->Get(*_it); }
+        pointer operator->() const noexcept { return &operator*(); }
+
+        AttrIterator& operator++() noexcept
+        {
+            ++_it;
+            return *this;
+        }
+        AttrIterator operator++(int) noexcept
+        {
+            auto tmp = *this;
+            ++_it;
+            return tmp;
+        }
+        AttrIterator& operator+=(const difference_type move) noexcept
+        {
+            _it += move;
+            return *this;
+        }
+        AttrIterator operator+(const difference_type move) const noexcept
+        {
+            auto tmp = *this;
+            tmp += move;
+            return tmp;
+        }
+
+        bool operator==(const AttrIterator& other) const noexcept { return _it == other._it; }
+        bool operator!=(const AttrIterator& other) const noexcept { return _it != other._it; }
+
+    private:
+        id_iterator _it;
+        const TextAttributeTable* _table;
+    };
+
+    // Iterates over the runs of identical attributes in a row. Unlike AttrIterator
+    // this only visits each run once, instead of each column of it.
+    class AttrRunIterator
+    {
+    public:
+        using run_iterator = til::small_rle<TextAttributeTable::id_type, uint16_t, 1>::container::const_iterator;
+
+        AttrRunIterator(run_iterator it, run_iterator end, const TextAttributeTable* table, til::CoordType begin) noexcept :
+            _it{ it },
+            _end{ end },
+            _table{ table },
+            _begin{ begin }
+        {
+        }
+
+        explicit operator bool() const noexcept { return _it != _end; }
+
+        const TextAttribute& Attr() const noexcept { return _table->Get(_it->value); }
+        // The first column of the run.
+        til::CoordType Begin() const noexcept { return _begin; }
+        // The column past the last one of the run.
+        til::CoordType End() const noexcept { return _begin + _it->length; }
+
+        AttrRunIterator& operator++() noexcept
+        {
+            _begin += _it->length;
+            ++_it;
+            return *this;
+        }
+
+    private:
+        run_iterator _it;
+        run_iterator _end;
+        const TextAttributeTable* _table;
+        til::CoordType _begin;
+    };
+
     ROW() = default;
-    ROW(wchar_t* charsBuffer, uint16_t* charOffsetsBuffer, uint16_t rowWidth, const TextAttribute& fillAttribute);
+    ROW(TextAttributeTable& attrTable, uint64_t& bufferGeneration) noexcept;
+    ROW(TextAttributeTable& attrTable, uint64_t& bufferGeneration, wchar_t* charsBuffer, uint16_t* charOffsetsBuffer, uint16_t rowWidth, const TextAttribute& fillAttribute);
 
     ROW(const ROW& other) = delete;
     ROW& operator=(const ROW& other) = delete;
@@ -57,18 +149,23 @@ public:
     bool WasDoubleBytePadded() const noexcept;
     void SetLineRendition(const LineRendition lineRendition) noexcept;
     LineRendition GetLineRendition() const noexcept;
+    void SetGeneration(const uint64_t generation) noexcept;
+    uint64_t GetGeneration() const noexcept;
 
     void Reset(const TextAttribute& attr);
     void Resize(wchar_t* charsBuffer, uint16_t* charOffsetsBuffer, uint16_t rowWidth, const TextAttribute& fillAttribute);
-    void TransferAttributes(const til::small_rle<TextAttribute, uint16_t, 1>& attr, til::CoordType newWidth);
+    void TransferAttributes(const ROW& source, til::CoordType newWidth);
 
     void ClearCell(til::CoordType column);
     OutputCellIterator WriteCells(OutputCellIterator it, til::CoordType columnBegin, std::optional<bool> wrap = std::nullopt, std::optional<til::CoordType> limitRight = std::nullopt);
+    til::CoordType WriteAsciiRun(til::CoordType columnBegin, const std::wstring_view& chars, const TextAttribute& attr, std::optional<bool> wrap = std::nullopt, std::optional<til::CoordType> limitRight = std::nullopt);
+    size_t WriteGlyphRuns(til::CoordType columnBegin, const std::wstring_view& chars, std::span<const GlyphRun> runs, const TextAttribute& attr, til::CoordType& columnsWritten, std::optional<bool> wrap = std::nullopt, std::optional<til::CoordType> limitRight = std::nullopt);
     bool SetAttrToEnd(til::CoordType columnBegin, TextAttribute attr);
     void ReplaceAttributes(til::CoordType beginIndex, til::CoordType endIndex, const TextAttribute& newAttr);
     void ReplaceCharacters(til::CoordType columnBegin, til::CoordType width, const std::wstring_view& chars);
+    til::CoordType CopyRangeFrom(til::CoordType columnBegin, const ROW& source, til::CoordType sourceBegin, til::CoordType sourceEnd);
+    void CopyAttributesFrom(til::CoordType columnBegin, const ROW& source, til::CoordType sourceBegin, til::CoordType sourceEnd);
 
-    const til::small_rle<TextAttribute, uint16_t, 1>& Attributes() const noexcept;
     TextAttribute GetAttrByColumn(til::CoordType column) const;
     std::vector<uint16_t> GetHyperlinks() const;
     uint16_t size() const noexcept;
@@ -78,10 +175,21 @@ public:
     std::wstring_view GlyphAt(til::CoordType column) const noexcept;
     DbcsAttribute DbcsAttrAt(til::CoordType column) const noexcept;
     std::wstring_view GetText() const noexcept;
+    til::CoordType GetLeadingColumnAtCharOffset(ptrdiff_t offset) const noexcept;
     DelimiterClass DelimiterClassAt(til::CoordType column, const std::wstring_view& wordDelimiters) const noexcept;
 
-    auto AttrBegin() const noexcept { return _attr.begin(); }
-    auto AttrEnd() const noexcept { return _attr.end(); }
+    AttrIterator AttrBegin() const noexcept { return { _attr.begin(), _attrTable }; }
+    AttrIterator AttrEnd() const noexcept { return { _attr.end(), _attrTable }; }
+    AttrRunIterator AttrRunAt(til::CoordType column) const noexcept;
+
+    void MarkAttributes(std::vector<bool>& live) const;
+    void RemapAttributes(const std::vector<TextAttributeTable::id_type>& remap);
+
+    const wchar_t* BackingBuffer() const noexcept;
+    bool IsFrozen() const noexcept;
+    size_t FrozenSize() const noexcept;
+    size_t Freeze(std::vector<uint8_t>& scratch, std::span<wchar_t> blankChars, std::span<uint16_t> blankOffsets);
+    void Thaw();
 
 #ifdef UNIT_TESTING
     friend constexpr bool operator==(const ROW& a, const ROW& b) noexcept;
@@ -95,6 +203,15 @@ private:
     static constexpr uint16_t CharOffsetsTrailer = 0x8000;
     static constexpr uint16_t CharOffsetsMask = 0x7fff;
 
+    // The header of _frozenData. See Freeze().
+    struct FrozenHeader
+    {
+        uint32_t size;
+        uint16_t columns;
+        uint16_t charCount;
+        bool hasOffsets;
+    };
+
     template<typename T>
     static constexpr uint16_t _clampedUint16(T v) noexcept;
     template<typename T>
@@ -107,7 +224,11 @@ private:
     uint16_t _uncheckedCharOffset(size_t col) const noexcept;
     bool _uncheckedIsTrailer(size_t col) const noexcept;
 
+    using AttrRuns = til::small_rle<TextAttributeTable::id_type, uint16_t, 1>::container;
+
     void _init() noexcept;
+    void _markChanged() noexcept;
+    AttrRuns _internRuns(const TextAttributeTable& sourceTable, const AttrRuns& runs) const;
     void _resizeChars(uint16_t colExtEnd, uint16_t chExtBeg, uint16_t chExtEnd, size_t chExtEndNew);
 
     // These fields are a bit "wasteful", but it makes all this a bit more robust against
@@ -125,6 +246,9 @@ private:
     // a simplified chars buffer, without having to allocate any additional heap memory.
     // _charsBuffer fits _columnCount characters at most.
     wchar_t* _charsBuffer = nullptr;
+    // The TextBuffer-provided buffer for _charOffsets. _charOffsets only points
+    // elsewhere while the row is frozen. See Freeze().
+    uint16_t* _charOffsetsBuffer = nullptr;
     // ...but if this ROW needs to store more than _columnCount characters
     // then it will allocate a larger string on the heap and store it here.
     // The capacity of this string on the heap is stored in _chars.size().
@@ -150,9 +274,15 @@ private:
     // In other words, _charOffsets tells us both the width in chars and width in columns.
     // See CharOffsetsTrailer for more information.
     std::span<uint16_t> _charOffsets;
-    // _attr is a run-length-encoded vector of TextAttribute with a decompressed
+    // The table that the IDs in _attr refer to. It's owned by the TextBuffer.
+    TextAttributeTable* _attrTable = nullptr;
+    // _attr is a run-length-encoded vector of TextAttributeTable IDs with a decompressed
     // length equal to _columnCount (= 1 TextAttribute per column).
-    til::small_rle<TextAttribute, uint16_t, 1> _attr;
+    til::small_rle<TextAttributeTable::id_type, uint16_t, 1> _attr;
+    // The generation counter of the owning TextBuffer. Modifying the row increments it.
+    uint64_t* _bufferGeneration = nullptr;
+    // The value of TextBuffer::GetGeneration() when this row was last modified.
+    uint64_t _generation = 0;
     // The width of the row in visual columns.
     uint16_t _columnCount = 0;
     // Stores double-width/height (DECSWL/DECDWL/DECDHL) attributes.
@@ -161,6 +291,8 @@ private:
     bool _wrapForced = false;
     // Occurs when the user runs out of text to support a double byte character and we're forced to the next line
     bool _doubleBytePadded = false;
+    // The compressed text of a frozen row, or nullptr if the row isn't frozen. See Freeze().
+    std::unique_ptr<uint8_t[]> _frozenData;
 };
 
 #ifdef UNIT_TESTING
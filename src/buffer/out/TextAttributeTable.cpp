@@ -0,0 +1,131 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "TextAttributeTable.hpp"
+
+#include <til/hash.h>
+
+size_t TextAttributeTable::Hasher::operator()(const TextAttribute& attr) const noexcept
+{
+    return til::hash(attr);
+}
+
+// Routine Description:
+// - Sets the function that Intern() calls to compact the table. It must mark the IDs that
+//   are in use, call Compact() and update the IDs in use with the returned mapping.
+void TextAttributeTable::SetCompactor(std::function<void()> compactor) noexcept
+{
+    _compactor = std::move(compactor);
+}
+
+// Routine Description:
+// - Returns the ID for the given attribute, adding it to the table if necessary.
+// - Adding an attribute may compact the table first. This renumbers all IDs
+//   that aren't stored in a row yet. See Epoch().
+// Arguments:
+// - attr - The attribute to look up
+// Return Value:
+// - The ID that can be passed to Get() to retrieve the attribute again
+TextAttributeTable::id_type TextAttributeTable::Intern(const TextAttribute& attr)
+{
+    if (_hasLast && _lastAttr == attr)
+    {
+        return _lastId;
+    }
+
+    id_type id = 0;
+    if (const auto it = _ids.find(attr); it != _ids.end())
+    {
+        id = it->second;
+    }
+    else
+    {
+        if (ShouldCompact() && _compactor)
+        {
+            _compactor();
+        }
+
+        // A buffer can't hold anywhere near 2^32 cells, and compaction keeps the table
+        // at most twice as large as the number of attributes in use. If we still got here,
+        // handing out an existing ID would silently show the text in the wrong colors.
+        FAIL_FAST_IF_MSG(_attributes.size() >= Capacity, "TextAttributeTable is full");
+
+        id = gsl::narrow_cast<id_type>(_attributes.size());
+        _attributes.emplace_back(attr);
+        _ids.emplace(attr, id);
+    }
+
+    _lastAttr = attr;
+    _lastId = id;
+    _hasLast = true;
+    return id;
+}
+
+const TextAttribute& TextAttributeTable::Get(const id_type id) const noexcept
+{
+    return til::at(_attributes, id);
+}
+
+size_t TextAttributeTable::size() const noexcept
+{
+    return _attributes.size();
+}
+
+// Routine Description:
+// - Returns a number that changes whenever the IDs got renumbered by Compact().
+//   IDs that were returned by Intern() but haven't been stored in a row yet
+//   are only valid as long as this number stays the same.
+uint64_t TextAttributeTable::Epoch() const noexcept
+{
+    return _epoch;
+}
+
+// Routine Description:
+// - Returns true if enough attributes were added since the last call to Compact() for it
+//   to be worthwhile. The threshold is twice the number of attributes that survived the
+//   last compaction, which keeps the amortized cost per added attribute constant. It also
+//   means that a compaction that freed nothing isn't repeated until the table has grown
+//   by as many attributes again.
+bool TextAttributeTable::ShouldCompact() const noexcept
+{
+    return _attributes.size() >= _compactionThreshold;
+}
+
+// Routine Description:
+// - Removes all attributes that aren't marked as live and renumbers the remaining ones.
+// Arguments:
+// - live - Indicates for each ID whether it's still in use
+// Return Value:
+// - A mapping from old IDs to new IDs. The entries for removed IDs are undefined.
+std::vector<TextAttributeTable::id_type> TextAttributeTable::Compact(const std::vector<bool>& live)
+{
+    std::vector<id_type> remap(_attributes.size());
+    std::vector<TextAttribute> attributes;
+    attributes.reserve(std::count(live.begin(), live.end(), true));
+
+    _ids.clear();
+
+    for (size_t i = 0; i < _attributes.size(); ++i)
+    {
+        if (i < live.size() && live[i])
+        {
+            const auto id = gsl::narrow_cast<id_type>(attributes.size());
+            const auto& attr = til::at(_attributes, i);
+            til::at(remap, i) = id;
+            attributes.emplace_back(attr);
+            _ids.emplace(attr, id);
+        }
+    }
+
+    // If nothing was removed, the mapping is the identity and all IDs remain valid.
+    if (attributes.size() != _attributes.size())
+    {
+        _epoch++;
+    }
+
+    _attributes = std::move(attributes);
+    _compactionThreshold = std::max(_attributes.size() * 2, MinCompactionThreshold);
+    _hasLast = false;
+    return remap;
+}
@@ -0,0 +1,68 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- TextAttributeTable.hpp
+
+Abstract:
+- Interns the TextAttributes used by the rows of a TextBuffer, so that each ROW
+  only needs to store a compact 32-bit ID per attribute run instead of a full
+  TextAttribute. Comparing two IDs is also a lot cheaper than a memcmp().
+  A 16-bit ID isn't enough, because a buffer can easily show more than 65536
+  distinct attributes at once, for instance an image drawn with RGB colors.
+- IDs are never reused while they're referenced. Instead, whenever Intern() is
+  about to add a new attribute and enough were added since the last time, it calls
+  the compactor given by the TextBuffer. The compactor marks the IDs that are still in use and
+  calls Compact(), which returns a mapping from the old to the new IDs that the rows are updated with.
+  Since every write to a row interns its attributes, this covers all of them.
+--*/
+
+#pragma once
+
+#include "TextAttribute.hpp"
+
+class TextAttributeTable final
+{
+public:
+    using id_type = uint32_t;
+
+    TextAttributeTable() = default;
+    TextAttributeTable(const TextAttributeTable&) = delete;
+    TextAttributeTable& operator=(const TextAttributeTable&) = delete;
+    TextAttributeTable(TextAttributeTable&&) = delete;
+    TextAttributeTable& operator=(TextAttributeTable&&) = delete;
+
+    void SetCompactor(std::function<void()> compactor) noexcept;
+
+    id_type Intern(const TextAttribute& attr);
+    const TextAttribute& Get(const id_type id) const noexcept;
+    size_t size() const noexcept;
+    uint64_t Epoch() const noexcept;
+
+    bool ShouldCompact() const noexcept;
+    std::vector<id_type> Compact(const std::vector<bool>& live);
+
+private:
+    struct Hasher
+    {
+        size_t operator()(const TextAttribute& attr) const noexcept;
+    };
+
+    // Not max() + 1, which would overflow size_t in 32-bit builds.
+    static constexpr size_t Capacity = std::numeric_limits<id_type>::max();
+    static constexpr size_t MinCompactionThreshold = 1024;
+
+    std::vector<TextAttribute> _attributes;
+    std::unordered_map<TextAttribute, id_type, Hasher> _ids;
+    size_t _compactionThreshold = MinCompactionThreshold;
+    std::function<void()> _compactor;
+    // Incremented whenever Compact() renumbers the IDs. See Epoch().
+    uint64_t _epoch = 0;
+
+    // Consecutive writes almost always use the same attribute.
+    // Caching the last result skips the hash lookup for those.
+    TextAttribute _lastAttr;
+    id_type _lastId = 0;
+    bool _hasLast = false;
+};
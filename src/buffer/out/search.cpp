@@ -5,10 +5,7 @@
 
 #include "search.h"
 
-#include <til/unicode.h>
-
 #include "textBuffer.hpp"
-#include "../types/inc/GlyphWidth.hpp"
 
 using namespace Microsoft::Console::Types;
 
@@ -28,11 +25,10 @@ Search::Search(Microsoft::Console::Render::IRenderData& renderData,
                const Sensitivity sensitivity) :
     _direction(direction),
     _sensitivity(sensitivity),
-    _needle(s_CreateNeedleFromString(str)),
+    _needle(str),
     _renderData(renderData),
     _coordAnchor(s_GetInitialAnchor(renderData, direction))
 {
-    _coordNext = _coordAnchor;
 }
 
 // Routine Description:
@@ -53,11 +49,10 @@ Search::Search(Microsoft::Console::Render::IRenderData& renderData,
                const til::point anchor) :
     _direction(direction),
     _sensitivity(sensitivity),
-    _needle(s_CreateNeedleFromString(str)),
+    _needle(str),
     _coordAnchor(anchor),
     _renderData(renderData)
 {
-    _coordNext = _coordAnchor;
 }
 
 // Routine Description
@@ -69,28 +64,73 @@ Search::Search(Microsoft::Console::Render::IRenderData& renderData,
 // - NOTE: You can FindNext() again after False to go around the buffer again.
 bool Search::FindNext()
 {
-    if (_reachedEnd)
+    if (!_matches)
+    {
+        _FindAllMatches();
+    }
+
+    // Once we've visited every match and are back at the anchor, we return false once.
+    if (_matchesVisited == _matchCount)
     {
-        _reachedEnd = false;
+        _matchesVisited = 0;
         return false;
     }
 
-    do
+    const auto& match = til::at(*_matches, _matchIndex);
+    _coordSelStart = match.start;
+    _coordSelEnd = match.end;
+    _matchesVisited++;
+
+    if (_direction == Direction::Forward)
     {
-        if (_FindNeedleInHaystackAt(_coordNext, _coordSelStart, _coordSelEnd))
-        {
-            _UpdateNextPosition();
-            _reachedEnd = _coordNext == _coordAnchor;
-            return true;
-        }
-        else
-        {
-            _UpdateNextPosition();
-        }
+        _matchIndex = _matchIndex + 1 < _matchCount ? _matchIndex + 1 : 0;
+    }
+    else
+    {
+        _matchIndex = _matchIndex > 0 ? _matchIndex - 1 : _matchCount - 1;
+    }
 
-    } while (_coordNext != _coordAnchor);
+    return true;
+}
+
+// Routine Description:
+// - Retrieves all matches from the text buffer (usually from its cache) and
+//   positions _matchIndex at the first match at or after the anchor (or at
+//   or before it when searching backwards), wrapping around if needed.
+void Search::_FindAllMatches()
+{
+    const auto& textBuffer = _renderData.GetTextBuffer();
+    _matches = textBuffer.SearchText(_needle, _sensitivity == Sensitivity::CaseInsensitive);
 
-    return false;
+    // Just like the text buffer end position is the "wrap around" point for the
+    // anchor, matches that start after it are ignored entirely.
+    const auto bufferEndPosition = _renderData.GetTextBufferEndPosition();
+    const auto byStart = [](const til::point_span& match, const til::point pos) noexcept {
+        return match.start < pos;
+    };
+    const auto endIt = std::partition_point(_matches->begin(), _matches->end(), [&](const til::point_span& match) noexcept {
+        return match.start <= bufferEndPosition;
+    });
+    _matchCount = gsl::narrow_cast<size_t>(endIt - _matches->begin());
+
+    if (_matchCount == 0)
+    {
+        return;
+    }
+
+    if (_direction == Direction::Forward)
+    {
+        const auto it = std::lower_bound(_matches->begin(), endIt, _coordAnchor, byStart);
+        _matchIndex = it != endIt ? gsl::narrow_cast<size_t>(it - _matches->begin()) : 0;
+    }
+    else
+    {
+        // The last match that starts at or before the anchor.
+        const auto it = std::partition_point(_matches->begin(), endIt, [&](const til::point_span& match) noexcept {
+            return match.start <= _coordAnchor;
+        });
+        _matchIndex = it != _matches->begin() ? gsl::narrow_cast<size_t>(it - _matches->begin()) - 1 : _matchCount - 1;
+    }
 }
 
 // Routine Description:
@@ -175,169 +215,3 @@ til::point Search::s_GetInitialAnchor(const Microsoft::Console::Render::IRenderD
         }
     }
 }
-
-// Routine Description:
-// - Attempts to compare the search term (the needle) to the screen buffer (the haystack)
-//   at the given coordinate position of the screen buffer.
-// - Performs one comparison. Call again with new positions to check other spots.
-// Arguments:
-// - pos - The position in the haystack (screen buffer) to compare
-// - start - If we found it, this is filled with the coordinate of the first character of the needle.
-// - end - If we found it, this is filled with the coordinate of the last character of the needle.
-// Return Value:
-// - True if we found it. False if not.
-bool Search::_FindNeedleInHaystackAt(const til::point pos, til::point& start, til::point& end) const
-{
-    start = {};
-    end = {};
-
-    auto bufferPos = pos;
-
-    for (const auto& needleChars : _needle)
-    {
-        // Haystack is the buffer. Needle is the string we were given.
-        const auto hayIter = _renderData.GetTextBuffer().GetTextDataAt(bufferPos);
-        const auto hayChars = *hayIter;
-
-        // If we didn't match at any point of the needle, return false.
-        if (!_CompareChars(hayChars, needleChars))
-        {
-            return false;
-        }
-
-        _IncrementCoord(bufferPos);
-    }
-
-    _DecrementCoord(bufferPos);
-
-    // If we made it the whole way through the needle, then it was in the haystack.
-    // Fill out the span that we found the result at and return true.
-    start = pos;
-    end = bufferPos;
-
-    return true;
-}
-
-// Routine Description:
-// - Provides an abstraction for comparing two spans of text.
-// - Internally handles case sensitivity based on object construction.
-// Arguments:
-// - one - String view representing the first string of text
-// - two - String view representing the second string of text
-// Return Value:
-// - True if they are the same. False otherwise.
-bool Search::_CompareChars(const std::wstring_view one, const std::wstring_view two) const noexcept
-{
-    if (one.size() != two.size())
-    {
-        return false;
-    }
-
-    for (size_t i = 0; i < one.size(); i++)
-    {
-        if (_ApplySensitivity(one.at(i)) != _ApplySensitivity(two.at(i)))
-        {
-            return false;
-        }
-    }
-
-    return true;
-}
-
-// Routine Description:
-// - Provides an abstraction for conditionally applying case sensitivity
-//   based on object construction
-// Arguments:
-// - wch - Character to adjust if necessary
-// Return Value:
-// - Adjusted value (or not).
-wchar_t Search::_ApplySensitivity(const wchar_t wch) const noexcept
-{
-    if (_sensitivity == Sensitivity::CaseInsensitive)
-    {
-        return ::towlower(wch);
-    }
-    else
-    {
-        return wch;
-    }
-}
-
-// Routine Description:
-// - Helper to increment a coordinate in respect to the associated screen buffer
-// Arguments
-// - coord - Updated by function to increment one position (will wrap X and Y direction)
-void Search::_IncrementCoord(til::point& coord) const noexcept
-{
-    _renderData.GetTextBuffer().GetSize().IncrementInBoundsCircular(coord);
-}
-
-// Routine Description:
-// - Helper to decrement a coordinate in respect to the associated screen buffer
-// Arguments
-// - coord - Updated by function to decrement one position (will wrap X and Y direction)
-void Search::_DecrementCoord(til::point& coord) const noexcept
-{
-    _renderData.GetTextBuffer().GetSize().DecrementInBoundsCircular(coord);
-}
-
-// Routine Description:
-// - Helper to update the coordinate position to the next point to be searched
-// Return Value:
-// - True if we haven't reached the end of the buffer. False otherwise.
-void Search::_UpdateNextPosition()
-{
-    if (_direction == Direction::Forward)
-    {
-        _IncrementCoord(_coordNext);
-    }
-    else if (_direction == Direction::Backward)
-    {
-        _DecrementCoord(_coordNext);
-    }
-    else
-    {
-        THROW_HR(E_NOTIMPL);
-    }
-
-    // To reduce wrap-around time, if the next position is larger than
-    // the end position of the written text
-    // We put the next position to:
-    // Forward: (0, 0)
-    // Backward: the position of the end of the text buffer
-    const auto bufferEndPosition = _renderData.GetTextBufferEndPosition();
-
-    if (_coordNext.y > bufferEndPosition.y ||
-        (_coordNext.y == bufferEndPosition.y && _coordNext.x > bufferEndPosition.x))
-    {
-        if (_direction == Direction::Forward)
-        {
-            _coordNext = {};
-        }
-        else
-        {
-            _coordNext = bufferEndPosition;
-        }
-    }
-}
-
-// Routine Description:
-// - Creates a "needle" of the correct format for comparison to the screen buffer text data
-//   that we can use for our search
-// Arguments:
-// - wstr - String that will be our search term
-// Return Value:
-// - Structured text data for comparison to screen buffer text data.
-std::vector<std::wstring> Search::s_CreateNeedleFromString(const std::wstring_view wstr)
-{
-    std::vector<std::wstring> cells;
-    for (const auto& chars : til::utf16_iterator{ wstr })
-    {
-        if (IsGlyphFullWidth(chars))
-        {
-            cells.emplace_back(chars);
-        }
-        cells.emplace_back(chars);
-    }
-    return cells;
-}
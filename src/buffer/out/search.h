@@ -57,25 +57,24 @@ public:
     std::pair<til::point, til::point> GetFoundLocation() const noexcept;
 
 private:
-    wchar_t _ApplySensitivity(const wchar_t wch) const noexcept;
-    bool _FindNeedleInHaystackAt(const til::point pos, til::point& start, til::point& end) const;
-    bool _CompareChars(const std::wstring_view one, const std::wstring_view two) const noexcept;
-    void _UpdateNextPosition();
-
-    void _IncrementCoord(til::point& coord) const noexcept;
-    void _DecrementCoord(til::point& coord) const noexcept;
+    void _FindAllMatches();
 
     static til::point s_GetInitialAnchor(const Microsoft::Console::Render::IRenderData& renderData, const Direction dir);
 
-    static std::vector<std::wstring> s_CreateNeedleFromString(const std::wstring_view wstr);
+    // All matches in the text buffer. See TextBuffer::SearchText().
+    std::shared_ptr<const std::vector<til::point_span>> _matches;
+    // The number of _matches that start before the end of the text buffer. Only those are visited.
+    size_t _matchCount = 0;
+    // The index into _matches that FindNext() will return next.
+    size_t _matchIndex = 0;
+    // The number of matches FindNext() returned since it last returned false.
+    size_t _matchesVisited = 0;
 
-    bool _reachedEnd = false;
-    til::point _coordNext;
     til::point _coordSelStart;
     til::point _coordSelEnd;
 
     const til::point _coordAnchor;
-    const std::vector<std::wstring> _needle;
+    const std::wstring _needle;
     const Direction _direction;
     const Sensitivity _sensitivity;
     Microsoft::Console::Render::IRenderData& _renderData;
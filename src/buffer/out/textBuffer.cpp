@@ -67,6 +67,11 @@ namespace
             return _height;
         }
 
+        size_t rowStride() const noexcept
+        {
+            return _rowStride;
+        }
+
         wil::unique_virtualalloc_ptr<std::byte>&& take() noexcept
         {
             return std::move(_buffer);
@@ -80,6 +85,95 @@ namespace
         uint16_t _width;
         uint16_t _height;
     };
+
+    // Appends the given text to `out`, lowercased the same way towlower() does it.
+    // Most text is ASCII, which we fold 8 characters at a time.
+    void foldCase(const std::wstring_view& text, std::wstring& out)
+    {
+        const auto offset = out.size();
+        out.resize(offset + text.size());
+
+        auto src = text.data();
+        auto dst = out.data() + offset;
+        auto remaining = text.size();
+
+#pragma warning(push)
+#pragma warning(disable : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
+#pragma warning(disable : 26490) // Don't use reinterpret_cast (type.1).
+#if _M_AMD64
+        const auto asciiMax = _mm_set1_epi16(0x7f);
+        const auto upperBeg = _mm_set1_epi16(L'A' - 1);
+        const auto upperEnd = _mm_set1_epi16(L'Z' + 1);
+        const auto foldBit = _mm_set1_epi16(0x20);
+
+        for (; remaining >= 8; remaining -= 8, src += 8, dst += 8)
+        {
+            const auto chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+            // _mm_subs_epu16 saturates at 0, so the result is only 0 for characters <= 0x7f.
+            const auto nonAscii = _mm_subs_epu16(chars, asciiMax);
+            if (_mm_movemask_epi8(_mm_cmpeq_epi16(nonAscii, _mm_setzero_si128())) == 0xffff)
+            {
+                const auto isUpper = _mm_and_si128(_mm_cmpgt_epi16(chars, upperBeg), _mm_cmplt_epi16(chars, upperEnd));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_add_epi16(chars, _mm_and_si128(isUpper, foldBit)));
+            }
+            else
+            {
+                for (size_t i = 0; i < 8; ++i)
+                {
+                    dst[i] = ::towlower(src[i]);
+                }
+            }
+        }
+#endif
+        for (; remaining; --remaining, ++src, ++dst)
+        {
+            *dst = ::towlower(*src);
+        }
+#pragma warning(pop)
+    }
+
+    // Same as std::wstring_view::find, but checks 8 positions at once by comparing the
+    // first and last character of the needle, before comparing the rest of it.
+    size_t findSubstring(const std::wstring_view& hay, const std::wstring_view& needle, size_t pos) noexcept
+    {
+        const auto needleSize = needle.size();
+        if (needleSize == 0 || hay.size() < needleSize)
+        {
+            return std::wstring_view::npos;
+        }
+
+#pragma warning(push)
+#pragma warning(disable : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
+#pragma warning(disable : 26490) // Don't use reinterpret_cast (type.1).
+#if _M_AMD64
+        const auto data = hay.data();
+        const auto first = _mm_set1_epi16(needle.front());
+        const auto last = _mm_set1_epi16(needle.back());
+
+        for (; pos + needleSize - 1 + 8 <= hay.size(); pos += 8)
+        {
+            const auto a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+            const auto b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos + needleSize - 1));
+            auto mask = gsl::narrow_cast<unsigned long>(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi16(a, first), _mm_cmpeq_epi16(b, last))));
+
+            while (mask)
+            {
+                unsigned long index;
+                _BitScanForward(&index, mask);
+                // The mask contains 2 bits per wchar_t.
+                const auto candidate = pos + index / 2;
+                if (needleSize <= 2 || wmemcmp(data + candidate + 1, needle.data() + 1, needleSize - 2) == 0)
+                {
+                    return candidate;
+                }
+                mask &= ~(3ul << index);
+            }
+        }
+#endif
+#pragma warning(pop)
+
+        return hay.find(needle, pos);
+    }
 }
 
 using namespace Microsoft::Console;
@@ -114,12 +208,16 @@ TextBuffer::TextBuffer(til::size screenBufferSize,
 
     BufferAllocator allocator{ screenBufferSize };
 
+    // Interning attributes compacts the table from time to time. See TextAttributeTable::Intern().
+    _attributeTable.SetCompactor([this]() { _CompactAttributes(); });
+
     _storage.reserve(allocator.height());
     for (til::CoordType i = 0; i < screenBufferSize.height; ++i, ++allocator)
     {
-        _storage.emplace_back(allocator.chars(), allocator.indices(), allocator.width(), _currentAttributes);
+        _storage.emplace_back(_attributeTable, _generation, allocator.chars(), allocator.indices(), allocator.width(), _currentAttributes);
     }
 
+    _charBufferRowStride = allocator.rowStride();
     _charBuffer = allocator.take();
     _UpdateSize();
 }
@@ -171,8 +269,23 @@ const ROW& TextBuffer::GetRowByOffset(const til::CoordType index) const noexcept
 ROW& TextBuffer::GetRowByOffset(const til::CoordType index) noexcept
 {
     // Rows are stored circularly, so the index you ask for is offset by the start position and mod the total of rows.
+    // The row increments _generation itself if it gets modified. See GetGeneration() and GetRowGeneration().
     const auto offsetIndex = gsl::narrow_cast<size_t>(_firstRow + index) % _storage.size();
-    return til::at(_storage, offsetIndex);
+    auto& row = til::at(_storage, offsetIndex);
+    if (row.IsFrozen())
+    {
+        // The caller might modify the row, which requires its actual contents. See FreezeRows().
+        try
+        {
+            _ThawRow(row);
+        }
+        catch (...)
+        {
+            FAIL_FAST_CAUGHT_EXCEPTION();
+        }
+        _frozenRowsHint = std::min(_frozenRowsHint, index);
+    }
+    return row;
 }
 
 // Routine Description:
@@ -460,6 +573,88 @@ OutputCellIterator TextBuffer::WriteLine(const OutputCellIterator givenIt,
     return newIt;
 }
 
+// Routine Description:
+// - Writes the leading printable ASCII characters of the given text to one line of the
+//   output buffer, stopping at the first character that isn't printable ASCII. This is a
+//   faster alternative to WriteLine() and WriteGlyphs(), as it avoids the per-cell overhead
+//   of OutputCellIterator and doesn't need to measure the text.
+// Arguments:
+// - chars - The text to write. Anything past the leading printable ASCII is ignored.
+// - target - Coordinate targeted within output buffer
+// - attr - The attribute to apply to all written cells
+// - wrap - change the wrap flag if we hit the end of the row while writing.
+// - limitRight - Optionally restrict the right boundary for writing (e.g. stop writing earlier than the end of line)
+// Return Value:
+// - The number of characters (and thus cells) that were written. 0 if the text doesn't
+//   start with printable ASCII.
+til::CoordType TextBuffer::WriteAsciiRun(const std::wstring_view& chars,
+                                         const til::point target,
+                                         const TextAttribute& attr,
+                                         const std::optional<bool> wrap,
+                                         std::optional<til::CoordType> limitRight)
+{
+    // If we're not in bounds, exit early.
+    if (!GetSize().IsInBounds(target))
+    {
+        return 0;
+    }
+
+    auto& row = GetRowByOffset(target.y);
+    const auto written = row.WriteAsciiRun(target.x, chars, attr, wrap, limitRight);
+
+    if (written)
+    {
+        const auto paint = Viewport::FromDimensions(target, { written, 1 });
+        TriggerRedraw(paint);
+    }
+
+    return written;
+}
+
+// Routine Description:
+// - Writes arbitrary text with a single attribute to one line of the output buffer.
+//   This is a faster alternative to WriteLine() for non-ASCII text: The text is
+//   measured with MeasureGlyphRuns() in one pass and then copied into the row
+//   in bulk, instead of measuring and writing it glyph by glyph.
+// Arguments:
+// - chars - The text to write.
+// - target - Coordinate targeted within output buffer
+// - attr - The attribute to apply to all written cells
+// - columnsWritten - Receives the number of cells the written glyphs occupy.
+// - wrap - change the wrap flag if we hit the end of the row while writing.
+// - limitRight - Optionally restrict the right boundary for writing (e.g. stop writing earlier than the end of line)
+// Return Value:
+// - The number of characters that were written.
+size_t TextBuffer::WriteGlyphs(const std::wstring_view& chars,
+                               const til::point target,
+                               const TextAttribute& attr,
+                               til::CoordType& columnsWritten,
+                               const std::optional<bool> wrap,
+                               std::optional<til::CoordType> limitRight)
+{
+    columnsWritten = 0;
+
+    // If we're not in bounds, exit early.
+    if (!GetSize().IsInBounds(target))
+    {
+        return 0;
+    }
+
+    // A glyph is at most 2 characters long and takes up at least 1 column,
+    // so we never need to measure more than 2 characters per remaining column.
+    const auto columns = gsl::narrow_cast<size_t>(std::max(0, limitRight.value_or(GetSize().RightInclusive()) - target.x + 1));
+    _glyphRuns.clear();
+    MeasureGlyphRuns(chars.substr(0, columns * 2), _glyphRuns);
+
+    auto& row = GetRowByOffset(target.y);
+    const auto written = row.WriteGlyphRuns(target.x, chars, _glyphRuns, attr, columnsWritten, wrap, limitRight);
+
+    const auto paint = Viewport::FromDimensions(target, { columnsWritten, 1 });
+    TriggerRedraw(paint);
+
+    return written;
+}
+
 //Routine Description:
 // - Inserts one codepoint into the buffer at the current cursor position and advances the cursor as appropriate.
 //Arguments:
@@ -648,7 +843,14 @@ bool TextBuffer::IncrementCircularBuffer(const bool inVtMode)
         // the current background color, but with no meta attributes set.
         fillAttributes.SetStandardErase();
     }
-    GetRowByOffset(0).Reset(fillAttributes);
+    {
+        // Not using GetRowByOffset(), because thawing the row would be wasted work.
+        auto& row = til::at(_storage, _firstRow);
+        _ReleaseFrozenPages(row, row.FrozenSize());
+        row.Reset(fillAttributes);
+        // The rows after it move up by one.
+        _frozenRowsHint = std::max(0, _frozenRowsHint - 1);
+    }
     {
         // Now proceed to increment.
         // Incrementing it will cause the next line down to become the new "top" of the window (the new "0" in logical coordinates)
@@ -659,6 +861,9 @@ bool TextBuffer::IncrementCircularBuffer(const bool inVtMode)
         {
             _firstRow = 0;
         }
+
+        // The rows keep their generation, only their offset changed. See GetRowGeneration().
+        _generation++;
     }
     return true;
 }
@@ -757,6 +962,8 @@ void TextBuffer::_UpdateSize()
 void TextBuffer::_SetFirstRowIndex(const til::CoordType FirstRowIndex) noexcept
 {
     _firstRow = FirstRowIndex;
+    // The rows keep their generation, only their offset changed. See GetRowGeneration().
+    _generation++;
 }
 
 void TextBuffer::ScrollRows(const til::CoordType firstRow, const til::CoordType size, const til::CoordType delta)
@@ -767,17 +974,10 @@ void TextBuffer::ScrollRows(const til::CoordType firstRow, const til::CoordType
         return;
     }
 
-    // OK. We're about to play games by moving rows around within the deque to
-    // scroll a massive region in a faster way than copying things.
-    // To make this easier, first correct the circular buffer to have the first row be 0 again.
-    if (_firstRow != 0)
-    {
-        // Rotate the buffer to put the first row at the front.
-        std::rotate(_storage.begin(), _storage.begin() + _firstRow, _storage.end());
-
-        // The first row is now at the top.
-        _firstRow = 0;
-    }
+    // OK. We're about to play games by swapping rows around within the circular buffer
+    // to scroll a massive region in a faster way than copying things. The rows are
+    // addressed relative to _firstRow, so only the rows inside the region are touched,
+    // no matter how much scrollback there is.
 
     // Rotate just the subsection specified
     if (delta < 0)
@@ -785,7 +985,7 @@ void TextBuffer::ScrollRows(const til::CoordType firstRow, const til::CoordType
         // The layout is like this:
         // delta is -2, size is 3, firstRow is 5
         // We want 3 rows from 5 (5, 6, and 7) to move up 2 spots.
-        // --- (storage) ----
+        // --- (rows) -------
         // | 0 begin
         // | 1
         // | 2
@@ -801,7 +1001,7 @@ void TextBuffer::ScrollRows(const til::CoordType firstRow, const til::CoordType
         // - end
         // We want B to slide up to A (the negative delta) and everything from [B,C) to slide up with it.
         // So the final layout will be
-        // --- (storage) ----
+        // --- (rows) -------
         // | 0 begin
         // | 1
         // | 2
@@ -815,14 +1015,14 @@ void TextBuffer::ScrollRows(const til::CoordType firstRow, const til::CoordType
         // | 10
         // | 11
         // - end
-        std::rotate(_storage.begin() + firstRow + delta, _storage.begin() + firstRow, _storage.begin() + firstRow + size);
+        _RotateRows(firstRow + delta, firstRow, firstRow + size);
     }
     else
     {
         // The layout is like this:
         // delta is 2, size is 3, firstRow is 5
         // We want 3 rows from 5 (5, 6, and 7) to move down 2 spots.
-        // --- (storage) ----
+        // --- (rows) -------
         // | 0 begin
         // | 1
         // | 2
@@ -838,7 +1038,7 @@ void TextBuffer::ScrollRows(const til::CoordType firstRow, const til::CoordType
         // - end
         // We want B-1 to slide down to C-1 (the positive delta) and everything from [A, B) to slide down with it.
         // So the final layout will be
-        // --- (storage) ----
+        // --- (rows) -------
         // | 0 begin
         // | 1
         // | 2
@@ -852,10 +1052,43 @@ void TextBuffer::ScrollRows(const til::CoordType firstRow, const til::CoordType
         // | 10
         // | 11
         // - end
-        std::rotate(_storage.begin() + firstRow, _storage.begin() + firstRow + size, _storage.begin() + firstRow + size + delta);
+        _RotateRows(firstRow, firstRow + size, firstRow + size + delta);
+    }
+
+    // Every row in the rotated range now sits at a different offset.
+    _generation++;
+    const auto begin = std::min(firstRow, firstRow + delta);
+    const auto end = std::max(firstRow + size, firstRow + size + delta);
+    for (auto y = begin; y < end; ++y)
+    {
+        GetRowByOffset(y).SetGeneration(_generation);
     }
 }
 
+// Routine Description:
+// - Rotates the rows [begin, end) to the left, such that the row at middle becomes the row at begin.
+//   This works like std::rotate(), but the indices are relative to the circular buffer's first row.
+// Arguments:
+// - begin - The first row of the range
+// - middle - The row that should become the first row of the range
+// - end - One past the last row of the range
+void TextBuffer::_RotateRows(const til::CoordType begin, const til::CoordType middle, const til::CoordType end) noexcept
+{
+    // A rotation is equivalent to reversing both halves and then the whole range.
+    // Unlike std::rotate() on the underlying storage this doesn't require the
+    // range to be contiguous in memory and so it works across the wrap-around point.
+    const auto reverse = [this](til::CoordType first, til::CoordType last) noexcept {
+        for (--last; first < last; ++first, --last)
+        {
+            swap(GetRowByOffset(first), GetRowByOffset(last));
+        }
+    };
+
+    reverse(begin, middle);
+    reverse(middle, end);
+    reverse(begin, end);
+}
+
 Cursor& TextBuffer::GetCursor() noexcept
 {
     return _cursor;
@@ -957,8 +1190,10 @@ void TextBuffer::Reset()
 
     for (auto& row : _storage)
     {
+        _ReleaseFrozenPages(row, row.FrozenSize());
         row.Reset(attr);
     }
+    _frozenRowsHint = 0;
 }
 
 // Routine Description:
@@ -975,6 +1210,9 @@ void TextBuffer::Reset()
 
     try
     {
+        // The rows are about to be copied into a new buffer.
+        ThawAll();
+
         BufferAllocator allocator{ newSize };
 
         const auto currentSize = GetSize().Dimensions();
@@ -992,8 +1230,14 @@ void TextBuffer::Reset()
         _SetFirstRowIndex(0);
 
         // realloc in the Y direction
-        // remove rows if we're shrinking
-        _storage.resize(allocator.height());
+        // remove rows if we're shrinking, add blank ones if we're growing
+        // (the latter are given their buffers by Resize() below)
+        const size_t newHeight = allocator.height();
+        _storage.resize(std::min(_storage.size(), newHeight));
+        while (_storage.size() < newHeight)
+        {
+            _storage.emplace_back(_attributeTable, _generation);
+        }
 
         // realloc in the X direction
         for (auto& it : _storage)
@@ -1005,7 +1249,12 @@ void TextBuffer::Reset()
         // Update the cached size value
         _UpdateSize();
 
+        _charBufferRowStride = allocator.rowStride();
         _charBuffer = allocator.take();
+        if (_memoryLimit)
+        {
+            _InitializeFreezing();
+        }
     }
     CATCH_RETURN();
 
@@ -1354,6 +1603,230 @@ til::point TextBuffer::_GetWordEndForSelection(const til::point target, const st
     return result;
 }
 
+// Method Description:
+// - Removes the attributes that aren't used by any row anymore from the attribute table.
+//   It's called by TextAttributeTable::Intern() once enough new attributes were added to make
+//   it worthwhile, which may happen in the middle of a ROW method. That's fine, because
+//   ROW methods only intern an attribute right before storing it. See ROW::_internRuns().
+void TextBuffer::_CompactAttributes()
+{
+    std::vector<bool> live(_attributeTable.size());
+    for (const auto& row : _storage)
+    {
+        row.MarkAttributes(live);
+    }
+
+    const auto remap = _attributeTable.Compact(live);
+    for (auto& row : _storage)
+    {
+        row.RemapAttributes(remap);
+    }
+}
+
+// Routine Description:
+// - Sets the amount of memory the text of this buffer may use. Once FreezeRows() is called while it's
+//   exceeded, the oldest rows get frozen into a compressed representation (see ROW::Freeze()).
+// Arguments:
+// - megabytes - The limit in MiB. 0 disables the limit and thaws all rows.
+void TextBuffer::SetMemoryLimit(const size_t megabytes)
+{
+    static constexpr size_t megabyte = 1024 * 1024;
+    const auto limit = std::min(megabytes, SIZE_MAX / megabyte) * megabyte;
+
+    if (!limit)
+    {
+        ThawAll();
+        _pageRowCount = {};
+        _pageFrozenCount = {};
+        _pageDiscarded = {};
+        _frozenRowBlanks.reset();
+        _freezeScratch = {};
+    }
+    else if (!_memoryLimit)
+    {
+        _InitializeFreezing();
+    }
+
+    _memoryLimit = limit;
+}
+
+// Routine Description:
+// - Returns the number of bytes used to store the text of the rows. This doesn't include
+//   the attributes and any bookkeeping, which are small in comparison.
+size_t TextBuffer::GetMemoryUsage() const noexcept
+{
+    // The last page might only be partially used by the rows, so clamp to avoid underflows.
+    const auto total = _storage.size() * _charBufferRowStride;
+    return total - std::min(total, _discardedPages * PageSize) + _frozenBytes;
+}
+
+// Routine Description:
+// - Freezes the oldest rows until the memory usage is below the limit again. We go a bit further than
+//   that, so that we don't end up freezing a row for every new line. Frozen rows read as blank through
+//   the const accessors, so the caller must only call this if nothing reads rows above `end` that way
+//   and thaw them again with ThawRows() or ThawAll() before it does.
+// Arguments:
+// - end - Rows at or below this offset are left alone.
+void TextBuffer::FreezeRows(const til::CoordType end)
+{
+    if (!_memoryLimit || GetMemoryUsage() <= _memoryLimit)
+    {
+        return;
+    }
+
+    const auto target = _memoryLimit / 8 * 7;
+    const auto last = std::min({ end, _frozenRowsHint + FreezeBatchSize, TotalRowCount() });
+
+    for (; _frozenRowsHint < last && GetMemoryUsage() > target; ++_frozenRowsHint)
+    {
+        // Not using GetRowByOffset() here, because it would thaw the row.
+        const auto offsetIndex = gsl::narrow_cast<size_t>(_firstRow + _frozenRowsHint) % _storage.size();
+        _FreezeRow(til::at(_storage, offsetIndex));
+    }
+}
+
+// Routine Description:
+// - Thaws the rows in the given range, if they're frozen. See FreezeRows().
+// Arguments:
+// - begin - The first row to thaw
+// - end - One past the last row to thaw
+void TextBuffer::ThawRows(const til::CoordType begin, const til::CoordType end)
+{
+    const auto first = std::max(0, begin);
+    const auto last = std::min(end, TotalRowCount());
+
+    for (auto y = first; y < last; ++y)
+    {
+        const auto offsetIndex = gsl::narrow_cast<size_t>(_firstRow + y) % _storage.size();
+        if (auto& row = til::at(_storage, offsetIndex); row.IsFrozen())
+        {
+            _ThawRow(row);
+            _frozenRowsHint = std::min(_frozenRowsHint, y);
+        }
+    }
+}
+
+// Routine Description:
+// - Thaws all frozen rows. See FreezeRows().
+void TextBuffer::ThawAll()
+{
+    if (_frozenBytes)
+    {
+        for (auto& row : _storage)
+        {
+            _ThawRow(row);
+        }
+    }
+    _frozenRowsHint = 0;
+}
+
+// Routine Description:
+// - Returns the pages of _charBuffer that the given row's buffers overlap as a [first, last] range.
+std::pair<size_t, size_t> TextBuffer::_GetPageRange(const ROW& row) const noexcept
+{
+    const auto offset = til::bit_cast<uintptr_t>(row.BackingBuffer()) - til::bit_cast<uintptr_t>(_charBuffer.get());
+    return { offset / PageSize, (offset + _charBufferRowStride - 1) / PageSize };
+}
+
+// Routine Description:
+// - Sets up the bookkeeping for FreezeRows() for the current _charBuffer. No row may be frozen.
+void TextBuffer::_InitializeFreezing()
+{
+    const auto pages = (_storage.size() * _charBufferRowStride + PageSize - 1) / PageSize;
+    _pageRowCount.assign(pages, 0);
+    _pageFrozenCount.assign(pages, 0);
+    _pageDiscarded.assign(pages, false);
+    _discardedPages = 0;
+    _frozenBytes = 0;
+    _frozenRowsHint = 0;
+
+    for (const auto& row : _storage)
+    {
+        const auto [first, last] = _GetPageRange(row);
+        for (auto page = first; page <= last; ++page)
+        {
+            til::at(_pageRowCount, page)++;
+        }
+    }
+
+    // The text and char offsets of a blank row, which frozen rows point to. It's read-only,
+    // because the same memory is shared by all of them. See ROW::Freeze().
+    const size_t width = GetSize().Width();
+    const auto bytes = width * sizeof(wchar_t) + (width + 1) * sizeof(uint16_t);
+    _frozenRowBlanks = wil::unique_virtualalloc_ptr<std::byte>{ static_cast<std::byte*>(VirtualAlloc(nullptr, bytes, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE)) };
+    THROW_IF_NULL_ALLOC(_frozenRowBlanks);
+
+    const std::span chars{ til::bit_cast<wchar_t*>(_frozenRowBlanks.get()), width };
+    const std::span offsets{ til::bit_cast<uint16_t*>(chars.data() + width), width + 1 };
+    std::fill(chars.begin(), chars.end(), L' ');
+    std::iota(offsets.begin(), offsets.end(), uint16_t{ 0 });
+
+    DWORD oldProtect = 0;
+    THROW_IF_WIN32_BOOL_FALSE(VirtualProtect(_frozenRowBlanks.get(), bytes, PAGE_READONLY, &oldProtect));
+}
+
+void TextBuffer::_FreezeRow(ROW& row)
+{
+    if (row.IsFrozen())
+    {
+        return;
+    }
+
+    const size_t width = GetSize().Width();
+    const std::span chars{ til::bit_cast<wchar_t*>(_frozenRowBlanks.get()), width };
+    const std::span offsets{ til::bit_cast<uint16_t*>(chars.data() + width), width + 1 };
+    _frozenBytes += row.Freeze(_freezeScratch, chars, offsets);
+
+    const auto [first, last] = _GetPageRange(row);
+    for (auto page = first; page <= last; ++page)
+    {
+        if (++til::at(_pageFrozenCount, page) == til::at(_pageRowCount, page))
+        {
+            // Nothing reads the page anymore and thawing a row overwrites its part of it.
+            // So we can let the OS reclaim it without having to commit it again later.
+            const auto address = _charBuffer.get() + page * PageSize;
+            if (!LOG_IF_WIN32_ERROR(DiscardVirtualMemory(address, PageSize)))
+            {
+                til::at(_pageDiscarded, page) = true;
+                _discardedPages++;
+            }
+        }
+    }
+}
+
+void TextBuffer::_ThawRow(ROW& row)
+{
+    const auto frozenSize = row.FrozenSize();
+    row.Thaw();
+    _ReleaseFrozenPages(row, frozenSize);
+}
+
+// Routine Description:
+// - Updates the bookkeeping for a row that got thawed or is about to be overwritten.
+// Arguments:
+// - row - The row
+// - frozenSize - The row's ROW::FrozenSize() before it was thawed. 0 if it wasn't frozen.
+void TextBuffer::_ReleaseFrozenPages(const ROW& row, const size_t frozenSize) noexcept
+{
+    if (!frozenSize)
+    {
+        return;
+    }
+
+    _frozenBytes -= frozenSize;
+
+    const auto [first, last] = _GetPageRange(row);
+    for (auto page = first; page <= last; ++page)
+    {
+        if (til::at(_pageDiscarded, page))
+        {
+            til::at(_pageDiscarded, page) = false;
+            _discardedPages--;
+        }
+        til::at(_pageFrozenCount, page)--;
+    }
+}
+
 void TextBuffer::_PruneHyperlinks()
 {
     // Check the old first row for hyperlink references
@@ -1361,7 +1834,9 @@ void TextBuffer::_PruneHyperlinks()
     // If the buffer does not contain the same reference, we can remove that hyperlink from our map
     // This way, obsolete hyperlink references are cleared from our hyperlink map instead of hanging around
     // Get all the hyperlink references in the row we're erasing
-    const auto hyperlinks = GetRowByOffset(0).GetHyperlinks();
+    // Only the attributes are needed, which frozen rows retain. So we don't need to thaw them.
+    const auto& self = *this;
+    const auto hyperlinks = self.GetRowByOffset(0).GetHyperlinks();
 
     if (!hyperlinks.empty())
     {
@@ -1377,7 +1852,7 @@ void TextBuffer::_PruneHyperlinks()
         // to see if those references are anywhere else
         for (til::CoordType i = 1; i < total; ++i)
         {
-            const auto nextRowRefs = GetRowByOffset(i).GetHyperlinks();
+            const auto nextRowRefs = self.GetRowByOffset(i).GetHyperlinks();
             for (auto id : nextRowRefs)
             {
                 if (firstRowRefs.find(id) != firstRowRefs.end())
@@ -2331,6 +2806,15 @@ HRESULT TextBuffer::Reflow(TextBuffer& oldBuffer,
     const auto& oldCursor = oldBuffer.GetCursor();
     auto& newCursor = newBuffer.GetCursor();
 
+    try
+    {
+        // The old rows are read through const accessors below, so they must not be frozen.
+        // The new buffer keeps the limit, so that its owner can freeze its rows again.
+        oldBuffer.ThawAll();
+        newBuffer.SetMemoryLimit(oldBuffer._memoryLimit / (1024 * 1024));
+    }
+    CATCH_RETURN();
+
     // We need to save the old cursor position so that we can
     // place the new cursor back on the equivalent character in
     // the new buffer.
@@ -2386,14 +2870,21 @@ HRESULT TextBuffer::Reflow(TextBuffer& oldBuffer,
             }
         }
 
-        // Loop through every character in the current row (up to
-        // the "right" boundary, which is one past the final valid
-        // character)
+        // Never cut a wide glyph in half.
+        if (iRight < cOldColsTotal && row.DbcsAttrAt(iRight) == DbcsAttribute::Trailing)
+        {
+            iRight++;
+        }
+
+        // Copy the current row (up to the "right" boundary, which is one past the final
+        // valid character) in spans. Each span is as long as fits into the remainder of
+        // the current row in the new buffer. This results in the same contents as
+        // inserting the text glyph by glyph via InsertCharacter(), but much faster.
         til::CoordType iOldCol = 0;
         const auto copyRight = iRight;
-        for (; iOldCol < copyRight; iOldCol++)
+        while (iOldCol < copyRight)
         {
-            if (iOldCol == cOldCursorPos.x && iOldRow == cOldCursorPos.y)
+            if (!fFoundCursorPos && iOldCol == cOldCursorPos.x && iOldRow == cOldCursorPos.y)
             {
                 cNewCursorPos = newCursor.GetPosition();
                 fFoundCursorPos = true;
@@ -2401,12 +2892,52 @@ HRESULT TextBuffer::Reflow(TextBuffer& oldBuffer,
 
             try
             {
-                // TODO: MSFT: 19446208 - this should just use an iterator and the inserter...
-                const auto glyph = row.GlyphAt(iOldCol);
-                const auto dbcsAttr = row.DbcsAttrAt(iOldCol);
-                const auto textAttr = row.GetAttrByColumn(iOldCol);
+                const auto newPos = newCursor.GetPosition();
+                const auto newWidth = newBuffer.GetLineWidth(newPos.y);
+                auto& newRow = newBuffer.GetRowByOffset(newPos.y);
+
+                auto spanEnd = std::min(copyRight, iOldCol + newWidth - newPos.x);
+                if (spanEnd < cOldColsTotal && row.DbcsAttrAt(spanEnd) == DbcsAttribute::Trailing)
+                {
+                    spanEnd--;
+                }
+
+                if (spanEnd == iOldCol)
+                {
+                    if (newPos.x == 0)
+                    {
+                        // The new buffer is too narrow to fit this wide glyph at all. Skip it.
+                        iOldCol += 2;
+                        continue;
+                    }
+
+                    // Just like _PrepareForDoubleByteSequence() we pad the row
+                    // if a wide glyph doesn't fit into the last column.
+                    newRow.SetDoubleBytePadded(true);
+                    if (!newBuffer.IncrementCursor())
+                    {
+                        hr = E_OUTOFMEMORY;
+                        break;
+                    }
+                    continue;
+                }
+
+                const auto copied = newRow.CopyRangeFrom(newPos.x, row, iOldCol, spanEnd);
+
+                // Like InsertCharacter(), extend the attribute of the last glyph to the end of the row.
+                newRow.SetAttrToEnd(newPos.x + copied, row.GetAttrByColumn(spanEnd - 1));
+
+                if (!fFoundCursorPos && iOldRow == cOldCursorPos.y && cOldCursorPos.x > iOldCol && cOldCursorPos.x < spanEnd)
+                {
+                    cNewCursorPos = { newPos.x + cOldCursorPos.x - iOldCol, newPos.y };
+                    fFoundCursorPos = true;
+                }
 
-                if (!newBuffer.InsertCharacter(glyph, dbcsAttr, textAttr))
+                // Place the cursor on the last copied column and let IncrementCursor()
+                // take care of setting the wrap flag and moving onto the next row.
+                newCursor.SetXPosition(newPos.x + copied - 1);
+                iOldCol = spanEnd;
+                if (!newBuffer.IncrementCursor())
                 {
                     hr = E_OUTOFMEMORY;
                     break;
@@ -2437,22 +2968,17 @@ HRESULT TextBuffer::Reflow(TextBuffer& oldBuffer,
         //     move on.
         const auto newRowY = newCursor.GetPosition().y;
         auto& newRow = newBuffer.GetRowByOffset(newRowY);
-        auto newAttrColumn = newCursor.GetPosition().x;
+        const auto newAttrColumn = newCursor.GetPosition().x;
         const auto newWidth = newBuffer.GetLineWidth(newRowY);
         // Stop when we get to the end of the buffer width, or the new position
         // for inserting an attr would be past the right of the new buffer.
-        for (auto copyAttrCol = iOldCol;
-             copyAttrCol < cOldColsTotal && newAttrColumn < newWidth;
-             copyAttrCol++, newAttrColumn++)
+        if (iOldCol < cOldColsTotal && newAttrColumn < newWidth)
         {
             try
             {
-                // TODO: MSFT: 19446208 - this should just use an iterator and the inserter...
-                const auto textAttr = row.GetAttrByColumn(copyAttrCol);
-                if (!newRow.SetAttrToEnd(newAttrColumn, textAttr))
-                {
-                    break;
-                }
+                const auto copyAttrEnd = std::min(cOldColsTotal, iOldCol + newWidth - newAttrColumn);
+                newRow.CopyAttributesFrom(newAttrColumn, row, iOldCol, copyAttrEnd);
+                newRow.SetAttrToEnd(newAttrColumn + copyAttrEnd - iOldCol, row.GetAttrByColumn(copyAttrEnd - 1));
             }
             CATCH_LOG(); // Not worth dying over.
         }
@@ -2563,7 +3089,7 @@ HRESULT TextBuffer::Reflow(TextBuffer& oldBuffer,
         // the last attr when wider.
         auto& newRow = newBuffer.GetRowByOffset(newRowY);
         const auto newWidth = newBuffer.GetLineWidth(newRowY);
-        newRow.TransferAttributes(row.Attributes(), newWidth);
+        newRow.TransferAttributes(row, newWidth);
 
         newRowY++;
     }
@@ -2749,6 +3275,7 @@ void TextBuffer::CopyHyperlinkMaps(const TextBuffer& other)
 // Method Description:
 // - Adds a regex pattern we should search for
 // - The searching does not happen here, we only search when asked to by TerminalCore
+// - The pattern is compiled once here. See PatternRecognizer.
 // Arguments:
 // - The regex pattern
 // Return value:
@@ -2756,7 +3283,8 @@ void TextBuffer::CopyHyperlinkMaps(const TextBuffer& other)
 const size_t TextBuffer::AddPatternRecognizer(const std::wstring_view regexString)
 {
     ++_currentPatternId;
-    _idsAndPatterns.emplace(std::make_pair(_currentPatternId, regexString));
+    _idsAndPatterns.emplace(_currentPatternId, PatternRecognizer{ regexString });
+    _patternCache.valid = false;
     return _currentPatternId;
 }
 
@@ -2766,6 +3294,7 @@ void TextBuffer::ClearPatternRecognizers() noexcept
 {
     _idsAndPatterns.clear();
     _currentPatternId = 0;
+    _patternCache.valid = false;
 }
 
 // Method Description:
@@ -2776,6 +3305,7 @@ void TextBuffer::CopyPatterns(const TextBuffer& OtherBuffer)
 {
     _idsAndPatterns = OtherBuffer._idsAndPatterns;
     _currentPatternId = OtherBuffer._currentPatternId;
+    _patternCache.valid = false;
 }
 
 // Method Description:
@@ -2784,64 +3314,250 @@ void TextBuffer::CopyPatterns(const TextBuffer& OtherBuffer)
 // - The firstRow to start searching from
 // - The lastRow to search
 // Return value:
-// - An interval tree containing the patterns found
-PointTree TextBuffer::GetPatterns(const til::CoordType firstRow, const til::CoordType lastRow) const
+// - An interval tree containing the patterns found. It's shared with the cache, so that repeated calls don't copy it.
+std::shared_ptr<const PointTree> TextBuffer::GetPatterns(const til::CoordType firstRow, const til::CoordType lastRow) const
 {
+    // The result only depends on the given rows and the pattern recognizers. The coordinates
+    // are relative to firstRow, so it doesn't matter at which offset the rows are now.
+    const auto firstRowIndex = gsl::narrow_cast<size_t>(_firstRow + firstRow) % _storage.size();
+    const auto rowCount = lastRow - firstRow + 1;
+    if (_patternCache.valid && _patternCache.firstRowIndex == firstRowIndex && _patternCache.rowCount == rowCount &&
+        !RowsChangedSince(firstRow, lastRow, _patternCache.generation))
+    {
+        return _patternCache.result;
+    }
+
     PointTree::interval_vector intervals;
 
     std::wstring concatAll;
+    std::vector<size_t> rowOffsets;
     const auto rowSize = GetRowByOffset(0).size();
     concatAll.reserve(gsl::narrow_cast<size_t>(rowSize) * gsl::narrow_cast<size_t>(lastRow - firstRow + 1));
+    rowOffsets.reserve(gsl::narrow_cast<size_t>(lastRow - firstRow + 2));
 
     // to deal with text that spans multiple lines, we will first concatenate
     // all the text into one string and find the patterns in that string
     for (til::CoordType i = firstRow; i <= lastRow; ++i)
     {
         auto& row = GetRowByOffset(i);
+        rowOffsets.emplace_back(concatAll.size());
         concatAll += row.GetText();
     }
+    rowOffsets.emplace_back(concatAll.size());
 
     // for each pattern we know of, iterate through the string
-    for (const auto& idAndPattern : _idsAndPatterns)
+    for (const auto& [id, recognizer] : _idsAndPatterns)
     {
-        std::wregex regexObj{ idAndPattern.second };
+        // The recognizer tells us where the text can be split into groups of rows
+        // that can be matched independently. The matches of each group are cached
+        // by its text, which means that only groups that changed get rescanned.
+        size_t groupBegin = 0;
+        for (size_t i = 1; i < rowOffsets.size(); ++i)
+        {
+            const auto offset = til::at(rowOffsets, i);
+            if (i + 1 < rowOffsets.size() && offset != 0 && offset < concatAll.size() &&
+                recognizer.CanMatchAcross(til::at(concatAll, offset - 1), til::at(concatAll, offset)))
+            {
+                continue;
+            }
+
+            const auto groupOffset = til::at(rowOffsets, groupBegin);
+            const std::wstring_view group{ concatAll.data() + groupOffset, offset - groupOffset };
+            const auto base = gsl::narrow_cast<til::CoordType>(groupBegin) * rowSize;
+            groupBegin = i;
+
+            for (const auto& match : recognizer.FindMatches(group))
+            {
+                const auto start = base + match.begin;
+                const auto end = base + match.end;
+
+                const til::point startCoord{ start % rowSize, start / rowSize };
+                const til::point endCoord{ end % rowSize, end / rowSize };
+
+                // store the intervals
+                // NOTE: these intervals are relative to the VIEWPORT not the buffer
+                // Keeping these relative to the viewport for now because its the renderer
+                // that actually uses these locations and the renderer works relative to
+                // the viewport
+                intervals.push_back(PointTree::interval(startCoord, endCoord, id));
+            }
+        }
+    }
+    auto result = std::make_shared<const PointTree>(std::move(intervals));
+
+    _patternCache.valid = true;
+    _patternCache.generation = _generation;
+    _patternCache.firstRowIndex = firstRowIndex;
+    _patternCache.rowCount = rowCount;
+    _patternCache.result = result;
+
+    return result;
+}
+
+// Routine Description:
+// - Returns a number that changes whenever the contents of the buffer might have changed.
+//   It can be used to check whether anything derived from the buffer contents is still valid.
+uint64_t TextBuffer::GetGeneration() const noexcept
+{
+    return _generation;
+}
 
-        // search through the run with our regex object
-        auto words_begin = std::wsregex_iterator(concatAll.begin(), concatAll.end(), regexObj);
-        auto words_end = std::wsregex_iterator();
+// Routine Description:
+// - Returns the generation at which the row at the given offset last changed.
+//   If it's not greater than a value previously returned by GetGeneration(),
+//   the row hasn't changed since then. Just like GetGeneration() this is conservative.
+// - The generation belongs to the row and not to its offset: IncrementCircularBuffer() only
+//   changes the recycled row, while all other rows move up by one offset and keep theirs.
+//   Anything that's cached by offset also needs to compare GetFirstRowIndex().
+// Arguments:
+// - row - The offset of the row from the first row of the buffer.
+// Return Value:
+// - The generation of the row.
+uint64_t TextBuffer::GetRowGeneration(const til::CoordType row) const noexcept
+{
+    return GetRowByOffset(row).GetGeneration();
+}
 
-        til::CoordType lenUpToThis = 0;
-        for (auto i = words_begin; i != words_end; ++i)
+// Routine Description:
+// - Checks whether any of the given rows changed since GetGeneration() returned `generation`.
+//   Just like GetRowGeneration() this doesn't account for the rows having moved to another offset.
+// Arguments:
+// - firstRow - The first row to check.
+// - lastRow - The last row to check (inclusive).
+// - generation - A value previously returned by GetGeneration().
+// Return Value:
+// - true if any of the rows changed.
+bool TextBuffer::RowsChangedSince(const til::CoordType firstRow, const til::CoordType lastRow, const uint64_t generation) const noexcept
+{
+    const auto first = std::max(firstRow, 0);
+    const auto last = std::min(lastRow, TotalRowCount() - 1);
+    for (auto y = first; y <= last; ++y)
+    {
+        if (GetRowByOffset(y).GetGeneration() > generation)
         {
-            // record the locations -
-            // when we find a match, the prefix is text that is between this
-            // match and the previous match, so we use the size of the prefix
-            // along with the size of the match to determine the locations
-            til::CoordType prefixSize = 0;
-            for (const auto str = i->prefix().str(); const auto& glyph : til::utf16_iterator{ str })
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Routine Description:
+// - Finds all occurrences of the given text in the buffer in a single pass over all rows.
+//   Just like the Search class, matches may span across multiple rows.
+// - The result is cached until the buffer changes (see GetGeneration()), which makes
+//   repeated searches for the same text (for instance "find next") basically free.
+// Arguments:
+// - needle - The text to search for
+// - caseInsensitive - If true, both the text and the needle are lowercased via towlower() first
+// Return Value:
+// - The start and inclusive end position of each match, ordered by their start position.
+std::shared_ptr<const std::vector<til::point_span>> TextBuffer::SearchText(const std::wstring_view& needle, const bool caseInsensitive) const
+{
+    if (_searchCache.results && _searchCache.generation == _generation && _searchCache.caseInsensitive == caseInsensitive && _searchCache.needle == needle)
+    {
+        return _searchCache.results;
+    }
+
+    auto results = std::make_shared<std::vector<til::point_span>>();
+
+    std::wstring foldedNeedle;
+    auto pattern = needle;
+    if (caseInsensitive)
+    {
+        foldCase(needle, foldedNeedle);
+        pattern = foldedNeedle;
+    }
+
+    // The haystack consists of the text of the current row, prefixed with the last
+    // pattern.size() - 1 characters of the preceding rows, so that we find matches
+    // that span across rows. Each segment maps a part of it back to its row.
+    struct Segment
+    {
+        til::CoordType row;
+        size_t hayOffset;
+        size_t textOffset;
+    };
+    std::wstring hay;
+    std::vector<Segment> segments;
+
+    const auto locate = [&](const size_t pos) noexcept {
+        auto it = segments.end();
+        while ((--it)->hayOffset > pos)
+        {
+        }
+        return std::pair{ it->row, gsl::narrow_cast<ptrdiff_t>(it->textOffset + (pos - it->hayOffset)) };
+    };
+
+    const auto rowCount = TotalRowCount();
+    for (til::CoordType y = 0; y < rowCount && !pattern.empty(); ++y)
+    {
+        const auto text = GetRowByOffset(y).GetText();
+        segments.emplace_back(Segment{ y, hay.size(), 0 });
+        if (caseInsensitive)
+        {
+            foldCase(text, hay);
+        }
+        else
+        {
+            hay.append(text);
+        }
+
+        for (auto pos = findSubstring(hay, pattern, 0); pos != std::wstring_view::npos; pos = findSubstring(hay, pattern, pos + 1))
+        {
+            // Matches must start and end on glyph boundaries. Searching for "a" shouldn't find
+            // the "a" in the middle of a combining character sequence, for instance.
+            const auto [startRow, startOffset] = locate(pos);
+            const auto& firstRow = GetRowByOffset(startRow);
+            const auto startColumn = firstRow.GetLeadingColumnAtCharOffset(startOffset);
+            if (firstRow.GlyphAt(startColumn).data() != firstRow.GetText().data() + startOffset)
+            {
+                continue;
+            }
+
+            const auto [endRow, endOffset] = locate(pos + pattern.size() - 1);
+            const auto& lastRow = GetRowByOffset(endRow);
+            auto endColumn = lastRow.GetLeadingColumnAtCharOffset(endOffset);
+            const auto lastGlyph = lastRow.GlyphAt(endColumn);
+            if (lastGlyph.data() + lastGlyph.size() != lastRow.GetText().data() + endOffset + 1)
             {
-                prefixSize += IsGlyphFullWidth(glyph) ? 2 : 1;
+                continue;
             }
-            const auto start = lenUpToThis + prefixSize;
-            til::CoordType matchSize = 0;
-            for (const auto str = i->str(); const auto& glyph : til::utf16_iterator{ str })
+            // The end is inclusive and so it needs to point at the trailing half of wide glyphs.
+            for (; endColumn + 1 < lastRow.size() && lastRow.DbcsAttrAt(endColumn + 1) == DbcsAttribute::Trailing; ++endColumn)
             {
-                matchSize += IsGlyphFullWidth(glyph) ? 2 : 1;
             }
-            const auto end = start + matchSize;
-            lenUpToThis = end;
 
-            const til::point startCoord{ start % rowSize, start / rowSize };
-            const til::point endCoord{ end % rowSize, end / rowSize };
+            results->emplace_back(til::point_span{ { startColumn, startRow }, { endColumn, endRow } });
+        }
 
-            // store the intervals
-            // NOTE: these intervals are relative to the VIEWPORT not the buffer
-            // Keeping these relative to the viewport for now because its the renderer
-            // that actually uses these locations and the renderer works relative to
-            // the viewport
-            intervals.push_back(PointTree::interval(startCoord, endCoord, idAndPattern.first));
+        // Only the last pattern.size() - 1 characters can be part of a match that
+        // extends into the next row. Everything before that can be discarded.
+        const auto keep = std::min(hay.size(), pattern.size() - 1);
+        const auto discard = hay.size() - keep;
+        hay.erase(0, discard);
+
+        while (segments.size() > 1 && segments[1].hayOffset <= discard)
+        {
+            segments.erase(segments.begin());
+        }
+        for (auto& segment : segments)
+        {
+            if (segment.hayOffset < discard)
+            {
+                segment.textOffset += discard - segment.hayOffset;
+                segment.hayOffset = 0;
+            }
+            else
+            {
+                segment.hayOffset -= discard;
+            }
         }
     }
-    PointTree result(std::move(intervals));
-    return result;
+
+    _searchCache.generation = _generation;
+    _searchCache.needle = needle;
+    _searchCache.caseInsensitive = caseInsensitive;
+    _searchCache.results = std::move(results);
+    return _searchCache.results;
 }
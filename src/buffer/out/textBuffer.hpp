@@ -52,6 +52,7 @@ filling in the last row, and updating the screen.
 #include <vector>
 
 #include "cursor.h"
+#include "PatternRecognizer.hpp"
 #include "Row.hpp"
 #include "TextAttribute.hpp"
 #include "../types/inc/Viewport.hpp"
@@ -73,6 +74,10 @@ public:
                const bool isActiveBuffer,
                Microsoft::Console::Render::Renderer& renderer);
     TextBuffer(const TextBuffer& a) = delete;
+    TextBuffer& operator=(const TextBuffer&) = delete;
+    // The rows and the attribute table's compactor point back into the buffer.
+    TextBuffer(TextBuffer&&) = delete;
+    TextBuffer& operator=(TextBuffer&&) = delete;
 
     // Used for duplicating properties to another text buffer
     void CopyProperties(const TextBuffer& OtherBuffer) noexcept;
@@ -100,6 +105,19 @@ public:
                                  const std::optional<bool> setWrap = std::nullopt,
                                  const std::optional<til::CoordType> limitRight = std::nullopt);
 
+    til::CoordType WriteAsciiRun(const std::wstring_view& chars,
+                                 const til::point target,
+                                 const TextAttribute& attr,
+                                 const std::optional<bool> setWrap = std::nullopt,
+                                 const std::optional<til::CoordType> limitRight = std::nullopt);
+
+    size_t WriteGlyphs(const std::wstring_view& chars,
+                       const til::point target,
+                       const TextAttribute& attr,
+                       til::CoordType& columnsWritten,
+                       const std::optional<bool> setWrap = std::nullopt,
+                       const std::optional<til::CoordType> limitRight = std::nullopt);
+
     bool InsertCharacter(const wchar_t wch, const DbcsAttribute dbcsAttribute, const TextAttribute attr);
     bool InsertCharacter(const std::wstring_view chars, const DbcsAttribute dbcsAttribute, const TextAttribute attr);
     bool IncrementCursor();
@@ -213,11 +231,28 @@ public:
     const size_t AddPatternRecognizer(const std::wstring_view regexString);
     void ClearPatternRecognizers() noexcept;
     void CopyPatterns(const TextBuffer& OtherBuffer);
-    interval_tree::IntervalTree<til::point, size_t> GetPatterns(const til::CoordType firstRow, const til::CoordType lastRow) const;
+    std::shared_ptr<const interval_tree::IntervalTree<til::point, size_t>> GetPatterns(const til::CoordType firstRow, const til::CoordType lastRow) const;
+
+    uint64_t GetGeneration() const noexcept;
+    uint64_t GetRowGeneration(const til::CoordType row) const noexcept;
+    bool RowsChangedSince(const til::CoordType firstRow, const til::CoordType lastRow, const uint64_t generation) const noexcept;
+    std::shared_ptr<const std::vector<til::point_span>> SearchText(const std::wstring_view& needle, const bool caseInsensitive) const;
+
+    void SetMemoryLimit(const size_t megabytes);
+    size_t GetMemoryUsage() const noexcept;
+    void FreezeRows(const til::CoordType end);
+    void ThawRows(const til::CoordType begin, const til::CoordType end);
+    void ThawAll();
 
 private:
+    // Rows are frozen one at a time, but memory can only be released in pages.
+    static constexpr size_t PageSize = 4096;
+    // FreezeRows() visits at most this many rows per call, so that it never holds up the caller for long.
+    static constexpr til::CoordType FreezeBatchSize = 1024;
+
     void _UpdateSize();
     void _SetFirstRowIndex(const til::CoordType FirstRowIndex) noexcept;
+    void _RotateRows(const til::CoordType begin, const til::CoordType middle, const til::CoordType end) noexcept;
     til::point _GetPreviousFromCursor() const noexcept;
     void _SetWrapOnCurrentRow() noexcept;
     void _AdjustWrapOnCurrentRow(const bool fSet) noexcept;
@@ -232,6 +267,12 @@ private:
     til::point _GetWordEndForAccessibility(const til::point target, const std::wstring_view wordDelimiters, const til::point limit) const;
     til::point _GetWordEndForSelection(const til::point target, const std::wstring_view wordDelimiters) const noexcept;
     void _PruneHyperlinks();
+    void _CompactAttributes();
+    std::pair<size_t, size_t> _GetPageRange(const ROW& row) const noexcept;
+    void _InitializeFreezing();
+    void _FreezeRow(ROW& row);
+    void _ThawRow(ROW& row);
+    void _ReleaseFrozenPages(const ROW& row, const size_t frozenSize) noexcept;
 
     static void _AppendRTFText(std::ostringstream& contentBuilder, const std::wstring_view& text);
 
@@ -241,10 +282,13 @@ private:
     std::unordered_map<std::wstring, uint16_t> _hyperlinkCustomIdMap;
     uint16_t _currentHyperlinkId = 1;
 
-    std::unordered_map<size_t, std::wstring> _idsAndPatterns;
+    std::unordered_map<size_t, PatternRecognizer> _idsAndPatterns;
     size_t _currentPatternId = 0;
 
     wil::unique_virtualalloc_ptr<std::byte> _charBuffer;
+    size_t _charBufferRowStride = 0;
+    // Must be declared before _storage, because the rows refer to it.
+    TextAttributeTable _attributeTable;
     std::vector<ROW> _storage;
     TextAttribute _currentAttributes;
     til::CoordType _firstRow = 0; // indexes top row (not necessarily 0)
@@ -252,8 +296,56 @@ private:
     Cursor _cursor;
     Microsoft::Console::Types::Viewport _size;
 
+    // Scratch space for WriteGlyphs(), so that it doesn't allocate for every line.
+    std::vector<GlyphRun> _glyphRuns;
+
     bool _isActiveBuffer = false;
 
+    // Incremented whenever the contents of the buffer change. The rows increment it
+    // themselves when they're modified and store the new value. See ROW::GetGeneration().
+    uint64_t _generation = 0;
+
+    // The result of the last SearchText() call. Only valid as long as _generation doesn't change.
+    struct SearchCache
+    {
+        uint64_t generation = 0;
+        std::wstring needle;
+        bool caseInsensitive = false;
+        std::shared_ptr<const std::vector<til::point_span>> results;
+    };
+    mutable SearchCache _searchCache;
+
+    // The result of the last GetPatterns() call. Only valid as long as none of its rows changed.
+    // It's keyed by the index of the first row in _storage instead of its offset, so that
+    // it survives the rows moving up when the buffer is cycled (see GetRowGeneration()).
+    struct PatternCache
+    {
+        bool valid = false;
+        uint64_t generation = 0;
+        size_t firstRowIndex = 0;
+        til::CoordType rowCount = 0;
+        std::shared_ptr<const interval_tree::IntervalTree<til::point, size_t>> result;
+    };
+    mutable PatternCache _patternCache;
+
+    // While the memory usage exceeds _memoryLimit, FreezeRows() compresses the oldest rows (see ROW::Freeze()).
+    // Once all rows overlapping a page of _charBuffer are frozen, the page's memory is discarded.
+    // Frozen rows read as blank through the const accessors, which is why they must be thawed
+    // before they're read. The non-const GetRowByOffset() does so on its own.
+    size_t _memoryLimit = 0;
+    size_t _frozenBytes = 0;
+    size_t _discardedPages = 0;
+    // The number of rows overlapping each page of _charBuffer, how many of them are frozen and
+    // whether the page got discarded, because all of them are.
+    std::vector<uint16_t> _pageRowCount;
+    std::vector<uint16_t> _pageFrozenCount;
+    std::vector<bool> _pageDiscarded;
+    // Read-only blank text and char offsets for frozen rows, as wide as the buffer.
+    wil::unique_virtualalloc_ptr<std::byte> _frozenRowBlanks;
+    std::vector<uint8_t> _freezeScratch;
+    // All rows in [0, _frozenRowsHint) are frozen. FreezeRows() continues from there.
+    til::CoordType _frozenRowsHint = 0;
+
 #ifdef UNIT_TESTING
     friend class TextBufferTests;
     friend class UiaTextRangeTests;
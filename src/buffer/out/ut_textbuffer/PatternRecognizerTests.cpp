@@ -0,0 +1,181 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "WexTestClass.h"
+#include "../../inc/consoletaeftemplates.hpp"
+
+#include <chrono>
+
+#include "../PatternRecognizer.hpp"
+#include "../textBuffer.hpp"
+#include "../../renderer/inc/DummyRenderer.hpp"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+class PatternRecognizerTests
+{
+    TEST_CLASS(PatternRecognizerTests);
+
+    TEST_METHOD(UrlScannerMatchesRegex);
+    TEST_METHOD(CanMatchAcross);
+    TEST_METHOD(CachesMatches);
+    TEST_METHOD(GetPatternsAcrossRows);
+
+    BEGIN_TEST_METHOD(GetPatternsThroughput)
+        TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+    END_TEST_METHOD()
+
+    static DummyRenderer renderer;
+};
+
+DummyRenderer PatternRecognizerTests::renderer{};
+
+void PatternRecognizerTests::UrlScannerMatchesRegex()
+{
+    static constexpr std::wstring_view texts[]{
+        L"",
+        L"https://example.com",
+        L"see http://example.com/a?b=c&d=e#f, then ftp://x.y.",
+        L"file:///C:/Windows/System32/cmd.exe!",
+        L"xhttp://example.com _http://example.com -http://example.com",
+        L"http://",
+        L"http://...",
+        L"http://a http://b",
+        L"http://a/http://b",
+        L"httpss://a ftps://b htp://c https:/d",
+        L"(https://example.com/(foo))",
+        L"http://\x00e9xample.com https://ex\x00e4mple.com",
+        L"\x3042https://example.com \x00e9http://example.com",
+        L"https://example.com:8080/path;param,more.",
+    };
+
+    const PatternRecognizer recognizer{ PatternRecognizer::UrlPattern };
+    const std::wregex regex{ PatternRecognizer::UrlPattern.data(), PatternRecognizer::UrlPattern.size() };
+
+    for (const auto& text : texts)
+    {
+        std::vector<PatternRecognizer::Match> expected;
+        const auto end = std::wcregex_iterator{};
+        for (auto it = std::wcregex_iterator{ text.data(), text.data() + text.size(), regex }; it != end; ++it)
+        {
+            const auto begin = gsl::narrow_cast<til::CoordType>(it->position());
+            expected.emplace_back(PatternRecognizer::Match{ begin, begin + gsl::narrow_cast<til::CoordType>(it->length()) });
+        }
+
+        const auto& actual = recognizer.FindMatches(text);
+
+        Log::Comment(NoThrowString().Format(L"%.*s", gsl::narrow_cast<int>(text.size()), text.data()));
+        VERIFY_ARE_EQUAL(expected.size(), actual.size());
+        for (size_t i = 0; i < expected.size(); ++i)
+        {
+            VERIFY_ARE_EQUAL(expected[i].begin, actual[i].begin);
+            VERIFY_ARE_EQUAL(expected[i].end, actual[i].end);
+        }
+    }
+}
+
+void PatternRecognizerTests::CanMatchAcross()
+{
+    const PatternRecognizer url{ PatternRecognizer::UrlPattern };
+    VERIFY_IS_TRUE(url.CanMatchAcross(L'a', L'b'));
+    VERIFY_IS_TRUE(url.CanMatchAcross(L'/', L'.'));
+    VERIFY_IS_FALSE(url.CanMatchAcross(L'a', L' '));
+    VERIFY_IS_FALSE(url.CanMatchAcross(L' ', L'h'));
+    VERIFY_IS_FALSE(url.CanMatchAcross(L'(', L'h'));
+
+    Log::Comment(L"Nothing is known about arbitrary regular expressions.");
+    const PatternRecognizer regex{ L"a b" };
+    VERIFY_IS_TRUE(regex.CanMatchAcross(L'a', L' '));
+}
+
+void PatternRecognizerTests::CachesMatches()
+{
+    const PatternRecognizer recognizer{ PatternRecognizer::UrlPattern };
+
+    const auto& first = recognizer.FindMatches(L"\x3042 https://example.com");
+    VERIFY_ARE_EQUAL(1u, first.size());
+    Log::Comment(L"Matches are reported in columns, not characters.");
+    VERIFY_ARE_EQUAL(3, first[0].begin);
+    VERIFY_ARE_EQUAL(22, first[0].end);
+
+    Log::Comment(L"Looking up the same text again returns the cached result.");
+    std::wstring copy{ L"\x3042 https://example.com" };
+    VERIFY_ARE_EQUAL(&first, &recognizer.FindMatches(copy));
+}
+
+void PatternRecognizerTests::GetPatternsAcrossRows()
+{
+    TextBuffer buffer{ { 10, 4 }, TextAttribute{ 0x7 }, 0, false, renderer };
+    const auto id = buffer.AddPatternRecognizer(PatternRecognizer::UrlPattern);
+
+    buffer.WriteAsciiRun(L"a http://e", { 0, 0 }, TextAttribute{ 0x7 }, true);
+    buffer.WriteAsciiRun(L"x.com b", { 0, 1 }, TextAttribute{ 0x7 });
+    buffer.WriteAsciiRun(L"ftp://y z", { 0, 3 }, TextAttribute{ 0x7 });
+
+    const auto initial = buffer.GetPatterns(0, 3);
+    for (auto pass = 0; pass < 2; ++pass)
+    {
+        // The second pass is served from the cache and must return the same tree.
+        const auto patterns = buffer.GetPatterns(0, 3);
+        VERIFY_ARE_EQUAL(initial.get(), patterns.get());
+
+        const auto first = patterns->findOverlapping({ 2, 0 }, { 2, 0 });
+        VERIFY_ARE_EQUAL(1u, first.size());
+        VERIFY_ARE_EQUAL(til::point(2, 0), first[0].start);
+        VERIFY_ARE_EQUAL(til::point(5, 1), first[0].stop);
+        VERIFY_ARE_EQUAL(id, first[0].value);
+
+        const auto second = patterns->findOverlapping({ 0, 3 }, { 0, 3 });
+        VERIFY_ARE_EQUAL(1u, second.size());
+        VERIFY_ARE_EQUAL(til::point(0, 3), second[0].start);
+        VERIFY_ARE_EQUAL(til::point(7, 3), second[0].stop);
+
+        VERIFY_IS_TRUE(patterns->findOverlapping({ 0, 2 }, { 9, 2 }).empty());
+    }
+
+    Log::Comment(L"Changing a row updates the matches.");
+    buffer.WriteAsciiRun(L"x.com/path", { 0, 1 }, TextAttribute{ 0x7 });
+    const auto patterns = buffer.GetPatterns(0, 3);
+    const auto first = patterns->findOverlapping({ 2, 0 }, { 2, 0 });
+    VERIFY_ARE_EQUAL(1u, first.size());
+    VERIFY_ARE_EQUAL(til::point(0, 2), first[0].stop);
+
+    Log::Comment(L"The cache follows its rows when they move up due to the buffer being cycled.");
+    const auto bottom = buffer.GetPatterns(2, 3);
+    VERIFY_IS_TRUE(buffer.IncrementCircularBuffer());
+    VERIFY_ARE_EQUAL(bottom.get(), buffer.GetPatterns(1, 2).get());
+    VERIFY_ARE_NOT_EQUAL(bottom.get(), buffer.GetPatterns(2, 3).get());
+}
+
+void PatternRecognizerTests::GetPatternsThroughput()
+{
+    static constexpr til::CoordType width = 120;
+    static constexpr til::CoordType height = 50;
+
+    TextBuffer buffer{ { width, height }, TextAttribute{ 0x7 }, 0, false, renderer };
+    buffer.AddPatternRecognizer(PatternRecognizer::UrlPattern);
+
+    for (til::CoordType y = 0; y < height; ++y)
+    {
+        const auto line = y % 5 == 0 ? L"error: see https://example.com/docs/errors#E1234 for details" : L"lorem ipsum dolor sit amet, consectetur adipiscing elit";
+        buffer.WriteAsciiRun(line, { 0, y }, TextAttribute{ 0x7 });
+    }
+
+    // Simulate the typical workload of a new line of output scrolling the
+    // viewport by one row, followed by the patterns being updated.
+    static constexpr auto iterations = 1000;
+    const auto beg = std::chrono::steady_clock::now();
+    size_t matches = 0;
+    for (auto i = 0; i < iterations; ++i)
+    {
+        buffer.ScrollRows(1, height - 1, -1);
+        matches += buffer.GetPatterns(0, height - 1)->findOverlapping({ 0, 0 }, { width - 1, height - 1 }).size();
+    }
+    const auto end = std::chrono::steady_clock::now();
+    const auto us = std::chrono::duration_cast<std::chrono::microseconds>(end - beg).count();
+
+    Log::Comment(NoThrowString().Format(L"%d updates with %zu matches in %lld us (%lld us/update)", iterations, matches, us, us / iterations));
+}
@@ -10,6 +10,7 @@
 #include "../../types/inc/GlyphWidth.hpp"
 
 #include <IDataSource.h>
+#include <chrono>
 
 template<>
 class WEX::TestExecution::VerifyOutputTraits<wchar_t>
@@ -840,6 +841,98 @@ class ReflowTests
             _compareTextBufferAgainstTestBuffer(*textBuffer, testBuffer);
         }
     }
+
+    TEST_METHOD(TestReflowAttributes)
+    {
+        // A wrapped line "AAAABBBB" + "CC" where each letter has its own color,
+        // followed by a trailing colored run past the end of the text.
+        TextBuffer textBuffer{ { 10, 5 }, TextAttribute{ 0x7 }, 0, false, renderer };
+        auto& row0 = textBuffer.GetRowByOffset(0);
+        auto& row1 = textBuffer.GetRowByOffset(1);
+        row0.ReplaceCharacters(0, 1, L"A");
+        row0.ReplaceCharacters(1, 1, L"A");
+        row0.ReplaceCharacters(2, 1, L"A");
+        row0.ReplaceCharacters(3, 1, L"A");
+        row0.ReplaceCharacters(4, 1, L"B");
+        row0.ReplaceCharacters(5, 1, L"B");
+        row0.ReplaceCharacters(6, 1, L"B");
+        row0.ReplaceCharacters(7, 1, L"B");
+        row0.ReplaceCharacters(8, 1, L"C");
+        row0.ReplaceCharacters(9, 1, L"C");
+        row0.ReplaceAttributes(0, 4, TextAttribute{ 0x1 });
+        row0.ReplaceAttributes(4, 8, TextAttribute{ 0x2 });
+        row0.ReplaceAttributes(8, 10, TextAttribute{ 0x3 });
+        row0.SetWrapForced(true);
+        row1.ReplaceCharacters(0, 1, L"D");
+        row1.ReplaceAttributes(0, 1, TextAttribute{ 0x4 });
+        row1.ReplaceAttributes(1, 4, TextAttribute{ 0x5 });
+        textBuffer.GetCursor().SetPosition({ 1, 1 });
+
+        const auto newBuffer{ _textBufferByReflowingTextBuffer(textBuffer, { 6, 5 }) };
+        const auto& newRow0 = newBuffer->GetRowByOffset(0);
+        const auto& newRow1 = newBuffer->GetRowByOffset(1);
+
+        VERIFY_ARE_EQUAL(L"AAAABB", newRow0.GetText());
+        VERIFY_IS_TRUE(newRow0.WasWrapForced());
+        VERIFY_ARE_EQUAL(L"BBCCD ", newRow1.GetText());
+        VERIFY_ARE_EQUAL(til::point(5, 1), newBuffer->GetCursor().GetPosition());
+
+        VERIFY_ARE_EQUAL(TextAttribute{ 0x1 }, newRow0.GetAttrByColumn(0));
+        VERIFY_ARE_EQUAL(TextAttribute{ 0x1 }, newRow0.GetAttrByColumn(3));
+        VERIFY_ARE_EQUAL(TextAttribute{ 0x2 }, newRow0.GetAttrByColumn(4));
+        VERIFY_ARE_EQUAL(TextAttribute{ 0x2 }, newRow0.GetAttrByColumn(5));
+        VERIFY_ARE_EQUAL(TextAttribute{ 0x2 }, newRow1.GetAttrByColumn(1));
+        VERIFY_ARE_EQUAL(TextAttribute{ 0x3 }, newRow1.GetAttrByColumn(2));
+        VERIFY_ARE_EQUAL(TextAttribute{ 0x3 }, newRow1.GetAttrByColumn(3));
+        VERIFY_ARE_EQUAL(TextAttribute{ 0x4 }, newRow1.GetAttrByColumn(4));
+        // The attributes following the text are carried over as well.
+        VERIFY_ARE_EQUAL(TextAttribute{ 0x5 }, newRow1.GetAttrByColumn(5));
+    }
+
+    TEST_METHOD(TestReflowPerformance)
+    {
+        BEGIN_TEST_METHOD_PROPERTIES()
+            TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+            TEST_METHOD_PROPERTY(L"Data:scrollback", L"{1000, 10000, 32000}")
+        END_TEST_METHOD_PROPERTIES()
+
+        int scrollback = 1000;
+        TestData::TryGetValue(L"scrollback", scrollback);
+
+        static constexpr til::CoordType width = 120;
+        static constexpr std::wstring_view text{ L"The quick brown fox jumps over the lazy dog. " };
+        static constexpr std::wstring_view wide{ L"\u304a\u306f\u3088\u3046" };
+        static constexpr til::CoordType resizes[] = { 80, 120, 200, 120 };
+
+        auto textBuffer = std::make_unique<TextBuffer>(til::size{ width, scrollback }, TextAttribute{ 0x7 }, 0, false, renderer);
+        for (til::CoordType y = 0; y < scrollback; ++y)
+        {
+            auto& row = textBuffer->GetRowByOffset(y);
+            til::CoordType x = 0;
+            for (auto i = 0; x < width - 8; ++i)
+            {
+                const TextAttribute attr{ gsl::narrow_cast<WORD>((y + i) % 15 + 1) };
+                x += row.WriteAsciiRun(x, text.substr(0, (y + i) % text.size() + 1), attr);
+                for (const auto& ch : wide)
+                {
+                    row.ReplaceCharacters(x, 2, { &ch, 1 });
+                    x += 2;
+                }
+            }
+            row.SetWrapForced(y % 3 != 2);
+        }
+
+        for (const auto newWidth : resizes)
+        {
+            const auto beg = std::chrono::steady_clock::now();
+            auto newBuffer{ _textBufferByReflowingTextBuffer(*textBuffer, { newWidth, scrollback }) };
+            const auto end = std::chrono::steady_clock::now();
+            std::swap(textBuffer, newBuffer);
+
+            const auto elapsed = std::chrono::duration<double, std::milli>(end - beg).count();
+            Log::Comment(NoThrowString().Format(L"%d rows: reflow to %d columns took %.3f ms", scrollback, newWidth, elapsed));
+        }
+    }
 };
 
 DummyRenderer ReflowTests::renderer{};
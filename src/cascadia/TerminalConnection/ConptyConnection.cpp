@@ -673,7 +673,10 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
                 _receivedFirstByte = true;
             }
 
-            // Pass the output to our registered event handlers
+            // Pass the output to our registered event handlers. _u16Str is converted into a
+            // fast-pass hstring referencing it, which doesn't allocate. Handlers that need the
+            // string after returning have to copy it, since _u16Str is reused for the next read.
+            // ControlCore traces how many bytes it copies (see ControlCore::_traceOutputCopies).
             _TerminalOutputHandlers(_u16Str);
         }
 
@@ -39,6 +39,15 @@ constexpr const auto TsfRedrawInterval = std::chrono::milliseconds(100);
 // The minimum delay between updating the locations of regex patterns
 constexpr const auto UpdatePatternLocationsInterval = std::chrono::milliseconds(500);
 
+// The maximum number of characters that may be pending for the output writer thread, if output
+// coalescing is enabled. If the buffer is full the connection's reader thread blocks.
+constexpr const size_t OutputCoalescingBufferCapacity = 256 * 1024;
+
+// If the output writer thread wrote at least this many characters at once, the application is
+// likely producing more, and the writer waits up to the latency budget for more output to
+// accumulate before writing again. It stops waiting early if the buffer fills up.
+constexpr const size_t OutputCoalescingBulkThreshold = 1024;
+
 namespace winrt::Microsoft::Terminal::Control::implementation
 {
     static winrt::Microsoft::Terminal::Core::OptionalColor OptionalFromColor(const til::color& c)
@@ -212,6 +221,15 @@ namespace winrt::Microsoft::Terminal::Control::implementation
                 }
             });
 
+        if (_settings->CoalesceOutput())
+        {
+            const auto latencyBudget = std::chrono::milliseconds{ std::clamp(_settings->OutputLatencyBudget(), 0, 100) };
+            _coalesceOutput = true;
+            _outputWriterThread = std::thread{ [this, latencyBudget]() {
+                _outputWriterThreadMain(latencyBudget);
+            } };
+        }
+
         UpdateSettings(settings, unfocusedAppearance);
     }
 
@@ -405,6 +423,9 @@ namespace winrt::Microsoft::Terminal::Control::implementation
             _handleControlC();
         }
 
+        // The next frame most likely contains the echo of this character.
+        _renderer->NotifyInput();
+
         return _terminal->SendCharEvent(ch, scanCode, modifiers);
     }
 
@@ -546,6 +567,12 @@ namespace winrt::Microsoft::Terminal::Control::implementation
             }
         }
 
+        if (keyDown)
+        {
+            // The next frame most likely contains the echo of this key press.
+            _renderer->NotifyInput();
+        }
+
         // If the terminal translated the key, mark the event as handled.
         // This will prevent the system from trying to get the character out
         // of it and sending us a CharacterReceived event.
@@ -1467,6 +1494,8 @@ namespace winrt::Microsoft::Terminal::Control::implementation
 
         ::Search search(*GetRenderData(), text.c_str(), direction, sensitivity);
         auto lock = _terminal->LockForWriting();
+        // The search reads the entire buffer through const accessors, which don't thaw frozen rows.
+        _terminal->ThawScrollback();
         const auto foundMatch{ search.FindNext() };
         if (foundMatch)
         {
@@ -1498,10 +1527,60 @@ namespace winrt::Microsoft::Terminal::Control::implementation
             // Stop accepting new output and state changes before we disconnect everything.
             _connection.TerminalOutput(_connectionOutputEventToken);
             _connectionStateChangedRevoker.revoke();
+
+            // The connection's output thread may still be inside _connectionOutputHandler,
+            // so the output writer thread is only signaled under the lock. From now on output
+            // is dropped and the writer exits once it has written what is already buffered.
+            if (_coalesceOutput)
+            {
+                {
+                    const std::lock_guard lock{ _outputMutex };
+                    _outputClosed = true;
+                }
+                _outputCondition.notify_all();
+            }
+
             _connection.Close();
+
+            if (_outputWriterThread.joinable())
+            {
+                _outputWriterThread.join();
+            }
+
+            _traceOutputCopies();
         }
     }
 
+    // Method Description:
+    // - Emits the number of bytes the output path copied between receiving output from the
+    //   connection and handing it to Terminal::Write, relative to the number of bytes received.
+    //   Without output coalescing this is expected to be 0, since the connection's output is
+    //   written straight out of its decode buffer.
+    // Arguments:
+    // - <none>
+    // Return Value:
+    // - <none>
+    void ControlCore::_traceOutputCopies() const noexcept
+    {
+        const auto received = _outputBytesReceived.load(std::memory_order_relaxed);
+        if (!received)
+        {
+            return;
+        }
+
+        const auto copied = _outputBytesCopied.load(std::memory_order_relaxed);
+
+#pragma warning(suppress : 26477 26485 26494 26482 26446) // We don't control TraceLoggingWrite
+        TraceLoggingWrite(g_hTerminalControlProvider,
+                          "OutputPipelineCopies",
+                          TraceLoggingDescription("An event emitted when the control is closed, describing the copies made on the output path"),
+                          TraceLoggingUInt64(received, "BytesReceived"),
+                          TraceLoggingUInt64(copied, "BytesCopied"),
+                          TraceLoggingFloat64(static_cast<double>(copied) / static_cast<double>(received), "BytesCopiedPerByteReceived"),
+                          TraceLoggingKeyword(MICROSOFT_KEYWORD_MEASURES),
+                          TelemetryPrivacyDataTag(PDT_ProductAndServicePerformance));
+    }
+
     void ControlCore::_rendererWarning(const HRESULT hr)
     {
         _RendererWarningHandlers(*this, winrt::make<RendererWarningArgs>(hr));
@@ -1653,6 +1732,12 @@ namespace winrt::Microsoft::Terminal::Control::implementation
 
     void ControlCore::AttachUiaEngine(::Microsoft::Console::Render::IRenderEngine* const pEngine)
     {
+        // UIA can read any row at any time through const accessors, which don't thaw frozen rows.
+        {
+            auto lock = _terminal->LockForWriting();
+            _terminal->DisableScrollbackFreezing();
+        }
+
         // _renderer will always exist since it's introduced in the ctor
         _renderer->AddRenderEngine(pEngine);
     }
@@ -1674,6 +1759,30 @@ namespace winrt::Microsoft::Terminal::Control::implementation
     }
     void ControlCore::_connectionOutputHandler(const hstring& hstr)
     {
+        _outputBytesReceived.fetch_add(hstr.size() * sizeof(wchar_t), std::memory_order_relaxed);
+
+        // If output coalescing is enabled, the writer thread applies the output instead.
+        // This blocks if the buffer is full, which applies back-pressure on the connection.
+        // The hstring references the connection's reused decode buffer, so it has to be copied.
+        if (_coalesceOutput)
+        {
+            try
+            {
+                std::unique_lock lock{ _outputMutex };
+                _outputCondition.wait(lock, [this]() { return _outputClosed || _outputBuffer.size() < OutputCoalescingBufferCapacity; });
+                if (_outputClosed)
+                {
+                    return;
+                }
+
+                _outputBuffer.append(hstr);
+                _outputBytesCopied.fetch_add(hstr.size() * sizeof(wchar_t), std::memory_order_relaxed);
+            }
+            CATCH_LOG();
+            _outputCondition.notify_all();
+            return;
+        }
+
         try
         {
             _terminal->Write(hstr);
@@ -1688,6 +1797,70 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         }
     }
 
+    // Method Description:
+    // - The main function of the output writer thread, if output coalescing is enabled.
+    //   It waits for output from the connection, takes everything that accumulated in
+    //   _outputBuffer at once and writes it with a single Terminal::Write call. Under a
+    //   flood of output this turns thousands of lock handoffs, parser passes and cursor/scroll
+    //   notifications per second into a few, which leaves the render thread more room to
+    //   acquire the lock in between.
+    // - The buffer is swapped with a local string instead of being copied, so apart from the
+    //   copy made by _connectionOutputHandler the output isn't copied again.
+    // Arguments:
+    // - latencyBudget: after writing a large amount of output, the maximum time to wait for
+    //   more output to accumulate. The wait ends early if the buffer fills up or the control
+    //   is closed. Small writes, like echoed keystrokes, are not followed by a wait.
+    // Return Value:
+    // - <none>
+    void ControlCore::_outputWriterThreadMain(const std::chrono::milliseconds latencyBudget)
+    {
+        // The output taken from _outputBuffer. The two strings are swapped back and forth,
+        // so both capacities are reused for the lifetime of the thread.
+        std::wstring pending;
+        auto bulk = false;
+
+        while (true)
+        {
+            {
+                std::unique_lock lock{ _outputMutex };
+
+                if (bulk)
+                {
+                    _outputCondition.wait_for(lock, latencyBudget, [this]() { return _outputClosed || _outputBuffer.size() >= OutputCoalescingBufferCapacity; });
+                }
+
+                _outputCondition.wait(lock, [this]() { return _outputClosed || !_outputBuffer.empty(); });
+                if (_outputBuffer.empty())
+                {
+                    // We're closed and all output was written.
+                    break;
+                }
+
+                pending.clear();
+                pending.swap(_outputBuffer);
+            }
+
+            // Wake up the connection's reader thread, in case it's waiting for room in the buffer.
+            _outputCondition.notify_all();
+
+            try
+            {
+                // Terminal::Write acquires the terminal lock itself.
+                _terminal->Write(pending);
+            }
+            catch (...)
+            {
+                // We're expecting to receive an exception here if the terminal
+                // is closed while we're blocked playing a MIDI note.
+            }
+
+            // Start the throttled update of where our hyperlinks are.
+            (*_updatePatternLocations)();
+
+            bulk = pending.size() >= OutputCoalescingBulkThreshold && latencyBudget.count();
+        }
+    }
+
     // Method Description:
     // - Clear the contents of the buffer. The region cleared is given by
     //   clearType:
@@ -1722,6 +1895,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
     hstring ControlCore::ReadEntireBuffer() const
     {
         auto terminalLock = _terminal->LockForWriting();
+        _terminal->ThawScrollback();
 
         const auto& textBuffer = _terminal->GetTextBuffer();
 
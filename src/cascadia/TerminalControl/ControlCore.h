@@ -24,6 +24,8 @@
 #include "../buffer/out/search.h"
 #include "../buffer/out/TextColor.h"
 
+#include <condition_variable>
+
 #include <til/ticket_lock.h>
 
 namespace ControlUnitTests
@@ -283,6 +285,19 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         std::unique_ptr<til::throttled_func_trailing<>> _updatePatternLocations;
         std::shared_ptr<ThrottledFuncTrailing<Control::ScrollPositionChangedArgs>> _updateScrollBar;
 
+        // Only used if output coalescing is enabled. See _outputWriterThreadMain.
+        // _outputBuffer and _outputClosed are guarded by _outputMutex.
+        bool _coalesceOutput{ false };
+        std::mutex _outputMutex;
+        std::condition_variable _outputCondition;
+        std::wstring _outputBuffer;
+        bool _outputClosed{ false };
+        std::thread _outputWriterThread;
+
+        // The UTF-16 bytes received from the connection and copied before reaching Terminal::Write.
+        std::atomic<uint64_t> _outputBytesReceived{ 0 };
+        std::atomic<uint64_t> _outputBytesCopied{ 0 };
+
         bool _setFontSizeUnderLock(float fontSize);
         void _updateFont(const bool initialUpdate = false);
         void _refreshSizeUnderLock();
@@ -320,6 +335,8 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         void _raiseReadOnlyWarning();
         void _updateAntiAliasingMode();
         void _connectionOutputHandler(const hstring& hstr);
+        void _traceOutputCopies() const noexcept;
+        void _outputWriterThreadMain(const std::chrono::milliseconds latencyBudget);
         void _updateHoveredCell(const std::optional<til::point> terminalPosition);
         void _setOpacity(const double opacity);
 
@@ -140,6 +140,13 @@ void Terminal::UpdateSettings(ICoreSettings settings)
         _mainBuffer->ClearPatternRecognizers();
         _detectURLs = settings.DetectURLs();
         _updateUrlDetection();
+
+        // Only the main buffer has a scrollback worth freezing.
+        try
+        {
+            _mainBuffer->SetMemoryLimit(gsl::narrow_cast<size_t>(std::max(0, settings.ScrollbackMemoryLimit())));
+        }
+        CATCH_LOG();
     }
 }
 
@@ -486,6 +493,7 @@ void Terminal::Write(std::wstring_view stringView)
     const til::point cursorPosBefore{ cursor.GetPosition() };
 
     _stateMachine->ProcessString(stringView);
+    _FreezeColdRows();
 
     const til::point cursorPosAfter{ cursor.GetPosition() };
 
@@ -603,7 +611,7 @@ std::wstring Terminal::GetHyperlinkAtBufferPosition(const til::point bufferPos)
         // NOTE: patterns is stored with top y-position being 0,
         //       so we need to cleverly set the y-pos to 0.
         const til::point viewportPos{ bufferPos.x, 0 };
-        const auto results = patterns.findOverlapping(viewportPos, viewportPos);
+        const auto results = patterns->findOverlapping(viewportPos, viewportPos);
         if (!results.empty())
         {
             result = results.front();
@@ -646,7 +654,12 @@ uint16_t Terminal::GetHyperlinkIdAtViewportPosition(const til::point viewportPos
 // - The interval representing the start and end coordinates
 std::optional<PointTree::interval> Terminal::GetHyperlinkIntervalFromViewportPosition(const til::point viewportPos)
 {
-    const auto results = _patternIntervalTree.findOverlapping({ viewportPos.x + 1, viewportPos.y }, viewportPos);
+    if (!_patternIntervalTree)
+    {
+        return std::nullopt;
+    }
+
+    const auto results = _patternIntervalTree->findOverlapping({ viewportPos.x + 1, viewportPos.y }, viewportPos);
     if (results.size() > 0)
     {
         for (const auto& result : results)
@@ -848,15 +861,20 @@ void Terminal::FocusChanged(const bool focused) noexcept
 // - Invalidates the regions described in the given pattern tree for the rendering purposes
 // Arguments:
 // - The interval tree containing regions that need to be invalidated
-void Terminal::_InvalidatePatternTree(const interval_tree::IntervalTree<til::point, size_t>& tree)
+void Terminal::_InvalidatePatternTree(const std::shared_ptr<const interval_tree::IntervalTree<til::point, size_t>>& tree)
 {
+    if (!tree)
+    {
+        return;
+    }
+
     const auto vis = _VisibleStartIndex();
     auto invalidate = [=](const PointTree::interval& interval) {
         const til::point startCoord{ interval.start.x, interval.start.y + vis };
         const til::point endCoord{ interval.stop.x, interval.stop.y + vis };
         _InvalidateFromCoords(startCoord, endCoord);
     };
-    tree.visit_all(invalidate);
+    tree->visit_all(invalidate);
 }
 
 // Method Description:
@@ -1135,7 +1153,7 @@ void Terminal::_AdjustCursorPosition(const til::point proposedPosition)
         }
 
         // manually erase our pattern intervals since the locations have changed now
-        _patternIntervalTree = {};
+        _patternIntervalTree.reset();
     }
 
     // Update Cursor Position
@@ -1237,6 +1255,7 @@ void Terminal::UserScrollViewport(const int viewTop)
     // if viewTop > realTop, we want the offset to be 0.
 
     _scrollOffset = std::max(0, newDelta);
+    _ThawVisibleRows();
 
     // We can use the void variant of TriggerScroll here because
     // we adjusted the viewport so it can detect the difference
@@ -1249,6 +1268,53 @@ int Terminal::GetScrollOffset() noexcept
     return _VisibleStartIndex();
 }
 
+// Method Description:
+// - Thaws all rows of the main buffer. This must be called before reading rows outside
+//   of the visible viewport through the const TextBuffer accessors, which don't thaw.
+void Terminal::ThawScrollback()
+{
+    _mainBuffer->ThawAll();
+}
+
+// Method Description:
+// - Thaws all rows of the main buffer and stops freezing them for the rest of the
+//   Terminal's lifetime. Used by consumers that read arbitrary rows at any time, like UIA.
+void Terminal::DisableScrollbackFreezing()
+{
+    _scrollbackFreezingDisabled = true;
+    ThawScrollback();
+}
+
+// Method Description:
+// - Freezes the rows of the main buffer that are far above the viewport, if the buffer exceeds
+//   its memory limit. The renderer, the selection and UIA read rows through const accessors that
+//   don't thaw them. So we only do so while none of them can look at the scrollback: while
+//   we aren't scrolled up and there's no selection. Scrolling up and selecting thaw them.
+void Terminal::_FreezeColdRows() noexcept
+try
+{
+    if (_scrollbackFreezingDisabled || _scrollOffset != 0 || IsSelectionActive())
+    {
+        return;
+    }
+
+    // Rows this close to the viewport are never frozen, since that's where text is being written and read.
+    static constexpr til::CoordType hotRows = 1024;
+    const auto end = std::min(_mutableViewport.Top(), _mainBuffer->GetCursor().GetPosition().y) - hotRows;
+    _mainBuffer->FreezeRows(end);
+}
+CATCH_LOG()
+
+// Method Description:
+// - Thaws the rows that just became visible by scrolling, so that the renderer can read them.
+void Terminal::_ThawVisibleRows()
+{
+    if (!_inAltBuffer())
+    {
+        _mainBuffer->ThawRows(_VisibleStartIndex(), _VisibleEndIndex() + 1);
+    }
+}
+
 void Terminal::_NotifyScrollEvent() noexcept
 try
 {
@@ -1360,7 +1426,7 @@ bool Terminal::IsCursorBlinkingAllowed() const noexcept
 // - INVARIANT: this function can only be called if the caller has the writing lock on the terminal
 void Terminal::UpdatePatternsUnderLock()
 {
-    auto oldTree = _patternIntervalTree;
+    auto oldTree = std::move(_patternIntervalTree);
     _patternIntervalTree = _activeBuffer().GetPatterns(_VisibleStartIndex(), _VisibleEndIndex());
     _InvalidatePatternTree(oldTree);
     _InvalidatePatternTree(_patternIntervalTree);
@@ -1372,8 +1438,7 @@ void Terminal::UpdatePatternsUnderLock()
 //   visible region is changing
 void Terminal::ClearPatternTree()
 {
-    auto oldTree = _patternIntervalTree;
-    _patternIntervalTree = {};
+    auto oldTree = std::move(_patternIntervalTree);
     _InvalidatePatternTree(oldTree);
 }
 
@@ -17,7 +17,7 @@
 
 #include <til/ticket_lock.h>
 
-static constexpr std::wstring_view linkPattern{ LR"(\b(https?|ftp|file)://[-A-Za-z0-9+&@#/%?=~_|$!:,.;]*[A-Za-z0-9+&@#/%=~_|$])" };
+static constexpr std::wstring_view linkPattern{ PatternRecognizer::UrlPattern };
 static constexpr size_t TaskbarMinProgress{ 10 };
 
 // You have to forward decl the ICoreSettings here, instead of including the header.
@@ -85,6 +85,10 @@ public:
     // WritePastedText comes from our input and goes back to the PTY's input channel
     void WritePastedText(std::wstring_view stringView);
 
+    // Frozen scrollback rows read as blank until they're thawed. See TextBuffer::FreezeRows().
+    void ThawScrollback();
+    void DisableScrollbackFreezing();
+
     [[nodiscard]] std::unique_lock<til::recursive_ticket_lock> LockForReading();
     [[nodiscard]] std::unique_lock<til::recursive_ticket_lock> LockForWriting();
     til::recursive_ticket_lock_suspension SuspendLock() noexcept;
@@ -364,6 +368,7 @@ private:
     Microsoft::Console::Types::Viewport _mutableViewport;
     til::CoordType _scrollbackLines = 0;
     bool _detectURLs = false;
+    bool _scrollbackFreezingDisabled = false;
 
     til::size _altBufferSize;
     std::optional<til::size> _deferredResize;
@@ -384,8 +389,9 @@ private:
     //      underneath them, while others would prefer to anchor it in place.
     //      Either way, we should make this behavior controlled by a setting.
 
-    interval_tree::IntervalTree<til::point, size_t> _patternIntervalTree;
-    void _InvalidatePatternTree(const interval_tree::IntervalTree<til::point, size_t>& tree);
+    // Shared with the TextBuffer's pattern cache. nullptr if there are no patterns.
+    std::shared_ptr<const interval_tree::IntervalTree<til::point, size_t>> _patternIntervalTree;
+    void _InvalidatePatternTree(const std::shared_ptr<const interval_tree::IntervalTree<til::point, size_t>>& tree);
     void _InvalidateFromCoords(const til::point start, const til::point end);
 
     // Since virtual keys are non-zero, you assume that this field is empty/invalid if it is.
@@ -429,6 +435,8 @@ private:
     bool _inAltBuffer() const noexcept;
     TextBuffer& _activeBuffer() const noexcept;
     void _updateUrlDetection();
+    void _FreezeColdRows() noexcept;
+    void _ThawVisibleRows();
 
 #pragma region TextSelection
     // These methods are defined in TerminalSelection.cpp
@@ -170,6 +170,9 @@ const bool Terminal::IsBlockSelection() const noexcept
 // - expansionMode: the SelectionExpansion to dictate the boundaries of the selection anchors
 void Terminal::MultiClickSelection(const til::point viewportPos, SelectionExpansion expansionMode)
 {
+    // The selection may be expanded to anywhere in the buffer, which is then read through const accessors.
+    ThawScrollback();
+
     // set the selection pivot to expand the selection using SetSelectionEnd()
     _selection = SelectionAnchors{};
     _selection->pivot = _ConvertToBufferCell(viewportPos);
@@ -188,6 +191,9 @@ void Terminal::MultiClickSelection(const til::point viewportPos, SelectionExpans
 // - position: the (x,y) coordinate on the visible viewport
 void Terminal::SetSelectionAnchor(const til::point viewportPos)
 {
+    // The selection may be expanded to anywhere in the buffer, which is then read through const accessors.
+    ThawScrollback();
+
     _selection = SelectionAnchors{};
     _selection->pivot = _ConvertToBufferCell(viewportPos);
 
@@ -324,6 +330,7 @@ void Terminal::ToggleMarkMode()
         if (!IsSelectionActive())
         {
             // No selection --> start one at the cursor
+            ThawScrollback();
             const auto cursorPos{ _activeBuffer().GetCursor().GetPosition() };
             _selection = SelectionAnchors{};
             _selection->start = cursorPos;
@@ -474,7 +481,11 @@ void Terminal::SelectHyperlink(const SearchDirection dir)
     til::point searchEnd = dir == SearchDirection::Forward ? til::point{ bufferSize.RightInclusive(), _VisibleEndIndex() } : _selection->start;
 
     // 1.A) Try searching the current viewport (no scrolling required)
-    auto resultList = _patternIntervalTree.findContained(convertToSearchArea(searchStart), convertToSearchArea(searchEnd));
+    std::vector<interval_tree::Interval<til::point, size_t>> resultList;
+    if (_patternIntervalTree)
+    {
+        resultList = _patternIntervalTree->findContained(convertToSearchArea(searchStart), convertToSearchArea(searchEnd));
+    }
     std::optional<std::pair<til::point, til::point>> result = extractResultFromList(resultList);
     if (!result)
     {
@@ -496,7 +507,7 @@ void Terminal::SelectHyperlink(const SearchDirection dir)
         while (!result && bufferSize.IsInBounds(searchStart) && bufferSize.IsInBounds(searchEnd) && searchStart <= searchEnd && bufferStart <= searchStart && searchEnd <= bufferEnd)
         {
             auto patterns = _activeBuffer().GetPatterns(searchStart.y, searchEnd.y);
-            resultList = patterns.findContained(convertToSearchArea(searchStart), convertToSearchArea(searchEnd));
+            resultList = patterns->findContained(convertToSearchArea(searchStart), convertToSearchArea(searchEnd));
             result = extractResultFromList(resultList);
             if (!result)
             {
@@ -666,6 +677,7 @@ void Terminal::UpdateSelection(SelectionDirection direction, SelectionExpansion
 
 void Terminal::SelectAll()
 {
+    ThawScrollback();
     const auto bufferSize{ _activeBuffer().GetSize() };
     _selection = SelectionAnchors{};
     _selection->start = bufferSize.Origin();
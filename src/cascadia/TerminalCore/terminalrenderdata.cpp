@@ -106,7 +106,12 @@ const std::wstring Microsoft::Terminal::Core::Terminal::GetHyperlinkCustomId(uin
 const std::vector<size_t> Terminal::GetPatternId(const til::point location) const
 {
     // Look through our interval tree for this location
-    const auto intervals = _patternIntervalTree.findOverlapping({ location.x + 1, location.y }, location);
+    if (!_patternIntervalTree)
+    {
+        return {};
+    }
+
+    const auto intervals = _patternIntervalTree->findOverlapping({ location.x + 1, location.y }, location);
     if (intervals.size() == 0)
     {
         return {};
@@ -148,6 +153,9 @@ catch (...)
 
 void Terminal::SelectNewRegion(const til::point coordStart, const til::point coordEnd)
 {
+    // The selection may be expanded to anywhere in the buffer, which is then read through const accessors.
+    ThawScrollback();
+
 #pragma warning(push)
 #pragma warning(disable : 26496) // cpp core checks wants these const, but they're decremented below.
     auto realCoordStart = coordStart;
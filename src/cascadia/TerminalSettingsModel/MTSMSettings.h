@@ -28,6 +28,9 @@ Author(s):
     X(bool, SoftwareRendering, "experimental.rendering.software", false)                                                                                   \
     X(bool, UseBackgroundImageForWindow, "experimental.useBackgroundImageForWindow", false)                                                                \
     X(bool, ForceVTInput, "experimental.input.forceVT", false)                                                                                             \
+    X(bool, CoalesceOutput, "experimental.output.coalesce", false)                                                                                         \
+    X(int32_t, OutputLatencyBudget, "experimental.output.latencyBudget", 4)                                                                                \
+    X(int32_t, ScrollbackMemoryLimit, "experimental.scrollbackMemoryLimit", 0)                                                                             \
     X(bool, TrimBlockSelection, "trimBlockSelection", true)                                                                                                \
     X(bool, DetectURLs, "experimental.detectURLs", true)                                                                                                   \
     X(bool, AlwaysShowTabs, "alwaysShowTabs", true)                                                                                                        \
@@ -326,6 +326,9 @@ namespace winrt::Microsoft::Terminal::Settings::Model::implementation
         _SoftwareRendering = globalSettings.SoftwareRendering();
         _UseBackgroundImageForWindow = globalSettings.UseBackgroundImageForWindow();
         _ForceVTInput = globalSettings.ForceVTInput();
+        _CoalesceOutput = globalSettings.CoalesceOutput();
+        _OutputLatencyBudget = globalSettings.OutputLatencyBudget();
+        _ScrollbackMemoryLimit = globalSettings.ScrollbackMemoryLimit();
         _TrimBlockSelection = globalSettings.TrimBlockSelection();
         _DetectURLs = globalSettings.DetectURLs();
     }
@@ -153,6 +153,9 @@ namespace winrt::Microsoft::Terminal::Settings::Model::implementation
         INHERITABLE_SETTING(Model::TerminalSettings, bool, SoftwareRendering, false);
         INHERITABLE_SETTING(Model::TerminalSettings, bool, UseBackgroundImageForWindow, false);
         INHERITABLE_SETTING(Model::TerminalSettings, bool, ForceVTInput, false);
+        INHERITABLE_SETTING(Model::TerminalSettings, bool, CoalesceOutput, false);
+        INHERITABLE_SETTING(Model::TerminalSettings, int32_t, OutputLatencyBudget, 4);
+        INHERITABLE_SETTING(Model::TerminalSettings, int32_t, ScrollbackMemoryLimit, 0);
 
         INHERITABLE_SETTING(Model::TerminalSettings, hstring, PixelShaderPath);
 
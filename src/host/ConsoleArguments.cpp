@@ -21,6 +21,8 @@ const std::wstring_view ConsoleArguments::HEIGHT_ARG = L"--height";
 const std::wstring_view ConsoleArguments::INHERIT_CURSOR_ARG = L"--inheritcursor";
 const std::wstring_view ConsoleArguments::RESIZE_QUIRK = L"--resizeQuirk";
 const std::wstring_view ConsoleArguments::WIN32_INPUT_MODE = L"--win32input";
+const std::wstring_view ConsoleArguments::SHADOW_FRAME_ARG = L"--shadowFrame";
+const std::wstring_view ConsoleArguments::OUTPUT_HIGH_WATER_MARK_ARG = L"--outputHighWaterMark";
 const std::wstring_view ConsoleArguments::FEATURE_ARG = L"--feature";
 const std::wstring_view ConsoleArguments::FEATURE_PTY_ARG = L"pty";
 const std::wstring_view ConsoleArguments::COM_SERVER_ARG = L"-Embedding";
@@ -521,6 +523,17 @@ void ConsoleArguments::s_ConsumeArg(_Inout_ std::vector<std::wstring>& args, _In
             s_ConsumeArg(args, i);
             hr = S_OK;
         }
+        else if (arg == SHADOW_FRAME_ARG)
+        {
+            _shadowFrame = true;
+            s_ConsumeArg(args, i);
+            hr = S_OK;
+        }
+        else if (arg == OUTPUT_HIGH_WATER_MARK_ARG)
+        {
+            // The value is in KiB.
+            hr = s_GetArgumentValue(args, i, &_outputHighWaterMark);
+        }
         else if (arg == CLIENT_COMMANDLINE_ARG)
         {
             // Everything after this is the explicit commandline
@@ -681,6 +694,14 @@ bool ConsoleArguments::IsWin32InputModeEnabled() const
 {
     return _win32InputMode;
 }
+bool ConsoleArguments::IsShadowFrameEnabled() const
+{
+    return _shadowFrame;
+}
+short ConsoleArguments::GetOutputHighWaterMark() const
+{
+    return _outputHighWaterMark;
+}
 
 #ifdef UNIT_TESTING
 // Method Description:
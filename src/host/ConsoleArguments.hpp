@@ -56,6 +56,8 @@ public:
     bool GetInheritCursor() const;
     bool IsResizeQuirkEnabled() const;
     bool IsWin32InputModeEnabled() const;
+    bool IsShadowFrameEnabled() const;
+    short GetOutputHighWaterMark() const;
 
 #ifdef UNIT_TESTING
     void EnableConptyModeForTests();
@@ -75,6 +77,8 @@ public:
     static const std::wstring_view INHERIT_CURSOR_ARG;
     static const std::wstring_view RESIZE_QUIRK;
     static const std::wstring_view WIN32_INPUT_MODE;
+    static const std::wstring_view SHADOW_FRAME_ARG;
+    static const std::wstring_view OUTPUT_HIGH_WATER_MARK_ARG;
     static const std::wstring_view FEATURE_ARG;
     static const std::wstring_view FEATURE_PTY_ARG;
     static const std::wstring_view COM_SERVER_ARG;
@@ -145,6 +149,8 @@ private:
     bool _inheritCursor;
     bool _resizeQuirk{ false };
     bool _win32InputMode{ false };
+    bool _shadowFrame{ false };
+    short _outputHighWaterMark{ 0 };
 
     [[nodiscard]] HRESULT _GetClientCommandline(_Inout_ std::vector<std::wstring>& args,
                                                 const size_t index,
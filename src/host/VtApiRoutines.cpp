@@ -106,45 +106,45 @@ void VtApiRoutines::_SynchronizeCursor(std::unique_ptr<IWaitRoutine>& waiter) no
 }
 
 [[nodiscard]] HRESULT VtApiRoutines::PeekConsoleInputAImpl(IConsoleInputObject& context,
-                                                           std::deque<std::unique_ptr<IInputEvent>>& outEvents,
+                                                           std::vector<INPUT_RECORD>& outRecords,
                                                            const size_t eventsToRead,
                                                            INPUT_READ_HANDLE_DATA& readHandleState,
                                                            std::unique_ptr<IWaitRoutine>& waiter) noexcept
 {
-    const auto hr = m_pUsualRoutines->PeekConsoleInputAImpl(context, outEvents, eventsToRead, readHandleState, waiter);
+    const auto hr = m_pUsualRoutines->PeekConsoleInputAImpl(context, outRecords, eventsToRead, readHandleState, waiter);
     _SynchronizeCursor(waiter);
     return hr;
 }
 
 [[nodiscard]] HRESULT VtApiRoutines::PeekConsoleInputWImpl(IConsoleInputObject& context,
-                                                           std::deque<std::unique_ptr<IInputEvent>>& outEvents,
+                                                           std::vector<INPUT_RECORD>& outRecords,
                                                            const size_t eventsToRead,
                                                            INPUT_READ_HANDLE_DATA& readHandleState,
                                                            std::unique_ptr<IWaitRoutine>& waiter) noexcept
 {
-    const auto hr = m_pUsualRoutines->PeekConsoleInputWImpl(context, outEvents, eventsToRead, readHandleState, waiter);
+    const auto hr = m_pUsualRoutines->PeekConsoleInputWImpl(context, outRecords, eventsToRead, readHandleState, waiter);
     _SynchronizeCursor(waiter);
     return hr;
 }
 
 [[nodiscard]] HRESULT VtApiRoutines::ReadConsoleInputAImpl(IConsoleInputObject& context,
-                                                           std::deque<std::unique_ptr<IInputEvent>>& outEvents,
+                                                           std::vector<INPUT_RECORD>& outRecords,
                                                            const size_t eventsToRead,
                                                            INPUT_READ_HANDLE_DATA& readHandleState,
                                                            std::unique_ptr<IWaitRoutine>& waiter) noexcept
 {
-    const auto hr = m_pUsualRoutines->ReadConsoleInputAImpl(context, outEvents, eventsToRead, readHandleState, waiter);
+    const auto hr = m_pUsualRoutines->ReadConsoleInputAImpl(context, outRecords, eventsToRead, readHandleState, waiter);
     _SynchronizeCursor(waiter);
     return hr;
 }
 
 [[nodiscard]] HRESULT VtApiRoutines::ReadConsoleInputWImpl(IConsoleInputObject& context,
-                                                           std::deque<std::unique_ptr<IInputEvent>>& outEvents,
+                                                           std::vector<INPUT_RECORD>& outRecords,
                                                            const size_t eventsToRead,
                                                            INPUT_READ_HANDLE_DATA& readHandleState,
                                                            std::unique_ptr<IWaitRoutine>& waiter) noexcept
 {
-    const auto hr = m_pUsualRoutines->ReadConsoleInputWImpl(context, outEvents, eventsToRead, readHandleState, waiter);
+    const auto hr = m_pUsualRoutines->ReadConsoleInputWImpl(context, outRecords, eventsToRead, readHandleState, waiter);
     _SynchronizeCursor(waiter);
     return hr;
 }
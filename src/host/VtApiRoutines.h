@@ -53,25 +53,25 @@ public:
                                                             ULONG& events) noexcept override;
 
     [[nodiscard]] HRESULT PeekConsoleInputAImpl(IConsoleInputObject& context,
-                                                std::deque<std::unique_ptr<IInputEvent>>& outEvents,
+                                                std::vector<INPUT_RECORD>& outRecords,
                                                 const size_t eventsToRead,
                                                 INPUT_READ_HANDLE_DATA& readHandleState,
                                                 std::unique_ptr<IWaitRoutine>& waiter) noexcept override;
 
     [[nodiscard]] HRESULT PeekConsoleInputWImpl(IConsoleInputObject& context,
-                                                std::deque<std::unique_ptr<IInputEvent>>& outEvents,
+                                                std::vector<INPUT_RECORD>& outRecords,
                                                 const size_t eventsToRead,
                                                 INPUT_READ_HANDLE_DATA& readHandleState,
                                                 std::unique_ptr<IWaitRoutine>& waiter) noexcept override;
 
     [[nodiscard]] HRESULT ReadConsoleInputAImpl(IConsoleInputObject& context,
-                                                std::deque<std::unique_ptr<IInputEvent>>& outEvents,
+                                                std::vector<INPUT_RECORD>& outRecords,
                                                 const size_t eventsToRead,
                                                 INPUT_READ_HANDLE_DATA& readHandleState,
                                                 std::unique_ptr<IWaitRoutine>& waiter) noexcept override;
 
     [[nodiscard]] HRESULT ReadConsoleInputWImpl(IConsoleInputObject& context,
-                                                std::deque<std::unique_ptr<IInputEvent>>& outEvents,
+                                                std::vector<INPUT_RECORD>& outRecords,
                                                 const size_t eventsToRead,
                                                 INPUT_READ_HANDLE_DATA& readHandleState,
                                                 std::unique_ptr<IWaitRoutine>& waiter) noexcept override;
@@ -30,7 +30,8 @@ VtInputThread::VtInputThread(_In_ wil::unique_hfile hPipe,
     _u8State{},
     _dwThreadId{ 0 },
     _exitRequested{ false },
-    _pfnSetLookingForDSR{}
+    _pfnSetLookingForDSR{},
+    _pfnFlushPendingPaste{}
 {
     THROW_HR_IF(E_HANDLE, _hFile.get() == INVALID_HANDLE_VALUE);
 
@@ -48,6 +49,9 @@ VtInputThread::VtInputThread(_In_ wil::unique_hfile hPipe,
 
     // we need this callback to capture the reply if someone requests a status from the terminal
     _pfnSetLookingForDSR = std::bind(&InputStateMachineEngine::SetLookingForDSR, engineRef, std::placeholders::_1);
+
+    // the engine collects a bracketed paste, until it ends or we run out of input
+    _pfnFlushPendingPaste = std::bind(&InputStateMachineEngine::FlushPendingPaste, engineRef);
 }
 
 // Method Description:
@@ -78,6 +82,7 @@ VtInputThread::VtInputThread(_In_ wil::unique_hfile hPipe,
             return S_FALSE;
         }
         _pInputStateMachine->ProcessString(wstr);
+        _pfnFlushPendingPaste();
     }
     CATCH_RETURN();
 
@@ -107,7 +112,9 @@ DWORD WINAPI VtInputThread::StaticVtInputThreadProc(_In_ LPVOID lpParameter)
 // - <none>
 void VtInputThread::DoReadInput(const bool throwOnFail)
 {
-    char buffer[256];
+    // A paste arrives in a single write. Reading it in larger chunks means fewer
+    // trips through the state machine, and fewer writes to the input buffer.
+    char buffer[4096];
     DWORD dwRead = 0;
     auto fSuccess = !!ReadFile(_hFile.get(), buffer, ARRAYSIZE(buffer), &dwRead, nullptr);
 
@@ -39,6 +39,7 @@ namespace Microsoft::Console
         bool _exitRequested;
 
         std::function<void(bool)> _pfnSetLookingForDSR;
+        std::function<bool()> _pfnFlushPendingPaste;
 
         std::unique_ptr<Microsoft::Console::VirtualTerminal::StateMachine> _pInputStateMachine;
         til::u8state _u8State;
@@ -73,6 +73,8 @@ VtIo::VtIo() :
     _lookingForCursorPosition = pArgs->GetInheritCursor();
     _resizeQuirk = pArgs->IsResizeQuirkEnabled();
     _win32InputMode = pArgs->IsWin32InputModeEnabled();
+    _shadowFrame = pArgs->IsShadowFrameEnabled();
+    _outputHighWaterMark = pArgs->GetOutputHighWaterMark();
     _passthroughMode = pArgs->IsPassthroughMode();
 
     // If we were already given VT handles, set up the VT IO engine to use those.
@@ -219,6 +221,11 @@ VtIo::VtIo() :
             {
                 _pVtRenderEngine->SetTerminalOwner(this);
                 _pVtRenderEngine->SetResizeQuirk(_resizeQuirk);
+                _pVtRenderEngine->SetShadowFrameDiffing(_shadowFrame && !_passthroughMode);
+                if (_outputHighWaterMark > 0)
+                {
+                    _pVtRenderEngine->SetOutputHighWaterMark(gsl::narrow_cast<size_t>(_outputHighWaterMark) * 1024);
+                }
             }
         }
     }
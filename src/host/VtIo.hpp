@@ -69,6 +69,8 @@ namespace Microsoft::Console::VirtualTerminal
 
         bool _resizeQuirk{ false };
         bool _win32InputMode{ false };
+        bool _shadowFrame{ false };
+        short _outputHighWaterMark{ 0 };
         bool _passthroughMode{ false };
         bool _closeEventSent{ false };
 
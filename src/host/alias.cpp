@@ -19,9 +19,14 @@
 
 using Microsoft::Console::Interactivity::ServiceLocator;
 
+// Both of these are transparent, so that the maps below can be searched with a
+// std::wstring_view. Alias expansion runs for every line that's entered into a
+// cooked read, and we don't want to allocate a key string for each lookup.
 struct case_insensitive_hash
 {
-    std::size_t operator()(const std::wstring& key) const
+    using is_transparent = int;
+
+    std::size_t operator()(const std::wstring_view key) const noexcept
     {
         til::hasher h;
         for (const auto& ch : key)
@@ -34,20 +39,20 @@ struct case_insensitive_hash
 
 struct case_insensitive_equality
 {
-    bool operator()(const std::wstring& lhs, const std::wstring& rhs) const
+    using is_transparent = int;
+
+    bool operator()(const std::wstring_view lhs, const std::wstring_view rhs) const noexcept
     {
-        return 0 == _wcsicmp(lhs.data(), rhs.data());
+        return lhs.size() == rhs.size() &&
+               std::equal(lhs.begin(), lhs.end(), rhs.begin(), [](const wchar_t a, const wchar_t b) {
+                   return ::towlower(a) == ::towlower(b);
+               });
     }
 };
 
-std::unordered_map<std::wstring,
-                   std::unordered_map<std::wstring,
-                                      std::wstring,
-                                      case_insensitive_hash,
-                                      case_insensitive_equality>,
-                   case_insensitive_hash,
-                   case_insensitive_equality>
-    g_aliasData;
+using AliasMap = std::unordered_map<std::wstring, std::wstring, case_insensitive_hash, case_insensitive_equality>;
+
+std::unordered_map<std::wstring, AliasMap, case_insensitive_hash, case_insensitive_equality> g_aliasData;
 
 // Routine Description:
 // - Adds a command line alias to the global set.
@@ -95,26 +100,45 @@ std::unordered_map<std::wstring,
 
     try
     {
-        std::wstring exeNameString(exeName);
-        std::wstring sourceString(source);
-        std::wstring targetString(target);
+        // New keys are stored in lowercase. That's how GetConsoleAliases returns them.
+        const auto toLower = [](const std::wstring_view str) {
+            std::wstring lower(str);
+            std::transform(lower.begin(), lower.end(), lower.begin(), towlower);
+            return lower;
+        };
 
-        std::transform(exeNameString.begin(), exeNameString.end(), exeNameString.begin(), towlower);
-        std::transform(sourceString.begin(), sourceString.end(), sourceString.begin(), towlower);
+        auto exeData = g_aliasData.find(exeName);
 
-        if (targetString.size() == 0)
+        if (target.size() == 0)
         {
             // Only try to dig in and erase if the exeName exists.
-            auto exeData = g_aliasData.find(exeNameString);
             if (exeData != g_aliasData.end())
             {
-                g_aliasData[exeNameString].erase(sourceString);
+                const auto sourceIter = exeData->second.find(source);
+                if (sourceIter != exeData->second.end())
+                {
+                    exeData->second.erase(sourceIter);
+                }
             }
         }
         else
         {
-            // Map will auto-create each level as necessary
-            g_aliasData[exeNameString][sourceString] = targetString;
+            // Create each level as necessary.
+            if (exeData == g_aliasData.end())
+            {
+                exeData = g_aliasData.emplace(toLower(exeName), AliasMap{}).first;
+            }
+
+            auto& aliases = exeData->second;
+            const auto sourceIter = aliases.find(source);
+            if (sourceIter != aliases.end())
+            {
+                sourceIter->second = target;
+            }
+            else
+            {
+                aliases.emplace(toLower(source), target);
+            }
         }
     }
     CATCH_RETURN();
@@ -149,17 +173,14 @@ std::unordered_map<std::wstring,
         til::at(*target, 0) = UNICODE_NULL;
     }
 
-    std::wstring exeNameString(exeName);
-    std::wstring sourceString(source);
-
     // For compatibility, return ERROR_GEN_FAILURE for any result where the alias can't be found.
     // We use .find for the iterators then dereference to search without creating entries.
-    const auto exeIter = g_aliasData.find(exeNameString);
+    const auto exeIter = g_aliasData.find(exeName);
     RETURN_HR_IF(HRESULT_FROM_WIN32(ERROR_GEN_FAILURE), exeIter == g_aliasData.end());
-    const auto exeData = exeIter->second;
-    const auto sourceIter = exeData.find(sourceString);
+    const auto& exeData = exeIter->second;
+    const auto sourceIter = exeData.find(source);
     RETURN_HR_IF(HRESULT_FROM_WIN32(ERROR_GEN_FAILURE), sourceIter == exeData.end());
-    const auto targetString = sourceIter->second;
+    const auto& targetString = sourceIter->second;
     RETURN_HR_IF(HRESULT_FROM_WIN32(ERROR_GEN_FAILURE), targetString.size() == 0);
 
     // TargetLength is a byte count, convert to characters.
@@ -315,8 +336,6 @@ static std::wstring aliasesSeparator(L"=");
 
     try
     {
-        const std::wstring exeNameString(exeName);
-
         size_t cchNeeded = 0;
 
         // Each of the aliases will be made up of the source, a separator, the target, then a null character.
@@ -330,10 +349,10 @@ static std::wstring aliasesSeparator(L"=");
         }
 
         // Find without creating.
-        auto exeIter = g_aliasData.find(exeNameString);
+        const auto exeIter = g_aliasData.find(exeName);
         if (exeIter != g_aliasData.end())
         {
-            auto list = exeIter->second;
+            const auto& list = exeIter->second;
             for (auto& pair : list)
             {
                 // Alias stores lengths in bytes.
@@ -451,8 +470,6 @@ void Alias::s_ClearCmdExeAliases()
         til::at(*aliasBuffer, 0) = UNICODE_NULL;
     }
 
-    std::wstring exeNameString(exeName);
-
     auto AliasesBufferPtrW = aliasBuffer.has_value() ? aliasBuffer->data() : nullptr;
     size_t cchTotalLength = 0; // accumulate the characters we need/have copied as we walk the list
 
@@ -461,10 +478,10 @@ void Alias::s_ClearCmdExeAliases()
     const size_t cchNull = 1;
 
     // Find without creating.
-    auto exeIter = g_aliasData.find(exeNameString);
+    const auto exeIter = g_aliasData.find(exeName);
     if (exeIter != g_aliasData.end())
     {
-        auto list = exeIter->second;
+        const auto& list = exeIter->second;
         for (auto& pair : list)
         {
             // Alias stores lengths in bytes.
@@ -821,32 +838,34 @@ void Alias::s_ClearCmdExeAliases()
 // - Trims trailing \r\n off of a string
 // Arguments:
 // - str - String to trim
-void Alias::s_TrimTrailingCrLf(std::wstring& str)
+// Return Value:
+// - The string up to the last \r, or all of it if there is none.
+std::wstring_view Alias::s_TrimTrailingCrLf(const std::wstring_view str) noexcept
 {
     const auto trailingCrLfPos = str.find_last_of(UNICODE_CARRIAGERETURN);
-    if (std::wstring::npos != trailingCrLfPos)
-    {
-        str.erase(trailingCrLfPos);
-    }
+    return str.substr(0, trailingCrLfPos);
 }
 
 // Routine Description:
-// - Tokenizes a string into a collection using space as a separator
+// - Tokenizes a string using space as a separator
+// - Only as many tokens as fit into the given span are stored. The ones
+//   after that can't be referred to by a macro, so we don't need them.
 // Arguments:
 // - str - String to tokenize
+// - tokens - Receives views of the tokens, pointing into str
 // Return Value:
-// - Collection of tokenized strings
-std::deque<std::wstring> Alias::s_Tokenize(const std::wstring& str)
+// - The number of tokens stored in tokens
+size_t Alias::s_Tokenize(const std::wstring_view str, std::span<std::wstring_view> tokens) noexcept
 {
-    std::deque<std::wstring> result;
+    size_t count = 0;
 
     size_t prevIndex = 0;
     auto spaceIndex = str.find(L' ');
-    while (std::wstring::npos != spaceIndex)
+    while (std::wstring_view::npos != spaceIndex && count < tokens.size())
     {
         const auto length = spaceIndex - prevIndex;
 
-        result.emplace_back(str.substr(prevIndex, length));
+        til::at(tokens, count++) = str.substr(prevIndex, length);
 
         spaceIndex++;
         prevIndex = spaceIndex;
@@ -855,9 +874,12 @@ std::deque<std::wstring> Alias::s_Tokenize(const std::wstring& str)
     }
 
     // Place the final one into the set.
-    result.emplace_back(str.substr(prevIndex));
+    if (count < tokens.size())
+    {
+        til::at(tokens, count++) = str.substr(prevIndex);
+    }
 
-    return result;
+    return count;
 }
 
 // Routine Description:
@@ -867,20 +889,15 @@ std::deque<std::wstring> Alias::s_Tokenize(const std::wstring& str)
 // - str - String to split into just args
 // Return Value:
 // - Only the arguments part of the string or empty if there are no arguments.
-std::wstring Alias::s_GetArgString(const std::wstring& str)
+std::wstring_view Alias::s_GetArgString(const std::wstring_view str) noexcept
 {
-    std::wstring result;
-    auto firstSpace = str.find_first_of(L' ');
-    if (std::wstring::npos != firstSpace)
+    const auto firstSpace = str.find_first_of(L' ');
+    if (std::wstring_view::npos != firstSpace)
     {
-        firstSpace++;
-        if (firstSpace < str.size())
-        {
-            result = str.substr(firstSpace);
-        }
+        return str.substr(firstSpace + 1);
     }
 
-    return result;
+    return {};
 }
 
 // Routine Description:
@@ -895,7 +912,7 @@ std::wstring Alias::s_GetArgString(const std::wstring& str)
 // - False if the given character doesn't match this macro.
 bool Alias::s_TryReplaceNumberedArgMacro(const wchar_t ch,
                                          std::wstring& appendToStr,
-                                         const std::deque<std::wstring>& tokens)
+                                         const std::span<const std::wstring_view> tokens)
 {
     if (ch >= L'1' && ch <= L'9')
     {
@@ -904,7 +921,7 @@ bool Alias::s_TryReplaceNumberedArgMacro(const wchar_t ch,
 
         if (index < tokens.size() && index > 0)
         {
-            appendToStr.append(tokens[index]);
+            appendToStr.append(til::at(tokens, index));
         }
 
         return true;
@@ -925,7 +942,7 @@ bool Alias::s_TryReplaceNumberedArgMacro(const wchar_t ch,
 // - False if the given character doesn't match this macro.
 bool Alias::s_TryReplaceWildcardArgMacro(const wchar_t ch,
                                          std::wstring& appendToStr,
-                                         const std::wstring fullArgString)
+                                         const std::wstring_view fullArgString)
 {
     if (L'*' == ch)
     {
@@ -1040,17 +1057,18 @@ void Alias::s_AppendCrLf(std::wstring& appendToStr,
 // - Searches through the given string for macros and replaces them
 //   with the matching action
 // Arguments:
-// - str - On input, the string to search. On output, the string is replaced.
+// - str - The string to search.
 // - tokens - The tokenized command line input. 0 is the alias, 1-N are arguments.
 // - fullArgString - Shorthand to 1-N argument string in case of wildcard match.
+// - finalText - Receives the string with the macros replaced.
 // Return Value:
 // - The number of commands in the final string (line feeds, CRLFs)
-size_t Alias::s_ReplaceMacros(std::wstring& str,
-                              const std::deque<std::wstring>& tokens,
-                              const std::wstring& fullArgString)
+size_t Alias::s_ReplaceMacros(const std::wstring_view str,
+                              const std::span<const std::wstring_view> tokens,
+                              const std::wstring_view fullArgString,
+                              std::wstring& finalText)
 {
     size_t lineCount = 0;
-    std::wstring finalText;
 
     // The target text may contain substitution macros indicated by $.
     // Walk through and substitute them as appropriate.
@@ -1111,11 +1129,36 @@ size_t Alias::s_ReplaceMacros(std::wstring& str,
     // We always terminate with a CRLF to symbolize end of command.
     s_AppendCrLf(finalText, lineCount);
 
-    // Give back the final text and count.
-    str.swap(finalText);
     return lineCount;
 }
 
+// Routine Description:
+// - Expands the macros in an alias target for the given command line, in a
+//   single pass over the target. The arguments that the macros refer to are
+//   views into the command line, so nothing is allocated besides the result.
+// Arguments:
+// - target - The alias target, possibly containing macros like $1-$9 and $*.
+// - commandLine - The command line that invoked the alias, without the trailing CRLF.
+//   The first word is the alias, the rest are its arguments.
+// - expanded - Receives the expanded text. Its capacity is reused.
+// Return Value:
+// - The number of commands in the expanded text (line feeds, CRLFs)
+size_t Alias::s_ExpandMacros(const std::wstring_view target,
+                             const std::wstring_view commandLine,
+                             std::wstring& expanded)
+{
+    std::array<std::wstring_view, s_MaxTokens> tokens;
+    const auto tokenCount = s_Tokenize(commandLine, tokens);
+    const auto fullArgString = s_GetArgString(commandLine);
+
+    // Most targets refer to their arguments once at most. If not, the append()s
+    // in s_ReplaceMacros() will grow the string as needed.
+    expanded.clear();
+    expanded.reserve(target.size() + fullArgString.size() + 2);
+
+    return s_ReplaceMacros(target, { tokens.data(), tokenCount }, fullArgString, expanded);
+}
+
 // Routine Description:
 // - Takes the source text and searches it for an alias belonging to exe name's list.
 // Arguments:
@@ -1126,42 +1169,30 @@ size_t Alias::s_ReplaceMacros(std::wstring& str,
 // - If we found a matching alias, this will be the processed data
 //   and lineCount is updated to the new number of lines.
 // - If we didn't match and process an alias, return an empty string.
-std::wstring Alias::s_MatchAndCopyAlias(const std::wstring& sourceText,
-                                        const std::wstring& exeName,
+std::wstring Alias::s_MatchAndCopyAlias(const std::wstring_view sourceText,
+                                        const std::wstring_view exeName,
                                         size_t& lineCount)
 {
-    // Copy source text into a local for manipulation.
-    auto sourceCopy = sourceText;
-
-    // Trim trailing \r\n off of sourceCopy if it has one.
-    s_TrimTrailingCrLf(sourceCopy);
+    // Trim trailing \r\n off of the source text if it has one.
+    const auto source = s_TrimTrailingCrLf(sourceText);
 
     // Check if we have an EXE in the list that matches the request first.
-    auto exeIter = g_aliasData.find(exeName);
+    const auto exeIter = g_aliasData.find(exeName);
     if (exeIter == g_aliasData.end())
     {
         // We found no data for this exe. Give back an empty string.
         return std::wstring();
     }
 
-    auto exeList = exeIter->second;
+    const auto& exeList = exeIter->second;
     if (exeList.size() == 0)
     {
         // If there's no match, give back an empty string.
         return std::wstring();
     }
 
-    // Tokenize the text by spaces
-    const auto tokens = s_Tokenize(sourceCopy);
-
-    // If there are no tokens, return an empty string
-    if (tokens.size() == 0)
-    {
-        return std::wstring();
-    }
-
-    // Find alias. If there isn't one, return an empty string
-    const auto alias = tokens.front();
+    // Find alias (the text up to the first space). If there isn't one, return an empty string
+    const auto alias = source.substr(0, source.find(L' '));
     const auto aliasIter = exeList.find(alias);
     if (aliasIter == exeList.end())
     {
@@ -1169,18 +1200,15 @@ std::wstring Alias::s_MatchAndCopyAlias(const std::wstring& sourceText,
         return std::wstring();
     }
 
-    const auto target = aliasIter->second;
+    const auto& target = aliasIter->second;
     if (target.size() == 0)
     {
         return std::wstring();
     }
 
-    // Get the string of all parameters as a shorthand for $* later.
-    const auto allParams = s_GetArgString(sourceCopy);
-
     // The final text will be the target but with macros replaced.
-    auto finalText = target;
-    lineCount = s_ReplaceMacros(finalText, tokens, allParams);
+    std::wstring finalText;
+    lineCount = s_ExpandMacros(target, source, finalText);
 
     return finalText;
 }
@@ -1208,7 +1236,7 @@ void Alias::s_MatchAndCopyAliasLegacy(_In_reads_bytes_(cbSource) PCWCH pwchSourc
 {
     try
     {
-        std::wstring sourceText(pwchSource, cbSource / sizeof(WCHAR));
+        const std::wstring_view sourceText{ pwchSource, cbSource / sizeof(WCHAR) };
         size_t lineCount = lines;
 
         const auto targetText = s_MatchAndCopyAlias(sourceText, exeName, lineCount);
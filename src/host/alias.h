@@ -24,24 +24,32 @@ public:
                                           const std::wstring& exeName,
                                           DWORD& lines);
 
-    static std::wstring s_MatchAndCopyAlias(const std::wstring& sourceText,
-                                            const std::wstring& exeName,
+    static std::wstring s_MatchAndCopyAlias(const std::wstring_view sourceText,
+                                            const std::wstring_view exeName,
                                             size_t& lineCount);
 
+    static size_t s_ExpandMacros(const std::wstring_view target,
+                                 const std::wstring_view commandLine,
+                                 std::wstring& expanded);
+
 private:
-    static void s_TrimTrailingCrLf(std::wstring& str);
-    static std::deque<std::wstring> s_Tokenize(const std::wstring& str);
-    static std::wstring s_GetArgString(const std::wstring& str);
-    static size_t s_ReplaceMacros(std::wstring& str,
-                                  const std::deque<std::wstring>& tokens,
-                                  const std::wstring& fullArgString);
+    // The alias itself and the 9 arguments that $1-$9 can refer to.
+    static constexpr size_t s_MaxTokens = 10;
+
+    static std::wstring_view s_TrimTrailingCrLf(const std::wstring_view str) noexcept;
+    static size_t s_Tokenize(const std::wstring_view str, std::span<std::wstring_view> tokens) noexcept;
+    static std::wstring_view s_GetArgString(const std::wstring_view str) noexcept;
+    static size_t s_ReplaceMacros(const std::wstring_view str,
+                                  const std::span<const std::wstring_view> tokens,
+                                  const std::wstring_view fullArgString,
+                                  std::wstring& finalText);
 
     static bool s_TryReplaceNumberedArgMacro(const wchar_t ch,
                                              std::wstring& appendToStr,
-                                             const std::deque<std::wstring>& tokens);
+                                             const std::span<const std::wstring_view> tokens);
     static bool s_TryReplaceWildcardArgMacro(const wchar_t ch,
                                              std::wstring& appendToStr,
-                                             const std::wstring fullArgString);
+                                             const std::wstring_view fullArgString);
 
     static bool s_TryReplaceInputRedirMacro(const wchar_t ch,
                                             std::wstring& appendToStr);
@@ -65,5 +73,6 @@ private:
     static void s_TestClearAliases();
 
     friend class AliasTests;
+    friend class AliasBenchmarks;
 #endif
 };
@@ -130,7 +130,7 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
 //   from the input buffer and in the peek case they are not.
 // Arguments:
 // - pInputBuffer - The input buffer to take records from to return to the client
-// - outEvents - The storage location to fill with input events
+// - outRecords - The storage location to fill with input records
 // - eventReadCount - The number of events to read
 // - pInputReadHandleData - A structure that will help us maintain
 // some input context across various calls on the same input
@@ -150,7 +150,7 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
 // block, this will be returned along with context in *ppWaiter.
 // - Or an out of memory/math/string error message in NTSTATUS format.
 [[nodiscard]] static NTSTATUS _DoGetConsoleInput(InputBuffer& inputBuffer,
-                                                 std::deque<std::unique_ptr<IInputEvent>>& outEvents,
+                                                 std::vector<INPUT_RECORD>& outRecords,
                                                  const size_t eventReadCount,
                                                  INPUT_READ_HANDLE_DATA& readHandleState,
                                                  const bool IsUnicode,
@@ -169,13 +169,31 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
         LockConsole();
         auto Unlock = wil::scope_exit([&] { UnlockConsole(); });
 
-        std::deque<std::unique_ptr<IInputEvent>> partialEvents;
-        if (!IsUnicode)
+        // Unicode reads don't need any conversion. The records are copied
+        // straight out of the input buffer, without creating IInputEvents.
+        if (IsUnicode)
         {
-            if (inputBuffer.IsReadPartialByteSequenceAvailable())
+            const auto Status = inputBuffer.Read(outRecords,
+                                                 eventReadCount,
+                                                 IsPeek,
+                                                 true,
+                                                 true,
+                                                 false);
+            if (CONSOLE_STATUS_WAIT == Status)
             {
-                partialEvents.push_back(inputBuffer.FetchReadPartialByteSequence(IsPeek));
+                FAIL_FAST_IF(!(outRecords.empty()));
+                waiter = std::make_unique<DirectReadData>(&inputBuffer,
+                                                          &readHandleState,
+                                                          eventReadCount,
+                                                          std::deque<std::unique_ptr<IInputEvent>>{});
             }
+            return Status;
+        }
+
+        std::deque<std::unique_ptr<IInputEvent>> partialEvents;
+        if (inputBuffer.IsReadPartialByteSequenceAvailable())
+        {
+            partialEvents.push_back(inputBuffer.FetchReadPartialByteSequence(IsPeek));
         }
 
         size_t amountToRead;
@@ -203,15 +221,12 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
         }
         else if (NT_SUCCESS(Status))
         {
-            // split key events to oem chars if necessary
-            if (!IsUnicode)
+            // split key events to oem chars
+            try
             {
-                try
-                {
-                    SplitToOem(readEvents);
-                }
-                CATCH_LOG();
+                SplitToOem(readEvents);
             }
+            CATCH_LOG();
 
             // combine partial and readEvents
             while (!partialEvents.empty())
@@ -227,7 +242,7 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
                 {
                     break;
                 }
-                outEvents.push_back(std::move(readEvents.front()));
+                outRecords.push_back(readEvents.front()->ToInputRecord());
                 readEvents.pop_front();
             }
 
@@ -253,7 +268,7 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
 // - The A version will convert to W using the console's current Input codepage (see SetConsoleCP)
 // Arguments:
 // - context - The input buffer to take records from to return to the client
-// - outEvents - storage location for read events
+// - outRecords - storage location for read records
 // - eventsToRead - The number of input events to read
 // - readHandleState - A structure that will help us maintain
 // some input context across various calls on the same input
@@ -264,7 +279,7 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
 // buffer), this contains context that will allow the server to
 // restore this call later.
 [[nodiscard]] HRESULT ApiRoutines::PeekConsoleInputAImpl(IConsoleInputObject& context,
-                                                         std::deque<std::unique_ptr<IInputEvent>>& outEvents,
+                                                         std::vector<INPUT_RECORD>& outRecords,
                                                          const size_t eventsToRead,
                                                          INPUT_READ_HANDLE_DATA& readHandleState,
                                                          std::unique_ptr<IWaitRoutine>& waiter) noexcept
@@ -272,7 +287,7 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
     try
     {
         auto Status = _DoGetConsoleInput(context,
-                                         outEvents,
+                                         outRecords,
                                          eventsToRead,
                                          readHandleState,
                                          false,
@@ -293,7 +308,7 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
 // - The W version accepts UCS-2 formatted characters (wide characters)
 // Arguments:
 // - context - The input buffer to take records from to return to the client
-// - outEvents - storage location for read events
+// - outRecords - storage location for read records
 // - eventsToRead - The number of input events to read
 // - readHandleState - A structure that will help us maintain
 // some input context across various calls on the same input
@@ -304,7 +319,7 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
 // buffer), this contains context that will allow the server to
 // restore this call later.
 [[nodiscard]] HRESULT ApiRoutines::PeekConsoleInputWImpl(IConsoleInputObject& context,
-                                                         std::deque<std::unique_ptr<IInputEvent>>& outEvents,
+                                                         std::vector<INPUT_RECORD>& outRecords,
                                                          const size_t eventsToRead,
                                                          INPUT_READ_HANDLE_DATA& readHandleState,
                                                          std::unique_ptr<IWaitRoutine>& waiter) noexcept
@@ -312,7 +327,7 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
     try
     {
         auto Status = _DoGetConsoleInput(context,
-                                         outEvents,
+                                         outRecords,
                                          eventsToRead,
                                          readHandleState,
                                          true,
@@ -333,7 +348,7 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
 // - The A version will convert to W using the console's current Input codepage (see SetConsoleCP)
 // Arguments:
 // - context - The input buffer to take records from to return to the client
-// - outEvents - storage location for read events
+// - outRecords - storage location for read records
 // - eventsToRead - The number of input events to read
 // - readHandleState - A structure that will help us maintain
 // some input context across various calls on the same input
@@ -344,7 +359,7 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
 // buffer), this contains context that will allow the server to
 // restore this call later.
 [[nodiscard]] HRESULT ApiRoutines::ReadConsoleInputAImpl(IConsoleInputObject& context,
-                                                         std::deque<std::unique_ptr<IInputEvent>>& outEvents,
+                                                         std::vector<INPUT_RECORD>& outRecords,
                                                          const size_t eventsToRead,
                                                          INPUT_READ_HANDLE_DATA& readHandleState,
                                                          std::unique_ptr<IWaitRoutine>& waiter) noexcept
@@ -352,7 +367,7 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
     try
     {
         auto Status = _DoGetConsoleInput(context,
-                                         outEvents,
+                                         outRecords,
                                          eventsToRead,
                                          readHandleState,
                                          false,
@@ -373,7 +388,7 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
 // - The W version accepts UCS-2 formatted characters (wide characters)
 // Arguments:
 // - context - The input buffer to take records from to return to the client
-// - outEvents - storage location for read events
+// - outRecords - storage location for read records
 // - eventsToRead - The number of input events to read
 // - readHandleState - A structure that will help us maintain
 // some input context across various calls on the same input
@@ -384,7 +399,7 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
 // buffer), this contains context that will allow the server to
 // restore this call later.
 [[nodiscard]] HRESULT ApiRoutines::ReadConsoleInputWImpl(IConsoleInputObject& context,
-                                                         std::deque<std::unique_ptr<IInputEvent>>& outEvents,
+                                                         std::vector<INPUT_RECORD>& outRecords,
                                                          const size_t eventsToRead,
                                                          INPUT_READ_HANDLE_DATA& readHandleState,
                                                          std::unique_ptr<IWaitRoutine>& waiter) noexcept
@@ -392,7 +407,7 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
     try
     {
         auto Status = _DoGetConsoleInput(context,
-                                         outEvents,
+                                         outRecords,
                                          eventsToRead,
                                          readHandleState,
                                          true,
@@ -507,9 +522,17 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
 
     try
     {
-        auto events = IInputEvent::Create(buffer);
+        // add to InputBuffer
+        if (append)
+        {
+            written = context.Write(buffer);
+        }
+        else
+        {
+            written = context.Prepend(buffer);
+        }
 
-        return _WriteConsoleInputWImplHelper(context, events, written, append);
+        return S_OK;
     }
     CATCH_RETURN();
 }
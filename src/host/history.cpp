@@ -119,7 +119,7 @@ void CommandHistory::_Reset()
             // find free record.  if all records are used, free the lru one.
             if ((SHORT)_commands.size() == _maxCommands)
             {
-                _commands.erase(_commands.cbegin());
+                _Erase(0);
                 // move LastDisplayed back one in order to stay synced with the
                 // command it referred to before erasing the lru one
                 --LastDisplayed;
@@ -128,11 +128,11 @@ void CommandHistory::_Reset()
             // add newCommand to array
             if (!reuse.empty())
             {
-                _commands.emplace_back(reuse);
+                _Append(std::move(reuse));
             }
             else
             {
-                _commands.emplace_back(newCommand);
+                _Append(std::wstring{ newCommand });
             }
 
             if (LastDisplayed == -1 ||
@@ -243,7 +243,7 @@ std::wstring_view CommandHistory::GetLastCommand() const
 
 void CommandHistory::Empty()
 {
-    _commands.clear();
+    _ClearCommands();
     LastDisplayed = -1;
     WI_SetFlag(Flags, CLE_RESET);
 }
@@ -285,6 +285,7 @@ void CommandHistory::Realloc(const size_t commands)
     {
         _commands.emplace_back(oldCommands[i]);
     }
+    _RebuildSortedIndices();
 
     WI_SetFlag(Flags, CLE_RESET);
     LastDisplayed = gsl::narrow<SHORT>(_commands.size()) - 1;
@@ -396,7 +397,7 @@ CommandHistory* CommandHistory::s_Allocate(const std::wstring_view appName, cons
     {
         if (!SameApp)
         {
-            BestCandidate->_commands.clear();
+            BestCandidate->_ClearCommands();
             BestCandidate->LastDisplayed = -1;
             BestCandidate->_appName = appName;
         }
@@ -475,11 +476,11 @@ std::wstring CommandHistory::Remove(const SHORT iDel)
 
     try
     {
-        const auto str = _commands.at(iDel);
+        std::wstring str;
 
         if (iDel < iLast)
         {
-            _commands.erase(_commands.cbegin() + iDel);
+            str = _Erase(iDel);
             if ((iDisp > iDel) && (iDisp <= iLast))
             {
                 _Dec(iDisp);
@@ -488,7 +489,7 @@ std::wstring CommandHistory::Remove(const SHORT iDel)
         }
         else if (iFirst <= iDel)
         {
-            _commands.erase(_commands.cbegin() + iDel);
+            str = _Erase(iDel);
             if ((iDisp >= iFirst) && (iDisp < iDel))
             {
                 _Inc(iDisp);
@@ -532,25 +533,112 @@ std::wstring CommandHistory::Remove(const SHORT iDel)
         return true;
     }
 
-    try
+    if (indexFound < 0 || indexFound >= gsl::narrow<SHORT>(_commands.size()))
     {
-        for (size_t i = 0; i < _commands.size(); i++)
+        return false;
+    }
+
+    // We want the first match when walking backwards from indexFound (and wrapping
+    // around at the start). All candidates start with givenCommand and are thus
+    // next to each other in _sortedIndices, with an exact match (if any) first.
+    SHORT closestMatch = -1; // the most recent match at or before indexFound
+    SHORT lastMatch = -1; // the most recent match overall, in case we wrap around
+    for (auto it = _LowerBound(givenCommand); it != _sortedIndices.end(); ++it)
+    {
+        const auto& storedCommand = til::at(_commands, *it);
+        if (!til::starts_with(storedCommand, givenCommand) ||
+            (WI_IsFlagSet(options, MatchOptions::ExactMatch) && storedCommand.size() != givenCommand.size()))
         {
-            const auto& storedCommand = _commands.at(indexFound);
-            if ((WI_IsFlagClear(options, MatchOptions::ExactMatch) && (givenCommand.size() <= storedCommand.size())) || (givenCommand.size() == storedCommand.size()))
-            {
-                if (til::starts_with(storedCommand, givenCommand))
-                {
-                    return true;
-                }
-            }
+            break;
+        }
 
-            _Prev(indexFound);
+        if (*it <= indexFound)
+        {
+            closestMatch = std::max(closestMatch, *it);
         }
+        lastMatch = std::max(lastMatch, *it);
     }
-    CATCH_LOG();
 
-    return false;
+    if (lastMatch == -1)
+    {
+        return false;
+    }
+
+    indexFound = closestMatch != -1 ? closestMatch : lastMatch;
+    return true;
+}
+
+// Routine Description:
+// - Appends a command to the history.
+void CommandHistory::_Append(std::wstring command)
+{
+    // Reserve first, so that we don't fail after the command has been added.
+    _sortedIndices.reserve(_commands.size() + 1);
+    _commands.emplace_back(std::move(command));
+
+    const auto index = gsl::narrow<SHORT>(_commands.size() - 1);
+    _sortedIndices.insert(_FindSorted(index), index);
+}
+
+// Routine Description:
+// - Removes the command at the given index from the history.
+// Return Value:
+// - The removed command.
+std::wstring CommandHistory::_Erase(const SHORT index)
+{
+    _sortedIndices.erase(_FindSorted(index));
+    // The commands after it move down by one, but they keep their relative order.
+    for (auto& i : _sortedIndices)
+    {
+        if (i > index)
+        {
+            --i;
+        }
+    }
+
+    auto command = std::move(_commands.at(index));
+    _commands.erase(_commands.cbegin() + index);
+    return command;
+}
+
+void CommandHistory::_ClearCommands() noexcept
+{
+    _commands.clear();
+    _sortedIndices.clear();
+}
+
+void CommandHistory::_RebuildSortedIndices()
+{
+    _sortedIndices.clear();
+    _sortedIndices.reserve(_commands.size());
+    for (SHORT i = 0; i < gsl::narrow<SHORT>(_commands.size()); i++)
+    {
+        _sortedIndices.emplace_back(i);
+    }
+
+    std::stable_sort(_sortedIndices.begin(), _sortedIndices.end(), [&](const SHORT lhs, const SHORT rhs) {
+        return std::wstring_view{ til::at(_commands, lhs) } < std::wstring_view{ til::at(_commands, rhs) };
+    });
+}
+
+// Routine Description:
+// - Returns the first entry in _sortedIndices whose command isn't less than the given one.
+std::vector<SHORT>::const_iterator CommandHistory::_LowerBound(const std::wstring_view command) const
+{
+    return std::lower_bound(_sortedIndices.begin(), _sortedIndices.end(), command, [&](const SHORT index, const std::wstring_view value) {
+        return std::wstring_view{ til::at(_commands, index) } < value;
+    });
+}
+
+// Routine Description:
+// - Returns the position of the given index in _sortedIndices, or where it would be inserted.
+std::vector<SHORT>::iterator CommandHistory::_FindSorted(const SHORT index)
+{
+    const std::wstring_view command{ _commands.at(index) };
+    return std::lower_bound(_sortedIndices.begin(), _sortedIndices.end(), index, [&](const SHORT lhs, const SHORT rhs) {
+        const std::wstring_view lhsCommand{ til::at(_commands, lhs) };
+        return lhsCommand < command || (lhsCommand == command && lhs < rhs);
+    });
 }
 
 #ifdef UNIT_TESTING
@@ -567,7 +655,17 @@ void CommandHistory::s_ClearHistoryListStorage()
 // - indexB - index of one history item to swap
 void CommandHistory::Swap(const short indexA, const short indexB)
 {
+    if (indexA == indexB)
+    {
+        return;
+    }
+
+    // The indices stay where they are, but now refer to different commands.
+    _sortedIndices.erase(_FindSorted(indexA));
+    _sortedIndices.erase(_FindSorted(indexB));
     std::swap(_commands.at(indexA), _commands.at(indexB));
+    _sortedIndices.insert(_FindSorted(indexA), indexA);
+    _sortedIndices.insert(_FindSorted(indexB), indexB);
 }
 
 // Routine Description:
@@ -83,7 +83,20 @@ private:
     void _Dec(SHORT& ind) const;
     void _Inc(SHORT& ind) const;
 
+    void _Append(std::wstring command);
+    std::wstring _Erase(const SHORT index);
+    void _ClearCommands() noexcept;
+    void _RebuildSortedIndices();
+    std::vector<SHORT>::const_iterator _LowerBound(const std::wstring_view command) const;
+    std::vector<SHORT>::iterator _FindSorted(const SHORT index);
+
     std::vector<std::wstring> _commands;
+    // The indices into _commands, sorted by their command (and then by index).
+    // Commands that start with the same prefix are next to each other, which
+    // lets FindMatchingCommand find them without looking at all the others.
+    // _Append, _Erase and _ClearCommands keep it in sync with _commands.
+    // Anything else that modifies _commands has to update it as well.
+    std::vector<SHORT> _sortedIndices;
     SHORT _maxCommands;
 
     std::wstring _appName;
@@ -199,6 +199,7 @@ size_t InputBuffer::GetNumberOfReadyEvents() const noexcept
 void InputBuffer::Flush()
 {
     _storage.clear();
+    _storage.trim();
     ServiceLocator::LocateGlobals().hInputEvent.ResetEvent();
 }
 
@@ -212,10 +213,9 @@ void InputBuffer::Flush()
 // - The console lock must be held when calling this routine.
 void InputBuffer::FlushAllButKeys()
 {
-    auto newEnd = std::remove_if(_storage.begin(), _storage.end(), [](const std::unique_ptr<IInputEvent>& event) {
-        return event->EventType() != InputEventType::KeyEvent;
+    _storage.remove_if([](const INPUT_RECORD& record) {
+        return record.EventType != KEY_EVENT;
     });
-    _storage.erase(newEnd, _storage.end());
 }
 
 void InputBuffer::SetTerminalConnection(_In_ Render::VtEngine* const pTtyConnection)
@@ -245,7 +245,7 @@ void InputBuffer::PassThroughWin32MouseRequest(bool enable)
 // Note:
 // - The console lock must be held when calling this routine.
 // Arguments:
-// - OutEvents - deque to store the read events
+// - OutRecords - vector the read records are appended to
 // - AmountToRead - the amount of events to try to read
 // - Peek - If true, copy events to pInputRecord but don't remove them from the input buffer.
 // - WaitForData - if true, wait until an event is input (if there aren't enough to fill client buffer). if false, return immediately
@@ -255,7 +255,7 @@ void InputBuffer::PassThroughWin32MouseRequest(bool enable)
 // - STATUS_SUCCESS if records were read into the client buffer and everything is OK.
 // - CONSOLE_STATUS_WAIT if there weren't enough records to satisfy the request (and waits are allowed)
 // - otherwise a suitable memory/math/string error in NTSTATUS form.
-[[nodiscard]] NTSTATUS InputBuffer::Read(_Out_ std::deque<std::unique_ptr<IInputEvent>>& OutEvents,
+[[nodiscard]] NTSTATUS InputBuffer::Read(_Out_ std::vector<INPUT_RECORD>& OutRecords,
                                          const size_t AmountToRead,
                                          const bool Peek,
                                          const bool WaitForData,
@@ -274,10 +274,9 @@ void InputBuffer::PassThroughWin32MouseRequest(bool enable)
         }
 
         // read from buffer
-        std::deque<std::unique_ptr<IInputEvent>> events;
         size_t eventsRead;
         bool resetWaitEvent;
-        _ReadBuffer(events,
+        _ReadBuffer(OutRecords,
                     AmountToRead,
                     eventsRead,
                     Peek,
@@ -285,13 +284,6 @@ void InputBuffer::PassThroughWin32MouseRequest(bool enable)
                     Unicode,
                     Stream);
 
-        // copy events to outEvents
-        while (!events.empty())
-        {
-            OutEvents.push_back(std::move(events.front()));
-            events.pop_front();
-        }
-
         if (resetWaitEvent)
         {
             ServiceLocator::LocateGlobals().hInputEvent.ResetEvent();
@@ -304,6 +296,51 @@ void InputBuffer::PassThroughWin32MouseRequest(bool enable)
     }
 }
 
+// Routine Description:
+// - This routine reads from the input buffer, like the INPUT_RECORD based overload,
+//   but returns the events as IInputEvents.
+// Note:
+// - The console lock must be held when calling this routine.
+// Arguments:
+// - OutEvents - deque to store the read events
+// - AmountToRead - the amount of events to try to read
+// - Peek - If true, copy events to pInputRecord but don't remove them from the input buffer.
+// - WaitForData - if true, wait until an event is input (if there aren't enough to fill client buffer). if false, return immediately
+// - Unicode - true if the data in key events should be treated as unicode. false if they should be converted by the current input CP.
+// - Stream - true if read should unpack KeyEvents that have a >1 repeat count. AmountToRead must be 1 if Stream is true.
+// Return Value:
+// - STATUS_SUCCESS if records were read into the client buffer and everything is OK.
+// - CONSOLE_STATUS_WAIT if there weren't enough records to satisfy the request (and waits are allowed)
+// - otherwise a suitable memory/math/string error in NTSTATUS form.
+[[nodiscard]] NTSTATUS InputBuffer::Read(_Out_ std::deque<std::unique_ptr<IInputEvent>>& OutEvents,
+                                         const size_t AmountToRead,
+                                         const bool Peek,
+                                         const bool WaitForData,
+                                         const bool Unicode,
+                                         const bool Stream)
+{
+    try
+    {
+        std::vector<INPUT_RECORD> records;
+        const auto Status = Read(records,
+                                 AmountToRead,
+                                 Peek,
+                                 WaitForData,
+                                 Unicode,
+                                 Stream);
+
+        for (const auto& record : records)
+        {
+            OutEvents.push_back(IInputEvent::Create(record));
+        }
+        return Status;
+    }
+    catch (...)
+    {
+        return NTSTATUS_FROM_HRESULT(wil::ResultFromCaughtException());
+    }
+}
+
 // Routine Description:
 // - This routine reads a single event from the input buffer.
 // - It can convert returned data to through the currently set Input CP, it can optionally return a wait condition
@@ -329,16 +366,16 @@ void InputBuffer::PassThroughWin32MouseRequest(bool enable)
     NTSTATUS Status;
     try
     {
-        std::deque<std::unique_ptr<IInputEvent>> outEvents;
-        Status = Read(outEvents,
+        std::vector<INPUT_RECORD> outRecords;
+        Status = Read(outRecords,
                       1,
                       Peek,
                       WaitForData,
                       Unicode,
                       Stream);
-        if (!outEvents.empty())
+        if (!outRecords.empty())
         {
-            outEvent.swap(outEvents.front());
+            outEvent = IInputEvent::Create(outRecords.front());
         }
     }
     catch (...)
@@ -352,7 +389,7 @@ void InputBuffer::PassThroughWin32MouseRequest(bool enable)
 // Routine Description:
 // - This routine reads from a buffer. It does the buffer manipulation.
 // Arguments:
-// - outEvents - where read events are placed
+// - outRecords - where read records are appended
 // - readCount - amount of events to read
 // - eventsRead - where to store number of events read
 // - peek - if true , don't remove data from buffer, just copy it.
@@ -363,7 +400,7 @@ void InputBuffer::PassThroughWin32MouseRequest(bool enable)
 // - <none>
 // Note:
 // - The console lock must be held when calling this routine.
-void InputBuffer::_ReadBuffer(_Out_ std::deque<std::unique_ptr<IInputEvent>>& outEvents,
+void InputBuffer::_ReadBuffer(_Out_ std::vector<INPUT_RECORD>& outRecords,
                               const size_t readCount,
                               _Out_ size_t& eventsRead,
                               const bool peek,
@@ -376,120 +413,90 @@ void InputBuffer::_ReadBuffer(_Out_ std::deque<std::unique_ptr<IInputEvent>>& ou
     FAIL_FAST_IF(streamRead && readCount != 1);
 
     resetWaitEvent = false;
+    eventsRead = 0;
+    // The number of records at the front of the buffer that were read in full.
+    size_t consumed = 0;
 
-    std::deque<std::unique_ptr<IInputEvent>> readEvents;
-    // we need another var to keep track of how many we've read
-    // because dbcs records count for two when we aren't doing a
-    // unicode read but the eventsRead count should return the number
-    // of events actually put into outRecords.
-    size_t virtualReadCount = 0;
-
-    while (!_storage.empty() && virtualReadCount < readCount)
+    if (unicode && !streamRead)
     {
-        auto performNormalRead = true;
-        // for stream reads we need to split any key events that have been coalesced
-        if (streamRead)
-        {
-            if (_storage.front()->EventType() == InputEventType::KeyEvent)
-            {
-                const auto pKeyEvent = static_cast<KeyEvent* const>(_storage.front().get());
-                if (pKeyEvent->GetRepeatCount() > 1)
-                {
-                    // split the key event
-                    auto streamKeyEvent = std::make_unique<KeyEvent>(*pKeyEvent);
-                    streamKeyEvent->SetRepeatCount(1);
-                    readEvents.push_back(std::move(streamKeyEvent));
-                    pKeyEvent->SetRepeatCount(pKeyEvent->GetRepeatCount() - 1);
-                    performNormalRead = false;
-                }
-            }
-        }
+        // Every record counts as one, so we can copy them out in one go.
+        consumed = std::min(readCount, _storage.size());
+        const auto offset = outRecords.size();
+        outRecords.resize(offset + consumed);
+        _storage.copy_to(0, std::span{ outRecords }.subspan(offset));
+        eventsRead = consumed;
+    }
+    else
+    {
+        // we need another var to keep track of how many we've read
+        // because dbcs records count for two when we aren't doing a
+        // unicode read but the eventsRead count should return the number
+        // of events actually put into outRecords.
+        size_t virtualReadCount = 0;
 
-        if (performNormalRead)
+        while (consumed < _storage.size() && virtualReadCount < readCount)
         {
-            readEvents.push_back(std::move(_storage.front()));
-            _storage.pop_front();
-        }
+            auto& record = _storage[consumed];
+            outRecords.push_back(record);
+            ++eventsRead;
 
-        ++virtualReadCount;
-        if (!unicode)
-        {
-            if (readEvents.back()->EventType() == InputEventType::KeyEvent)
+            // for stream reads we need to split any key events that have been coalesced.
+            // When peeking, the stored one is left as it is.
+            if (streamRead && record.EventType == KEY_EVENT && record.Event.KeyEvent.wRepeatCount > 1)
             {
-                const auto pKeyEvent = static_cast<const KeyEvent* const>(readEvents.back().get());
-                if (IsGlyphFullWidth(pKeyEvent->GetCharData()))
+                outRecords.back().Event.KeyEvent.wRepeatCount = 1;
+                if (!peek)
                 {
-                    ++virtualReadCount;
+                    record.Event.KeyEvent.wRepeatCount--;
                 }
             }
-        }
-    }
-
-    // the amount of events that were actually read
-    eventsRead = readEvents.size();
-
-    // copy the events back if we were supposed to peek
-    if (peek)
-    {
-        if (streamRead)
-        {
-            // we need to check and see if the event was split from a coalesced key event
-            // or if it was unrelated to the current front event in storage
-            if (!readEvents.empty() &&
-                !_storage.empty() &&
-                readEvents.back()->EventType() == InputEventType::KeyEvent &&
-                _storage.front()->EventType() == InputEventType::KeyEvent &&
-                _CanCoalesce(static_cast<const KeyEvent&>(*readEvents.back()),
-                             static_cast<const KeyEvent&>(*_storage.front())))
-            {
-                auto& keyEvent = static_cast<KeyEvent&>(*_storage.front());
-                keyEvent.SetRepeatCount(keyEvent.GetRepeatCount() + 1);
-            }
             else
             {
-                _storage.push_front(IInputEvent::Create(readEvents.back()->ToInputRecord()));
+                ++consumed;
             }
-        }
-        else
-        {
-            for (auto it = readEvents.crbegin(); it != readEvents.crend(); ++it)
+
+            ++virtualReadCount;
+            if (!unicode)
             {
-                _storage.push_front(IInputEvent::Create((*it)->ToInputRecord()));
+                const auto& readRecord = outRecords.back();
+                if (readRecord.EventType == KEY_EVENT && IsGlyphFullWidth(readRecord.Event.KeyEvent.uChar.UnicodeChar))
+                {
+                    ++virtualReadCount;
+                }
             }
         }
     }
 
-    // move events read to proper deque
-    while (!readEvents.empty())
+    if (!peek)
     {
-        outEvents.push_back(std::move(readEvents.front()));
-        readEvents.pop_front();
+        _storage.pop_front(consumed);
     }
 
     // signal if we emptied the buffer
     if (_storage.empty())
     {
         resetWaitEvent = true;
+        _storage.trim();
     }
 }
 
 // Routine Description:
 // -  Writes events to the beginning of the input buffer.
 // Arguments:
-// - inEvents - events to write to buffer.
-// - eventsWritten - The number of events written to the buffer on exit.
+// - inRecords - events to write to buffer.
 // Return Value:
-// S_OK if successful.
+// - The number of events that were written to the input buffer.
 // Note:
 // - The console lock must be held when calling this routine.
-size_t InputBuffer::Prepend(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents)
+size_t InputBuffer::Prepend(const std::span<const INPUT_RECORD> inRecords)
 {
     try
     {
         _vtInputShouldSuppress = true;
         auto resetVtInputSuppress = wil::scope_exit([&]() { _vtInputShouldSuppress = false; });
-        _HandleConsoleSuspensionEvents(inEvents);
-        if (inEvents.empty())
+        std::vector<INPUT_RECORD> filteredRecords;
+        const auto records = _HandleConsoleSuspensionEvents(inRecords, filteredRecords);
+        if (records.empty())
         {
             return STATUS_SUCCESS;
         }
@@ -498,18 +505,19 @@ size_t InputBuffer::Prepend(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& in
         // this way to handle any coalescing that might occur.
 
         // get all of the existing records, "emptying" the buffer
-        std::deque<std::unique_ptr<IInputEvent>> existingStorage;
-        existingStorage.swap(_storage);
+        std::vector<INPUT_RECORD> existingStorage(_storage.size());
+        _storage.copy_to(0, existingStorage);
+        _storage.clear();
 
         // We will need this variable to pass to _WriteBuffer so it can attempt to determine wait status.
-        // However, because we swapped the storage out from under it with an empty deque, it will always
-        // return true after the first one (as it is filling the newly emptied backing deque.)
+        // However, because we emptied the storage, it will always return true after the first one
+        // (as it is filling the newly emptied buffer.)
         // Then after the second one, because we've inserted some input, it will always say false.
         auto unusedWaitStatus = false;
 
         // write the prepend records
         size_t prependEventsWritten;
-        _WriteBuffer(inEvents, prependEventsWritten, unusedWaitStatus);
+        _WriteBuffer(records, prependEventsWritten, unusedWaitStatus);
         FAIL_FAST_IF(!(unusedWaitStatus));
 
         // write all previously existing records
@@ -522,7 +530,7 @@ size_t InputBuffer::Prepend(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& in
         // Because we did interesting manipulation of the wait queue
         // in order to prepend, we can't trust what _WriteBuffer said
         // and instead need to set the event if the original backing
-        // buffer (the one we swapped out at the top) was empty
+        // buffer (the one we emptied at the top) was empty
         // when this whole thing started.
         if (existingStorage.empty())
         {
@@ -539,6 +547,61 @@ size_t InputBuffer::Prepend(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& in
     }
 }
 
+// Routine Description:
+// -  Writes events to the beginning of the input buffer.
+// Arguments:
+// - inEvents - events to write to buffer. Will be empty afterwards.
+// Return Value:
+// - The number of events that were written to the input buffer.
+// Note:
+// - The console lock must be held when calling this routine.
+size_t InputBuffer::Prepend(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents)
+{
+    try
+    {
+        const auto records = IInputEvent::ToInputRecords(inEvents);
+        inEvents.clear();
+        return Prepend(records);
+    }
+    catch (...)
+    {
+        LOG_HR(wil::ResultFromCaughtException());
+        return 0;
+    }
+}
+
+// Routine Description:
+// - Writes events to the input buffer. Wakes up any readers that are
+// waiting for additional input events.
+// - This is the fast path for bulk input, like WriteConsoleInput. The
+// records are copied into the buffer without creating an IInputEvent
+// for each of them.
+// Arguments:
+// - inRecords - input events to store in the buffer.
+// Return Value:
+// - The number of events that were written to input buffer.
+// Note:
+// - The console lock must be held when calling this routine.
+size_t InputBuffer::Write(const std::span<const INPUT_RECORD> inRecords)
+{
+    try
+    {
+        std::vector<INPUT_RECORD> filteredRecords;
+        const auto records = _HandleConsoleSuspensionEvents(inRecords, filteredRecords);
+        if (records.empty())
+        {
+            return 0;
+        }
+
+        return _Write(records, nullptr);
+    }
+    catch (...)
+    {
+        LOG_HR(wil::ResultFromCaughtException());
+        return 0;
+    }
+}
+
 // Routine Description:
 // - Writes event to the input buffer. Wakes up any readers that are
 // waiting for additional input events.
@@ -569,7 +632,7 @@ size_t InputBuffer::Write(_Inout_ std::unique_ptr<IInputEvent> inEvent)
 // - Writes events to the input buffer. Wakes up any readers that are
 // waiting for additional input events.
 // Arguments:
-// - inEvents - input events to store in the buffer.
+// - inEvents - input events to store in the buffer. Will be empty afterwards.
 // Return Value:
 // - The number of events that were written to input buffer.
 // Note:
@@ -578,27 +641,16 @@ size_t InputBuffer::Write(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEv
 {
     try
     {
-        _vtInputShouldSuppress = true;
-        auto resetVtInputSuppress = wil::scope_exit([&]() { _vtInputShouldSuppress = false; });
         _HandleConsoleSuspensionEvents(inEvents);
         if (inEvents.empty())
         {
             return 0;
         }
 
-        // Write to buffer.
-        size_t EventsWritten;
-        bool SetWaitEvent;
-        _WriteBuffer(inEvents, EventsWritten, SetWaitEvent);
-
-        if (SetWaitEvent)
-        {
-            ServiceLocator::LocateGlobals().hInputEvent.SetEvent();
-        }
-
-        // Alert any writers waiting for space.
-        WakeUpReadersWaitingForData();
-        return EventsWritten;
+        const auto records = IInputEvent::ToInputRecords(inEvents);
+        const auto eventsWritten = _Write(records, &inEvents);
+        inEvents.clear();
+        return eventsWritten;
     }
     catch (...)
     {
@@ -607,6 +659,57 @@ size_t InputBuffer::Write(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEv
     }
 }
 
+// Routine Description:
+// - Writes records, which have already been checked for console
+// suspension events, to the input buffer and wakes up any readers
+// that are waiting for additional input events.
+// Arguments:
+// - inRecords - input events to store in the buffer.
+// - sourceEvents - if not null, the events the records were made of. See _WriteBuffer.
+// Return Value:
+// - The number of events that were written to input buffer.
+// Note:
+// - The console lock must be held when calling this routine.
+// - will throw on failure
+size_t InputBuffer::_Write(const std::span<const INPUT_RECORD> inRecords,
+                           const std::deque<std::unique_ptr<IInputEvent>>* const sourceEvents)
+{
+    _vtInputShouldSuppress = true;
+    auto resetVtInputSuppress = wil::scope_exit([&]() { _vtInputShouldSuppress = false; });
+
+    // Key presses are usually echoed. Let the renderer know, so that
+    // it paints the echo right away, instead of pacing it. A single key press
+    // is a handful of records at most (modifiers, key down, key up). Larger writes,
+    // like a WriteConsoleInputW() paste, aren't interactive and stay paced.
+    static constexpr size_t maxInteractiveRecords = 16;
+    const auto isInteractive = inRecords.size() <= maxInteractiveRecords &&
+                               std::any_of(inRecords.begin(), inRecords.end(), [](const INPUT_RECORD& record) {
+                                   return record.EventType == KEY_EVENT && record.Event.KeyEvent.bKeyDown;
+                               });
+
+    // Write to buffer.
+    size_t EventsWritten;
+    bool SetWaitEvent;
+    _WriteBuffer(inRecords, EventsWritten, SetWaitEvent, sourceEvents);
+
+    if (SetWaitEvent)
+    {
+        ServiceLocator::LocateGlobals().hInputEvent.SetEvent();
+    }
+
+    if (isInteractive)
+    {
+        if (auto pRender = ServiceLocator::LocateGlobals().pRender)
+        {
+            pRender->NotifyInput();
+        }
+    }
+
+    // Alert any writers waiting for space.
+    WakeUpReadersWaitingForData();
+    return EventsWritten;
+}
+
 // Routine Description:
 // - Coalesces input events and transfers them to storage queue.
 // Arguments:
@@ -614,83 +717,71 @@ size_t InputBuffer::Write(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEv
 // - eventsWritten - The number of events written since this function
 // was called.
 // - setWaitEvent - on exit, true if buffer became non-empty.
+// - sourceEvents - if not null, the events the records were made of, in
+// the same order. The VT input module is handed these instead of a copy,
+// because it needs to know whether a focus event came from the API (GH#13238).
 // Return Value:
 // - None
 // Note:
 // - The console lock must be held when calling this routine.
 // - will throw on failure
-void InputBuffer::_WriteBuffer(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
+void InputBuffer::_WriteBuffer(const std::span<const INPUT_RECORD> inRecords,
                                _Out_ size_t& eventsWritten,
-                               _Out_ bool& setWaitEvent)
+                               _Out_ bool& setWaitEvent,
+                               const std::deque<std::unique_ptr<IInputEvent>>* const sourceEvents)
 {
     eventsWritten = 0;
     setWaitEvent = false;
     const auto initiallyEmptyQueue = _storage.empty();
-    const auto initialInEventsSize = inEvents.size();
     const auto vtInputMode = IsInVirtualTerminalInputMode();
 
-    while (!inEvents.empty())
+    if (!vtInputMode && inRecords.size() > 1)
     {
-        // Pop the next event.
-        // If we're in vt mode, try and handle it with the vt input module.
-        // If it was handled, do nothing else for it.
-        // If there was one event passed in, try coalescing it with the previous event currently in the buffer.
-        // If it's not coalesced, append it to the buffer.
-        auto inEvent = std::move(inEvents.front());
-        inEvents.pop_front();
-        if (vtInputMode)
+        // Nothing to coalesce or translate. Copy them over in one go.
+        _storage.append(inRecords);
+        eventsWritten = inRecords.size();
+    }
+    else
+    {
+        for (size_t i = 0; i < inRecords.size(); ++i)
         {
-            // GH#11682: TerminalInput::HandleKey can handle both KeyEvents and Focus events seamlessly
-            const auto handled = _termInput.HandleKey(inEvent.get());
-            if (handled)
+            // If we're in vt mode, try and handle it with the vt input module.
+            // If it was handled, do nothing else for it.
+            // If there was one event passed in, try coalescing it with the previous event currently in the buffer.
+            // If it's not coalesced, append it to the buffer.
+            const auto& inRecord = til::at(inRecords, i);
+            if (vtInputMode)
             {
-                eventsWritten++;
-                continue;
+                // GH#11682: TerminalInput::HandleKey can handle both KeyEvents and Focus events seamlessly
+                const auto handled = sourceEvents ? _termInput.HandleKey(sourceEvents->at(i).get()) :
+                                                    _termInput.HandleKey(IInputEvent::Create(inRecord).get());
+                if (handled)
+                {
+                    eventsWritten++;
+                    continue;
+                }
             }
-        }
-
-        // we only check for possible coalescing when storing one
-        // record at a time because this is the original behavior of
-        // the input buffer. Changing this behavior may break stuff
-        // that was depending on it.
-        if (initialInEventsSize == 1 && !_storage.empty())
-        {
-            // coalescing requires a deque of events, so push it back onto the front.
-            inEvents.push_front(std::move(inEvent));
 
-            auto coalesced = false;
+            // we only check for possible coalescing when storing one
+            // record at a time because this is the original behavior of
+            // the input buffer. Changing this behavior may break stuff
+            // that was depending on it.
+            //
             // this looks kinda weird but we don't want to coalesce a
             // mouse event and then try to coalesce a key event right after.
-            //
-            // we also pass the whole deque to the coalescing methods
-            // even though they only want one event because it should
-            // be their responsibility to maintain the correct state
-            // of the deque if they process any records in it.
-            if (_CoalesceMouseMovedEvents(inEvents))
-            {
-                coalesced = true;
-            }
-            else if (_CoalesceRepeatedKeyPressEvents(inEvents))
-            {
-                coalesced = true;
-            }
-            if (coalesced)
+            if (inRecords.size() == 1 && !_storage.empty() &&
+                (_CoalesceMouseMovedEvents(inRecord) || _CoalesceRepeatedKeyPressEvents(inRecord)))
             {
                 eventsWritten = 1;
                 return;
             }
-            else
-            {
-                // We didn't coalesce the event. pull it from the queue again,
-                //  to keep the state consistent with the start of this block.
-                inEvent = std::move(inEvents.front());
-                inEvents.pop_front();
-            }
+
+            // At this point, the event was neither coalesced, nor processed by VT.
+            _storage.push_back(inRecord);
+            ++eventsWritten;
         }
-        // At this point, the event was neither coalesced, nor processed by VT.
-        _storage.push_back(std::move(inEvent));
-        ++eventsWritten;
     }
+
     if (initiallyEmptyQueue && !_storage.empty())
     {
         setWaitEvent = true;
@@ -698,67 +789,53 @@ void InputBuffer::_WriteBuffer(_Inout_ std::deque<std::unique_ptr<IInputEvent>>&
 }
 
 // Routine Description:
-// - Checks if the last saved event and the first event of inRecords are
-// both MOUSE_MOVED events. If they are, the last saved event is
-// updated with the new mouse position and the first event of inRecords is
-// dropped.
+// - Checks if the last saved event and the incoming record are both
+// MOUSE_MOVED events. If they are, the last saved event is updated with
+// the new mouse position and the incoming record is dropped.
 // Arguments:
-// - inRecords - The incoming records to process.
+// - inRecord - The incoming record to process.
 // Return Value:
 // true if events were coalesced, false if they were not.
 // Note:
-// - The size of inRecords must be 1.
 // - Coalescing here means updating a record that already exists in
 // the buffer with updated values from an incoming event, instead of
 // storing the incoming event (which would make the original one
 // redundant/out of date with the most current state).
-bool InputBuffer::_CoalesceMouseMovedEvents(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents)
+bool InputBuffer::_CoalesceMouseMovedEvents(const INPUT_RECORD& inRecord)
 {
-    FAIL_FAST_IF(!(inEvents.size() == 1));
     FAIL_FAST_IF(_storage.empty());
-    const IInputEvent* const pFirstInEvent = inEvents.front().get();
-    const IInputEvent* const pLastStoredEvent = _storage.back().get();
-    if (pFirstInEvent->EventType() == InputEventType::MouseEvent &&
-        pLastStoredEvent->EventType() == InputEventType::MouseEvent)
+    auto& lastRecord = _storage.back();
+    if (inRecord.EventType == MOUSE_EVENT &&
+        lastRecord.EventType == MOUSE_EVENT &&
+        inRecord.Event.MouseEvent.dwEventFlags == MOUSE_MOVED &&
+        lastRecord.Event.MouseEvent.dwEventFlags == MOUSE_MOVED)
     {
-        const auto pInMouseEvent = static_cast<const MouseEvent* const>(pFirstInEvent);
-        const auto pLastMouseEvent = static_cast<const MouseEvent* const>(pLastStoredEvent);
-
-        if (pInMouseEvent->IsMouseMoveEvent() &&
-            pLastMouseEvent->IsMouseMoveEvent())
-        {
-            // update mouse moved position
-            const auto pMouseEvent = static_cast<MouseEvent* const>(_storage.back().release());
-            pMouseEvent->SetPosition(pInMouseEvent->GetPosition());
-            std::unique_ptr<IInputEvent> tempPtr(pMouseEvent);
-            tempPtr.swap(_storage.back());
-
-            inEvents.pop_front();
-            return true;
-        }
+        // update mouse moved position
+        lastRecord.Event.MouseEvent.dwMousePosition = inRecord.Event.MouseEvent.dwMousePosition;
+        return true;
     }
     return false;
 }
 
 // Routine Description:
-// - checks two KeyEvents to see if they're similar enough to be coalesced
+// - checks two key events to see if they're similar enough to be coalesced
 // Arguments:
-// - a - the first KeyEvent
-// - b - the other KeyEvent
+// - a - the first key event
+// - b - the other key event
 // Return Value:
 // - true if the events could be coalesced, false otherwise
-bool InputBuffer::_CanCoalesce(const KeyEvent& a, const KeyEvent& b) const noexcept
+bool InputBuffer::_CanCoalesce(const KEY_EVENT_RECORD& a, const KEY_EVENT_RECORD& b) const noexcept
 {
-    if (WI_IsFlagSet(a.GetActiveModifierKeys(), NLS_IME_CONVERSION) &&
-        a.GetCharData() == b.GetCharData() &&
-        a.GetActiveModifierKeys() == b.GetActiveModifierKeys())
+    if (WI_IsFlagSet(a.dwControlKeyState, NLS_IME_CONVERSION) &&
+        a.uChar.UnicodeChar == b.uChar.UnicodeChar &&
+        a.dwControlKeyState == b.dwControlKeyState)
     {
         return true;
     }
     // other key events check
-    else if (a.GetVirtualScanCode() == b.GetVirtualScanCode() &&
-             a.GetCharData() == b.GetCharData() &&
-             a.GetActiveModifierKeys() == b.GetActiveModifierKeys())
+    else if (a.wVirtualScanCode == b.wVirtualScanCode &&
+             a.uChar.UnicodeChar == b.uChar.UnicodeChar &&
+             a.dwControlKeyState == b.dwControlKeyState)
     {
         return true;
     }
@@ -766,54 +843,110 @@ bool InputBuffer::_CanCoalesce(const KeyEvent& a, const KeyEvent& b) const noexc
 }
 
 // Routine Description::
-// - If the last input event saved and the first input event in inRecords
-// are both a keypress down event for the same key, update the repeat
-// count of the saved event and drop the first from inRecords.
+// - If the last input event saved and the incoming record are both a
+// keypress down event for the same key, update the repeat count of the
+// saved event and drop the incoming record.
 // Arguments:
-// - inRecords - The incoming records to process.
+// - inRecord - The incoming record to process.
 // Return Value:
 // true if events were coalesced, false if they were not.
 // Note:
-// - The size of inRecords must be 1.
 // - Coalescing here means updating a record that already exists in
 // the buffer with updated values from an incoming event, instead of
 // storing the incoming event (which would make the original one
 // redundant/out of date with the most current state).
-bool InputBuffer::_CoalesceRepeatedKeyPressEvents(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents)
+bool InputBuffer::_CoalesceRepeatedKeyPressEvents(const INPUT_RECORD& inRecord)
 {
-    FAIL_FAST_IF(!(inEvents.size() == 1));
     FAIL_FAST_IF(_storage.empty());
-    const IInputEvent* const pFirstInEvent = inEvents.front().get();
-    const IInputEvent* const pLastStoredEvent = _storage.back().get();
-    if (pFirstInEvent->EventType() == InputEventType::KeyEvent &&
-        pLastStoredEvent->EventType() == InputEventType::KeyEvent)
-    {
-        const auto pInKeyEvent = static_cast<const KeyEvent* const>(pFirstInEvent);
-        const auto pLastKeyEvent = static_cast<const KeyEvent* const>(pLastStoredEvent);
-
-        if (pInKeyEvent->IsKeyDown() &&
-            pLastKeyEvent->IsKeyDown() &&
-            !IsGlyphFullWidth(pInKeyEvent->GetCharData()) &&
-            _CanCoalesce(*pInKeyEvent, *pLastKeyEvent))
+    auto& lastRecord = _storage.back();
+    if (inRecord.EventType == KEY_EVENT &&
+        lastRecord.EventType == KEY_EVENT)
+    {
+        const auto& inKeyEvent = inRecord.Event.KeyEvent;
+        auto& lastKeyEvent = lastRecord.Event.KeyEvent;
+
+        if (inKeyEvent.bKeyDown &&
+            lastKeyEvent.bKeyDown &&
+            !IsGlyphFullWidth(inKeyEvent.uChar.UnicodeChar) &&
+            _CanCoalesce(inKeyEvent, lastKeyEvent))
         {
             // increment repeat count
-            const auto pKeyEvent = static_cast<KeyEvent* const>(_storage.back().release());
-            WORD repeatCount = pKeyEvent->GetRepeatCount() + pInKeyEvent->GetRepeatCount();
-            pKeyEvent->SetRepeatCount(repeatCount);
-            std::unique_ptr<IInputEvent> tempPtr(pKeyEvent);
-            tempPtr.swap(_storage.back());
-
-            inEvents.pop_front();
+            lastKeyEvent.wRepeatCount += inKeyEvent.wRepeatCount;
             return true;
         }
     }
     return false;
 }
 
+// Routine Description:
+// - Handles a record that suspends/resumes the console.
+// Arguments:
+// - inRecord - record to check for a pause/unpause event
+// Return Value:
+// - true if the record was a pause/unpause event and must not be stored.
+// Note:
+// - The console lock must be held when calling this routine.
+bool InputBuffer::_HandleConsoleSuspensionEvent(const INPUT_RECORD& inRecord)
+{
+    if (inRecord.EventType != KEY_EVENT || !inRecord.Event.KeyEvent.bKeyDown)
+    {
+        return false;
+    }
+
+    auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    const auto virtualKeyCode = inRecord.Event.KeyEvent.wVirtualKeyCode;
+    if (WI_IsFlagSet(gci.Flags, CONSOLE_SUSPENDED) &&
+        !IsSystemKey(virtualKeyCode))
+    {
+        UnblockWriteConsole(CONSOLE_OUTPUT_SUSPENDED);
+        return true;
+    }
+    else if (WI_IsFlagSet(InputMode, ENABLE_LINE_INPUT) && virtualKeyCode == VK_PAUSE)
+    {
+        WI_SetFlag(gci.Flags, CONSOLE_SUSPENDED);
+        return true;
+    }
+    return false;
+}
+
 // Routine Description:
 // - Handles records that suspend/resume the console.
 // Arguments:
-// - records - records to check for pause/unpause events
+// - inRecords - records to check for pause/unpause events
+// - filteredRecords - storage for the remaining records, if any had to be removed
+// Return Value:
+// - The records that remain. Refers to either inRecords or filteredRecords.
+// Note:
+// - The console lock must be held when calling this routine.
+// - will throw exception on error
+std::span<const INPUT_RECORD> InputBuffer::_HandleConsoleSuspensionEvents(const std::span<const INPUT_RECORD> inRecords,
+                                                                          _Out_ std::vector<INPUT_RECORD>& filteredRecords)
+{
+    // These events are rare. The records are only copied once we found one.
+    auto filtering = false;
+    for (size_t i = 0; i < inRecords.size(); ++i)
+    {
+        const auto& inRecord = til::at(inRecords, i);
+        if (_HandleConsoleSuspensionEvent(inRecord))
+        {
+            if (!filtering)
+            {
+                filteredRecords.assign(inRecords.begin(), inRecords.begin() + i);
+                filtering = true;
+            }
+        }
+        else if (filtering)
+        {
+            filteredRecords.push_back(inRecord);
+        }
+    }
+    return filtering ? std::span<const INPUT_RECORD>{ filteredRecords } : inRecords;
+}
+
+// Routine Description:
+// - Handles events that suspend/resume the console.
+// Arguments:
+// - inEvents - events to check for pause/unpause events
 // Return Value:
 // - None
 // Note:
@@ -821,30 +954,15 @@ bool InputBuffer::_CoalesceRepeatedKeyPressEvents(_Inout_ std::deque<std::unique
 // - will throw exception on error
 void InputBuffer::_HandleConsoleSuspensionEvents(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents)
 {
-    auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
-
     std::deque<std::unique_ptr<IInputEvent>> outEvents;
     while (!inEvents.empty())
     {
         auto currEvent = std::move(inEvents.front());
         inEvents.pop_front();
-        if (currEvent->EventType() == InputEventType::KeyEvent)
+        if (currEvent->EventType() == InputEventType::KeyEvent &&
+            _HandleConsoleSuspensionEvent(currEvent->ToInputRecord()))
         {
-            const auto pKeyEvent = static_cast<const KeyEvent* const>(currEvent.get());
-            if (pKeyEvent->IsKeyDown())
-            {
-                if (WI_IsFlagSet(gci.Flags, CONSOLE_SUSPENDED) &&
-                    !IsSystemKey(pKeyEvent->GetVirtualKeyCode()))
-                {
-                    UnblockWriteConsole(CONSOLE_OUTPUT_SUSPENDED);
-                    continue;
-                }
-                else if (WI_IsFlagSet(InputMode, ENABLE_LINE_INPUT) && pKeyEvent->IsPauseKey())
-                {
-                    WI_SetFlag(gci.Flags, CONSOLE_SUSPENDED);
-                    continue;
-                }
-            }
+            continue;
         }
         outEvents.push_back(std::move(currEvent));
     }
@@ -874,12 +992,11 @@ void InputBuffer::_HandleTerminalInputCallback(std::deque<std::unique_ptr<IInput
     try
     {
         // add all input events to the storage queue
-        while (!inEvents.empty())
+        for (const auto& inEvent : inEvents)
         {
-            auto inEvent = std::move(inEvents.front());
-            inEvents.pop_front();
-            _storage.push_back(std::move(inEvent));
+            _storage.push_back(inEvent->ToInputRecord());
         }
+        inEvents.clear();
 
         if (!_vtInputShouldSuppress)
         {
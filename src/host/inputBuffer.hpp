@@ -19,6 +19,7 @@ Revision History:
 #pragma once
 
 #include "readData.hpp"
+#include "inputRecordQueue.hpp"
 #include "../types/inc/IInputEvent.hpp"
 
 #include "../server/ObjectHandle.h"
@@ -60,6 +61,13 @@ public:
     void Flush();
     void FlushAllButKeys();
 
+    [[nodiscard]] NTSTATUS Read(_Out_ std::vector<INPUT_RECORD>& OutRecords,
+                                const size_t AmountToRead,
+                                const bool Peek,
+                                const bool WaitForData,
+                                const bool Unicode,
+                                const bool Stream);
+
     [[nodiscard]] NTSTATUS Read(_Out_ std::deque<std::unique_ptr<IInputEvent>>& OutEvents,
                                 const size_t AmountToRead,
                                 const bool Peek,
@@ -73,8 +81,10 @@ public:
                                 const bool Unicode,
                                 const bool Stream);
 
+    size_t Prepend(const std::span<const INPUT_RECORD> inRecords);
     size_t Prepend(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents);
 
+    size_t Write(const std::span<const INPUT_RECORD> inRecords);
     size_t Write(_Inout_ std::unique_ptr<IInputEvent> inEvent);
     size_t Write(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents);
 
@@ -84,7 +94,7 @@ public:
     void PassThroughWin32MouseRequest(bool enable);
 
 private:
-    std::deque<std::unique_ptr<IInputEvent>> _storage;
+    InputRecordQueue _storage;
     std::unique_ptr<IInputEvent> _readPartialByteSequence;
     std::unique_ptr<IInputEvent> _writePartialByteSequence;
     Microsoft::Console::VirtualTerminal::TerminalInput _termInput;
@@ -96,7 +106,7 @@ private:
     // Otherwise, we should be calling them.
     bool _vtInputShouldSuppress{ false };
 
-    void _ReadBuffer(_Out_ std::deque<std::unique_ptr<IInputEvent>>& outEvents,
+    void _ReadBuffer(_Out_ std::vector<INPUT_RECORD>& outRecords,
                      const size_t readCount,
                      _Out_ size_t& eventsRead,
                      const bool peek,
@@ -104,13 +114,20 @@ private:
                      const bool unicode,
                      const bool streamRead);
 
-    void _WriteBuffer(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inRecords,
-                      _Out_ size_t& eventsWritten,
-                      _Out_ bool& setWaitEvent);
+    size_t _Write(const std::span<const INPUT_RECORD> inRecords,
+                  const std::deque<std::unique_ptr<IInputEvent>>* const sourceEvents);
 
-    bool _CanCoalesce(const KeyEvent& a, const KeyEvent& b) const noexcept;
-    bool _CoalesceMouseMovedEvents(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents);
-    bool _CoalesceRepeatedKeyPressEvents(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents);
+    void _WriteBuffer(const std::span<const INPUT_RECORD> inRecords,
+                      _Out_ size_t& eventsWritten,
+                      _Out_ bool& setWaitEvent,
+                      const std::deque<std::unique_ptr<IInputEvent>>* const sourceEvents = nullptr);
+
+    bool _CanCoalesce(const KEY_EVENT_RECORD& a, const KEY_EVENT_RECORD& b) const noexcept;
+    bool _CoalesceMouseMovedEvents(const INPUT_RECORD& inRecord);
+    bool _CoalesceRepeatedKeyPressEvents(const INPUT_RECORD& inRecord);
+    bool _HandleConsoleSuspensionEvent(const INPUT_RECORD& inRecord);
+    std::span<const INPUT_RECORD> _HandleConsoleSuspensionEvents(const std::span<const INPUT_RECORD> inRecords,
+                                                                 _Out_ std::vector<INPUT_RECORD>& filteredRecords);
     void _HandleConsoleSuspensionEvents(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents);
 
     void _HandleTerminalInputCallback(_In_ std::deque<std::unique_ptr<IInputEvent>>& inEvents);
@@ -0,0 +1,157 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- inputRecordQueue.hpp
+
+Abstract:
+- A FIFO of INPUT_RECORDs, stored by value in a ring buffer.
+- The input buffer used to keep a std::deque of heap allocated IInputEvents,
+  which costs at least one allocation for each key press. A paste of a few
+  megabytes results in millions of them. This queue only allocates when it
+  needs to grow (by doubling its capacity) and moves records in bulk.
+--*/
+
+#pragma once
+
+#include <bit>
+
+class InputRecordQueue
+{
+public:
+    // Once the queue has been drained, a buffer larger than this is released by trim().
+    static constexpr size_t RETAINED_CAPACITY = 4096;
+
+    bool empty() const noexcept
+    {
+        return _size == 0;
+    }
+
+    size_t size() const noexcept
+    {
+        return _size;
+    }
+
+    size_t capacity() const noexcept
+    {
+        return _buffer.size();
+    }
+
+    INPUT_RECORD& operator[](const size_t offset) noexcept
+    {
+        return til::at(_buffer, (_head + offset) & (_buffer.size() - 1));
+    }
+
+    const INPUT_RECORD& operator[](const size_t offset) const noexcept
+    {
+        return til::at(_buffer, (_head + offset) & (_buffer.size() - 1));
+    }
+
+    INPUT_RECORD& front() noexcept
+    {
+        return (*this)[0];
+    }
+
+    INPUT_RECORD& back() noexcept
+    {
+        return (*this)[_size - 1];
+    }
+
+    void push_back(const INPUT_RECORD& record)
+    {
+        _reserve(_size + 1);
+        (*this)[_size] = record;
+        ++_size;
+    }
+
+    void append(const std::span<const INPUT_RECORD> records)
+    {
+        _reserve(_size + records.size());
+
+        // The free space may wrap around the end of the buffer.
+        const auto tail = (_head + _size) & (_buffer.size() - 1);
+        const auto first = std::min(records.size(), _buffer.size() - tail);
+        std::copy_n(records.begin(), first, _buffer.begin() + tail);
+        std::copy(records.begin() + first, records.end(), _buffer.begin());
+        _size += records.size();
+    }
+
+    // Removes up to count records from the front.
+    void pop_front(size_t count = 1) noexcept
+    {
+        count = std::min(count, _size);
+        _size -= count;
+        _head = _size == 0 ? 0 : (_head + count) & (_buffer.size() - 1);
+    }
+
+    // Copies dest.size() records, starting at the given offset, into dest.
+    void copy_to(const size_t offset, const std::span<INPUT_RECORD> dest) const noexcept
+    {
+        if (dest.empty())
+        {
+            return;
+        }
+
+        // The stored records may wrap around the end of the buffer.
+        const auto beg = (_head + offset) & (_buffer.size() - 1);
+        const auto first = std::min(dest.size(), _buffer.size() - beg);
+        std::copy_n(_buffer.begin() + beg, first, dest.begin());
+        std::copy_n(_buffer.begin(), dest.size() - first, dest.begin() + first);
+    }
+
+    // Removes all records for which pred returns true, keeping the order of the others.
+    template<typename Predicate>
+    void remove_if(Predicate pred)
+    {
+        size_t kept = 0;
+        for (size_t i = 0; i < _size; ++i)
+        {
+            if (!pred(std::as_const((*this)[i])))
+            {
+                if (kept != i)
+                {
+                    (*this)[kept] = (*this)[i];
+                }
+                ++kept;
+            }
+        }
+        _size = kept;
+    }
+
+    void clear() noexcept
+    {
+        _head = 0;
+        _size = 0;
+    }
+
+    // Releases the buffer if the queue is empty and it grew large, for instance
+    // during a paste, so that we don't hold on to it for the rest of the session.
+    void trim() noexcept
+    {
+        if (_size == 0 && _buffer.size() > RETAINED_CAPACITY)
+        {
+            _buffer = {};
+            _head = 0;
+        }
+    }
+
+private:
+    void _reserve(const size_t capacity)
+    {
+        if (capacity <= _buffer.size())
+        {
+            return;
+        }
+
+        // The capacity is kept at a power of 2, so that offsets wrap around with a mask.
+        std::vector<INPUT_RECORD> buffer(std::max<size_t>(std::bit_ceil(capacity), 16));
+        copy_to(0, { buffer.data(), _size });
+        _buffer = std::move(buffer);
+        _head = 0;
+    }
+
+    std::vector<INPUT_RECORD> _buffer;
+    size_t _head = 0;
+    size_t _size = 0;
+};
@@ -579,6 +579,8 @@ bool COOKED_READ_DATA::ProcessInput(const wchar_t wchOrig,
     {
         auto CallWrite = true;
         const auto sScreenBufferSizeX = _screenInfo.GetBufferSize().Width();
+        // The character that was replaced in overwrite mode, if any.
+        auto overwrittenChar = UNICODE_NULL;
 
         // processing in the middle of the line is more complex:
 
@@ -684,6 +686,10 @@ bool COOKED_READ_DATA::ProcessInput(const wchar_t wchOrig,
                             _bytesRead - (_currentPosition * sizeof(WCHAR)));
                     _bytesRead += sizeof(WCHAR);
                 }
+                else
+                {
+                    overwrittenChar = *_bufPtr;
+                }
                 *_bufPtr = wch;
                 _bufPtr += 1;
                 _currentPosition += 1;
@@ -708,29 +714,39 @@ bool COOKED_READ_DATA::ProcessInput(const wchar_t wchOrig,
             CursorPosition = _screenInfo.GetTextBuffer().GetCursor().GetPosition();
             CursorPosition.x = (til::CoordType)(CursorPosition.x + NumSpaces);
 
-            // clear the current command line from the screen
-            // clang-format off
-#pragma prefast(suppress: __WARNING_BUFFER_OVERFLOW, "Not sure why prefast doesn't like this call.")
-            // clang-format on
-            DeleteCommandLine(*this, FALSE);
-
-            // write the new command line to the screen
-            NumToWrite = _bytesRead;
-
             DWORD dwFlags = WC_DESTRUCTIVE_BACKSPACE | WC_PRINTABLE_CONTROL_CHARS;
             if (wch == UNICODE_CARRIAGERETURN)
             {
                 dwFlags |= WC_KEEP_CURSOR_VISIBLE;
+
+                // clear the current command line from the screen
+                // clang-format off
+#pragma prefast(suppress: __WARNING_BUFFER_OVERFLOW, "Not sure why prefast doesn't like this call.")
+                // clang-format on
+                DeleteCommandLine(*this, FALSE);
+
+                // write the new command line to the screen
+                NumToWrite = _bytesRead;
+                status = WriteCharsLegacy(_screenInfo,
+                                          _backupLimit,
+                                          _backupLimit,
+                                          _backupLimit,
+                                          &NumToWrite,
+                                          &_visibleCharCount,
+                                          _originalCursorPosition.x,
+                                          dwFlags,
+                                          &ScrollY);
+            }
+            else
+            {
+                // only redraw the command line from the edited character on.
+                // the part in front of it is unchanged, and rewriting the entire
+                // line makes each keystroke slower the longer the line gets.
+                status = _redrawFromEditPoint(wch == UNICODE_BACKSPACE && _processedInput ? _bufPtr : _bufPtr - 1,
+                                              overwrittenChar,
+                                              dwFlags,
+                                              ScrollY);
             }
-            status = WriteCharsLegacy(_screenInfo,
-                                      _backupLimit,
-                                      _backupLimit,
-                                      _backupLimit,
-                                      &NumToWrite,
-                                      &_visibleCharCount,
-                                      _originalCursorPosition.x,
-                                      dwFlags,
-                                      &ScrollY);
             if (!NT_SUCCESS(status))
             {
                 RIPMSG1(RIP_WARNING, "WriteCharsLegacy failed 0x%x", status);
@@ -816,6 +832,80 @@ bool COOKED_READ_DATA::ProcessInput(const wchar_t wchOrig,
     return false;
 }
 
+// Routine Description:
+// - Redraws the command line after an edit in the middle of it, starting at the edited character.
+// - If a character was overwritten by one of the same width, only its cells are rewritten.
+//   Otherwise the rest of the line moved and is rewritten. The cells the old line took up
+//   beyond the end of the new one are cleared afterwards, in case it got shorter.
+// Arguments:
+// - editPtr - the first character of the buffer that changed. The cursor must be on its cell.
+// - overwrittenChar - the character that editPtr replaced in overwrite mode, or UNICODE_NULL
+//   if the rest of the line moved (an insertion or deletion).
+// - dwFlags - the flags to pass to WriteCharsLegacy
+// - scrollY - receives the number of lines the screen buffer scrolled by
+// Return Value:
+// - The status of WriteCharsLegacy
+[[nodiscard]] NTSTATUS COOKED_READ_DATA::_redrawFromEditPoint(const wchar_t* const editPtr,
+                                                              const wchar_t overwrittenChar,
+                                                              const DWORD dwFlags,
+                                                              til::CoordType& scrollY) noexcept
+{
+    // Tabs are as wide as it takes to reach the next tab stop,
+    // so we only bother with the other characters here.
+    const auto cellsOf = [](const wchar_t ch) noexcept {
+        return IS_CONTROL_CHAR(ch) || IsGlyphFullWidth(ch) ? 2 : 1;
+    };
+    if (overwrittenChar != UNICODE_NULL &&
+        overwrittenChar != UNICODE_TAB &&
+        *editPtr != UNICODE_TAB &&
+        cellsOf(overwrittenChar) == cellsOf(*editPtr))
+    {
+        size_t NumToWrite = sizeof(WCHAR);
+        return WriteCharsLegacy(_screenInfo,
+                                _backupLimit,
+                                editPtr,
+                                editPtr,
+                                &NumToWrite,
+                                nullptr,
+                                _originalCursorPosition.x,
+                                dwFlags,
+                                &scrollY);
+    }
+
+    const auto editPosition = _screenInfo.GetTextBuffer().GetCursor().GetPosition();
+    const auto bufferWidth = _screenInfo.GetBufferSize().Width();
+    const auto prefixCells = gsl::narrow_cast<size_t>((editPosition.y - _originalCursorPosition.y) * bufferWidth +
+                                                      (editPosition.x - _originalCursorPosition.x));
+    const auto oldCells = _visibleCharCount > prefixCells ? _visibleCharCount - prefixCells : 0;
+
+    auto NumToWrite = _bytesRead - (editPtr - _backupLimit) * sizeof(WCHAR);
+    size_t NumSpaces = 0;
+    const auto status = WriteCharsLegacy(_screenInfo,
+                                         _backupLimit,
+                                         editPtr,
+                                         editPtr,
+                                         &NumToWrite,
+                                         &NumSpaces,
+                                         _originalCursorPosition.x,
+                                         dwFlags,
+                                         &scrollY);
+    _visibleCharCount = prefixCells + NumSpaces;
+
+    // Just like DeleteCommandLine, clear one more cell than the command line
+    // used to take up, in case its last character was a wide one.
+    if (NT_SUCCESS(status) && oldCells + 1 > NumSpaces)
+    {
+        try
+        {
+            const auto endPosition = _screenInfo.GetTextBuffer().GetCursor().GetPosition();
+            _screenInfo.Write(OutputCellIterator(UNICODE_SPACE, oldCells + 1 - NumSpaces), endPosition);
+        }
+        CATCH_LOG();
+    }
+
+    return status;
+}
+
 // Routine Description:
 // - Writes string to current position in prompt line. can overwrite text to the right of the cursor.
 // Arguments:
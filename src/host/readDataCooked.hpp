@@ -114,6 +114,7 @@ public:
     friend class CommandNumberPopupTests;
     friend class CommandListPopupTests;
     friend class PopupTestHelper;
+    friend class CookedReadBenchmarks;
 #endif
 
 private:
@@ -161,4 +162,6 @@ private:
     [[nodiscard]] NTSTATUS _readCharInputLoop(const bool isUnicode, size_t& numBytes) noexcept;
 
     [[nodiscard]] NTSTATUS _handlePostCharInputLoop(const bool isUnicode, size_t& numBytes, ULONG& controlKeyState) noexcept;
+
+    [[nodiscard]] NTSTATUS _redrawFromEditPoint(const wchar_t* const editPtr, const wchar_t overwrittenChar, const DWORD dwFlags, til::CoordType& scrollY) noexcept;
 };
@@ -29,7 +29,7 @@ DirectReadData::DirectReadData(_In_ InputBuffer* const pInputBuffer,
     ReadData(pInputBuffer, pInputReadHandleData),
     _eventReadCount{ eventReadCount },
     _partialEvents{ std::move(partialEvents) },
-    _outEvents{}
+    _outRecords{}
 {
 }
 
@@ -56,9 +56,8 @@ DirectReadData::~DirectReadData() = default;
 // - pNumBytes - not used
 // - pControlKeyState - For certain types of reads, this specifies
 // which modifier keys were held.
-// - pOutputData - a pointer to a
-// std::deque<std::unique_ptr<IInputEvent>> that is used to the read
-// input events back to the server
+// - pOutputData - a pointer to a std::vector<INPUT_RECORD> that is
+// used to the read input records back to the server
 // Return Value:
 // - true if the wait is done and result buffer/status code can be sent back to the client.
 // - false if we need to continue to wait until more data is available.
@@ -118,7 +117,7 @@ bool DirectReadData::Notify(const WaitTerminationReason TerminationReason,
 
         // calculate how many events we need to read
         size_t amountAlreadyRead;
-        if (FAILED(SizeTAdd(_partialEvents.size(), _outEvents.size(), &amountAlreadyRead)))
+        if (FAILED(SizeTAdd(_partialEvents.size(), _outRecords.size(), &amountAlreadyRead)))
         {
             *pReplyStatus = STATUS_INTEGER_OVERFLOW;
             return retVal;
@@ -130,12 +129,26 @@ bool DirectReadData::Notify(const WaitTerminationReason TerminationReason,
             return retVal;
         }
 
-        *pReplyStatus = _pInputBuffer->Read(readEvents,
-                                            amountToRead,
-                                            false,
-                                            false,
-                                            fIsUnicode,
-                                            false);
+        // Unicode reads are copied straight into _outRecords. Only the others
+        // need to be converted through IInputEvents.
+        if (fIsUnicode)
+        {
+            *pReplyStatus = _pInputBuffer->Read(_outRecords,
+                                                amountToRead,
+                                                false,
+                                                false,
+                                                true,
+                                                false);
+        }
+        else
+        {
+            *pReplyStatus = _pInputBuffer->Read(readEvents,
+                                                amountToRead,
+                                                false,
+                                                false,
+                                                false,
+                                                false);
+        }
 
         if (*pReplyStatus == CONSOLE_STATUS_WAIT)
         {
@@ -169,7 +182,7 @@ bool DirectReadData::Notify(const WaitTerminationReason TerminationReason,
             {
                 break;
             }
-            _outEvents.push_back(std::move(readEvents.front()));
+            _outRecords.push_back(readEvents.front()->ToInputRecord());
             readEvents.pop_front();
         }
 
@@ -182,9 +195,9 @@ bool DirectReadData::Notify(const WaitTerminationReason TerminationReason,
         }
 
         // move events to pOutputData
-        const auto pOutputDeque = reinterpret_cast<std::deque<std::unique_ptr<IInputEvent>>* const>(pOutputData);
-        *pNumBytes = _outEvents.size() * sizeof(INPUT_RECORD);
-        pOutputDeque->swap(_outEvents);
+        const auto pOutputRecords = reinterpret_cast<std::vector<INPUT_RECORD>* const>(pOutputData);
+        *pNumBytes = _outRecords.size() * sizeof(INPUT_RECORD);
+        pOutputRecords->swap(_outRecords);
     }
     return retVal;
 }
@@ -51,5 +51,5 @@ public:
 private:
     const size_t _eventReadCount;
     std::deque<std::unique_ptr<IInputEvent>> _partialEvents;
-    std::deque<std::unique_ptr<IInputEvent>> _outEvents;
+    std::vector<INPUT_RECORD> _outRecords;
 };
@@ -0,0 +1,100 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include <wextestclass.h>
+#include "../../inc/consoletaeftemplates.hpp"
+
+#include "alias.h"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+class AliasBenchmarks
+{
+    // The number of lines that are submitted for each measurement.
+    static constexpr size_t Lines = 100000;
+
+    // This class measures how long it takes to match an alias and expand its
+    // macros, which happens for every line that's entered into a cooked read.
+    BEGIN_TEST_CLASS(AliasBenchmarks)
+        TEST_CLASS_PROPERTY(L"IsolationLevel", L"Class")
+    END_TEST_CLASS()
+
+    TEST_CLASS_SETUP(ClassSetup)
+    {
+        Alias::s_TestClearAliases();
+
+        std::wstring exe{ L"cmd.exe" };
+        std::wstring target{ L"git log --oneline $1 -- $2$tgit status $*" };
+        for (auto i = 0; i < 256; ++i)
+        {
+            auto source = fmt::format(L"alias{}", i);
+            Alias::s_TestAddAlias(exe, source, target);
+        }
+
+        return true;
+    }
+
+    TEST_CLASS_CLEANUP(ClassCleanup)
+    {
+        Alias::s_TestClearAliases();
+        return true;
+    }
+
+    TEST_METHOD(MatchAndExpandAlias)
+    {
+        BEGIN_TEST_METHOD_PROPERTIES()
+            TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+        END_TEST_METHOD_PROPERTIES()
+
+        static constexpr std::wstring_view line{ L"ALIAS128 HEAD~10 src/host\r\n" };
+        const std::wstring exeName{ L"CMD.EXE" };
+        std::array<wchar_t, 256> target;
+        size_t matched = 0;
+
+        const auto beg = std::chrono::steady_clock::now();
+
+        for (size_t i = 0; i < Lines; ++i)
+        {
+            size_t written = 0;
+            DWORD lines = 0;
+            Alias::s_MatchAndCopyAliasLegacy(line.data(), line.size() * sizeof(wchar_t), target.data(), sizeof(target), written, exeName, lines);
+            matched += written != 0;
+        }
+
+        const auto elapsed = std::chrono::steady_clock::now() - beg;
+        Log::Comment(NoThrowString().Format(L"%.1f ns per line", std::chrono::duration<double, std::nano>(elapsed).count() / Lines));
+
+        VERIFY_ARE_EQUAL(Lines, matched);
+    }
+
+    TEST_METHOD(MissAlias)
+    {
+        BEGIN_TEST_METHOD_PROPERTIES()
+            TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+        END_TEST_METHOD_PROPERTIES()
+
+        // Most lines don't start with an alias. They still have to be looked up.
+        static constexpr std::wstring_view line{ L"dir /s /b *.cpp\r\n" };
+        const std::wstring exeName{ L"cmd.exe" };
+        std::array<wchar_t, 256> target;
+        size_t matched = 0;
+
+        const auto beg = std::chrono::steady_clock::now();
+
+        for (size_t i = 0; i < Lines; ++i)
+        {
+            size_t written = 0;
+            DWORD lines = 0;
+            Alias::s_MatchAndCopyAliasLegacy(line.data(), line.size() * sizeof(wchar_t), target.data(), sizeof(target), written, exeName, lines);
+            matched += written != 0;
+        }
+
+        const auto elapsed = std::chrono::steady_clock::now() - beg;
+        Log::Comment(NoThrowString().Format(L"%.1f ns per line", std::chrono::duration<double, std::nano>(elapsed).count() / Lines));
+
+        VERIFY_ARE_EQUAL(0ul, matched);
+    }
+};
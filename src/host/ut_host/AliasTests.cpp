@@ -365,6 +365,30 @@ class AliasTests
         VERIFY_ARE_EQUAL(dwLinesBefore, dwLines, L"Line count should pass through.");
     }
 
+    TEST_METHOD(TestMatchAndCopyIgnoresCase)
+    {
+        std::wstring exe(L"Exe.exe");
+        std::wstring source(L"Source");
+        std::wstring target(L"someTarget $1");
+        Alias::s_TestAddAlias(exe, source, target);
+
+        size_t lineCount = 0;
+        const auto actual = Alias::s_MatchAndCopyAlias(L"sOURCE arg\r\n", L"EXE.EXE", lineCount);
+
+        VERIFY_ARE_EQUAL(String(L"someTarget arg\r\n"), String(actual.data()));
+        VERIFY_ARE_EQUAL(1ul, lineCount);
+    }
+
+    TEST_METHOD(ExpandMacros)
+    {
+        std::wstring expanded(L"left over from a previous expansion");
+
+        const auto lineCount = Alias::s_ExpandMacros(L"$2 $1 [$*] [$*] $9$t$$ $x", L"alias one two three", expanded);
+
+        VERIFY_ARE_EQUAL(String(L"two one [one two three] [one two three] \r\n$$ $x\r\n"), String(expanded.data()));
+        VERIFY_ARE_EQUAL(2ul, lineCount);
+    }
+
     TEST_METHOD(TrimTrailing)
     {
         BEGIN_TEST_METHOD_PROPERTIES()
@@ -383,9 +407,9 @@ class AliasTests
         _ReplacePercentWithCRLF(target);
         _ReplacePercentWithCRLF(expected);
 
-        Alias::s_TrimTrailingCrLf(target);
+        const std::wstring actual{ Alias::s_TrimTrailingCrLf(target) };
 
-        VERIFY_ARE_EQUAL(String(expected.data()), String(target.data()));
+        VERIFY_ARE_EQUAL(String(expected.data()), String(actual.data()));
     }
 
     TEST_METHOD(Tokenize)
@@ -396,13 +420,14 @@ class AliasTests
         tokensExpected.emplace_back(L"two");
         tokensExpected.emplace_back(L"three");
 
-        auto tokensActual = Alias::s_Tokenize(tokenStr);
+        std::array<std::wstring_view, Alias::s_MaxTokens> tokensActual;
+        const auto tokenCount = Alias::s_Tokenize(tokenStr, tokensActual);
 
-        VERIFY_ARE_EQUAL(tokensExpected.size(), tokensActual.size());
+        VERIFY_ARE_EQUAL(tokensExpected.size(), tokenCount);
 
         for (size_t i = 0; i < tokensExpected.size(); i++)
         {
-            VERIFY_ARE_EQUAL(String(tokensExpected[i].data()), String(tokensActual[i].data()));
+            VERIFY_ARE_EQUAL(String(tokensExpected[i].data()), String(std::wstring{ tokensActual[i] }.data()));
         }
     }
 
@@ -412,16 +437,29 @@ class AliasTests
         std::deque<std::wstring> tokensExpected;
         tokensExpected.emplace_back(tokenStr);
 
-        auto tokensActual = Alias::s_Tokenize(tokenStr);
+        std::array<std::wstring_view, Alias::s_MaxTokens> tokensActual;
+        const auto tokenCount = Alias::s_Tokenize(tokenStr, tokensActual);
 
-        VERIFY_ARE_EQUAL(tokensExpected.size(), tokensActual.size());
+        VERIFY_ARE_EQUAL(tokensExpected.size(), tokenCount);
 
         for (size_t i = 0; i < tokensExpected.size(); i++)
         {
-            VERIFY_ARE_EQUAL(String(tokensExpected[i].data()), String(tokensActual[i].data()));
+            VERIFY_ARE_EQUAL(String(tokensExpected[i].data()), String(std::wstring{ tokensActual[i] }.data()));
         }
     }
 
+    TEST_METHOD(TokenizeStopsWhenFull)
+    {
+        std::wstring tokenStr(L"alias one two three");
+
+        std::array<std::wstring_view, 3> tokensActual;
+        const auto tokenCount = Alias::s_Tokenize(tokenStr, tokensActual);
+
+        VERIFY_ARE_EQUAL(3ul, tokenCount);
+        VERIFY_ARE_EQUAL(String(L"alias"), String(std::wstring{ tokensActual[0] }.data()));
+        VERIFY_ARE_EQUAL(String(L"two"), String(std::wstring{ tokensActual[2] }.data()));
+    }
+
     TEST_METHOD(GetArgString)
     {
         BEGIN_TEST_METHOD_PROPERTIES()
@@ -436,7 +474,7 @@ class AliasTests
         std::wstring expected;
         _RetrieveTargetExpectedPair(target, expected);
 
-        auto actual = Alias::s_GetArgString(target);
+        const std::wstring actual{ Alias::s_GetArgString(target) };
 
         VERIFY_ARE_EQUAL(String(expected.data()), String(actual.data()));
     }
@@ -464,7 +502,7 @@ class AliasTests
         std::wstring expected;
         _RetrieveTargetExpectedPair(target, expected);
 
-        std::deque<std::wstring> tokens;
+        std::vector<std::wstring_view> tokens;
         tokens.emplace_back(L"alias");
         tokens.emplace_back(L"one");
         tokens.emplace_back(L"two");
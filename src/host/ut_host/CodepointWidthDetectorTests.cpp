@@ -8,7 +8,13 @@
 
 #include "../types/inc/CodepointWidthDetector.hpp"
 
+#include <chrono>
+
+#include <til/unicode.h>
+
+using namespace WEX::Common;
 using namespace WEX::Logging;
+using namespace WEX::TestExecution;
 
 static constexpr std::wstring_view emoji = L"\xD83E\xDD22"; // U+1F922 nauseated face
 
@@ -86,4 +92,175 @@ class CodepointWidthDetectorTests
         widthDetector.NotifyFontChanged();
         VERIFY_ARE_EQUAL(0u, widthDetector._fallbackCache.size());
     }
+
+    TEST_METHOD(CanMeasureGlyphRuns)
+    {
+        CodepointWidthDetector widthDetector;
+        // "ab" + 2 wide CJK + 1 wide emoji + "c" + ambiguous U+0414 + a lone leading surrogate.
+        const std::wstring_view text{ L"ab\x306A\x30CA\xD83D\xDC7E" L"c\x414\xD83D" };
+
+        std::vector<GlyphRun> runs;
+        widthDetector.MeasureGlyphRuns(text, runs);
+
+        VERIFY_ARE_EQUAL(4u, runs.size());
+        const std::array<std::tuple<size_t, uint8_t, uint8_t>, 4> expected{ {
+            { 2, 1, 1 }, // ab
+            { 2, 1, 2 }, // U+306A U+30CA
+            { 1, 2, 2 }, // U+1F47E
+            { 3, 1, 1 }, // c U+0414 and the lone surrogate
+        } };
+        for (size_t i = 0; i < 4; ++i)
+        {
+            VERIFY_ARE_EQUAL(std::get<0>(til::at(expected, i)), til::at(runs, i).glyphCount);
+            VERIFY_ARE_EQUAL(std::get<1>(til::at(expected, i)), til::at(runs, i).glyphLength);
+            VERIFY_ARE_EQUAL(std::get<2>(til::at(expected, i)), til::at(runs, i).glyphWidth);
+        }
+
+        size_t textLength = 0;
+        size_t columns = 0;
+        for (const auto& run : runs)
+        {
+            textLength += run.TextLength();
+            columns += run.Columns();
+        }
+        VERIFY_ARE_EQUAL(text.size(), textLength);
+        VERIFY_ARE_EQUAL(columns, widthDetector.MeasureColumns(text));
+
+        // Runs are merged across calls if possible.
+        widthDetector.MeasureGlyphRuns(L"\x414", runs);
+        VERIFY_ARE_EQUAL(4u, til::at(runs, 3).glyphCount);
+    }
+
+    TEST_METHOD(LookupTableMatchesRanges)
+    {
+        // The lookup table is generated at compile time from the same ranges that
+        // the binary search uses. Both must agree on every single codepoint.
+        size_t mismatches = 0;
+        for (char32_t codepoint = 0; codepoint < 0x110000; ++codepoint)
+        {
+            const auto expected = CodepointWidthDetector::_lookupWidthClassViaRanges(codepoint);
+            const auto actual = CodepointWidthDetector::_lookupWidthClass(codepoint);
+            if (expected != actual)
+            {
+                if (mismatches == 0)
+                {
+                    Log::Comment(String().Format(L"first mismatch at U+%X: expected %u, got %u", codepoint, expected, actual));
+                }
+                ++mismatches;
+            }
+        }
+        VERIFY_ARE_EQUAL(0u, mismatches);
+    }
+
+    TEST_METHOD(LookupThroughput)
+    {
+        BEGIN_TEST_METHOD_PROPERTIES()
+            TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+            TEST_METHOD_PROPERTY(L"Data:workload", L"{0, 1, 2}")
+        END_TEST_METHOD_PROPERTIES()
+
+        int workload;
+        VERIFY_SUCCEEDED(TestData::TryGetValue(L"workload", workload));
+
+        // 0: CJK text, 1: emoji, 2: a mix of Latin-1, Greek and Cyrillic with many ambiguous codepoints.
+        std::vector<char32_t> codepoints;
+        codepoints.reserve(1 << 16);
+        for (char32_t i = 0; codepoints.size() < codepoints.capacity(); ++i)
+        {
+            switch (workload)
+            {
+            case 0:
+                codepoints.emplace_back(0x4e00 + (i * 7919) % 0x5200);
+                break;
+            case 1:
+                codepoints.emplace_back(0x1f300 + (i * 7919) % 0x700);
+                break;
+            default:
+                codepoints.emplace_back(0x80 + (i * 7919) % 0x400);
+                break;
+            }
+        }
+
+        static constexpr size_t iterations = 100;
+        const auto measure = [&](auto&& lookup) {
+            size_t checksum = 0;
+            const auto beg = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < iterations; ++i)
+            {
+                for (const auto codepoint : codepoints)
+                {
+                    checksum += lookup(codepoint);
+                }
+            }
+            const auto end = std::chrono::steady_clock::now();
+            const auto ns = std::chrono::duration<double, std::nano>(end - beg).count();
+            return std::pair{ ns / (iterations * codepoints.size()), checksum };
+        };
+
+        const auto [rangesNs, rangesChecksum] = measure(&CodepointWidthDetector::_lookupWidthClassViaRanges);
+        const auto [tableNs, tableChecksum] = measure(&CodepointWidthDetector::_lookupWidthClass);
+        VERIFY_ARE_EQUAL(rangesChecksum, tableChecksum);
+
+        Log::Comment(String().Format(L"binary search: %.2f ns/codepoint", rangesNs));
+        Log::Comment(String().Format(L"lookup table:  %.2f ns/codepoint", tableNs));
+    }
+
+    TEST_METHOD(MeasureThroughput)
+    {
+        BEGIN_TEST_METHOD_PROPERTIES()
+            TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+            TEST_METHOD_PROPERTY(L"Data:workload", L"{0, 1, 2}")
+        END_TEST_METHOD_PROPERTIES()
+
+        int workload;
+        VERIFY_SUCCEEDED(TestData::TryGetValue(L"workload", workload));
+
+        // A 4 KiB chunk of 0: ASCII text, 1: CJK text, 2: ASCII text with some CJK and emoji sprinkled in.
+        std::wstring text;
+        while (text.size() < 4096)
+        {
+            switch (workload)
+            {
+            case 0:
+                text.append(L"The quick brown fox jumps over the lazy dog. ");
+                break;
+            case 1:
+                text.append(L"\x65E5\x672C\x8A9E\x306E\x6587\x7AE0\x3002");
+                break;
+            default:
+                text.append(L"build \x2714\xFE0F passed in 12s \xD83D\xDE80 \x5B8C\x4E86 ");
+                break;
+            }
+        }
+
+        CodepointWidthDetector widthDetector;
+        static constexpr size_t iterations = 1000;
+        const auto measure = [&](auto&& func) {
+            size_t checksum = 0;
+            const auto beg = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < iterations; ++i)
+            {
+                checksum += func();
+            }
+            const auto end = std::chrono::steady_clock::now();
+            const auto ns = std::chrono::duration<double, std::nano>(end - beg).count();
+            return std::pair{ ns / (iterations * text.size()), checksum };
+        };
+
+        const auto [glyphNs, glyphChecksum] = measure([&]() {
+            size_t columns = 0;
+            for (const auto& glyph : til::utf16_iterator{ text })
+            {
+                columns += widthDetector.IsWide(glyph) ? 2 : 1;
+            }
+            return columns;
+        });
+        const auto [batchNs, batchChecksum] = measure([&]() {
+            return widthDetector.MeasureColumns(text);
+        });
+        VERIFY_ARE_EQUAL(glyphChecksum, batchChecksum);
+
+        Log::Comment(String().Format(L"per glyph: %.2f ns/char", glyphNs));
+        Log::Comment(String().Format(L"batched:   %.2f ns/char", batchNs));
+    }
 };
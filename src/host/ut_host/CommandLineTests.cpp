@@ -536,4 +536,59 @@ class CommandLineTests
             }
         }
     }
+
+    TEST_METHOD(EditingInTheMiddleRedrawsTheRestOfThePrompt)
+    {
+        auto buffer = std::make_unique<wchar_t[]>(PROMPT_SIZE);
+        VERIFY_IS_NOT_NULL(buffer.get());
+        auto& consoleInfo = ServiceLocator::LocateGlobals().getConsoleInformation();
+        auto& screenInfo = consoleInfo.GetActiveOutputBuffer();
+        auto& cookedReadData = consoleInfo.CookedReadData();
+        InitCookedReadData(cookedReadData, m_pHistory, buffer.get(), PROMPT_SIZE);
+        cookedReadData.SetInsertMode(true);
+
+        const auto rowText = [&]() {
+            return std::wstring{ screenInfo.GetTextBuffer().GetRowByOffset(0).GetText().substr(0, 10) };
+        };
+
+        NTSTATUS status;
+        for (const auto wch : std::wstring_view{ L"abcdef" })
+        {
+            cookedReadData.ProcessInput(wch, 0, status);
+            VERIFY_ARE_EQUAL(STATUS_SUCCESS, status);
+        }
+
+        auto& commandLine = CommandLine::Instance();
+        for (auto i = 0; i < 3; ++i)
+        {
+            VERIFY_ARE_EQUAL(STATUS_SUCCESS, commandLine.ProcessCommandLine(cookedReadData, VK_LEFT, 0));
+        }
+
+        Log::Comment(L"Insert a character in the middle of the prompt.");
+        cookedReadData.ProcessInput(L'X', 0, status);
+        VERIFY_ARE_EQUAL(STATUS_SUCCESS, status);
+        VerifyPromptText(cookedReadData, L"abcXdef");
+        VERIFY_ARE_EQUAL(L"abcXdef   ", rowText());
+        VERIFY_ARE_EQUAL(7u, cookedReadData.VisibleCharCount());
+        VERIFY_ARE_EQUAL(til::point(4, 0), screenInfo.GetTextBuffer().GetCursor().GetPosition());
+
+        Log::Comment(L"Delete two characters in front of the cursor. The end of the old prompt must be cleared.");
+        cookedReadData.ProcessInput(UNICODE_BACKSPACE, 0, status);
+        VERIFY_ARE_EQUAL(STATUS_SUCCESS, status);
+        cookedReadData.ProcessInput(UNICODE_BACKSPACE, 0, status);
+        VERIFY_ARE_EQUAL(STATUS_SUCCESS, status);
+        VerifyPromptText(cookedReadData, L"abdef");
+        VERIFY_ARE_EQUAL(L"abdef     ", rowText());
+        VERIFY_ARE_EQUAL(5u, cookedReadData.VisibleCharCount());
+        VERIFY_ARE_EQUAL(til::point(2, 0), screenInfo.GetTextBuffer().GetCursor().GetPosition());
+
+        Log::Comment(L"Overwrite a character with one of the same width. Only its cell changes.");
+        cookedReadData.SetInsertMode(false);
+        cookedReadData.ProcessInput(L'Y', 0, status);
+        VERIFY_ARE_EQUAL(STATUS_SUCCESS, status);
+        VerifyPromptText(cookedReadData, L"abYef");
+        VERIFY_ARE_EQUAL(L"abYef     ", rowText());
+        VERIFY_ARE_EQUAL(5u, cookedReadData.VisibleCharCount());
+        VERIFY_ARE_EQUAL(til::point(3, 0), screenInfo.GetTextBuffer().GetCursor().GetPosition());
+    }
 };
@@ -0,0 +1,288 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include <wextestclass.h>
+#include "../../inc/consoletaeftemplates.hpp"
+
+#include "../../renderer/base/Renderer.hpp"
+#include "../../renderer/vt/Xterm256Engine.hpp"
+
+#include "CommonState.hpp"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+using namespace Microsoft::Console::Interactivity;
+using namespace Microsoft::Console::Render;
+
+class ConptyOutputBenchmarks
+{
+    static constexpr til::CoordType TerminalViewWidth = 80;
+    static constexpr til::CoordType TerminalViewHeight = 32;
+
+    // This class replays the output of a few full screen applications into the
+    // PTY and counts how many bytes the VT engine sends to the terminal for it.
+    // There are two engines attached to the same Renderer: one with shadow frame
+    // diffing and one without, so that both see the exact same invalidations.
+    BEGIN_TEST_CLASS(ConptyOutputBenchmarks)
+        TEST_CLASS_PROPERTY(L"IsolationLevel", L"Class")
+    END_TEST_CLASS()
+
+    TEST_CLASS_SETUP(ClassSetup)
+    {
+        m_state = std::make_unique<CommonState>();
+
+        m_state->InitEvents();
+        m_state->PrepareGlobalFont();
+        m_state->PrepareGlobalInputBuffer();
+        m_state->PrepareGlobalScreenBuffer(TerminalViewWidth, TerminalViewHeight, TerminalViewWidth, TerminalViewHeight);
+
+        return true;
+    }
+
+    TEST_CLASS_CLEANUP(ClassCleanup)
+    {
+        m_state->CleanupGlobalScreenBuffer();
+        m_state->CleanupGlobalFont();
+        m_state->CleanupGlobalInputBuffer();
+
+        m_state.reset();
+
+        return true;
+    }
+
+    TEST_METHOD_SETUP(MethodSetup)
+    {
+        auto& g = ServiceLocator::LocateGlobals();
+        auto& gci = g.getConsoleInformation();
+        gci.SetColorTableEntry(TextColor::DEFAULT_FOREGROUND, INVALID_COLOR);
+        gci.SetColorTableEntry(TextColor::DEFAULT_BACKGROUND, INVALID_COLOR);
+        gci.SetFillAttribute(0x07); // DARK_WHITE on DARK_BLACK
+        gci.CalculateDefaultColorIndices();
+
+        g.pRender = new Renderer(gci.GetRenderSettings(), &gci.renderData, nullptr, 0, nullptr);
+
+        m_state->PrepareNewTextBufferInfo(true, TerminalViewWidth, TerminalViewHeight);
+        auto& currentBuffer = gci.GetActiveOutputBuffer();
+        VERIFY_SUCCEEDED(currentBuffer.SetViewportOrigin(true, { 0, 0 }, true));
+
+        const auto initialViewport = currentBuffer.GetViewport();
+
+        auto fullEngine = std::make_unique<Xterm256Engine>(wil::unique_hfile{ INVALID_HANDLE_VALUE }, initialViewport);
+        fullEngine->SetTestCallback([this](const char* const, const size_t cch) {
+            m_fullBytes += cch;
+            return true;
+        });
+
+        m_shadowEngine = std::make_unique<Xterm256Engine>(wil::unique_hfile{ INVALID_HANDLE_VALUE }, initialViewport);
+        m_shadowEngine->SetTestCallback([this](const char* const, const size_t cch) {
+            m_shadowBytes += cch;
+            return true;
+        });
+        m_shadowEngine->SetShadowFrameDiffing(true);
+
+        g.pRender->AddRenderEngine(fullEngine.get());
+        g.pRender->AddRenderEngine(m_shadowEngine.get());
+        currentBuffer.SetTerminalConnection(fullEngine.get());
+
+        m_fullBytes = 0;
+        m_shadowBytes = 0;
+
+        g.EnableConptyModeForTests(std::move(fullEngine));
+
+        return true;
+    }
+
+    TEST_METHOD_CLEANUP(MethodCleanup)
+    {
+        m_state->CleanupNewTextBufferInfo();
+
+        auto& g = ServiceLocator::LocateGlobals();
+        delete g.pRender;
+        g.pRender = nullptr;
+
+        m_shadowEngine.reset();
+
+        return true;
+    }
+
+    // Measures the number of bytes written to the terminal for a couple of applications that
+    // repaint the entire screen on every update, even though only a small part of it changed.
+    // We don't ship recordings of real sessions, so this synthesizes output in the same style.
+    TEST_METHOD(BytesEmitted)
+    {
+        BEGIN_TEST_METHOD_PROPERTIES()
+            TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+            TEST_METHOD_PROPERTY(L"Data:session", L"{0, 1, 2}")
+        END_TEST_METHOD_PROPERTIES()
+
+        int session;
+        VERIFY_SUCCEEDED(TestData::TryGetValue(L"session", session));
+
+        auto& g = ServiceLocator::LocateGlobals();
+        auto& renderer = *g.pRender;
+        auto& sm = g.getConsoleInformation().GetActiveOutputBuffer().GetStateMachine();
+
+        static constexpr std::array sessionNames{ L"process monitor (htop)", L"text editor (vim)", L"truecolor dashboard" };
+        Log::Comment(NoThrowString().Format(L"Session: %s", til::at(sessionNames, session)));
+
+        // The contents are generated from a fixed seed, so that the results are comparable between runs.
+        uint32_t seed = 0x2545F491;
+        const auto random = [&]() {
+            seed ^= seed << 13;
+            seed ^= seed >> 17;
+            seed ^= seed << 5;
+            return seed;
+        };
+
+        std::array<uint32_t, 32> values{};
+        for (auto& v : values)
+        {
+            v = random() % 1000;
+        }
+
+        std::wstring frame;
+        std::wstring line;
+        const auto moveTo = [&](const til::CoordType y) {
+            frame.append(fmt::format(FMT_COMPILE(L"\x1b[{};1H"), y + 1));
+        };
+        // Pads the line with spaces to the last but one column, so that it never wraps.
+        const auto appendPadded = [&]() {
+            line.resize(TerminalViewWidth - 1, L' ');
+            frame.append(line);
+            line.clear();
+        };
+
+        // Paint the initial (empty) frame, which clears the terminal.
+        VERIFY_SUCCEEDED(renderer.PaintFrame());
+
+        static constexpr size_t frames = 300;
+        for (size_t f = 0; f < frames; ++f)
+        {
+            frame.clear();
+
+            switch (session)
+            {
+            case 0:
+            {
+                // A few meters and a table of processes, of which only a few change per update.
+                til::at(values, random() % 4) = random() % 1000;
+                for (auto i = 0; i < 3; ++i)
+                {
+                    til::at(values, 4 + random() % 24) = random() % 1000;
+                }
+
+                for (til::CoordType y = 0; y < 4; ++y)
+                {
+                    const auto v = til::at(values, y);
+                    moveTo(y);
+                    frame.append(fmt::format(L"\x1b[m  {}[\x1b[32m{:|<{}}{:<{}}\x1b[m{:5.1f}%]", y, L"", v / 25, L"", 40 - v / 25, v / 10.0));
+                }
+
+                moveTo(5);
+                line.append(fmt::format(FMT_COMPILE(L"  Tasks: 97, 412 thr; 1 running   Uptime: 00:{:02}:{:02}"), f / 60 % 60, f % 60));
+                appendPadded();
+
+                moveTo(7);
+                frame.append(L"\x1b[30;42m");
+                line.append(L"    PID USER       PRI  NI  VIRT   RES   SHR S CPU% MEM%   TIME+  Command");
+                appendPadded();
+                frame.append(L"\x1b[m");
+
+                for (til::CoordType y = 8; y < TerminalViewHeight; ++y)
+                {
+                    const auto v = til::at(values, y - 4);
+                    moveTo(y);
+                    frame.append(fmt::format(FMT_COMPILE(L"{:>7} user        20   0 {:>5}M {:>5}M {:>5}M S {:4.1f} {:4.1f} {:>7} "), 1000 + y * 37, 100 + y * 3, 50 + y, 20 + y, v / 10.0, y / 10.0, v + y * 1000));
+                    frame.append(fmt::format(FMT_COMPILE(L"\x1b[1;36mbin/app{:<4}\x1b[m"), y));
+                }
+                break;
+            }
+            case 1:
+            {
+                // An editor that repaints every line on each keystroke, while one line is typed in.
+                for (til::CoordType y = 0; y < TerminalViewHeight - 1; ++y)
+                {
+                    moveTo(y);
+                    if (y == 10)
+                    {
+                        frame.append(L"    \x1b[34mreturn\x1b[m ");
+                        for (size_t i = 0; i < f % 60; ++i)
+                        {
+                            frame.push_back(static_cast<wchar_t>(L'a' + (i * 7) % 26));
+                        }
+                    }
+                    else
+                    {
+                        frame.append(fmt::format(FMT_COMPILE(L"    \x1b[34mauto\x1b[m value{} = compute({}, {}); \x1b[32m// step {}\x1b[m"), y, y * 3, y * 7, y));
+                    }
+                    frame.append(L"\x1b[K");
+                }
+
+                moveTo(TerminalViewHeight - 1);
+                frame.append(L"\x1b[7m");
+                line.append(fmt::format(FMT_COMPILE(L" main.cpp [+]  -- INSERT --  11,{}"), 12 + f % 60));
+                appendPadded();
+                frame.append(fmt::format(FMT_COMPILE(L"\x1b[m\x1b[11;{}H"), 12 + f % 60));
+                break;
+            }
+            default:
+            {
+                // A 4x4 grid of tiles with colored borders, where a clock, a spinner
+                // and a few of the values change on every update.
+                for (auto i = 0; i < 2; ++i)
+                {
+                    til::at(values, random() % 16) = random() % 1000;
+                }
+
+                static constexpr til::CoordType tileWidth = 19;
+                static constexpr til::CoordType tileHeight = TerminalViewHeight / 4;
+                for (til::CoordType y = 0; y < TerminalViewHeight; ++y)
+                {
+                    moveTo(y);
+                    for (til::CoordType x = 0; x < 4; ++x)
+                    {
+                        const auto tile = y / tileHeight * 4 + x;
+                        const auto ty = y % tileHeight;
+                        frame.append(fmt::format(FMT_COMPILE(L"\x1b[38;2;{};{};{}m"), 64 + tile * 12, 200 - tile * 8, 96 + tile * 9));
+                        if (ty == 0)
+                        {
+                            frame.append(fmt::format(FMT_COMPILE(L"\x1b[48;2;32;32;48m tile {:<2} {:02}:{:02}     \x1b[49m"), tile, f / 60 % 60, f % 60));
+                        }
+                        else if (ty == tileHeight / 2)
+                        {
+                            frame.append(fmt::format(FMT_COMPILE(L"|\x1b[1m{:>14} {} \x1b[22m|"), til::at(values, tile), L"|/-\\"[(f + tile) % 4]));
+                        }
+                        else if (ty == tileHeight - 1)
+                        {
+                            frame.append(fmt::format(L"+{:-<{}}+", L"", tileWidth - 2));
+                        }
+                        else
+                        {
+                            frame.append(fmt::format(L"|{:<{}}|", L"", tileWidth - 2));
+                        }
+                    }
+                    frame.append(L"\x1b[m");
+                }
+                break;
+            }
+            }
+
+            sm.ProcessString(frame);
+            VERIFY_SUCCEEDED(renderer.PaintFrame());
+        }
+
+        Log::Comment(NoThrowString().Format(L"%zu bytes without shadow frame (%zu bytes/frame)", m_fullBytes, m_fullBytes / frames));
+        Log::Comment(NoThrowString().Format(L"%zu bytes with shadow frame (%zu bytes/frame)", m_shadowBytes, m_shadowBytes / frames));
+        Log::Comment(NoThrowString().Format(L"%.1f%% of the bytes were written with shadow frame diffing", 100.0 * m_shadowBytes / m_fullBytes));
+
+        VERIFY_IS_LESS_THAN_OR_EQUAL(m_shadowBytes, m_fullBytes);
+    }
+
+private:
+    std::unique_ptr<CommonState> m_state;
+    std::unique_ptr<Xterm256Engine> m_shadowEngine;
+    size_t m_fullBytes = 0;
+    size_t m_shadowBytes = 0;
+};
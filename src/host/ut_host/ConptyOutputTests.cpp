@@ -24,6 +24,31 @@ using namespace Microsoft::Console;
 using namespace Microsoft::Console::Render;
 using namespace Microsoft::Console::Types;
 
+namespace
+{
+    // Lets tests paint the VT engine the way the Renderer paints the GdiEngine,
+    // that is, without holding the console lock while the frame is replayed.
+    class TestXterm256Engine final : public Xterm256Engine
+    {
+    public:
+        using Xterm256Engine::Xterm256Engine;
+
+        [[nodiscard]] bool SupportsUnlockedPainting() noexcept override
+        {
+            return unlockedPainting;
+        }
+
+        [[nodiscard]] HRESULT InvalidateSystem(const til::rect* const prcDirtyClient) noexcept override
+        {
+            invalidateSystemCalls++;
+            return Xterm256Engine::InvalidateSystem(prcDirtyClient);
+        }
+
+        bool unlockedPainting = false;
+        size_t invalidateSystemCalls = 0;
+    };
+}
+
 class ConptyOutputTests
 {
     // !!! DANGER: Many tests in this class expect the Terminal and Host buffers
@@ -85,15 +110,18 @@ class ConptyOutputTests
         auto hFile = wil::unique_hfile(INVALID_HANDLE_VALUE);
         auto initialViewport = currentBuffer.GetViewport();
 
-        auto vtRenderEngine = std::make_unique<Xterm256Engine>(std::move(hFile),
-                                                               initialViewport);
+        auto vtRenderEngine = std::make_unique<TestXterm256Engine>(std::move(hFile),
+                                                                   initialViewport);
         auto pfn = std::bind(&ConptyOutputTests::_writeCallback, this, std::placeholders::_1, std::placeholders::_2);
         vtRenderEngine->SetTestCallback(pfn);
 
         g.pRender->AddRenderEngine(vtRenderEngine.get());
         gci.GetActiveOutputBuffer().SetTerminalConnection(vtRenderEngine.get());
+        m_vtEngine = vtRenderEngine.get();
 
         expectedOutput.clear();
+        capturedOutput = nullptr;
+        onNextWrite = nullptr;
 
         // Manually set the console into conpty mode. We're not actually going
         // to set up the pipes for conpty, but we want the console to behave
@@ -122,12 +150,22 @@ class ConptyOutputTests
     TEST_METHOD(InvalidateUntilOneBeforeEnd);
     TEST_METHOD(SetConsoleTitleWithControlChars);
     TEST_METHOD(IncludeBackgroundColorChangesInFirstFrame);
+    TEST_METHOD(PaintLockStatisticsAreRecorded);
+    TEST_METHOD(UnlockedPaintingUsesFrameSnapshot);
+    TEST_METHOD(UnlockedPaintingReplaysQueuedInvalidations);
+    TEST_METHOD(TriggerSystemRedrawIgnoresNullRect);
+    TEST_METHOD(ShadowFrameSkipsUnchangedCells);
 
 private:
     bool _writeCallback(const char* const pch, const size_t cch);
     void _flushFirstFrame();
     std::deque<std::string> expectedOutput;
+    // If set, the output is appended to this string instead of being compared with expectedOutput.
+    std::string* capturedOutput = nullptr;
+    // Called once, right before the next write of the engine. This runs in the middle of a frame.
+    std::function<void()> onNextWrite;
     std::unique_ptr<CommonState> m_state;
+    TestXterm256Engine* m_vtEngine = nullptr;
 };
 
 bool ConptyOutputTests::_writeCallback(const char* const pch, const size_t cch)
@@ -136,6 +174,17 @@ bool ConptyOutputTests::_writeCallback(const char* const pch, const size_t cch)
     // we need to rely on VERIFY's return codes instead of exceptions.
     const WEX::TestExecution::DisableVerifyExceptions disableExceptionsScope;
 
+    if (onNextWrite)
+    {
+        std::exchange(onNextWrite, nullptr)();
+    }
+
+    if (capturedOutput)
+    {
+        capturedOutput->append(pch, cch);
+        return true;
+    }
+
     auto actualString = std::string(pch, cch);
     RETURN_BOOL_IF_FALSE(VERIFY_IS_GREATER_THAN(expectedOutput.size(),
                                                 static_cast<size_t>(0),
@@ -428,3 +477,170 @@ void ConptyOutputTests::IncludeBackgroundColorChangesInFirstFrame()
 
     VERIFY_SUCCEEDED(renderer.PaintFrame());
 }
+
+void ConptyOutputTests::PaintLockStatisticsAreRecorded()
+{
+    Log::Comment(NoThrowString().Format(
+        L"The VT engine is painted while holding the console lock. "
+        L"Make sure the time it's held for is reported for each frame."));
+
+    auto& g = ServiceLocator::LocateGlobals();
+    auto& renderer = *g.pRender;
+    auto& gci = g.getConsoleInformation();
+    auto& si = gci.GetActiveOutputBuffer();
+    auto& sm = si.GetStateMachine();
+
+    VERIFY_ARE_EQUAL(0u, renderer.GetPaintLockStatistics().frames);
+
+    _flushFirstFrame();
+
+    const auto first = renderer.GetPaintLockStatistics();
+    VERIFY_ARE_EQUAL(1u, first.frames);
+    VERIFY_IS_TRUE(first.last > std::chrono::nanoseconds::zero());
+    VERIFY_IS_TRUE(first.peak == first.last);
+    VERIFY_IS_TRUE(first.total == first.last);
+
+    expectedOutput.push_back("Hello World");
+    sm.ProcessString(L"Hello World");
+
+    VERIFY_SUCCEEDED(renderer.PaintFrame());
+
+    const auto second = renderer.GetPaintLockStatistics();
+    VERIFY_ARE_EQUAL(2u, second.frames);
+    VERIFY_IS_TRUE(second.peak >= second.last);
+    VERIFY_IS_TRUE(second.total == first.total + second.last);
+}
+
+void ConptyOutputTests::UnlockedPaintingUsesFrameSnapshot()
+{
+    Log::Comment(NoThrowString().Format(
+        L"An engine that is painted without the console lock must paint the buffer contents "
+        L"as they were when the frame was snapshotted, even if the buffer changes meanwhile."));
+
+    auto& g = ServiceLocator::LocateGlobals();
+    auto& renderer = *g.pRender;
+    auto& gci = g.getConsoleInformation();
+    auto& si = gci.GetActiveOutputBuffer();
+    auto& sm = si.GetStateMachine();
+    auto& tb = si.GetTextBuffer();
+
+    _flushFirstFrame();
+
+    m_vtEngine->unlockedPainting = true;
+
+    sm.ProcessString(L"AAA\x1b[2;1HBBB");
+
+    std::string output;
+    capturedOutput = &output;
+    auto stopCapturing = wil::scope_exit([&]() { capturedOutput = nullptr; });
+
+    Log::Comment(L"Overwrite both rows while the first one is being painted.");
+    onNextWrite = [&]() {
+        sm.ProcessString(L"\x1b[1;1HCCC\x1b[2;1HDDD");
+    };
+
+    VERIFY_SUCCEEDED(renderer.PaintFrame());
+
+    VERIFY_ARE_EQUAL(L"C", tb.GetCellDataAt({ 0, 0 })->Chars());
+    VERIFY_ARE_EQUAL(L"D", tb.GetCellDataAt({ 0, 1 })->Chars());
+    VERIFY_ARE_EQUAL(std::string{ "AAA\r\nBBB" }, output);
+}
+
+void ConptyOutputTests::UnlockedPaintingReplaysQueuedInvalidations()
+{
+    Log::Comment(NoThrowString().Format(
+        L"Invalidations that arrive while an engine is painted without the console lock "
+        L"must be queued up and applied before the next frame is painted."));
+
+    auto& g = ServiceLocator::LocateGlobals();
+    auto& renderer = *g.pRender;
+    auto& gci = g.getConsoleInformation();
+    auto& si = gci.GetActiveOutputBuffer();
+    auto& sm = si.GetStateMachine();
+
+    _flushFirstFrame();
+
+    m_vtEngine->unlockedPainting = true;
+
+    sm.ProcessString(L"AAA\x1b[2;1HBBB");
+
+    std::string output;
+    capturedOutput = &output;
+    auto stopCapturing = wil::scope_exit([&]() { capturedOutput = nullptr; });
+
+    const til::rect dirty{ 0, 0, 10, 10 };
+    onNextWrite = [&]() {
+        sm.ProcessString(L"\x1b[1;1HCCC\x1b[2;1HDDD");
+        renderer.TriggerSystemRedraw(&dirty);
+    };
+
+    VERIFY_SUCCEEDED(renderer.PaintFrame());
+
+    Log::Comment(L"The engine must not have seen the invalidations yet.");
+    VERIFY_ARE_EQUAL(0u, m_vtEngine->invalidateSystemCalls);
+    VERIFY_ARE_EQUAL(std::string{ "AAA\r\nBBB" }, output);
+
+    Log::Comment(L"The next frame applies them and repaints both rows.");
+    output.clear();
+    VERIFY_SUCCEEDED(renderer.PaintFrame());
+
+    VERIFY_ARE_EQUAL(1u, m_vtEngine->invalidateSystemCalls);
+    VERIFY_ARE_NOT_EQUAL(std::string::npos, output.find("CCC"));
+    VERIFY_ARE_NOT_EQUAL(std::string::npos, output.find("DDD"));
+}
+
+void ConptyOutputTests::TriggerSystemRedrawIgnoresNullRect()
+{
+    Log::Comment(NoThrowString().Format(
+        L"TriggerSystemRedraw() without a rectangle has nothing to invalidate. "
+        L"It must not reach the engines, nor queue anything up."));
+
+    auto& g = ServiceLocator::LocateGlobals();
+    auto& renderer = *g.pRender;
+
+    _flushFirstFrame();
+
+    renderer.TriggerSystemRedraw(nullptr);
+    VERIFY_ARE_EQUAL(0u, m_vtEngine->invalidateSystemCalls);
+
+    // Nothing was invalidated, so nothing gets written.
+    VERIFY_SUCCEEDED(renderer.PaintFrame());
+    VERIFY_ARE_EQUAL(0u, m_vtEngine->invalidateSystemCalls);
+
+    const til::rect dirty{ 0, 0, 10, 10 };
+    renderer.TriggerSystemRedraw(&dirty);
+    VERIFY_ARE_EQUAL(1u, m_vtEngine->invalidateSystemCalls);
+}
+
+void ConptyOutputTests::ShadowFrameSkipsUnchangedCells()
+{
+    Log::Comment(NoThrowString().Format(
+        L"With shadow frame diffing, repainting cells that the terminal already "
+        L"displays shouldn't write anything. Only the changed cells are written."));
+
+    auto& g = ServiceLocator::LocateGlobals();
+    auto& renderer = *g.pRender;
+    auto& gci = g.getConsoleInformation();
+    auto& si = gci.GetActiveOutputBuffer();
+    auto& sm = si.GetStateMachine();
+
+    m_vtEngine->SetShadowFrameDiffing(true);
+
+    _flushFirstFrame();
+
+    expectedOutput.push_back("Hello World");
+    sm.ProcessString(L"Hello World");
+    VERIFY_SUCCEEDED(renderer.PaintFrame());
+
+    Log::Comment(L"Redraw the same text. Nothing should be written.");
+    sm.ProcessString(L"\x1b[HHello World");
+    VERIFY_SUCCEEDED(renderer.PaintFrame());
+
+    Log::Comment(L"Change a single character. Only that one should be written.");
+    expectedOutput.push_back("\x1b[1;8H");
+    expectedOutput.push_back("x");
+    expectedOutput.push_back("\x1b[3C");
+    expectedOutput.push_back("\x1b[?25h");
+    sm.ProcessString(L"\x1b[HHello Wxrld");
+    VERIFY_SUCCEEDED(renderer.PaintFrame());
+}
@@ -0,0 +1,210 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include <wextestclass.h>
+#include "../../inc/consoletaeftemplates.hpp"
+
+#include "CommonState.hpp"
+
+#include "../../interactivity/inc/ServiceLocator.hpp"
+
+#include "../cmdline.h"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+using Microsoft::Console::Interactivity::ServiceLocator;
+
+class CookedReadBenchmarks
+{
+    // The number of keystrokes that are timed for each line length.
+    static constexpr size_t Keystrokes = 256;
+
+    // This class measures how long the cooked read editor takes to process a
+    // keystroke in the middle of a long command line, including the redraw.
+    BEGIN_TEST_CLASS(CookedReadBenchmarks)
+        TEST_CLASS_PROPERTY(L"IsolationLevel", L"Class")
+    END_TEST_CLASS()
+
+    TEST_CLASS_SETUP(ClassSetup)
+    {
+        m_state = std::make_unique<CommonState>();
+        m_state->PrepareGlobalFont();
+        return true;
+    }
+
+    TEST_CLASS_CLEANUP(ClassCleanup)
+    {
+        m_state->CleanupGlobalFont();
+        m_state.reset();
+        return true;
+    }
+
+    TEST_METHOD_SETUP(MethodSetup)
+    {
+        m_state->PrepareGlobalInputBuffer();
+        m_state->PrepareGlobalScreenBuffer();
+        m_state->PrepareReadHandle();
+        m_pHistory = CommandHistory::s_Allocate(L"cmd.exe", nullptr);
+        if (!m_pHistory)
+        {
+            return false;
+        }
+        // History must be prepared before COOKED_READ (as it uses s_Find to get at it)
+        m_state->PrepareCookedReadData();
+        return true;
+    }
+
+    TEST_METHOD_CLEANUP(MethodCleanup)
+    {
+        CommandHistory::s_Free(nullptr);
+        m_pHistory = nullptr;
+        m_state->CleanupCookedReadData();
+        m_state->CleanupReadHandle();
+        m_state->CleanupGlobalInputBuffer();
+        m_state->CleanupGlobalScreenBuffer();
+        return true;
+    }
+
+    // Types a character at the start of the command line and deletes it again,
+    // which moves the entire rest of the line on the screen twice.
+    TEST_METHOD(TypeAtStartOfLongCommandLine)
+    {
+        BEGIN_TEST_METHOD_PROPERTIES()
+            TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+            TEST_METHOD_PROPERTY(L"Data:lineLength", L"{80, 1024, 8192}")
+        END_TEST_METHOD_PROPERTIES()
+
+        _benchmarkEdit([](COOKED_READ_DATA& cookedReadData, const size_t) {
+            VERIFY_ARE_EQUAL(STATUS_SUCCESS, CommandLine::Instance().ProcessCommandLine(cookedReadData, VK_HOME, 0));
+        });
+    }
+
+    // Same as above, but in the middle of the line. Only the second half moves.
+    TEST_METHOD(TypeInMiddleOfLongCommandLine)
+    {
+        BEGIN_TEST_METHOD_PROPERTIES()
+            TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+            TEST_METHOD_PROPERTY(L"Data:lineLength", L"{80, 1024, 8192}")
+        END_TEST_METHOD_PROPERTIES()
+
+        _benchmarkEdit([](COOKED_READ_DATA& cookedReadData, const size_t lineLength) {
+            for (size_t i = 0; i < lineLength / 2; ++i)
+            {
+                VERIFY_ARE_EQUAL(STATUS_SUCCESS, CommandLine::Instance().ProcessCommandLine(cookedReadData, VK_LEFT, 0));
+            }
+        });
+    }
+
+    // Same as above, but at the end of the line, where nothing has to move.
+    TEST_METHOD(TypeAtEndOfLongCommandLine)
+    {
+        BEGIN_TEST_METHOD_PROPERTIES()
+            TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+            TEST_METHOD_PROPERTY(L"Data:lineLength", L"{80, 1024, 8192}")
+        END_TEST_METHOD_PROPERTIES()
+
+        _benchmarkEdit([](COOKED_READ_DATA&, const size_t) {});
+    }
+
+    // Overwrites a character in the middle of the line and moves back onto it.
+    // This should only ever rewrite that one cell, regardless of the line length.
+    TEST_METHOD(OverwriteInMiddleOfLongCommandLine)
+    {
+        BEGIN_TEST_METHOD_PROPERTIES()
+            TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+            TEST_METHOD_PROPERTY(L"Data:lineLength", L"{80, 1024, 8192}")
+        END_TEST_METHOD_PROPERTIES()
+
+        int length;
+        VERIFY_SUCCEEDED(TestData::TryGetValue(L"lineLength", length));
+        const auto lineLength = gsl::narrow<size_t>(length);
+
+        auto buffer = _prepareCommandLine(lineLength);
+        auto& cookedReadData = ServiceLocator::LocateGlobals().getConsoleInformation().CookedReadData();
+        for (size_t i = 0; i < lineLength / 2; ++i)
+        {
+            VERIFY_ARE_EQUAL(STATUS_SUCCESS, CommandLine::Instance().ProcessCommandLine(cookedReadData, VK_LEFT, 0));
+        }
+        cookedReadData.SetInsertMode(false);
+
+        NTSTATUS status;
+        const auto beg = std::chrono::steady_clock::now();
+
+        for (size_t i = 0; i < Keystrokes / 2; ++i)
+        {
+            cookedReadData.ProcessInput(L'x', 0, status);
+            LOG_IF_NTSTATUS_FAILED(CommandLine::Instance().ProcessCommandLine(cookedReadData, VK_LEFT, 0));
+        }
+
+        _logElapsed(lineLength, std::chrono::steady_clock::now() - beg);
+
+        VERIFY_ARE_EQUAL(lineLength * sizeof(wchar_t), cookedReadData._bytesRead);
+        VERIFY_ARE_EQUAL(lineLength, cookedReadData.VisibleCharCount());
+        VERIFY_ARE_EQUAL(L'x', buffer[lineLength - lineLength / 2]);
+    }
+
+private:
+    // Sets up a cooked read with a line of lineLength characters, with the cursor at its end.
+    std::unique_ptr<wchar_t[]> _prepareCommandLine(const size_t lineLength)
+    {
+        const auto bufferSize = lineLength + 16;
+        auto buffer = std::make_unique<wchar_t[]>(bufferSize);
+        auto& cookedReadData = ServiceLocator::LocateGlobals().getConsoleInformation().CookedReadData();
+        cookedReadData._commandHistory = m_pHistory;
+        cookedReadData._userBuffer = buffer.get();
+        cookedReadData._userBufferSize = bufferSize * sizeof(wchar_t);
+        cookedReadData._bufferSize = bufferSize * sizeof(wchar_t);
+        cookedReadData._backupLimit = buffer.get();
+        cookedReadData._bufPtr = buffer.get();
+        cookedReadData._exeName = L"cmd.exe";
+        cookedReadData.OriginalCursorPosition() = {};
+        cookedReadData.SetInsertMode(true);
+
+        NTSTATUS status;
+        for (size_t i = 0; i < lineLength; ++i)
+        {
+            cookedReadData.ProcessInput(static_cast<wchar_t>(L'a' + i % 26), 0, status);
+        }
+
+        return buffer;
+    }
+
+    // Prepares a command line, moves the cursor with moveCursor and then times
+    // typing a character and deleting it again with backspace.
+    template<typename T>
+    void _benchmarkEdit(T&& moveCursor)
+    {
+        int length;
+        VERIFY_SUCCEEDED(TestData::TryGetValue(L"lineLength", length));
+        const auto lineLength = gsl::narrow<size_t>(length);
+
+        const auto buffer = _prepareCommandLine(lineLength);
+        auto& cookedReadData = ServiceLocator::LocateGlobals().getConsoleInformation().CookedReadData();
+        moveCursor(cookedReadData, lineLength);
+
+        NTSTATUS status;
+        const auto beg = std::chrono::steady_clock::now();
+
+        for (size_t i = 0; i < Keystrokes / 2; ++i)
+        {
+            cookedReadData.ProcessInput(L'x', 0, status);
+            cookedReadData.ProcessInput(UNICODE_BACKSPACE, 0, status);
+        }
+
+        _logElapsed(lineLength, std::chrono::steady_clock::now() - beg);
+
+        VERIFY_ARE_EQUAL(lineLength * sizeof(wchar_t), cookedReadData._bytesRead);
+        VERIFY_ARE_EQUAL(lineLength, cookedReadData.VisibleCharCount());
+    }
+
+    static void _logElapsed(const size_t lineLength, const std::chrono::steady_clock::duration elapsed)
+    {
+        const auto us = std::chrono::duration<double, std::micro>(elapsed).count();
+        Log::Comment(NoThrowString().Format(L"%zu characters: %.1f us per keystroke", lineLength, us / Keystrokes));
+    }
+
+    std::unique_ptr<CommonState> m_state;
+    CommandHistory* m_pHistory;
+};
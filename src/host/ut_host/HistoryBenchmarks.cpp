@@ -0,0 +1,96 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include <wextestclass.h>
+#include "../../inc/consoletaeftemplates.hpp"
+
+#include "CommonState.hpp"
+
+#include "../history.h"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+class HistoryBenchmarks
+{
+    // The number of prefix searches that are timed for each history size.
+    static constexpr size_t Lookups = 1024;
+
+    // This class measures how long it takes to add commands to a large history
+    // with duplicates suppressed, and to search it for a prefix (F8).
+    BEGIN_TEST_CLASS(HistoryBenchmarks)
+        TEST_CLASS_PROPERTY(L"IsolationLevel", L"Class")
+    END_TEST_CLASS()
+
+    TEST_METHOD_SETUP(MethodSetup)
+    {
+        CommandHistory::s_ClearHistoryListStorage();
+        return true;
+    }
+
+    TEST_METHOD_CLEANUP(MethodCleanup)
+    {
+        CommandHistory::s_ClearHistoryListStorage();
+        return true;
+    }
+
+    TEST_METHOD(AddAndFindInLargeHistory)
+    {
+        BEGIN_TEST_METHOD_PROPERTIES()
+            TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+            TEST_METHOD_PROPERTY(L"Data:historySize", L"{50, 1024, 32000}")
+        END_TEST_METHOD_PROPERTIES()
+
+        int size;
+        VERIFY_SUCCEEDED(TestData::TryGetValue(L"historySize", size));
+        const auto historySize = gsl::narrow<SHORT>(size);
+
+        const auto history = CommandHistory::s_Allocate(L"cmd.exe", nullptr);
+        VERIFY_IS_NOT_NULL(history);
+        history->Realloc(historySize);
+
+        std::vector<std::wstring> commands;
+        commands.reserve(historySize);
+        for (SHORT i = 0; i < historySize; ++i)
+        {
+            commands.emplace_back(fmt::format(L"git commit -m \"change {}\"", i));
+        }
+
+        const auto beg = std::chrono::steady_clock::now();
+
+        for (const auto& command : commands)
+        {
+            VERIFY_SUCCEEDED(history->Add(command, true));
+        }
+
+        const auto mid = std::chrono::steady_clock::now();
+
+        // Every one of these is a duplicate that's moved to the end of the history.
+        for (size_t i = 0; i < commands.size(); i += 2)
+        {
+            VERIFY_SUCCEEDED(history->Add(til::at(commands, i), true));
+        }
+
+        const auto end = std::chrono::steady_clock::now();
+
+        SHORT index = 0;
+        size_t found = 0;
+        for (size_t i = 0; i < Lookups; ++i)
+        {
+            found += history->FindMatchingCommand(L"git commit -m \"change 1", index, index, CommandHistory::MatchOptions::JustLooking);
+        }
+
+        const auto lookupEnd = std::chrono::steady_clock::now();
+
+        Log::Comment(NoThrowString().Format(L"%d commands: add %.1f us, re-add %.1f us, prefix search %.1f us (per call)",
+                                            size,
+                                            std::chrono::duration<double, std::micro>(mid - beg).count() / commands.size(),
+                                            std::chrono::duration<double, std::micro>(end - mid).count() / ((commands.size() + 1) / 2),
+                                            std::chrono::duration<double, std::micro>(lookupEnd - end).count() / Lookups));
+
+        VERIFY_ARE_EQUAL(commands.size(), history->GetNumberOfCommands());
+        VERIFY_ARE_EQUAL(Lookups, found);
+    }
+};
@@ -242,6 +242,76 @@ class HistoryTests
         VERIFY_ARE_EQUAL(2ul, history->GetNumberOfCommands());
     }
 
+    TEST_METHOD(FindMatchingCommandByPrefix)
+    {
+        auto history = CommandHistory::s_Allocate(_manyApps[0], _MakeHandle(0));
+        VERIFY_IS_NOT_NULL(history);
+
+        for (size_t j = 0; j < _manyHistoryItems.size(); j++)
+        {
+            VERIFY_SUCCEEDED(history->Add(_manyHistoryItems[j], false));
+        }
+
+        // The first two items aged out, so "ipconfig" is at 2 and "ipconfig /all" at 3.
+        VERIFY_ARE_EQUAL(L"ipconfig", history->GetNth(2));
+        VERIFY_ARE_EQUAL(L"ipconfig /all", history->GetNth(3));
+
+        SHORT index = -1;
+        Log::Comment(L"The search starts before the given index and walks backwards.");
+        VERIFY_IS_TRUE(history->FindMatchingCommand(L"ipconfig", 9, index, CommandHistory::MatchOptions::JustLooking));
+        VERIFY_ARE_EQUAL(3, index);
+        VERIFY_IS_TRUE(history->FindMatchingCommand(L"ipconfig", 3, index, CommandHistory::MatchOptions::JustLooking));
+        VERIFY_ARE_EQUAL(2, index);
+
+        Log::Comment(L"Once it passed the oldest command, it wraps around to the most recent one.");
+        VERIFY_IS_TRUE(history->FindMatchingCommand(L"ipconfig", 2, index, CommandHistory::MatchOptions::JustLooking));
+        VERIFY_ARE_EQUAL(3, index);
+
+        Log::Comment(L"An exact match skips the commands that merely start with it.");
+        VERIFY_IS_TRUE(history->FindMatchingCommand(L"ipconfig", 9, index, CommandHistory::MatchOptions::JustLooking | CommandHistory::MatchOptions::ExactMatch));
+        VERIFY_ARE_EQUAL(2, index);
+
+        VERIFY_IS_FALSE(history->FindMatchingCommand(L"dir", 9, index, CommandHistory::MatchOptions::JustLooking));
+        VERIFY_IS_FALSE(history->FindMatchingCommand(L"ipconfig /all /v", 9, index, CommandHistory::MatchOptions::JustLooking));
+    }
+
+    TEST_METHOD(FindMatchingCommandAfterReordering)
+    {
+        auto history = CommandHistory::s_Allocate(_manyApps[0], _MakeHandle(0));
+        VERIFY_IS_NOT_NULL(history);
+
+        for (size_t j = 0; j < _manyHistoryItems.size(); j++)
+        {
+            VERIFY_SUCCEEDED(history->Add(_manyHistoryItems[j], false));
+        }
+
+        Log::Comment(L"Re-adding a command with duplicates suppressed moves it to the end.");
+        VERIFY_SUCCEEDED(history->Add(L"ipconfig", true));
+        VERIFY_ARE_EQUAL(10ul, history->GetNumberOfCommands());
+        VERIFY_ARE_EQUAL(L"ipconfig /all", history->GetNth(2));
+        VERIFY_ARE_EQUAL(L"ipconfig", history->GetNth(9));
+
+        SHORT index = -1;
+        VERIFY_IS_TRUE(history->FindMatchingCommand(L"ipconfig", 0, index, CommandHistory::MatchOptions::JustLooking | CommandHistory::MatchOptions::ExactMatch));
+        VERIFY_ARE_EQUAL(9, index);
+        VERIFY_IS_TRUE(history->FindMatchingCommand(L"ipconfig", 9, index, CommandHistory::MatchOptions::JustLooking));
+        VERIFY_ARE_EQUAL(2, index);
+
+        Log::Comment(L"Swapped commands are found at their new place.");
+        history->Swap(2, 9);
+        VERIFY_IS_TRUE(history->FindMatchingCommand(L"ipconfig /", 0, index, CommandHistory::MatchOptions::JustLooking));
+        VERIFY_ARE_EQUAL(9, index);
+        VERIFY_IS_TRUE(history->FindMatchingCommand(L"ipconfig", 0, index, CommandHistory::MatchOptions::JustLooking | CommandHistory::MatchOptions::ExactMatch));
+        VERIFY_ARE_EQUAL(2, index);
+
+        Log::Comment(L"Shrinking the history drops the commands past the new size from the search.");
+        history->Realloc(5);
+        VERIFY_ARE_EQUAL(5ul, history->GetNumberOfCommands());
+        VERIFY_IS_FALSE(history->FindMatchingCommand(L"ipconfig /", 0, index, CommandHistory::MatchOptions::JustLooking));
+        VERIFY_IS_TRUE(history->FindMatchingCommand(L"ipconfig", 0, index, CommandHistory::MatchOptions::JustLooking));
+        VERIFY_ARE_EQUAL(2, index);
+    }
+
 private:
     const std::array<std::wstring, 5> _manyApps = {
         L"foo.exe",
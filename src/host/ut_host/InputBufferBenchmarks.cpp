@@ -0,0 +1,157 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include <wextestclass.h>
+#include "../../inc/consoletaeftemplates.hpp"
+
+#include "ApiRoutines.h"
+
+#include "CommonState.hpp"
+
+#include "../interactivity/inc/ServiceLocator.hpp"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+using Microsoft::Console::Interactivity::ServiceLocator;
+
+class InputBufferBenchmarks
+{
+    // A paste of 1 MiB of text. Every character is sent as a key down and a key up event.
+    static constexpr size_t PasteSize = 1024 * 1024;
+    // The number of records a terminal writes and a client reads per call.
+    static constexpr size_t WriteChunkSize = 4096;
+    static constexpr size_t ReadChunkSize = 512;
+
+    // This class measures how long it takes for a large paste to travel
+    // through the input buffer, from WriteConsoleInputW to ReadConsoleInputW.
+    BEGIN_TEST_CLASS(InputBufferBenchmarks)
+        TEST_CLASS_PROPERTY(L"IsolationLevel", L"Class")
+    END_TEST_CLASS()
+
+    TEST_CLASS_SETUP(ClassSetup)
+    {
+        m_state = std::make_unique<CommonState>();
+        m_state->PrepareGlobalInputBuffer();
+
+        m_paste.reserve(PasteSize * 2);
+        for (size_t i = 0; i < PasteSize; ++i)
+        {
+            const auto wch = i % 80 == 79 ? L'\r' : static_cast<wchar_t>(L' ' + i % 95);
+            INPUT_RECORD record{};
+            record.EventType = KEY_EVENT;
+            record.Event.KeyEvent.bKeyDown = TRUE;
+            record.Event.KeyEvent.wRepeatCount = 1;
+            record.Event.KeyEvent.uChar.UnicodeChar = wch;
+            m_paste.push_back(record);
+            record.Event.KeyEvent.bKeyDown = FALSE;
+            m_paste.push_back(record);
+        }
+
+        return true;
+    }
+
+    TEST_CLASS_CLEANUP(ClassCleanup)
+    {
+        m_state->CleanupGlobalInputBuffer();
+        m_state.reset();
+        return true;
+    }
+
+    TEST_METHOD_SETUP(MethodSetup)
+    {
+        ServiceLocator::LocateGlobals().getConsoleInformation().pInputBuffer->Flush();
+        return true;
+    }
+
+    // Writes the paste in chunks and reads each chunk right back, like a client
+    // that keeps up with the terminal, and verifies that nothing got lost.
+    TEST_METHOD(PasteThroughConsoleInputApis)
+    {
+        BEGIN_TEST_METHOD_PROPERTIES()
+            TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+        END_TEST_METHOD_PROPERTIES()
+
+        auto& inputBuffer = *ServiceLocator::LocateGlobals().getConsoleInformation().pInputBuffer;
+        INPUT_READ_HANDLE_DATA readHandleState;
+        std::unique_ptr<IWaitRoutine> waiter;
+        std::vector<INPUT_RECORD> chunk;
+        size_t recordsRead = 0;
+        auto recordsMatch = true;
+
+        const auto beg = std::chrono::steady_clock::now();
+
+        for (size_t offset = 0; offset < m_paste.size(); offset += WriteChunkSize)
+        {
+            const auto records = std::span{ m_paste }.subspan(offset, std::min(WriteChunkSize, m_paste.size() - offset));
+            size_t written = 0;
+            VERIFY_SUCCEEDED(m_routines.WriteConsoleInputWImpl(inputBuffer, records, written, true));
+            VERIFY_ARE_EQUAL(records.size(), written);
+
+            while (inputBuffer.GetNumberOfReadyEvents() != 0)
+            {
+                chunk.clear();
+                VERIFY_SUCCEEDED(m_routines.ReadConsoleInputWImpl(inputBuffer, chunk, ReadChunkSize, readHandleState, waiter));
+                VERIFY_IS_NULL(waiter.get());
+
+                for (const auto& record : chunk)
+                {
+                    const auto& expected = til::at(m_paste, recordsRead);
+                    recordsMatch &= record.Event.KeyEvent.uChar.UnicodeChar == expected.Event.KeyEvent.uChar.UnicodeChar &&
+                                    record.Event.KeyEvent.bKeyDown == expected.Event.KeyEvent.bKeyDown;
+                    ++recordsRead;
+                }
+            }
+        }
+
+        const auto elapsed = std::chrono::steady_clock::now() - beg;
+        const auto ms = std::chrono::duration<double, std::milli>(elapsed).count();
+        Log::Comment(NoThrowString().Format(L"%zu records in %.1f ms (%.1f MiB/s of pasted text)", recordsRead, ms, PasteSize / 1048576.0 / ms * 1000.0));
+
+        VERIFY_ARE_EQUAL(m_paste.size(), recordsRead);
+        VERIFY_IS_TRUE(recordsMatch);
+    }
+
+    // Writes the entire paste at once, before the client reads any of it. This
+    // is how a paste through the clipboard arrives in the input buffer.
+    TEST_METHOD(PasteThroughConsoleInputApisAtOnce)
+    {
+        BEGIN_TEST_METHOD_PROPERTIES()
+            TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+        END_TEST_METHOD_PROPERTIES()
+
+        auto& inputBuffer = *ServiceLocator::LocateGlobals().getConsoleInformation().pInputBuffer;
+        INPUT_READ_HANDLE_DATA readHandleState;
+        std::unique_ptr<IWaitRoutine> waiter;
+        std::vector<INPUT_RECORD> chunk;
+        size_t recordsRead = 0;
+
+        const auto beg = std::chrono::steady_clock::now();
+
+        size_t written = 0;
+        VERIFY_SUCCEEDED(m_routines.WriteConsoleInputWImpl(inputBuffer, m_paste, written, true));
+        VERIFY_ARE_EQUAL(m_paste.size(), written);
+
+        const auto mid = std::chrono::steady_clock::now();
+
+        while (inputBuffer.GetNumberOfReadyEvents() != 0)
+        {
+            chunk.clear();
+            VERIFY_SUCCEEDED(m_routines.ReadConsoleInputWImpl(inputBuffer, chunk, ReadChunkSize, readHandleState, waiter));
+            recordsRead += chunk.size();
+        }
+
+        const auto end = std::chrono::steady_clock::now();
+        Log::Comment(NoThrowString().Format(L"Write: %.1f ms, read: %.1f ms",
+                                            std::chrono::duration<double, std::milli>(mid - beg).count(),
+                                            std::chrono::duration<double, std::milli>(end - mid).count()));
+
+        VERIFY_ARE_EQUAL(m_paste.size(), recordsRead);
+    }
+
+private:
+    std::unique_ptr<CommonState> m_state;
+    ApiRoutines m_routines;
+    std::vector<INPUT_RECORD> m_paste;
+};
@@ -78,7 +78,7 @@ class InputBufferTests
             INPUT_RECORD record;
             record.EventType = MENU_EVENT;
             VERIFY_IS_GREATER_THAN(inputBuffer.Write(IInputEvent::Create(record)), 0u);
-            VERIFY_ARE_EQUAL(record, inputBuffer._storage.back()->ToInputRecord());
+            VERIFY_ARE_EQUAL(record, inputBuffer._storage.back());
         }
         VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), RECORD_INSERT_COUNT);
     }
@@ -98,7 +98,7 @@ class InputBufferTests
         // verify that the events are the same in storage
         for (size_t i = 0; i < RECORD_INSERT_COUNT; ++i)
         {
-            VERIFY_ARE_EQUAL(inputBuffer._storage[i]->ToInputRecord(), record);
+            VERIFY_ARE_EQUAL(inputBuffer._storage[i], record);
         }
     }
 
@@ -121,10 +121,9 @@ class InputBufferTests
         // check that they coalesced
         VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), 1u);
         // check that the mouse position is being updated correctly
-        const IInputEvent* const pOutEvent = inputBuffer._storage.front().get();
-        const auto pMouseEvent = static_cast<const MouseEvent* const>(pOutEvent);
-        VERIFY_ARE_EQUAL(pMouseEvent->GetPosition().x, static_cast<SHORT>(RECORD_INSERT_COUNT));
-        VERIFY_ARE_EQUAL(pMouseEvent->GetPosition().y, static_cast<SHORT>(RECORD_INSERT_COUNT * 2));
+        const auto& outRecord = inputBuffer._storage.front();
+        VERIFY_ARE_EQUAL(outRecord.Event.MouseEvent.dwMousePosition.X, static_cast<SHORT>(RECORD_INSERT_COUNT));
+        VERIFY_ARE_EQUAL(outRecord.Event.MouseEvent.dwMousePosition.Y, static_cast<SHORT>(RECORD_INSERT_COUNT * 2));
 
         // add a key event and another mouse event to make sure that
         // an event between two mouse events stopped the coalescing.
@@ -162,10 +161,10 @@ class InputBufferTests
         // no events should have been coalesced
         VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), RECORD_INSERT_COUNT + 1);
         // check that the events stored match those inserted
-        VERIFY_ARE_EQUAL(inputBuffer._storage.front()->ToInputRecord(), mouseRecords[0]);
+        VERIFY_ARE_EQUAL(inputBuffer._storage.front(), mouseRecords[0]);
         for (size_t i = 0; i < RECORD_INSERT_COUNT; ++i)
         {
-            VERIFY_ARE_EQUAL(inputBuffer._storage[i + 1]->ToInputRecord(), mouseRecords[i]);
+            VERIFY_ARE_EQUAL(inputBuffer._storage[i + 1], mouseRecords[i]);
         }
     }
 
@@ -221,10 +220,10 @@ class InputBufferTests
         // no events should have been coalesced
         VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), RECORD_INSERT_COUNT + 1);
         // check that the events stored match those inserted
-        VERIFY_ARE_EQUAL(inputBuffer._storage.front()->ToInputRecord(), keyRecords[0]);
+        VERIFY_ARE_EQUAL(inputBuffer._storage.front(), keyRecords[0]);
         for (size_t i = 0; i < RECORD_INSERT_COUNT; ++i)
         {
-            VERIFY_ARE_EQUAL(inputBuffer._storage[i + 1]->ToInputRecord(), keyRecords[i]);
+            VERIFY_ARE_EQUAL(inputBuffer._storage[i + 1], keyRecords[i]);
         }
     }
 
@@ -239,7 +238,7 @@ class InputBufferTests
         for (size_t i = 0; i < RECORD_INSERT_COUNT; ++i)
         {
             VERIFY_IS_GREATER_THAN(inputBuffer.Write(IInputEvent::Create(record)), 0u);
-            VERIFY_ARE_EQUAL(inputBuffer._storage.back()->ToInputRecord(), record);
+            VERIFY_ARE_EQUAL(inputBuffer._storage.back(), record);
         }
 
         // The events shouldn't be coalesced
@@ -382,10 +381,10 @@ class InputBufferTests
         VERIFY_IS_GREATER_THAN(inputBuffer.Write(inEvents), 0u);
 
         // read one record, make sure ResetWaitEvent isn't set
-        std::deque<std::unique_ptr<IInputEvent>> outEvents;
+        std::vector<INPUT_RECORD> outRecords;
         size_t eventsRead = 0;
         auto resetWaitEvent = false;
-        inputBuffer._ReadBuffer(outEvents,
+        inputBuffer._ReadBuffer(outRecords,
                                 1,
                                 eventsRead,
                                 false,
@@ -396,8 +395,8 @@ class InputBufferTests
         VERIFY_IS_FALSE(!!resetWaitEvent);
 
         // read the rest, resetWaitEvent should be set to true
-        outEvents.clear();
-        inputBuffer._ReadBuffer(outEvents,
+        outRecords.clear();
+        inputBuffer._ReadBuffer(outRecords,
                                 RECORD_INSERT_COUNT - 1,
                                 eventsRead,
                                 false,
@@ -431,10 +430,10 @@ class InputBufferTests
         VERIFY_IS_GREATER_THAN(inputBuffer.Write(inEvents), 0u);
 
         // read them out non-unicode style and compare
-        std::deque<std::unique_ptr<IInputEvent>> outEvents;
+        std::vector<INPUT_RECORD> outRecords;
         size_t eventsRead = 0;
         auto resetWaitEvent = false;
-        inputBuffer._ReadBuffer(outEvents,
+        inputBuffer._ReadBuffer(outRecords,
                                 recordInsertCount,
                                 eventsRead,
                                 false,
@@ -444,10 +443,10 @@ class InputBufferTests
         // the dbcs record should have counted for two elements in
         // the array, making it so that we get less events read
         VERIFY_ARE_EQUAL(eventsRead, recordInsertCount - 1);
-        VERIFY_ARE_EQUAL(eventsRead, outEvents.size());
+        VERIFY_ARE_EQUAL(eventsRead, outRecords.size());
         for (size_t i = 0; i < eventsRead; ++i)
         {
-            VERIFY_ARE_EQUAL(outEvents[i]->ToInputRecord(), inRecords[i]);
+            VERIFY_ARE_EQUAL(outRecords[i], inRecords[i]);
         }
     }
 
@@ -589,22 +588,17 @@ class InputBufferTests
     {
         InputBuffer inputBuffer;
         auto record = MakeKeyEvent(true, 1, L'a', 0, L'a', 0);
-        auto inputEvent = IInputEvent::Create(record);
         size_t eventsWritten;
         auto waitEvent = false;
         inputBuffer.Flush();
         // write one event to an empty buffer
-        std::deque<std::unique_ptr<IInputEvent>> storage;
-        storage.push_back(std::move(inputEvent));
-        inputBuffer._WriteBuffer(storage, eventsWritten, waitEvent);
+        inputBuffer._WriteBuffer({ &record, 1 }, eventsWritten, waitEvent);
         VERIFY_IS_TRUE(waitEvent);
         // write another, it shouldn't signal this time
         auto record2 = MakeKeyEvent(true, 1, L'b', 0, L'b', 0);
-        auto inputEvent2 = IInputEvent::Create(record2);
         // write another event to a non-empty buffer
         waitEvent = false;
-        storage.push_back(std::move(inputEvent2));
-        inputBuffer._WriteBuffer(storage, eventsWritten, waitEvent);
+        inputBuffer._WriteBuffer({ &record2, 1 }, eventsWritten, waitEvent);
 
         VERIFY_IS_FALSE(waitEvent);
     }
@@ -625,7 +619,7 @@ class InputBufferTests
                                                  true));
         VERIFY_ARE_EQUAL(outEvents.size(), 1u);
         VERIFY_ARE_EQUAL(inputBuffer._storage.size(), 1u);
-        VERIFY_ARE_EQUAL(static_cast<const KeyEvent&>(*inputBuffer._storage.front()).GetRepeatCount(), repeatCount - 1);
+        VERIFY_ARE_EQUAL(inputBuffer._storage.front().Event.KeyEvent.wRepeatCount, repeatCount - 1);
         VERIFY_ARE_EQUAL(static_cast<const KeyEvent&>(*outEvents.front()).GetRepeatCount(), 1u);
     }
 
@@ -645,7 +639,67 @@ class InputBufferTests
                                                  true));
         VERIFY_ARE_EQUAL(outEvents.size(), 1u);
         VERIFY_ARE_EQUAL(inputBuffer._storage.size(), 1u);
-        VERIFY_ARE_EQUAL(static_cast<const KeyEvent&>(*inputBuffer._storage.front()).GetRepeatCount(), repeatCount);
+        VERIFY_ARE_EQUAL(inputBuffer._storage.front().Event.KeyEvent.wRepeatCount, repeatCount);
         VERIFY_ARE_EQUAL(static_cast<const KeyEvent&>(*outEvents.front()).GetRepeatCount(), 1u);
     }
+
+    TEST_METHOD(BulkWritesAndReadsWrapAroundTheQueue)
+    {
+        Log::Comment(L"Records written and read in bulk should come out in order, even once the queue wraps around");
+
+        InputBuffer inputBuffer;
+        std::vector<INPUT_RECORD> records;
+        for (auto wch = L'a'; wch <= L'x'; ++wch)
+        {
+            records.push_back(MakeKeyEvent(TRUE, 1, wch, 0, wch, 0));
+        }
+        const auto firstHalf = std::span{ records }.first(12);
+        const auto secondHalf = std::span{ records }.subspan(12);
+
+        // fill the queue and read most of it, so that the next write wraps around its end
+        VERIFY_ARE_EQUAL(inputBuffer.Write(firstHalf), firstHalf.size());
+        std::vector<INPUT_RECORD> outRecords;
+        VERIFY_SUCCESS_NTSTATUS(inputBuffer.Read(outRecords, 10, false, false, true, false));
+        VERIFY_ARE_EQUAL(outRecords.size(), 10u);
+
+        const auto capacity = inputBuffer._storage.capacity();
+        VERIFY_ARE_EQUAL(inputBuffer.Write(secondHalf), secondHalf.size());
+        VERIFY_ARE_EQUAL(inputBuffer._storage.capacity(), capacity);
+        VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), 14u);
+
+        // peeking doesn't remove anything
+        outRecords.clear();
+        VERIFY_SUCCESS_NTSTATUS(inputBuffer.Read(outRecords, 100, true, false, true, false));
+        VERIFY_ARE_EQUAL(outRecords.size(), 14u);
+        VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), 14u);
+
+        outRecords.clear();
+        VERIFY_SUCCESS_NTSTATUS(inputBuffer.Read(outRecords, 100, false, false, true, false));
+        VERIFY_ARE_EQUAL(outRecords.size(), 14u);
+        VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), 0u);
+        for (size_t i = 0; i < outRecords.size(); ++i)
+        {
+            VERIFY_ARE_EQUAL(outRecords[i], records[i + 10]);
+        }
+    }
+
+    TEST_METHOD(BulkWriteRemovesPauseKeys)
+    {
+        Log::Comment(L"A pause key and the key press that unpauses the console should be removed from a bulk write");
+
+        const auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        InputBuffer inputBuffer;
+        const std::array records{
+            MakeKeyEvent(true, 1, L'a', 0, L'a', 0),
+            MakeKeyEvent(true, 1, VK_PAUSE, 0, 0, 0),
+            MakeKeyEvent(true, 1, L'b', 0, L'b', 0),
+            MakeKeyEvent(true, 1, L'c', 0, L'c', 0),
+        };
+
+        VERIFY_ARE_EQUAL(inputBuffer.Write(records), 2u);
+        VERIFY_IS_FALSE(WI_IsFlagSet(gci.Flags, CONSOLE_OUTPUT_SUSPENDED));
+        VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), 2u);
+        VERIFY_ARE_EQUAL(inputBuffer._storage[0], records[0]);
+        VERIFY_ARE_EQUAL(inputBuffer._storage[1], records[3]);
+    }
 };
@@ -0,0 +1,258 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include <wextestclass.h>
+#include "../../inc/consoletaeftemplates.hpp"
+
+#include "../../renderer/base/Renderer.hpp"
+#include "../../renderer/inc/RenderEngineBase.hpp"
+
+#include "CommonState.hpp"
+
+#include <chrono>
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+using namespace Microsoft::Console::Interactivity;
+using namespace Microsoft::Console::Render;
+
+namespace
+{
+    // An engine that doesn't paint anything. It marks the entire viewport as dirty on every
+    // frame and counts what the Renderer asked it to paint, so that the benchmark below
+    // measures the cost of turning the text buffer into paint calls and nothing else.
+    class MockPaintRenderEngine final : public RenderEngineBase
+    {
+    public:
+        explicit MockPaintRenderEngine(const til::size viewportSize) :
+            _dirty{ til::point{ 0, 0 }, viewportSize }
+        {
+        }
+
+        size_t brushes = 0;
+        size_t lines = 0;
+        size_t clusters = 0;
+        size_t columns = 0;
+
+        void ResetCounters() noexcept
+        {
+            brushes = 0;
+            lines = 0;
+            clusters = 0;
+            columns = 0;
+        }
+
+        HRESULT StartPaint() noexcept override { return S_OK; }
+        HRESULT EndPaint() noexcept override { return S_OK; }
+        HRESULT Present() noexcept override { return S_OK; }
+        HRESULT PrepareForTeardown(_Out_ bool* pForcePaint) noexcept override
+        {
+            *pForcePaint = false;
+            return S_OK;
+        }
+        HRESULT ScrollFrame() noexcept override { return S_OK; }
+        HRESULT Invalidate(const til::rect* /*psrRegion*/) noexcept override { return S_OK; }
+        HRESULT InvalidateCursor(const til::rect* /*psrRegion*/) noexcept override { return S_OK; }
+        HRESULT InvalidateSystem(const til::rect* /*prcDirtyClient*/) noexcept override { return S_OK; }
+        HRESULT InvalidateSelection(const std::vector<til::rect>& /*rectangles*/) noexcept override { return S_OK; }
+        HRESULT InvalidateScroll(const til::point* /*pcoordDelta*/) noexcept override { return S_OK; }
+        HRESULT InvalidateAll() noexcept override { return S_OK; }
+        HRESULT PaintBackground() noexcept override { return S_OK; }
+        HRESULT PaintBufferLine(std::span<const Cluster> clusters, til::point /*coord*/, bool fTrimLeft, bool /*lineWrapped*/) noexcept override
+        {
+            lines++;
+            this->clusters += clusters.size();
+            for (const auto& cluster : clusters)
+            {
+                columns += cluster.GetColumns();
+            }
+            // The left half of a trimmed cluster isn't actually painted.
+            columns -= fTrimLeft ? 1 : 0;
+            return S_OK;
+        }
+        HRESULT PaintBufferGridLines(GridLineSet /*lines*/, COLORREF /*color*/, size_t /*cchLine*/, til::point /*coordTarget*/) noexcept override { return S_OK; }
+        HRESULT PaintSelection(const til::rect& /*rect*/) noexcept override { return S_OK; }
+        HRESULT PaintCursor(const CursorOptions& /*options*/) noexcept override { return S_OK; }
+        HRESULT UpdateDrawingBrushes(const TextAttribute& /*textAttributes*/, const RenderSettings& /*renderSettings*/, gsl::not_null<IRenderData*> /*pData*/, bool /*usingSoftFont*/, bool /*isSettingDefaultBrushes*/) noexcept override
+        {
+            brushes++;
+            return S_OK;
+        }
+        HRESULT UpdateFont(const FontInfoDesired& /*FontInfoDesired*/, _Out_ FontInfo& /*FontInfo*/) noexcept override { return S_OK; }
+        HRESULT UpdateDpi(int /*iDpi*/) noexcept override { return S_OK; }
+        HRESULT UpdateViewport(const til::inclusive_rect& /*srNewViewport*/) noexcept override { return S_OK; }
+        HRESULT GetProposedFont(const FontInfoDesired& /*FontInfoDesired*/, _Out_ FontInfo& /*FontInfo*/, int /*iDpi*/) noexcept override { return S_FALSE; }
+        HRESULT GetDirtyArea(std::span<const til::rect>& area) noexcept override
+        {
+            area = { &_dirty, 1 };
+            return S_OK;
+        }
+        HRESULT GetFontSize(_Out_ til::size* pFontSize) noexcept override
+        {
+            *pFontSize = { 8, 16 };
+            return S_OK;
+        }
+        HRESULT IsGlyphWideByFont(std::wstring_view /*glyph*/, _Out_ bool* pResult) noexcept override
+        {
+            *pResult = false;
+            return S_FALSE;
+        }
+
+    protected:
+        HRESULT _DoUpdateTitle(const std::wstring_view /*newTitle*/) noexcept override { return S_OK; }
+
+    private:
+        til::rect _dirty;
+    };
+}
+
+class RendererBenchmarks
+{
+    static constexpr til::CoordType ViewWidth = 120;
+    static constexpr til::CoordType ViewHeight = 30;
+
+    BEGIN_TEST_CLASS(RendererBenchmarks)
+        TEST_CLASS_PROPERTY(L"IsolationLevel", L"Class")
+    END_TEST_CLASS()
+
+    TEST_CLASS_SETUP(ClassSetup)
+    {
+        m_state = std::make_unique<CommonState>();
+
+        m_state->InitEvents();
+        m_state->PrepareGlobalFont();
+        m_state->PrepareGlobalInputBuffer();
+        m_state->PrepareGlobalScreenBuffer(ViewWidth, ViewHeight, ViewWidth, ViewHeight);
+
+        return true;
+    }
+
+    TEST_CLASS_CLEANUP(ClassCleanup)
+    {
+        m_state->CleanupGlobalScreenBuffer();
+        m_state->CleanupGlobalFont();
+        m_state->CleanupGlobalInputBuffer();
+
+        m_state.reset();
+
+        return true;
+    }
+
+    TEST_METHOD_SETUP(MethodSetup)
+    {
+        m_state->PrepareNewTextBufferInfo(true, ViewWidth, ViewHeight);
+        return true;
+    }
+
+    TEST_METHOD_CLEANUP(MethodCleanup)
+    {
+        m_state->CleanupNewTextBufferInfo();
+        return true;
+    }
+
+    // Measures how long it takes the Renderer to paint a frame in which every row is dirty.
+    TEST_METHOD(FrameTime)
+    {
+        BEGIN_TEST_METHOD_PROPERTIES()
+            TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+            TEST_METHOD_PROPERTY(L"Data:workload", L"{0, 1, 2, 3}")
+        END_TEST_METHOD_PROPERTIES()
+
+        int workload;
+        VERIFY_SUCCEEDED(TestData::TryGetValue(L"workload", workload));
+
+        auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        auto& si = gci.GetActiveOutputBuffer();
+        auto& sm = si.GetStateMachine();
+
+        static constexpr std::array workloadNames{ L"plain ASCII", L"SGR-heavy colored text", L"cmatrix-style sparse text", L"CJK and emoji" };
+        Log::Comment(NoThrowString().Format(L"Workload: %s", til::at(workloadNames, workload)));
+
+        // The contents are generated from a fixed seed, so that the results are comparable between runs.
+        uint32_t seed = 0x2545F491;
+        const auto random = [&]() {
+            seed ^= seed << 13;
+            seed ^= seed >> 17;
+            seed ^= seed << 5;
+            return seed;
+        };
+
+        std::wstring text;
+        for (til::CoordType y = 0; y < ViewHeight; ++y)
+        {
+            text.append(fmt::format(FMT_COMPILE(L"\x1b[{}H"), y + 1));
+
+            for (til::CoordType x = 0; x < ViewWidth;)
+            {
+                switch (workload)
+                {
+                case 0:
+                    text.push_back(static_cast<wchar_t>(L'!' + random() % 94));
+                    x++;
+                    break;
+                case 1:
+                {
+                    const auto word = std::min(gsl::narrow_cast<til::CoordType>(1 + random() % 8), ViewWidth - x);
+                    text.append(fmt::format(FMT_COMPILE(L"\x1b[{};{}m"), 30 + random() % 8, 40 + random() % 8));
+                    for (til::CoordType i = 0; i < word; ++i)
+                    {
+                        text.push_back(static_cast<wchar_t>(L'a' + random() % 26));
+                    }
+                    x += word;
+                    break;
+                }
+                case 2:
+                    // Mostly spaces in varying foreground colors, but the same background.
+                    text.append(fmt::format(FMT_COMPILE(L"\x1b[{}m"), 32 + random() % 2 * 60));
+                    text.push_back(random() % 4 ? L' ' : static_cast<wchar_t>(L'0' + random() % 10));
+                    x++;
+                    break;
+                default:
+                    if (x + 2 <= ViewWidth && random() % 2)
+                    {
+                        text.append(random() % 4 ? L"\x732B" : L"\xD83D\xDE00");
+                        x += 2;
+                    }
+                    else
+                    {
+                        text.push_back(static_cast<wchar_t>(L'a' + random() % 26));
+                        x++;
+                    }
+                    break;
+                }
+            }
+
+            text.append(L"\x1b[m");
+        }
+
+        sm.ProcessString(text);
+
+        MockPaintRenderEngine engine{ { ViewWidth, ViewHeight } };
+        Renderer renderer{ gci.GetRenderSettings(), &gci.renderData, nullptr, 0, nullptr };
+        renderer.AddRenderEngine(&engine);
+
+        // Warm up the Renderer's and the engine's buffers, and make sure each column is painted exactly once.
+        VERIFY_SUCCEEDED(renderer.PaintFrame());
+        VERIFY_ARE_EQUAL(size_t{ ViewWidth * ViewHeight }, engine.columns);
+
+        engine.ResetCounters();
+
+        static constexpr size_t frames = 1000;
+        const auto beg = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < frames; ++i)
+        {
+            VERIFY_SUCCEEDED(renderer.PaintFrame());
+        }
+        const auto end = std::chrono::steady_clock::now();
+        const auto us = std::chrono::duration<double, std::micro>(end - beg).count();
+
+        Log::Comment(NoThrowString().Format(L"%.2f us/frame", us / frames));
+        Log::Comment(NoThrowString().Format(L"%.2f ns/cell", us * 1000 / (frames * ViewWidth * ViewHeight)));
+        Log::Comment(NoThrowString().Format(L"%zu brush changes, %zu PaintBufferLine calls, %zu clusters per frame", engine.brushes / frames, engine.lines / frames, engine.clusters / frames));
+    }
+
+private:
+    std::unique_ptr<CommonState> m_state;
+};
@@ -3,6 +3,8 @@
 
 #include "precomp.h"
 
+#include <chrono>
+
 #include <til/hash.h>
 
 #include "WexTestClass.h"
@@ -141,12 +143,28 @@ class TextBufferTests
 
     TEST_METHOD(ResizeTraditionalRotationPreservesHighUnicode);
     TEST_METHOD(ScrollBufferRotationPreservesHighUnicode);
+    TEST_METHOD(ScrollRowsAcrossCircularBufferWrap);
+
+    BEGIN_TEST_METHOD(TestScrollRowsThroughput)
+        TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+        TEST_METHOD_PROPERTY(L"Data:scrollback", L"{100, 9001, 32000}")
+    END_TEST_METHOD()
 
     TEST_METHOD(ResizeTraditionalHighUnicodeRowRemoval);
     TEST_METHOD(ResizeTraditionalHighUnicodeColumnRemoval);
 
     TEST_METHOD(TestBurrito);
     TEST_METHOD(TestOverwriteChars);
+    TEST_METHOD(TestWriteAsciiRun);
+    TEST_METHOD(TestWriteGlyphs);
+    TEST_METHOD(TestAttributeTableCompaction);
+    TEST_METHOD(TestScrollbackFreezing);
+    TEST_METHOD(TestRowGenerations);
+    TEST_METHOD(TestSearchText);
+
+    BEGIN_TEST_METHOD(TestSearchTextThroughput)
+        TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+    END_TEST_METHOD()
 
     TEST_METHOD(TestAppendRTFText);
 
@@ -1909,6 +1927,74 @@ void TextBufferTests::ScrollBufferRotationPreservesHighUnicode()
     VERIFY_ARE_EQUAL(String(fire), String(shouldBeFireText.data(), gsl::narrow<int>(shouldBeFireText.size())));
 }
 
+// This tests that scrolling a region works when the region straddles the end of the circular buffer storage.
+void TextBufferTests::ScrollRowsAcrossCircularBufferWrap()
+{
+    const til::size bufferSize{ 10, 10 };
+    const TextAttribute attr{ 0x7f };
+    TextBuffer buffer{ bufferSize, attr, 12, false, _renderer };
+
+    // Move the first row close to the end of the storage, such
+    // that the rows 3 and onwards wrap around to the beginning.
+    for (auto i = 0; i < 7; ++i)
+    {
+        VERIFY_IS_TRUE(buffer.IncrementCircularBuffer());
+    }
+    VERIFY_ARE_EQUAL(7, buffer.GetFirstRowIndex());
+
+    const auto label = [&](const std::wstring_view& text) {
+        for (til::CoordType y = 0; y < bufferSize.height; ++y)
+        {
+            buffer.GetRowByOffset(y).ReplaceCharacters(0, 1, text.substr(y, 1));
+        }
+    };
+    const auto labels = [&]() {
+        std::wstring text;
+        for (til::CoordType y = 0; y < bufferSize.height; ++y)
+        {
+            text.push_back(buffer.GetRowByOffset(y).GlyphAt(0).front());
+        }
+        return text;
+    };
+
+    label(L"0123456789");
+    buffer.ScrollRows(4, 4, -2);
+    VERIFY_ARE_EQUAL(L"0145672389", labels());
+
+    label(L"0123456789");
+    buffer.ScrollRows(1, 5, 3);
+    VERIFY_ARE_EQUAL(L"0678123459", labels());
+
+    // Scrolling must not reorder the circular buffer as a whole.
+    VERIFY_ARE_EQUAL(7, buffer.GetFirstRowIndex());
+}
+
+void TextBufferTests::TestScrollRowsThroughput()
+{
+    int scrollback = 100;
+    TestData::TryGetValue(L"scrollback", scrollback);
+
+    const til::size bufferSize{ 120, scrollback };
+    const TextAttribute attr{ 0x7f };
+    TextBuffer buffer{ bufferSize, attr, 12, false, _renderer };
+
+    // Scroll a 30 row margin region at the bottom of the buffer, the way a TUI
+    // with a status line would, while the circular buffer isn't at its origin.
+    VERIFY_IS_TRUE(buffer.IncrementCircularBuffer());
+    const auto top = scrollback - 31;
+    static constexpr auto iterations = 10000;
+
+    const auto beg = std::chrono::steady_clock::now();
+    for (auto i = 0; i < iterations; ++i)
+    {
+        buffer.ScrollRows(top + 1, 29, -1);
+    }
+    const auto end = std::chrono::steady_clock::now();
+    const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - beg).count();
+
+    Log::Comment(String().Format(L"%d rows: %lld ns per scroll", scrollback, ns / iterations));
+}
+
 // This tests that rows removed from the buffer while resizing traditionally will also drop the high unicode
 // characters from the Unicode Storage buffer
 void TextBufferTests::ResizeTraditionalHighUnicodeRowRemoval()
@@ -2046,6 +2132,410 @@ void TextBufferTests::TestOverwriteChars()
 #undef complex1
 }
 
+void TextBufferTests::TestWriteAsciiRun()
+{
+    til::size bufferSize{ 10, 3 };
+    UINT cursorSize = 12;
+    TextAttribute attr{ 0x7f };
+    TextAttribute runAttr{ 0x1e };
+    TextBuffer buffer{ bufferSize, attr, cursorSize, false, _renderer };
+    auto& row = buffer.GetRowByOffset(0);
+
+// scientist emoji U+1F9D1 U+200D U+1F52C
+#define complex1 L"\U0001F9D1\U0000200D\U0001F52C"
+
+    Log::Comment(L"Writing a run stops at the given right limit.");
+    VERIFY_ARE_EQUAL(4, buffer.WriteAsciiRun(L"abcdefgh", { 2, 0 }, runAttr, std::nullopt, 5));
+    VERIFY_ARE_EQUAL(L"  abcd    ", row.GetText());
+    VERIFY_ARE_EQUAL(attr, row.GetAttrByColumn(1));
+    VERIFY_ARE_EQUAL(runAttr, row.GetAttrByColumn(2));
+    VERIFY_ARE_EQUAL(runAttr, row.GetAttrByColumn(5));
+    VERIFY_ARE_EQUAL(attr, row.GetAttrByColumn(6));
+    VERIFY_IS_FALSE(row.WasWrapForced());
+
+    Log::Comment(L"Partially overwritten wide glyphs are replaced with whitespace.");
+    row.ReplaceCharacters(0, 2, complex1);
+    row.ReplaceCharacters(8, 2, complex1);
+    VERIFY_ARE_EQUAL(complex1 L"abcd  " complex1, row.GetText());
+    VERIFY_ARE_EQUAL(8, row.WriteAsciiRun(1, L"ABCDEFGH", runAttr));
+    VERIFY_ARE_EQUAL(L" ABCDEFGH ", row.GetText());
+    for (til::CoordType col = 0; col < 10; ++col)
+    {
+        VERIFY_ARE_EQUAL(DbcsAttribute::Single, row.DbcsAttrAt(col));
+        VERIFY_ARE_EQUAL(row.GetText().substr(col, 1), row.GlyphAt(col));
+    }
+
+    Log::Comment(L"Filling the last column sets the wrap flag if asked to.");
+    VERIFY_ARE_EQUAL(3, row.WriteAsciiRun(7, L"xyz", runAttr, true));
+    VERIFY_ARE_EQUAL(L" ABCDEFxyz", row.GetText());
+    VERIFY_IS_TRUE(row.WasWrapForced());
+
+    Log::Comment(L"Writing outside of the limit is a no-op.");
+    VERIFY_ARE_EQUAL(0, row.WriteAsciiRun(6, L"123", runAttr, false, 5));
+    VERIFY_ARE_EQUAL(L" ABCDEFxyz", row.GetText());
+    VERIFY_IS_TRUE(row.WasWrapForced());
+
+    Log::Comment(L"Writing stops at the first character that isn't printable ASCII.");
+    VERIFY_ARE_EQUAL(2, row.WriteAsciiRun(0, L"12\u00e934", runAttr));
+    VERIFY_ARE_EQUAL(L"12BCDEFxyz", row.GetText());
+    VERIFY_ARE_EQUAL(0, row.WriteAsciiRun(0, L"\u00e934", runAttr));
+    VERIFY_ARE_EQUAL(0, row.WriteAsciiRun(0, L"\t34", runAttr));
+    VERIFY_ARE_EQUAL(L"12BCDEFxyz", row.GetText());
+
+#undef complex1
+}
+
+void TextBufferTests::TestWriteGlyphs()
+{
+    til::size bufferSize{ 10, 3 };
+    UINT cursorSize = 12;
+    TextAttribute attr{ 0x7f };
+    TextAttribute runAttr{ 0x1e };
+    TextBuffer buffer{ bufferSize, attr, cursorSize, false, _renderer };
+    const auto& row = buffer.GetRowByOffset(0);
+
+// grinning face U+1F600, a wide glyph consisting of a surrogate pair
+#define emoji L"\U0001F600"
+
+    Log::Comment(L"Narrow, wide and surrogate pair glyphs are written in one go.");
+    til::CoordType columns = 0;
+    VERIFY_ARE_EQUAL(6u, buffer.WriteGlyphs(L"a\u3042b" emoji L"c", { 1, 0 }, runAttr, columns));
+    VERIFY_ARE_EQUAL(7, columns);
+    VERIFY_ARE_EQUAL(L" a\u3042b" emoji L"c  ", row.GetText());
+    VERIFY_ARE_EQUAL(DbcsAttribute::Single, row.DbcsAttrAt(1));
+    VERIFY_ARE_EQUAL(DbcsAttribute::Leading, row.DbcsAttrAt(2));
+    VERIFY_ARE_EQUAL(DbcsAttribute::Trailing, row.DbcsAttrAt(3));
+    VERIFY_ARE_EQUAL(L"b", row.GlyphAt(4));
+    VERIFY_ARE_EQUAL(emoji, row.GlyphAt(5));
+    VERIFY_ARE_EQUAL(emoji, row.GlyphAt(6));
+    VERIFY_ARE_EQUAL(L"c", row.GlyphAt(7));
+    VERIFY_ARE_EQUAL(attr, row.GetAttrByColumn(0));
+    VERIFY_ARE_EQUAL(runAttr, row.GetAttrByColumn(1));
+    VERIFY_ARE_EQUAL(runAttr, row.GetAttrByColumn(7));
+    VERIFY_ARE_EQUAL(attr, row.GetAttrByColumn(8));
+
+    Log::Comment(L"Partially overwritten wide glyphs are replaced with whitespace.");
+    VERIFY_ARE_EQUAL(1u, buffer.WriteGlyphs(L"x", { 3, 0 }, runAttr, columns));
+    VERIFY_ARE_EQUAL(1, columns);
+    VERIFY_ARE_EQUAL(L" a xb" emoji L"c  ", row.GetText());
+
+    Log::Comment(L"A wide glyph that doesn't fit into the last column is padded, just like WriteLine() does.");
+    VERIFY_ARE_EQUAL(1u, buffer.WriteGlyphs(L"y\u3042", { 8, 0 }, runAttr, columns, true));
+    VERIFY_ARE_EQUAL(1, columns);
+    VERIFY_ARE_EQUAL(L" a xb" emoji L"cy ", row.GetText());
+    VERIFY_IS_TRUE(row.WasDoubleBytePadded());
+    VERIFY_IS_TRUE(row.WasWrapForced());
+    VERIFY_ARE_EQUAL(runAttr, row.GetAttrByColumn(9));
+
+    Log::Comment(L"Writing outside of the limit is a no-op.");
+    VERIFY_ARE_EQUAL(0u, buffer.WriteGlyphs(L"\u3042", { 6, 0 }, runAttr, columns, false, 5));
+    VERIFY_ARE_EQUAL(0, columns);
+    VERIFY_ARE_EQUAL(L" a xb" emoji L"cy ", row.GetText());
+
+#undef emoji
+}
+
+void TextBufferTests::TestRowGenerations()
+{
+    TextBuffer buffer{ { 10, 5 }, TextAttribute{ 0x7 }, 12, false, _renderer };
+
+    const auto initial = buffer.GetGeneration();
+    VERIFY_IS_FALSE(buffer.RowsChangedSince(0, 4, initial));
+
+    Log::Comment(L"Writing to a row only marks that row as changed.");
+    buffer.WriteAsciiRun(L"abc", { 0, 2 }, TextAttribute{ 0x7 });
+    VERIFY_IS_TRUE(buffer.GetRowGeneration(2) > initial);
+    VERIFY_IS_FALSE(buffer.GetRowGeneration(1) > initial);
+    VERIFY_IS_FALSE(buffer.GetRowGeneration(3) > initial);
+    VERIFY_IS_FALSE(buffer.RowsChangedSince(0, 1, initial));
+    VERIFY_IS_FALSE(buffer.RowsChangedSince(3, 4, initial));
+    VERIFY_IS_TRUE(buffer.RowsChangedSince(0, 4, initial));
+
+    Log::Comment(L"Reading from the buffer doesn't change anything.");
+    const auto written = buffer.GetGeneration();
+    VERIFY_ARE_EQUAL(L"abc", std::as_const(buffer).GetRowByOffset(2).GetText().substr(0, 3));
+    VERIFY_ARE_EQUAL(written, buffer.GetGeneration());
+    VERIFY_IS_FALSE(buffer.RowsChangedSince(0, 4, written));
+
+    Log::Comment(L"Neither does mutable access to a row, as long as it isn't modified.");
+    VERIFY_ARE_EQUAL(L"abc", buffer.GetRowByOffset(2).GetText().substr(0, 3));
+    buffer.GetRowByOffset(3).SetWrapForced(false);
+    VERIFY_ARE_EQUAL(written, buffer.GetGeneration());
+    VERIFY_IS_FALSE(buffer.RowsChangedSince(0, 4, written));
+
+    Log::Comment(L"Scrolling a region marks the rows it moved as changed.");
+    buffer.ScrollRows(1, 2, 1);
+    VERIFY_IS_FALSE(buffer.RowsChangedSince(0, 0, written));
+    VERIFY_IS_TRUE(buffer.RowsChangedSince(1, 1, written));
+    VERIFY_IS_TRUE(buffer.RowsChangedSince(3, 3, written));
+    VERIFY_IS_FALSE(buffer.RowsChangedSince(4, 4, written));
+
+    Log::Comment(L"Cycling the buffer only changes the recycled row. The others keep their generation at their new offset.");
+    const auto scrolled = buffer.GetGeneration();
+    const auto firstRow = buffer.GetFirstRowIndex();
+    const auto row3 = buffer.GetRowGeneration(3);
+    VERIFY_IS_TRUE(buffer.IncrementCircularBuffer());
+    VERIFY_IS_TRUE(buffer.GetGeneration() > scrolled);
+    VERIFY_ARE_NOT_EQUAL(firstRow, buffer.GetFirstRowIndex());
+    VERIFY_ARE_EQUAL(row3, buffer.GetRowGeneration(2));
+    VERIFY_IS_FALSE(buffer.RowsChangedSince(0, 3, scrolled));
+    VERIFY_IS_TRUE(buffer.GetRowGeneration(4) > scrolled);
+}
+
+void TextBufferTests::TestSearchText()
+{
+    til::size bufferSize{ 10, 4 };
+    UINT cursorSize = 12;
+    TextAttribute attr{ 0x7f };
+    TextBuffer buffer{ bufferSize, attr, cursorSize, false, _renderer };
+
+    buffer.WriteAsciiRun(L"foo bar fo", { 0, 0 }, attr, true);
+    buffer.WriteAsciiRun(L"o FOO", { 0, 1 }, attr);
+    buffer.GetRowByOffset(2).ReplaceCharacters(0, 2, L"\x30a2");
+    buffer.WriteAsciiRun(L"foo", { 2, 2 }, attr);
+
+    const auto verifySpan = [](const til::point_span& span, til::point start, til::point end) {
+        VERIFY_ARE_EQUAL(start, span.start);
+        VERIFY_ARE_EQUAL(end, span.end);
+    };
+
+    Log::Comment(L"Case-sensitive matches may cross wrapped row boundaries.");
+    const auto sensitive = buffer.SearchText(L"foo", false);
+    VERIFY_ARE_EQUAL(3u, sensitive->size());
+    verifySpan(sensitive->at(0), { 0, 0 }, { 2, 0 });
+    verifySpan(sensitive->at(1), { 8, 0 }, { 0, 1 });
+    verifySpan(sensitive->at(2), { 2, 2 }, { 4, 2 });
+
+    Log::Comment(L"Case-insensitive matches include the upper-case occurrence.");
+    const auto insensitive = buffer.SearchText(L"foo", true);
+    VERIFY_ARE_EQUAL(4u, insensitive->size());
+    verifySpan(insensitive->at(2), { 2, 1 }, { 4, 1 });
+
+    Log::Comment(L"A match on a wide glyph spans both of its columns.");
+    const auto wide = buffer.SearchText(L"\x30a2" L"f", false);
+    VERIFY_ARE_EQUAL(1u, wide->size());
+    verifySpan(wide->at(0), { 0, 2 }, { 2, 2 });
+
+    Log::Comment(L"Repeated searches are served from the cache until the buffer changes.");
+    const auto generation = buffer.GetGeneration();
+    VERIFY_ARE_EQUAL(wide.get(), buffer.SearchText(L"\x30a2" L"f", false).get());
+    VERIFY_IS_FALSE(buffer.GetRowByOffset(3).ContainsText());
+    VERIFY_ARE_EQUAL(wide.get(), buffer.SearchText(L"\x30a2" L"f", false).get());
+    buffer.WriteAsciiRun(L"xyz", { 2, 2 }, attr);
+    VERIFY_ARE_NOT_EQUAL(generation, buffer.GetGeneration());
+    VERIFY_ARE_EQUAL(0u, buffer.SearchText(L"\x30a2" L"f", false)->size());
+}
+
+void TextBufferTests::TestSearchTextThroughput()
+{
+    til::size bufferSize{ 120, 10000 };
+    UINT cursorSize = 12;
+    TextAttribute attr{ 0x7f };
+    TextBuffer buffer{ bufferSize, attr, cursorSize, false, _renderer };
+
+    std::wstring line;
+    for (til::CoordType y = 0; y < bufferSize.height; ++y)
+    {
+        line.clear();
+        while (line.size() < gsl::narrow_cast<size_t>(bufferSize.width))
+        {
+            line.append(y % 100 == 0 ? L"needle " : L"lorem ipsum dolor sit amet ");
+        }
+        buffer.WriteAsciiRun(line, { 0, y }, attr);
+    }
+
+    for (const auto caseInsensitive : { false, true })
+    {
+        const auto beg = std::chrono::steady_clock::now();
+        const auto results = buffer.SearchText(L"NEEDLE", caseInsensitive);
+        const auto end = std::chrono::steady_clock::now();
+        const auto us = std::chrono::duration_cast<std::chrono::microseconds>(end - beg).count();
+
+        Log::Comment(String().Format(L"caseInsensitive=%d: %zu matches in %lld us", caseInsensitive, results->size(), us));
+        VERIFY_ARE_EQUAL(caseInsensitive ? 100u * 17u : 0u, results->size());
+    }
+}
+
+void TextBufferTests::TestAttributeTableCompaction()
+{
+    til::size bufferSize{ 40, 20 };
+    UINT cursorSize = 12;
+    TextAttribute attr{ 0x7f };
+    TextBuffer buffer{ bufferSize, attr, cursorSize, false, _renderer };
+
+    // Identical attributes share a single entry.
+    buffer.WriteAsciiRun(L"abc", { 0, 0 }, attr);
+    buffer.WriteAsciiRun(L"def", { 0, 1 }, attr);
+    VERIFY_ARE_EQUAL(1u, buffer._attributeTable.size());
+
+    // Overwrite every cell with a distinct color a couple times. The colors of the
+    // previous passes aren't used anymore and should get dropped from the table.
+    static constexpr auto passes = 5;
+    const auto colorAt = [](til::CoordType x, til::CoordType y, int pass) {
+        TextAttribute color;
+        color.SetForeground(RGB(x, y, pass));
+        return color;
+    };
+    for (auto pass = 0; pass < passes; ++pass)
+    {
+        for (til::CoordType y = 0; y < bufferSize.height; ++y)
+        {
+            for (til::CoordType x = 0; x < bufferSize.width; ++x)
+            {
+                buffer.WriteAsciiRun(L"x", { x, y }, colorAt(x, y, pass));
+            }
+        }
+    }
+    VERIFY_IS_LESS_THAN(buffer._attributeTable.size(), bufferSize.area<size_t>() * passes);
+
+    // The rows must still resolve to the attributes of the last pass.
+    for (til::CoordType y = 0; y < bufferSize.height; ++y)
+    {
+        const auto& row = buffer.GetRowByOffset(y);
+        for (til::CoordType x = 0; x < bufferSize.width; ++x)
+        {
+            VERIFY_ARE_EQUAL(colorAt(x, y, passes - 1), row.GetAttrByColumn(x));
+        }
+    }
+
+    // A compaction that frees nothing must not be repeated right away.
+    {
+        auto& table = buffer._attributeTable;
+        std::vector<bool> live(table.size(), true);
+        table.Compact(live);
+        const auto size = table.size();
+        VERIFY_IS_FALSE(table.ShouldCompact());
+        for (size_t i = 0; !table.ShouldCompact(); ++i)
+        {
+            TextAttribute fresh;
+            fresh.SetBackground(RGB(i & 0xff, (i >> 8) & 0xff, 0xff));
+            table.Intern(fresh);
+        }
+        VERIFY_IS_GREATER_THAN_OR_EQUAL(table.size(), size * 2);
+    }
+
+    // Rows intern attributes no matter which method modifies them, so compaction
+    // doesn't depend on going through TextBuffer. Each pass writes 40960 distinct
+    // attributes, so the two passes together need IDs beyond 16 bits, and the
+    // table has to be compacted in the middle of a write.
+    TextBuffer large{ { 256, 160 }, attr, cursorSize, false, _renderer };
+    for (auto pass = 0; pass < 2; ++pass)
+    {
+        for (til::CoordType y = 0; y < 160; ++y)
+        {
+            auto& row = large.GetRowByOffset(y);
+            for (til::CoordType x = 0; x < 256; ++x)
+            {
+                row.ReplaceAttributes(x, x + 1, colorAt(x, y, pass));
+            }
+        }
+    }
+    size_t mismatches = 0;
+    for (til::CoordType y = 0; y < 160; ++y)
+    {
+        const auto& row = large.GetRowByOffset(y);
+        for (til::CoordType x = 0; x < 256; ++x)
+        {
+            mismatches += colorAt(x, y, 1) != row.GetAttrByColumn(x);
+        }
+    }
+    VERIFY_ARE_EQUAL(0u, mismatches);
+}
+
+void TextBufferTests::TestScrollbackFreezing()
+{
+    // 5000 rows of 200 columns take up about 4 MB.
+    til::size bufferSize{ 200, 5000 };
+    UINT cursorSize = 12;
+    TextAttribute attr{ 0x7f };
+    TextBuffer buffer{ bufferSize, attr, cursorSize, false, _renderer };
+    const auto& constBuffer = buffer;
+
+    // The rows cover all parts of the compressed format: ASCII text, repetitions of ASCII and non-ASCII
+    // characters, a run of more than 64 distinct non-ASCII characters and non-trivial char offsets.
+    const auto glyphsOf = [&](const ROW& row) {
+        std::wstring glyphs;
+        for (til::CoordType x = 0; x < bufferSize.width; ++x)
+        {
+            glyphs.append(row.GlyphAt(x)).push_back(L'|');
+        }
+        return glyphs;
+    };
+    std::vector<std::wstring> expected;
+    for (til::CoordType y = 0; y < 100; ++y)
+    {
+        auto& row = buffer.GetRowByOffset(y);
+        const TextAttribute color{ gsl::narrow_cast<WORD>(y % 15 + 1) };
+        auto x = row.WriteAsciiRun(0, L"row " + std::to_wstring(y) + L" ", color);
+        x += row.WriteAsciiRun(x, std::wstring(20, L'='), color);
+        for (auto i = 0; i < 10; ++i, ++x)
+        {
+            row.ReplaceCharacters(x, 1, L"\x2500");
+        }
+        row.ReplaceCharacters(x, 2, L"\x304a");
+        row.ReplaceCharacters(x + 2, 2, L"\xD83D\xDD25");
+        x += 4;
+        for (auto i = 0; i < 70; ++i, ++x)
+        {
+            const wchar_t greek = gsl::narrow_cast<wchar_t>(0x3b1 + (y + i) % 25);
+            row.ReplaceCharacters(x, 1, { &greek, 1 });
+        }
+        row.SetWrapForced(y % 2 == 0);
+        expected.emplace_back(glyphsOf(row));
+    }
+    buffer.GetCursor().SetPosition({ 0, bufferSize.height - 1 });
+
+    const auto unlimited = buffer.GetMemoryUsage();
+    VERIFY_IS_GREATER_THAN(unlimited, size_t{ 4'000'000 });
+
+    // Rows are only frozen when the owner of the buffer asks for it,
+    // and each call only visits a limited number of rows.
+    static constexpr size_t limit = 1024 * 1024;
+    buffer.SetMemoryLimit(1);
+    VERIFY_ARE_EQUAL(unlimited, buffer.GetMemoryUsage());
+    for (auto i = 0; i < 10 && buffer.GetMemoryUsage() > limit; ++i)
+    {
+        buffer.FreezeRows(bufferSize.height - 1024);
+    }
+    VERIFY_IS_LESS_THAN_OR_EQUAL(buffer.GetMemoryUsage(), limit);
+    VERIFY_IS_TRUE(constBuffer.GetRowByOffset(0).IsFrozen());
+    VERIFY_IS_FALSE(constBuffer.GetRowByOffset(bufferSize.height - 1024).IsFrozen());
+
+    // Frozen rows read as blank through the const accessors, but keep their attributes and flags.
+    {
+        const auto& row = constBuffer.GetRowByOffset(1);
+        VERIFY_ARE_EQUAL(std::wstring(bufferSize.width, L' '), std::wstring{ row.GetText() });
+        VERIFY_ARE_EQUAL(TextAttribute{ 2 }, row.GetAttrByColumn(0));
+        VERIFY_IS_FALSE(row.WasWrapForced());
+    }
+
+    // ThawRows() and the non-const GetRowByOffset() restore the rows unchanged.
+    buffer.ThawRows(0, 50);
+    for (til::CoordType y = 0; y < 100; ++y)
+    {
+        const auto& row = y < 50 ? constBuffer.GetRowByOffset(y) : buffer.GetRowByOffset(y);
+        VERIFY_IS_FALSE(row.IsFrozen());
+        VERIFY_ARE_EQUAL(til::at(expected, y), glyphsOf(row));
+        VERIFY_ARE_EQUAL(y % 2 == 0, row.WasWrapForced());
+        VERIFY_ARE_EQUAL(TextAttribute{ gsl::narrow_cast<WORD>(y % 15 + 1) }, row.GetAttrByColumn(0));
+    }
+
+    // Rows that scroll out of the buffer are discarded without being thawed.
+    const auto frozen = buffer.GetMemoryUsage();
+    VERIFY_IS_TRUE(constBuffer.GetRowByOffset(100).IsFrozen());
+    for (auto i = 0; i < 101; ++i)
+    {
+        VERIFY_IS_TRUE(buffer.IncrementCircularBuffer());
+    }
+    VERIFY_IS_LESS_THAN_OR_EQUAL(buffer.GetMemoryUsage(), frozen);
+    VERIFY_IS_FALSE(constBuffer.GetRowByOffset(bufferSize.height - 1).IsFrozen());
+
+    // Lifting the limit thaws everything.
+    buffer.SetMemoryLimit(0);
+    VERIFY_ARE_EQUAL(unlimited, buffer.GetMemoryUsage());
+    VERIFY_IS_FALSE(constBuffer.GetRowByOffset(1000).IsFrozen());
+}
+
 void TextBufferTests::TestAppendRTFText()
 {
     {
@@ -37,6 +37,7 @@ class Microsoft::Console::VirtualTerminal::VtIoTests
     TEST_METHOD(DtorTestStackAllocMany);
 
     TEST_METHOD(RendererDtorAndThread);
+    TEST_METHOD(RenderThreadPaintsInputEchoRightAway);
 
 #if TIL_FEATURE_CONHOSTDXENGINE_ENABLED
     TEST_METHOD(RendererDtorAndThreadAndDx);
@@ -423,6 +424,54 @@ void VtIoTests::RendererDtorAndThread()
     }
 }
 
+void VtIoTests::RenderThreadPaintsInputEchoRightAway()
+{
+    auto data = std::make_unique<MockRenderData>();
+    auto thread = std::make_unique<Microsoft::Console::Render::RenderThread>();
+    auto* pThread = thread.get();
+    auto pRenderer = std::make_unique<Microsoft::Console::Render::Renderer>(RenderSettings{}, data.get(), nullptr, 0, std::move(thread));
+    VERIFY_SUCCEEDED(pThread->Initialize(pRenderer.get()));
+    pThread->EnablePainting();
+
+    // We only wait for the render thread to get around to painting.
+    // How the frames were paced is checked through the statistics.
+    const auto waitForFrames = [&](const uint64_t frames) {
+        for (auto i = 0; i < 5000 && pRenderer->GetFrameStatistics().paintedFrames < frames; ++i)
+        {
+            Sleep(1);
+        }
+        return pRenderer->GetFrameStatistics();
+    };
+
+    Log::Comment(L"The first frame has no previous one to be paced against.");
+    pRenderer->NotifyPaintFrame();
+    auto stats = waitForFrames(1);
+    VERIFY_ARE_EQUAL(uint64_t{ 1 }, stats.paintedFrames);
+    VERIFY_ARE_EQUAL(uint64_t{ 0 }, stats.pacedFrames);
+    VERIFY_ARE_EQUAL(uint64_t{ 0 }, stats.inputFrames);
+    VERIFY_IS_TRUE(stats.inputLatency.empty());
+    VERIFY_IS_GREATER_THAN(stats.frameInterval.count(), 0);
+
+    Log::Comment(L"The frame after input skips the pacing wait and yields a latency sample.");
+    pRenderer->NotifyInput();
+    pRenderer->NotifyPaintFrame();
+    stats = waitForFrames(2);
+    VERIFY_ARE_EQUAL(uint64_t{ 2 }, stats.paintedFrames);
+    VERIFY_ARE_EQUAL(uint64_t{ 0 }, stats.pacedFrames);
+    VERIFY_ARE_EQUAL(uint64_t{ 1 }, stats.inputFrames);
+    VERIFY_ARE_EQUAL(size_t{ 1 }, stats.inputLatency.size());
+
+    Log::Comment(L"The input was consumed by that frame. The next one isn't attributed to it.");
+    pRenderer->NotifyPaintFrame();
+    stats = waitForFrames(3);
+    VERIFY_ARE_EQUAL(uint64_t{ 3 }, stats.paintedFrames);
+    VERIFY_ARE_EQUAL(uint64_t{ 1 }, stats.inputFrames);
+    VERIFY_ARE_EQUAL(size_t{ 1 }, stats.inputLatency.size());
+
+    pRenderer->TriggerTeardown();
+    pRenderer.reset();
+}
+
 #if TIL_FEATURE_CONHOSTDXENGINE_ENABLED
 void VtIoTests::RendererDtorAndThreadAndDx()
 {
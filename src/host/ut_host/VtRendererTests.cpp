@@ -83,6 +83,8 @@ class Microsoft::Console::Render::VtRendererTest
 
     TEST_METHOD(TestCursorVisibility);
 
+    TEST_METHOD(PipeWriterPreservesOrderAndReportsErrors);
+
     void Test16Colors(VtEngine* engine);
 
     std::deque<std::string> qExpectedInput;
@@ -1594,3 +1596,54 @@ void VtRendererTest::FormattedString()
     qExpectedInput.push_back("\x1b[28;3;500;500;500m");
     VERIFY_SUCCEEDED(engine->_WriteFormatted(bigFormat, bigValue, bigValue, bigValue));
 }
+
+void VtRendererTest::PipeWriterPreservesOrderAndReportsErrors()
+{
+    wil::unique_hfile readPipe;
+    wil::unique_hfile writePipe;
+    VERIFY_WIN32_BOOL_SUCCEEDED(CreatePipe(readPipe.addressof(), writePipe.addressof(), nullptr, 0));
+
+    VtPipeWriter writer{ writePipe.get() };
+
+    // Reads exactly the given number of bytes from the other end of the pipe.
+    const auto read = [&](const size_t count) {
+        std::string result(count, '\0');
+        size_t offset = 0;
+        while (offset < count)
+        {
+            DWORD dwRead = 0;
+            VERIFY_WIN32_BOOL_SUCCEEDED(ReadFile(readPipe.get(), result.data() + offset, gsl::narrow_cast<DWORD>(count - offset), &dwRead, nullptr));
+            offset += dwRead;
+        }
+        return result;
+    };
+
+    Log::Comment(L"1.) Everything that's submitted arrives, in order.");
+    std::string buffer = "\x1b[H";
+    VERIFY_SUCCEEDED(writer.Submit(buffer));
+    VERIFY_IS_TRUE(buffer.empty());
+    buffer = "Hello, World!";
+    VERIFY_SUCCEEDED(writer.Submit(buffer));
+    VERIFY_IS_TRUE(buffer.empty());
+    VERIFY_ARE_EQUAL(std::string{ "\x1b[HHello, World!" }, read(16));
+
+    VERIFY_SUCCEEDED(writer.Drain());
+    VERIFY_ARE_EQUAL(uint64_t{ 16 }, writer.GetStatistics().bytesWritten);
+
+    Log::Comment(L"2.) Without a high-water mark, Submit waits until the writer picked the bytes up.");
+    writer.SetHighWaterMark(0);
+    buffer = "\x1b[2J";
+    VERIFY_SUCCEEDED(writer.Submit(buffer));
+    VERIFY_ARE_EQUAL(std::string{ "\x1b[2J" }, read(4));
+    VERIFY_SUCCEEDED(writer.Drain());
+
+    Log::Comment(L"3.) Once the terminal went away, the write error is returned.");
+    readPipe.reset();
+    buffer = "\x1b[?25h";
+    std::ignore = writer.Submit(buffer);
+    VERIFY_FAILED(writer.Drain());
+
+    buffer = "\x1b[?25l";
+    VERIFY_FAILED(writer.Submit(buffer));
+    VERIFY_IS_TRUE(buffer.empty());
+}
@@ -13,7 +13,10 @@ Tests have been made in order to investigate whether or not own algorithms
 could overcome disadvantages of syscalls. Test results can be read up
 in PR #4093 and the test algorithms are available in src\tools\U8U16Test.
 Based on the results the decision was made to keep using the platform
-functions MultiByteToWideChar and WideCharToMultiByte.
+function WideCharToMultiByte for UTF-16 to UTF-8 conversions.
+The UTF-8 to UTF-16 direction is on the hot path of the conpty output and
+uses the self-contained details::u8u16_transcode, which widens ASCII runs
+16 or 32 bytes at a time and only decodes multibyte sequences individually.
 
 Author(s):
 - Steffen Illhardt (german-one), Leonard Hecker (lhecker) 2020-2021
@@ -23,6 +26,127 @@ Author(s):
 
 namespace til // Terminal Implementation Library. Also: "Today I Learned"
 {
+    namespace details
+    {
+#pragma warning(push)
+#pragma warning(disable : 26481 26490) // Don't use pointer arithmetic. Don't use reinterpret_cast.
+        // Routine Description:
+        // - Converts UTF-8 into UTF-16 without any OS calls. Invalid sequences are replaced
+        //   with U+FFFD REPLACEMENT CHARACTER, one per maximal subpart of an ill-formed
+        //   sequence (the Unicode "best practice", which MultiByteToWideChar follows as well).
+        //   Incomplete sequences at the end of the input are treated as invalid.
+        //   The caller is responsible for caching partials (see u8state).
+        // Arguments:
+        // - in - pointer to the UTF-8 code units
+        // - length - number of UTF-8 code units
+        // - out - pointer to the output buffer, which must have room for at least `length` UTF-16 code units
+        // Return Value:
+        // - The number of UTF-16 code units written to `out`.
+        inline size_t u8u16_transcode(const char* in, const size_t length, wchar_t* out) noexcept
+        {
+            auto it = reinterpret_cast<const uint8_t*>(in);
+            const auto end = it + length;
+            auto dst = out;
+
+            while (it != end)
+            {
+                // ASCII fast path: Widen entire vectors at once as long as none of the bytes has its MSB set.
+#if defined(__AVX2__)
+                for (; end - it >= 32; it += 32, dst += 32)
+                {
+                    const auto vec = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(it));
+                    if (_mm256_movemask_epi8(vec))
+                    {
+                        break;
+                    }
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), _mm256_cvtepu8_epi16(_mm256_castsi256_si128(vec)));
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 16), _mm256_cvtepu8_epi16(_mm256_extracti128_si256(vec, 1)));
+                }
+#elif defined(_M_AMD64)
+                for (; end - it >= 16; it += 16, dst += 16)
+                {
+                    const auto vec = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+                    if (_mm_movemask_epi8(vec))
+                    {
+                        break;
+                    }
+                    const auto zero = _mm_setzero_si128();
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_unpacklo_epi8(vec, zero));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 8), _mm_unpackhi_epi8(vec, zero));
+                }
+#endif
+
+                // Copy the ASCII prefix of the current vector (or all ASCII on other platforms).
+                for (; it != end && *it < 0x80; ++it, ++dst)
+                {
+                    *dst = static_cast<wchar_t>(*it);
+                }
+
+                // Decode and validate multibyte sequences until we hit the next ASCII character.
+                while (it != end && *it >= 0x80)
+                {
+                    const auto lead = *it++;
+                    char32_t cp = 0xFFFD;
+
+                    if (lead >= 0xC2 && lead <= 0xF4)
+                    {
+                        // The valid range of the first continuation byte depends on the lead byte.
+                        // This rejects overlong encodings, surrogates and code points beyond U+10FFFF.
+                        uint8_t lo = 0x80;
+                        uint8_t hi = 0xBF;
+                        switch (lead)
+                        {
+                        case 0xE0:
+                            lo = 0xA0;
+                            break;
+                        case 0xED:
+                            hi = 0x9F;
+                            break;
+                        case 0xF0:
+                            lo = 0x90;
+                            break;
+                        case 0xF4:
+                            hi = 0x8F;
+                            break;
+                        default:
+                            break;
+                        }
+
+                        const auto count = lead < 0xE0 ? 1 : lead < 0xF0 ? 2 : 3;
+                        char32_t value = lead & (0x3F >> count);
+                        auto i = 0;
+
+                        for (; i < count && it != end && *it >= lo && *it <= hi; ++i, ++it)
+                        {
+                            value = (value << 6) | (*it & 0x3F);
+                            lo = 0x80;
+                            hi = 0xBF;
+                        }
+
+                        if (i == count)
+                        {
+                            cp = value;
+                        }
+                    }
+
+                    if (cp >= 0x10000)
+                    {
+                        cp -= 0x10000;
+                        *dst++ = static_cast<wchar_t>(0xD800 | (cp >> 10));
+                        *dst++ = static_cast<wchar_t>(0xDC00 | (cp & 0x3FF));
+                    }
+                    else
+                    {
+                        *dst++ = static_cast<wchar_t>(cp);
+                    }
+                }
+            }
+
+            return static_cast<size_t>(dst - out);
+        }
+#pragma warning(pop)
+    }
+
     // state structure for maintenance of UTF-8 partials
     struct u8state
     {
@@ -56,7 +180,6 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
     // - S_OK          - the conversion succeeded
     // - E_OUTOFMEMORY - the function failed to allocate memory for the resulting string
     // - E_ABORT       - the resulting string length would exceed the upper boundary of an int and thus, the conversion was aborted before the conversion has been completed
-    // - E_UNEXPECTED  - the underlying conversion function failed
     // - HRESULT value converted from a caught exception
     template<class outT>
     [[nodiscard]] HRESULT u8u16(const std::string_view& in, outT& out) noexcept
@@ -69,11 +192,11 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
             int lengthRequired{};
             // The worst ratio of UTF-8 code units to UTF-16 code units is 1 to 1 if UTF-8 consists of ASCII only.
             RETURN_HR_IF(E_ABORT, !base::MakeCheckedNum(in.length()).AssignIfValid(&lengthRequired));
-            out.resize(in.length()); // avoid to call MultiByteToWideChar twice only to get the required size
-            const int lengthOut = MultiByteToWideChar(CP_UTF8, 0ul, in.data(), lengthRequired, out.data(), lengthRequired);
-            out.resize(gsl::narrow_cast<size_t>(lengthOut));
+            out.resize(in.length()); // avoid to scan the input twice only to get the required size
+            const auto lengthOut = details::u8u16_transcode(in.data(), in.length(), out.data());
+            out.resize(lengthOut);
 
-            return lengthOut == 0 ? E_UNEXPECTED : S_OK;
+            return S_OK;
         }
         CATCH_RETURN();
     }
@@ -90,7 +213,6 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
     // - S_OK          - the conversion succeeded
     // - E_OUTOFMEMORY - the function failed to allocate memory for the resulting string
     // - E_ABORT       - the resulting string length would exceed the upper boundary of an int and thus, the conversion was aborted before the conversion has been completed
-    // - E_UNEXPECTED  - the underlying conversion function failed
     // - HRESULT value converted from a caught exception
     template<class outT>
     [[nodiscard]] HRESULT u8u16(const std::string_view& in, outT& out, u8state& state) noexcept
@@ -120,10 +242,8 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
                     return S_OK;
                 }
 
-                len16 = MultiByteToWideChar(CP_UTF8, 0UL, &state.partials[0], gsl::narrow_cast<int>(state.have), out.data(), capa16);
-                RETURN_HR_IF(E_UNEXPECTED, !len16);
+                len16 = gsl::narrow_cast<int>(details::u8u16_transcode(&state.partials[0], state.have, out.data()));
 
-                capa16 -= len16;
                 len8 -= copyable;
                 cursor8 += copyable;
                 // state.want is already zero at this point
@@ -158,10 +278,7 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
 
             if (len8)
             {
-                const auto convLen{ MultiByteToWideChar(CP_UTF8, 0UL, cursor8, len8, out.data() + len16, capa16) };
-                RETURN_HR_IF(E_UNEXPECTED, !convLen);
-
-                len16 += convLen;
+                len16 += gsl::narrow_cast<int>(details::u8u16_transcode(cursor8, gsl::narrow_cast<size_t>(len8), out.data() + len16));
             }
 
             out.resize(gsl::narrow_cast<size_t>(len16));
@@ -71,6 +71,62 @@ std::deque<std::unique_ptr<KeyEvent>> Microsoft::Console::Interactivity::CharToK
     return SynthesizeKeyboardEvents(wch, keyState);
 }
 
+// Routine Description:
+// - converts a string into the INPUT_RECORDs that CharToKeyEvents would
+// produce for each of its characters, and appends them to records
+// - This is meant for large amounts of text, like a paste. Converting a
+// character queries the keyboard layout and allocates a KeyEvent for each
+// record. Since a paste mostly consists of the same few ASCII characters,
+// those are only converted once and their records are copied afterwards.
+// Arguments:
+// - string - the text to convert
+// - codepage - the codepage for characters that are typed using alt + numpad
+// - records - receives the key events that represent the text being typed
+// Note:
+// - will throw exception on error
+void Microsoft::Console::Interactivity::StringToInputRecords(const std::wstring_view string,
+                                                             const unsigned int codepage,
+                                                             std::vector<INPUT_RECORD>& records)
+{
+    struct CachedRecords
+    {
+        size_t offset = 0;
+        size_t count = 0;
+    };
+    std::array<CachedRecords, 128> asciiCache{};
+    std::vector<INPUT_RECORD> cachedRecords;
+
+    const auto appendRecords = [&](const wchar_t wch, std::vector<INPUT_RECORD>& dest) {
+        for (const auto& keyEvent : CharToKeyEvents(wch, codepage))
+        {
+            dest.push_back(keyEvent->ToInputRecord());
+        }
+    };
+
+    // Most characters are typed as a key down and a key up event.
+    records.reserve(records.size() + string.size() * 2);
+
+    for (const auto wch : string)
+    {
+        if (wch >= asciiCache.size())
+        {
+            appendRecords(wch, records);
+            continue;
+        }
+
+        auto& cached = til::at(asciiCache, wch);
+        if (cached.count == 0)
+        {
+            cached.offset = cachedRecords.size();
+            appendRecords(wch, cachedRecords);
+            cached.count = cachedRecords.size() - cached.offset;
+        }
+
+        const auto beg = cachedRecords.begin() + cached.offset;
+        records.insert(records.end(), beg, beg + cached.count);
+    }
+}
+
 // Routine Description:
 // - converts a wchar_t into a series of KeyEvents as if it was typed
 // using the keyboard
@@ -16,12 +16,15 @@ Author:
 #pragma once
 #include <deque>
 #include <memory>
+#include <vector>
 #include "../../types/inc/IInputEvent.hpp"
 
 namespace Microsoft::Console::Interactivity
 {
     std::deque<std::unique_ptr<KeyEvent>> CharToKeyEvents(const wchar_t wch, const unsigned int codepage);
 
+    void StringToInputRecords(const std::wstring_view string, const unsigned int codepage, std::vector<INPUT_RECORD>& records);
+
     std::deque<std::unique_ptr<KeyEvent>> SynthesizeKeyboardEvents(const wchar_t wch,
                                                                    const short keyState);
 
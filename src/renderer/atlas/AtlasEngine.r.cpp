@@ -188,6 +188,13 @@ CATCH_RETURN()
     return debugGeneralPerformance || _r.requiresContinuousRedraw;
 }
 
+[[nodiscard]] bool AtlasEngine::SupportsUnlockedPainting() noexcept
+{
+    // The painting functions share _api with the setters that ControlCore
+    // calls under the console lock (SetWindowSize(), UpdateFont(), etc.).
+    return false;
+}
+
 void AtlasEngine::WaitUntilCanRender() noexcept
 {
     // IDXGISwapChain2::GetFrameLatencyWaitableObject returns an auto-reset event.
@@ -0,0 +1,254 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "FrameSnapshot.hpp"
+
+#pragma hdrstop
+
+using namespace Microsoft::Console::Render;
+
+// Routine Description:
+// - Clears the previous frame, while keeping the allocations around for reuse.
+// Arguments:
+// - renderSettings - The settings to copy. Engines only get to see this copy,
+//   as the original may be modified while they paint.
+// - directEngine - If not null, the following calls are forwarded to this engine
+//   immediately instead of being recorded and nothing is copied. Replay() is a no-op then.
+//   Only valid for engines that paint while the console lock is held.
+// - pData - Passed through to UpdateDrawingBrushes() if directEngine is not null.
+void FrameSnapshot::Reset(const RenderSettings& renderSettings, IRenderEngine* directEngine, IRenderData* pData)
+{
+    _directEngine = directEngine;
+    _directData = pData;
+    _liveRenderSettings = &renderSettings;
+    if (!directEngine)
+    {
+        _renderSettings = renderSettings;
+    }
+    _renderInfo = {};
+    _commands.clear();
+    _clusterText.clear();
+    _clusters.clear();
+    _text.clear();
+    _title.clear();
+}
+
+// Routine Description:
+// - Must be called once all commands were recorded and before calling Replay().
+void FrameSnapshot::Finish()
+{
+    // The clusters point into _text which may have been reallocated while
+    // it was being filled. That's why we only create them now.
+    _clusters.clear();
+    _clusters.reserve(_clusterText.size());
+    for (const auto& c : _clusterText)
+    {
+        _clusters.emplace_back(std::wstring_view{ _text }.substr(c.offset, c.length), c.columns);
+    }
+}
+
+// Routine Description:
+// - Paints the recorded frame. This doesn't access anything but the snapshot itself.
+// Arguments:
+// - engine - The engine to paint with. Its StartPaint() must have been called.
+// - pData - Passed through to UpdateDrawingBrushes(). Engines that support unlocked
+//   painting must not access it, as the console lock might not be held anymore.
+void FrameSnapshot::Replay(IRenderEngine& engine, const gsl::not_null<IRenderData*> pData) const
+{
+    const auto clusters = std::span{ _clusters };
+
+    for (const auto& c : _commands)
+    {
+        switch (c.kind)
+        {
+        case Command::Kind::PrepareRenderInfo:
+            THROW_IF_FAILED(engine.PrepareRenderInfo(_renderInfo));
+            break;
+        case Command::Kind::PaintBackground:
+            THROW_IF_FAILED(engine.PaintBackground());
+            break;
+        case Command::Kind::UpdateDrawingBrushes:
+            THROW_IF_FAILED(engine.UpdateDrawingBrushes(c.attributes, _renderSettings, pData, c.flag1, false));
+            break;
+        case Command::Kind::PrepareLineTransform:
+            LOG_IF_FAILED(engine.PrepareLineTransform(c.lineRendition, c.coord.y, c.coord.x));
+            break;
+        case Command::Kind::ResetLineTransform:
+            LOG_IF_FAILED(engine.ResetLineTransform());
+            break;
+        case Command::Kind::PaintBufferLine:
+            THROW_IF_FAILED(engine.PaintBufferLine(clusters.subspan(c.begin, c.end - c.begin), c.coord, c.flag1, c.flag2));
+            break;
+        case Command::Kind::PaintBufferGridLines:
+            LOG_IF_FAILED(engine.PaintBufferGridLines(c.lines, c.color, c.begin, c.coord));
+            break;
+        case Command::Kind::PaintSelection:
+            LOG_IF_FAILED(engine.PaintSelection(c.rect));
+            break;
+        case Command::Kind::PaintCursor:
+            LOG_IF_FAILED(engine.PaintCursor(_cursor));
+            break;
+        case Command::Kind::UpdateTitle:
+            THROW_IF_FAILED(engine.UpdateTitle(_title));
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+void FrameSnapshot::PrepareRenderInfo(RenderFrameInfo info)
+{
+    if (_directEngine)
+    {
+        THROW_IF_FAILED(_directEngine->PrepareRenderInfo(info));
+        return;
+    }
+
+    _renderInfo = std::move(info);
+
+    auto& c = _commands.emplace_back();
+    c.kind = Command::Kind::PrepareRenderInfo;
+}
+
+void FrameSnapshot::PaintBackground()
+{
+    if (_directEngine)
+    {
+        THROW_IF_FAILED(_directEngine->PaintBackground());
+        return;
+    }
+
+    auto& c = _commands.emplace_back();
+    c.kind = Command::Kind::PaintBackground;
+}
+
+void FrameSnapshot::UpdateDrawingBrushes(const TextAttribute& textAttributes, const bool usingSoftFont)
+{
+    if (_directEngine)
+    {
+        THROW_IF_FAILED(_directEngine->UpdateDrawingBrushes(textAttributes, *_liveRenderSettings, _directData, usingSoftFont, false));
+        return;
+    }
+
+    // Engines only see our copy of the settings, but the original needs to learn about blinking
+    // text, which it tracks through GetAttributeColors(). Otherwise, it would never blink again.
+    if (textAttributes.IsBlinking() && _liveRenderSettings)
+    {
+        std::ignore = _liveRenderSettings->GetAttributeColors(textAttributes);
+    }
+
+    auto& c = _commands.emplace_back();
+    c.kind = Command::Kind::UpdateDrawingBrushes;
+    c.attributes = textAttributes;
+    c.flag1 = usingSoftFont;
+}
+
+void FrameSnapshot::PrepareLineTransform(const LineRendition lineRendition, const til::CoordType targetRow, const til::CoordType viewportLeft)
+{
+    if (_directEngine)
+    {
+        LOG_IF_FAILED(_directEngine->PrepareLineTransform(lineRendition, targetRow, viewportLeft));
+        return;
+    }
+
+    auto& c = _commands.emplace_back();
+    c.kind = Command::Kind::PrepareLineTransform;
+    c.lineRendition = lineRendition;
+    c.coord = { viewportLeft, targetRow };
+}
+
+void FrameSnapshot::ResetLineTransform()
+{
+    if (_directEngine)
+    {
+        LOG_IF_FAILED(_directEngine->ResetLineTransform());
+        return;
+    }
+
+    auto& c = _commands.emplace_back();
+    c.kind = Command::Kind::ResetLineTransform;
+}
+
+void FrameSnapshot::PaintBufferLine(const std::span<const Cluster> clusters, const til::point coord, const bool trimLeft, const bool lineWrapped)
+{
+    if (_directEngine)
+    {
+        THROW_IF_FAILED(_directEngine->PaintBufferLine(clusters, coord, trimLeft, lineWrapped));
+        return;
+    }
+
+    auto& c = _commands.emplace_back();
+    c.kind = Command::Kind::PaintBufferLine;
+    c.coord = coord;
+    c.flag1 = trimLeft;
+    c.flag2 = lineWrapped;
+    c.begin = _clusterText.size();
+
+    for (const auto& cluster : clusters)
+    {
+        const auto text = cluster.GetText();
+        _clusterText.emplace_back(ClusterText{ _text.size(), text.size(), cluster.GetColumns() });
+        _text.append(text);
+    }
+
+    c.end = _clusterText.size();
+}
+
+void FrameSnapshot::PaintBufferGridLines(const IRenderEngine::GridLineSet lines, const COLORREF color, const size_t cchLine, const til::point coordTarget)
+{
+    if (_directEngine)
+    {
+        LOG_IF_FAILED(_directEngine->PaintBufferGridLines(lines, color, cchLine, coordTarget));
+        return;
+    }
+
+    auto& c = _commands.emplace_back();
+    c.kind = Command::Kind::PaintBufferGridLines;
+    c.lines = lines;
+    c.color = color;
+    c.begin = cchLine;
+    c.coord = coordTarget;
+}
+
+void FrameSnapshot::PaintSelection(const til::rect& rect)
+{
+    if (_directEngine)
+    {
+        LOG_IF_FAILED(_directEngine->PaintSelection(rect));
+        return;
+    }
+
+    auto& c = _commands.emplace_back();
+    c.kind = Command::Kind::PaintSelection;
+    c.rect = rect;
+}
+
+void FrameSnapshot::PaintCursor(const CursorOptions& options)
+{
+    if (_directEngine)
+    {
+        LOG_IF_FAILED(_directEngine->PaintCursor(options));
+        return;
+    }
+
+    _cursor = options;
+
+    auto& c = _commands.emplace_back();
+    c.kind = Command::Kind::PaintCursor;
+}
+
+void FrameSnapshot::UpdateTitle(const std::wstring_view title)
+{
+    if (_directEngine)
+    {
+        THROW_IF_FAILED(_directEngine->UpdateTitle(title));
+        return;
+    }
+
+    _title.assign(title);
+
+    auto& c = _commands.emplace_back();
+    c.kind = Command::Kind::UpdateTitle;
+}
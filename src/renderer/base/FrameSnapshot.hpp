@@ -0,0 +1,91 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- FrameSnapshot.hpp
+
+Abstract:
+- A copy of everything a render engine needs to paint the dirty parts of a frame.
+- The Renderer fills it while holding the console lock, using the same calls it'd otherwise make
+  on the engine, and replays it into the engine afterwards. This allows engines that support it
+  to paint without holding the console lock. See Renderer::_PaintFrameForEngine.
+- Engines that paint under the lock anyway don't need the copy. For them, the snapshot
+  forwards each call to the engine right away instead of recording it.
+--*/
+
+#pragma once
+
+#include "../inc/IRenderEngine.hpp"
+#include "../inc/RenderSettings.hpp"
+
+namespace Microsoft::Console::Render
+{
+    class FrameSnapshot
+    {
+    public:
+        void Reset(const RenderSettings& renderSettings, IRenderEngine* directEngine, IRenderData* pData);
+        void Finish();
+        void Replay(IRenderEngine& engine, const gsl::not_null<IRenderData*> pData) const;
+
+        void PrepareRenderInfo(RenderFrameInfo info);
+        void PaintBackground();
+        void UpdateDrawingBrushes(const TextAttribute& textAttributes, const bool usingSoftFont);
+        void PrepareLineTransform(const LineRendition lineRendition, const til::CoordType targetRow, const til::CoordType viewportLeft);
+        void ResetLineTransform();
+        void PaintBufferLine(const std::span<const Cluster> clusters, const til::point coord, const bool trimLeft, const bool lineWrapped);
+        void PaintBufferGridLines(const IRenderEngine::GridLineSet lines, const COLORREF color, const size_t cchLine, const til::point coordTarget);
+        void PaintSelection(const til::rect& rect);
+        void PaintCursor(const CursorOptions& options);
+        void UpdateTitle(const std::wstring_view title);
+
+    private:
+        struct Command
+        {
+            enum class Kind : uint8_t
+            {
+                PrepareRenderInfo,
+                PaintBackground,
+                UpdateDrawingBrushes,
+                PrepareLineTransform,
+                ResetLineTransform,
+                PaintBufferLine,
+                PaintBufferGridLines,
+                PaintSelection,
+                PaintCursor,
+                UpdateTitle,
+            };
+
+            Kind kind{};
+            bool flag1 = false; // UpdateDrawingBrushes: usingSoftFont, PaintBufferLine: trimLeft
+            bool flag2 = false; // PaintBufferLine: lineWrapped
+            LineRendition lineRendition{};
+            COLORREF color = 0;
+            IRenderEngine::GridLineSet lines;
+            TextAttribute attributes;
+            til::point coord; // PrepareLineTransform: { viewportLeft, targetRow }
+            til::rect rect;
+            size_t begin = 0; // PaintBufferLine: index into _clusters, PaintBufferGridLines: cchLine
+            size_t end = 0;
+        };
+
+        struct ClusterText
+        {
+            size_t offset;
+            size_t length;
+            til::CoordType columns;
+        };
+
+        IRenderEngine* _directEngine = nullptr;
+        IRenderData* _directData = nullptr;
+        const RenderSettings* _liveRenderSettings = nullptr;
+        RenderSettings _renderSettings;
+        RenderFrameInfo _renderInfo;
+        std::vector<Command> _commands;
+        std::vector<ClusterText> _clusterText;
+        std::vector<Cluster> _clusters;
+        std::wstring _text;
+        std::wstring _title;
+        CursorOptions _cursor{};
+    };
+}
@@ -69,12 +69,25 @@ HRESULT RenderEngineBase::PrepareLineTransform(const LineRendition /*lineRenditi
     return false;
 }
 
+// Method Description:
+// - By default, engines are painted while the console lock is held, because
+//   other parts of the console might call into them directly, relying on that lock.
+//   If an engine is only ever used through the Renderer, it can return true here, which
+//   allows the Renderer to release the lock after StartPaint() and ScrollFrame().
+//   Such an engine must not access the IRenderData passed to UpdateDrawingBrushes().
+// - Only the GdiEngine returns true so far. The AtlasEngine, VtEngine and UiaEngine are painted under the lock.
+[[nodiscard]] bool RenderEngineBase::SupportsUnlockedPainting() noexcept
+{
+    return false;
+}
+
 // Method Description:
 // - Blocks until the engine is able to render without blocking.
+// - The RenderThread already limits the frame rate to the display's refresh
+//   rate, so engines only need to override this if they have to wait for
+//   something else, like a swap chain.
 void RenderEngineBase::WaitUntilCanRender() noexcept
 {
-    // Throttle the render loop a bit by default (~60 FPS), improving throughput.
-    Sleep(8);
 }
 
 // Routine Description:
@@ -4,6 +4,8 @@
 #include "precomp.h"
 #include "renderer.hpp"
 
+#include <til/atomic.h>
+
 #pragma hdrstop
 
 using namespace Microsoft::Console::Render;
@@ -111,10 +113,15 @@ try
     FAIL_FAST_IF_NULL(pEngine); // This is a programming error. Fail fast.
 
     _pData->LockConsole();
+    const auto lockTime = std::chrono::steady_clock::now();
     auto unlock = wil::scope_exit([&]() {
+        _RecordPaintLockTime(std::chrono::steady_clock::now() - lockTime);
         _pData->UnlockConsole();
     });
 
+    // Apply the invalidations that arrived while the previous frame was painted without the lock.
+    _ApplyPendingInvalidations();
+
     // Last chance check if anything scrolled without an explicit invalidate notification since the last frame.
     _CheckViewportAndScroll();
 
@@ -130,6 +137,16 @@ try
         return S_OK;
     }
 
+    // Must be declared before endPaint, because EndPaint() must be called before we reset this flag.
+    auto unlockedPainting = false;
+    auto finishUnlockedPainting = wil::scope_exit([&]() {
+        if (unlockedPainting)
+        {
+            _unlockedPainting.store(false, std::memory_order_release);
+            til::atomic_notify_all(_unlockedPainting);
+        }
+    });
+
     auto endPaint = wil::scope_exit([&]() {
         LOG_IF_FAILED(pEngine->EndPaint());
 
@@ -148,11 +165,20 @@ try
     // B. Perform Scroll Operations
     RETURN_IF_FAILED(_PerformScrolling(pEngine));
 
+    // The scroll operation above was the last one that can affect the dirty area.
+    // If the engine allows it, we can let go of the lock once everything is painted into _frame,
+    // because the frame copies everything the engine needs out of the console data structures.
+    // NOTE: Only the GdiEngine opts into this at the moment. The AtlasEngine, VtEngine and
+    // UiaEngine are also called directly by code that relies on the lock and still paint under it.
+    // For them, _frame forwards all calls right away and nothing is copied.
+    const auto supportsUnlockedPainting = pEngine->SupportsUnlockedPainting();
+    _frame.Reset(_renderSettings, supportsUnlockedPainting ? nullptr : pEngine, _pData);
+
     // C. Prepare the engine with additional information before we start drawing.
-    RETURN_IF_FAILED(_PrepareRenderInfo(pEngine));
+    _PrepareRenderInfo();
 
     // 1. Paint Background
-    RETURN_IF_FAILED(_PaintBackground(pEngine));
+    _PaintBackground();
 
     // 2. Paint Rows of Text
     _PaintBufferOutput(pEngine);
@@ -164,14 +190,30 @@ try
     _PaintSelection(pEngine);
 
     // 5. Paint Cursor
-    _PaintCursor(pEngine);
+    _PaintCursor();
 
     // 6. Paint window title
-    RETURN_IF_FAILED(_PaintTitle(pEngine));
+    _PaintTitle();
+
+    _frame.Finish();
+
+    // Other threads can now continue to write into the buffer, while we paint the frame.
+    // Their invalidations are queued up in _pendingInvalidations until we're done.
+    // See _InvalidateEngines().
+    if (supportsUnlockedPainting)
+    {
+        _unlockedPainting.store(true, std::memory_order_relaxed);
+        unlockedPainting = true;
+        unlock.reset();
+
+        _frame.Replay(*pEngine, _pData);
+    }
 
     // Force scope exit end paint to finish up collecting information and possibly painting
     endPaint.reset();
 
+    finishUnlockedPainting.reset();
+
     // Force scope exit unlock to let go of global lock so other threads can run
     unlock.reset();
 
@@ -193,6 +235,169 @@ void Renderer::NotifyPaintFrame() noexcept
     }
 }
 
+// Routine Description:
+// - Called when input arrived. The next frame most likely contains its echo,
+//   which is why the render thread paints it right away instead of pacing it.
+void Renderer::NotifyInput() noexcept
+{
+    if (_pThread)
+    {
+        _pThread->NotifyInput();
+    }
+}
+
+// Routine Description:
+// - Returns the frame pacing statistics of the render thread. Empty if there is none.
+RenderThread::FrameStatistics Renderer::GetFrameStatistics() const
+{
+    return _pThread ? _pThread->GetFrameStatistics() : RenderThread::FrameStatistics{};
+}
+
+// Routine Description:
+// - Returns how long PaintFrame() held the console lock, for the last frame and in total.
+//   For engines that support unlocked painting this excludes the time spent painting.
+Renderer::PaintLockStatistics Renderer::GetPaintLockStatistics() const noexcept
+{
+    PaintLockStatistics stats;
+    stats.last = std::chrono::nanoseconds{ _paintLockTimeLast.load(std::memory_order_relaxed) };
+    stats.peak = std::chrono::nanoseconds{ _paintLockTimePeak.load(std::memory_order_relaxed) };
+    stats.total = std::chrono::nanoseconds{ _paintLockTimeTotal.load(std::memory_order_relaxed) };
+    stats.frames = _paintLockFrames.load(std::memory_order_relaxed);
+    return stats;
+}
+
+// Routine Description:
+// - Called with the console lock held, so there's only ever one writer.
+void Renderer::_RecordPaintLockTime(const std::chrono::nanoseconds duration) noexcept
+{
+    const auto count = duration.count();
+    _paintLockTimeLast.store(count, std::memory_order_relaxed);
+    _paintLockTimePeak.store(std::max(count, _paintLockTimePeak.load(std::memory_order_relaxed)), std::memory_order_relaxed);
+    _paintLockTimeTotal.fetch_add(count, std::memory_order_relaxed);
+    _paintLockFrames.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Routine Description:
+// - Forwards an invalidation to all engines. If an engine is currently being painted without the
+//   console lock, it gets queued up instead and will be applied before the next frame is painted.
+// - Must be called with the console lock held.
+// Arguments:
+// - invalidation - The invalidation to forward.
+void Renderer::_InvalidateEngines(const Invalidation& invalidation)
+{
+    if (_unlockedPainting.load(std::memory_order_acquire))
+    {
+        // Only now do we need to copy what the invalidation borrowed.
+        PendingInvalidation pending{ .invalidation = invalidation, .text = std::wstring{ invalidation.text } };
+        if (invalidation.rects)
+        {
+            pending.rects = *invalidation.rects;
+        }
+
+        const std::lock_guard guard{ _pendingInvalidationsLock };
+        _pendingInvalidations.emplace_back(std::move(pending));
+        _hasPendingInvalidations.store(true, std::memory_order_relaxed);
+        return;
+    }
+
+    // The previously queued invalidations must be applied first to retain their order.
+    _ApplyPendingInvalidations();
+
+    FOREACH_ENGINE(pEngine)
+    {
+        s_ApplyInvalidation(*pEngine, invalidation);
+    }
+}
+
+void Renderer::s_ApplyInvalidation(IRenderEngine& engine, const Invalidation& invalidation) noexcept
+{
+    switch (invalidation.kind)
+    {
+    case Invalidation::Kind::Region:
+        LOG_IF_FAILED(engine.Invalidate(&invalidation.rect));
+        break;
+    case Invalidation::Kind::Cursor:
+        LOG_IF_FAILED(engine.InvalidateCursor(&invalidation.rect));
+        break;
+    case Invalidation::Kind::System:
+        LOG_IF_FAILED(engine.InvalidateSystem(&invalidation.rect));
+        break;
+    case Invalidation::Kind::Selection:
+        if (invalidation.rects)
+        {
+            LOG_IF_FAILED(engine.InvalidateSelection(*invalidation.rects));
+        }
+        break;
+    case Invalidation::Kind::Scroll:
+        LOG_IF_FAILED(engine.InvalidateScroll(&invalidation.delta));
+        break;
+    case Invalidation::Kind::Viewport:
+        LOG_IF_FAILED(engine.UpdateViewport(invalidation.viewport));
+        LOG_IF_FAILED(engine.InvalidateScroll(&invalidation.delta));
+        break;
+    case Invalidation::Kind::All:
+        LOG_IF_FAILED(engine.InvalidateAll());
+        break;
+    case Invalidation::Kind::Title:
+        LOG_IF_FAILED(engine.InvalidateTitle(invalidation.text));
+        break;
+    case Invalidation::Kind::NewText:
+        LOG_IF_FAILED(engine.NotifyNewText(invalidation.text));
+        break;
+    default:
+        break;
+    }
+}
+
+// Routine Description:
+// - Applies the invalidations queued up by _InvalidateEngines().
+// - Must be called with the console lock held and while no engine is painted without it.
+void Renderer::_ApplyPendingInvalidations()
+{
+    // Invalidations are only queued up by threads holding the console lock, just like ours,
+    // so we can skip the mutex in the common case where there are none.
+    if (!_hasPendingInvalidations.load(std::memory_order_relaxed))
+    {
+        return;
+    }
+
+    std::vector<PendingInvalidation> pending;
+    {
+        const std::lock_guard guard{ _pendingInvalidationsLock };
+        if (_pendingInvalidations.empty())
+        {
+            return;
+        }
+        pending.swap(_pendingInvalidations);
+        _hasPendingInvalidations.store(false, std::memory_order_relaxed);
+    }
+
+    for (const auto& p : pending)
+    {
+        // Point the views back at the copies we made in _InvalidateEngines().
+        auto invalidation = p.invalidation;
+        invalidation.rects = &p.rects;
+        invalidation.text = p.text;
+
+        FOREACH_ENGINE(pEngine)
+        {
+            s_ApplyInvalidation(*pEngine, invalidation);
+        }
+    }
+}
+
+// Routine Description:
+// - Blocks until the engine that's currently painted without holding the console lock
+//   (if any) is done. Must be called before accessing the engines in any other way than
+//   through _InvalidateEngines(). This can't deadlock, because such a paint never acquires the lock.
+void Renderer::_WaitForUnlockedPaint() const noexcept
+{
+    while (_unlockedPainting.load(std::memory_order_acquire))
+    {
+        til::atomic_wait(_unlockedPainting, true);
+    }
+}
+
 // Routine Description:
 // - Called when the system has requested we redraw a portion of the console.
 // Arguments:
@@ -201,11 +406,13 @@ void Renderer::NotifyPaintFrame() noexcept
 // - <none>
 void Renderer::TriggerSystemRedraw(const til::rect* const prcDirtyClient)
 {
-    FOREACH_ENGINE(pEngine)
+    if (!prcDirtyClient)
     {
-        LOG_IF_FAILED(pEngine->InvalidateSystem(prcDirtyClient));
+        return;
     }
 
+    _InvalidateEngines({ .kind = Invalidation::Kind::System, .rect = *prcDirtyClient });
+
     NotifyPaintFrame();
 }
 
@@ -235,10 +442,7 @@ void Renderer::TriggerRedraw(const Viewport& region)
     if (view.TrimToViewport(&srUpdateRegion))
     {
         view.ConvertToOrigin(&srUpdateRegion);
-        FOREACH_ENGINE(pEngine)
-        {
-            LOG_IF_FAILED(pEngine->Invalidate(&srUpdateRegion));
-        }
+        _InvalidateEngines({ .kind = Invalidation::Kind::Region, .rect = srUpdateRegion });
 
         NotifyPaintFrame();
     }
@@ -286,10 +490,7 @@ void Renderer::TriggerRedrawCursor(const til::point* const pcoord)
         if (view.TrimToViewport(&updateRect))
         {
             view.ConvertToOrigin(&updateRect);
-            FOREACH_ENGINE(pEngine)
-            {
-                LOG_IF_FAILED(pEngine->InvalidateCursor(&updateRect));
-            }
+            _InvalidateEngines({ .kind = Invalidation::Kind::Cursor, .rect = updateRect });
 
             NotifyPaintFrame();
         }
@@ -306,10 +507,7 @@ void Renderer::TriggerRedrawCursor(const til::point* const pcoord)
 // - <none>
 void Renderer::TriggerRedrawAll(const bool backgroundChanged, const bool frameChanged)
 {
-    FOREACH_ENGINE(pEngine)
-    {
-        LOG_IF_FAILED(pEngine->InvalidateAll());
-    }
+    _InvalidateEngines({ .kind = Invalidation::Kind::All });
 
     NotifyPaintFrame();
 
@@ -335,6 +533,7 @@ void Renderer::TriggerTeardown() noexcept
 {
     // We need to shut down the paint thread on teardown.
     _pThread->WaitForPaintCompletionAndDisable(INFINITE);
+    _ApplyPendingInvalidations();
 
     // Then walk through and do one final paint on the caller's thread.
     FOREACH_ENGINE(pEngine)
@@ -372,11 +571,8 @@ void Renderer::TriggerSelection()
             sr &= viewport;
         }
 
-        FOREACH_ENGINE(pEngine)
-        {
-            LOG_IF_FAILED(pEngine->InvalidateSelection(_previousSelection));
-            LOG_IF_FAILED(pEngine->InvalidateSelection(rects));
-        }
+        _InvalidateEngines({ .kind = Invalidation::Kind::Selection, .rects = &_previousSelection });
+        _InvalidateEngines({ .kind = Invalidation::Kind::Selection, .rects = &rects });
 
         _previousSelection = std::move(rects);
 
@@ -408,11 +604,7 @@ bool Renderer::_CheckViewportAndScroll()
     coordDelta.x = srOldViewport.left - srNewViewport.left;
     coordDelta.y = srOldViewport.top - srNewViewport.top;
 
-    FOREACH_ENGINE(engine)
-    {
-        LOG_IF_FAILED(engine->UpdateViewport(srNewViewport));
-        LOG_IF_FAILED(engine->InvalidateScroll(&coordDelta));
-    }
+    _InvalidateEngines({ .kind = Invalidation::Kind::Viewport, .viewport = srNewViewport, .delta = coordDelta });
 
     _ScrollPreviousSelection(coordDelta);
     return true;
@@ -444,10 +636,7 @@ void Renderer::TriggerScroll()
 // - <none>
 void Renderer::TriggerScroll(const til::point* const pcoordDelta)
 {
-    FOREACH_ENGINE(pEngine)
-    {
-        LOG_IF_FAILED(pEngine->InvalidateScroll(pcoordDelta));
-    }
+    _InvalidateEngines({ .kind = Invalidation::Kind::Scroll, .delta = *pcoordDelta });
 
     _ScrollPreviousSelection(*pcoordDelta);
 
@@ -465,6 +654,10 @@ void Renderer::TriggerFlush(const bool circling)
 {
     const auto rects = _GetSelectionRects();
 
+    // The engines might want to paint synchronously below.
+    _WaitForUnlockedPaint();
+    _ApplyPendingInvalidations();
+
     FOREACH_ENGINE(pEngine)
     {
         auto fEngineRequestsRepaint = false;
@@ -490,31 +683,25 @@ void Renderer::TriggerFlush(const bool circling)
 void Renderer::TriggerTitleChange()
 {
     const auto newTitle = _pData->GetConsoleTitle();
-    FOREACH_ENGINE(pEngine)
-    {
-        LOG_IF_FAILED(pEngine->InvalidateTitle(newTitle));
-    }
+    _InvalidateEngines({ .kind = Invalidation::Kind::Title, .text = newTitle });
     NotifyPaintFrame();
 }
 
 void Renderer::TriggerNewTextNotification(const std::wstring_view newText)
 {
-    FOREACH_ENGINE(pEngine)
-    {
-        LOG_IF_FAILED(pEngine->NotifyNewText(newText));
-    }
+    _InvalidateEngines({ .kind = Invalidation::Kind::NewText, .text = newText });
 }
 
 // Routine Description:
-// - Update the title for a particular engine.
+// - Records the title update for the frame that's being painted.
 // Arguments:
-// - pEngine: the engine to update the title for.
+// - <none>
 // Return Value:
-// - the HRESULT of the underlying engine's UpdateTitle call.
-HRESULT Renderer::_PaintTitle(IRenderEngine* const pEngine)
+// - <none>
+void Renderer::_PaintTitle()
 {
     const auto newTitle = _pData->GetConsoleTitle();
-    return pEngine->UpdateTitle(newTitle);
+    _frame.UpdateTitle(newTitle);
 }
 
 // Routine Description:
@@ -527,6 +714,8 @@ HRESULT Renderer::_PaintTitle(IRenderEngine* const pEngine)
 // - <none>
 void Renderer::TriggerFontChange(const int iDpi, const FontInfoDesired& FontInfoDesired, _Out_ FontInfo& FontInfo)
 {
+    _WaitForUnlockedPaint();
+
     FOREACH_ENGINE(pEngine)
     {
         LOG_IF_FAILED(pEngine->UpdateDpi(iDpi));
@@ -553,6 +742,8 @@ void Renderer::UpdateSoftFont(const std::span<const uint16_t> bitPattern, const
     const auto softFontCharCount = cellSize.height ? bitPattern.size() / cellSize.height : 0;
     _lastSoftFontChar = _firstSoftFontChar + softFontCharCount - 1;
 
+    _WaitForUnlockedPaint();
+
     FOREACH_ENGINE(pEngine)
     {
         LOG_IF_FAILED(pEngine->UpdateSoftFont(bitPattern, cellSize, centeringHint));
@@ -583,6 +774,7 @@ bool Renderer::s_IsSoftFontChar(const std::wstring_view& v, const size_t firstSo
     //      renderer. We won't know which is which, so iterate over them.
     //      Only return the result of the successful one if it's not S_FALSE (which is the VT renderer)
     // TODO: 14560740 - The Window might be able to get at this info in a more sane manner
+    _WaitForUnlockedPaint();
     FOREACH_ENGINE(pEngine)
     {
         const auto hr = LOG_IF_FAILED(pEngine->GetProposedFont(FontInfoDesired, FontInfo, iDpi));
@@ -614,6 +806,7 @@ bool Renderer::IsGlyphWideByFont(const std::wstring_view glyph)
     //      renderer. We won't know which is which, so iterate over them.
     //      Only return the result of the successful one if it's not S_FALSE (which is the VT renderer)
     // TODO: 14560740 - The Window might be able to get at this info in a more sane manner
+    _WaitForUnlockedPaint();
     FOREACH_ENGINE(pEngine)
     {
         const auto hr = LOG_IF_FAILED(pEngine->IsGlyphWideByFont(glyph, &fIsFullWidth));
@@ -665,9 +858,9 @@ void Renderer::WaitForPaintCompletionAndDisable(const DWORD dwTimeoutMs)
 // - <none>
 // Return Value:
 // - <none>
-[[nodiscard]] HRESULT Renderer::_PaintBackground(_In_ IRenderEngine* const pEngine)
+void Renderer::_PaintBackground()
 {
-    return pEngine->PaintBackground();
+    _frame.PaintBackground();
 }
 
 // Routine Description:
@@ -692,7 +885,7 @@ void Renderer::_PaintBufferOutput(_In_ IRenderEngine* const pEngine)
 
     // This is to make sure any transforms are reset when this paint is finished.
     auto resetLineTransform = wil::scope_exit([&]() {
-        LOG_IF_FAILED(pEngine->ResetLineTransform());
+        _frame.ResetLineTransform();
     });
 
     for (const auto& dirtyRect : dirtyAreas)
@@ -735,21 +928,21 @@ void Renderer::_PaintBufferOutput(_In_ IRenderEngine* const pEngine)
             // of the backing buffer to fill in line 1 of the screen.
             const auto screenPosition = bufferLine.Origin() - til::point{ 0, view.Top() };
 
-            // Retrieve the cell information iterator limited to just this line we want to redraw.
-            auto it = buffer.GetCellDataAt(bufferLine.Origin(), bufferLine);
+            // Retrieve the row we want to redraw. The helper reads its text and attribute runs directly.
+            const auto& bufferRow = buffer.GetRowByOffset(bufferLine.Origin().y);
 
             // Calculate if two things are true:
             // 1. this row wrapped
             // 2. We're painting the last col of the row.
             // In that case, set lineWrapped=true for the _PaintBufferOutputHelper call.
-            const auto lineWrapped = (buffer.GetRowByOffset(bufferLine.Origin().y).WasWrapForced()) &&
+            const auto lineWrapped = bufferRow.WasWrapForced() &&
                                      (bufferLine.RightExclusive() == buffer.GetSize().Width());
 
             // Prepare the appropriate line transform for the current row and viewport offset.
-            LOG_IF_FAILED(pEngine->PrepareLineTransform(lineRendition, screenPosition.y, view.Left()));
+            _frame.PrepareLineTransform(lineRendition, screenPosition.y, view.Left());
 
             // Ask the helper to paint through this specific line.
-            _PaintBufferOutputHelper(pEngine, it, screenPosition, lineWrapped);
+            _PaintBufferOutputHelper(bufferRow, bufferLine.Left(), bufferLine.RightExclusive(), screenPosition, lineWrapped);
         }
     }
 }
@@ -760,154 +953,241 @@ static bool _IsAllSpaces(const std::wstring_view v)
     return v.find_first_not_of(L' ') == decltype(v)::npos;
 }
 
-void Renderer::_PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
-                                        TextBufferCellIterator it,
+// Returns the number of consecutive spaces in the given row, starting at `columnBegin`
+// and ending at `columnEnd` at most. Each of them occupies exactly 1 column.
+static til::CoordType _CountLeadingSpaces(const ROW& row, const til::CoordType columnBegin, const til::CoordType columnEnd) noexcept
+{
+    const auto text = row.GetText();
+    const auto offset = row.GlyphAt(columnBegin).data() - text.data();
+    const auto remaining = text.substr(gsl::narrow_cast<size_t>(offset));
+    const auto limit = std::min(gsl::narrow_cast<size_t>(columnEnd - columnBegin), remaining.size());
+    auto count = std::min(remaining.find_first_not_of(L' '), limit);
+
+    // The last space might be the start of a longer glyph, like a space followed by a combining mark.
+    if (count != 0 && row.GlyphAt(columnBegin + gsl::narrow_cast<til::CoordType>(count) - 1).size() != 1)
+    {
+        --count;
+    }
+
+    return gsl::narrow_cast<til::CoordType>(count);
+}
+
+// Routine Description:
+// - Paint helper for primary buffer output function.
+// - Turns the given columns of a row into clusters and paints them, one run of identical attributes at a time.
+// Arguments:
+// - row - The row to paint.
+// - columnBegin - The first column of the row to paint.
+// - columnEnd - The column past the last one to paint. Wide glyphs may extend past it.
+// - target - The screen position of columnBegin.
+// - lineWrapped - Whether the row wrapped and we're painting up to its last column.
+// Return Value:
+// - <none>
+void Renderer::_PaintBufferOutputHelper(const ROW& row,
+                                        const til::CoordType columnBegin,
+                                        const til::CoordType columnEnd,
                                         const til::point target,
                                         const bool lineWrapped)
 {
-    auto globalInvert{ _renderSettings.GetRenderMode(RenderSettings::Mode::ScreenReversed) };
+    const auto end = std::min<til::CoordType>(columnEnd, row.size());
+    if (columnBegin < 0 || columnBegin >= end)
+    {
+        return;
+    }
 
-    // If we have valid data, let's figure out how to draw it.
-    if (it)
+    const auto globalInvert{ _renderSettings.GetRenderMode(RenderSettings::Mode::ScreenReversed) };
+
+    // Patterns only affect the output while one is hovered (see _PaintBufferOutputGridLineHelper)
+    // and soft fonts only while one is loaded. Unless that's the case, we don't need to look
+    // at individual glyphs at all, except to turn them into clusters.
+    const auto checkPatterns = _hoveredInterval.has_value();
+    const auto checkSoftFont = _lastSoftFontChar >= _firstSoftFontChar;
+    const auto checkGlyphs = checkPatterns || checkSoftFont;
+
+    // The attributes only change at the end of a run, so we only need to compare them there.
+    auto run = row.AttrRunAt(columnBegin);
+    // Retrieve the first color.
+    auto color = run.Attr();
+    // Whether the current run's attributes differ from `color`. This is the case if we
+    // continued painting runs of spaces with the previous color. See below.
+    auto runDiffers = false;
+    // Whether spaces in the current run look the same in the previous color.
+    auto runBlankCompatible = false;
+    // Retrieve the first pattern id
+    std::vector<size_t> patternIds;
+    // Determine whether we're using a soft font.
+    auto usingSoftFont = false;
+    if (checkPatterns)
     {
-        // TODO: MSFT: 20961091 -  This is a perf issue. Instead of rebuilding this and allocing memory to hold the reinterpretation,
-        // we should have an iterator/view adapter for the rendering.
-        // That would probably also eliminate the RenderData needing to give us the entire TextBuffer as well...
-        // Retrieve the iterator for one line of information.
-        til::CoordType cols = 0;
+        patternIds = _pData->GetPatternId(target);
+    }
+    if (checkSoftFont)
+    {
+        usingSoftFont = s_IsSoftFontChar(row.GlyphAt(columnBegin), _firstSoftFontChar, _lastSoftFontChar);
+    }
 
-        // Retrieve the first color.
-        auto color = it->TextAttr();
-        // Retrieve the first pattern id
-        auto patternIds = _pData->GetPatternId(target);
-        // Determine whether we're using a soft font.
-        auto usingSoftFont = s_IsSoftFontChar(it->Chars(), _firstSoftFontChar, _lastSoftFontChar);
+    auto column = columnBegin;
 
-        // And hold the point where we should start drawing.
-        auto screenPoint = target;
+    // This outer loop will continue until we reach the end of the text we are trying to draw.
+    while (column < end)
+    {
+        // Hold onto the current run color right here for the length of the outer loop.
+        // We'll be changing the persistent one as we run through the inner loop to detect
+        // when a run changes, but we will still need to know this color at the bottom
+        // when we go to draw gridlines for the length of the run.
+        const auto currentRunColor = color;
 
-        // This outer loop will continue until we reach the end of the text we are trying to draw.
-        while (it)
+        // Update the drawing brushes with our color and font usage.
+        _frame.UpdateDrawingBrushes(currentRunColor, usingSoftFont);
+
+        // Hold onto the start of this run and the target location where we started
+        // in case we need to do some special work to paint the line drawing characters.
+        const auto currentRunColumnStart = column;
+        auto screenPoint = til::point{ target.x + column - columnBegin, target.y };
+
+        // Ensure that our cluster vector is clear.
+        _clusterBuffer.clear();
+
+        // Reset our flag to know when we're in the special circumstance
+        // of attempting to draw only the right-half of a two-column character
+        // as the first item in our run.
+        auto trimLeft = false;
+
+        // Run contains wide character (>1 columns)
+        auto containsWideCharacter = false;
+
+        // The number of columns the clusters occupy.
+        til::CoordType cols = 0;
+
+        // This inner loop will accumulate clusters until the color changes.
+        // When the color changes, it will save the new color off and break.
+        // We also accumulate clusters according to regex patterns
+        do
         {
-            // Hold onto the current run color right here for the length of the outer loop.
-            // We'll be changing the persistent one as we run through the inner loops to detect
-            // when a run changes, but we will still need to know this color at the bottom
-            // when we go to draw gridlines for the length of the run.
-            const auto currentRunColor = color;
-
-            // Hold onto the current pattern id as well
-            const auto currentPatternId = patternIds;
-
-            // Update the drawing brushes with our color and font usage.
-            THROW_IF_FAILED(_UpdateDrawingBrushes(pEngine, currentRunColor, usingSoftFont, false));
-
-            // Advance the point by however many columns we've just outputted and reset the accumulator.
-            screenPoint.x += cols;
-            cols = 0;
-
-            // Hold onto the start of this run iterator and the target location where we started
-            // in case we need to do some special work to paint the line drawing characters.
-            const auto currentRunItStart = it;
-            const auto currentRunTargetStart = screenPoint;
-
-            // Ensure that our cluster vector is clear.
-            _clusterBuffer.clear();
-
-            // Reset our flag to know when we're in the special circumstance
-            // of attempting to draw only the right-half of a two-column character
-            // as the first item in our run.
-            auto trimLeft = false;
-
-            // Run contains wide character (>1 columns)
-            auto containsWideCharacter = false;
-
-            // This inner loop will accumulate clusters until the color changes.
-            // When the color changes, it will save the new color off and break.
-            // We also accumulate clusters according to regex patterns
-            do
+            if (column >= run.End())
             {
-                til::point thisPoint{ screenPoint.x + cols, screenPoint.y };
-                const auto thisPointPatterns = _pData->GetPatternId(thisPoint);
-                const auto thisUsingSoftFont = s_IsSoftFontChar(it->Chars(), _firstSoftFontChar, _lastSoftFontChar);
-                const auto changedPatternOrFont = patternIds != thisPointPatterns || usingSoftFont != thisUsingSoftFont;
-                if (color != it->TextAttr() || changedPatternOrFont)
+                do
+                {
+                    ++run;
+                } while (column >= run.End());
+
+                const auto& runAttr = run.Attr();
+                runDiffers = runAttr != color;
+                // foreground doesn't matter for runs of spaces (!)
+                // if we trick it . . . we call Paint far fewer times for cmatrix
+                runBlankCompatible = runDiffers && runAttr.HasIdenticalVisualRepresentationForBlankSpace(color, globalInvert);
+
+                // Unless we need to check each glyph, we can add all leading spaces of the run in one go.
+                if (runBlankCompatible && !checkGlyphs)
                 {
-                    auto newAttr{ it->TextAttr() };
-                    // foreground doesn't matter for runs of spaces (!)
-                    // if we trick it . . . we call Paint far fewer times for cmatrix
-                    if (!_IsAllSpaces(it->Chars()) || !newAttr.HasIdenticalVisualRepresentationForBlankSpace(color, globalInvert) || changedPatternOrFont)
+                    const auto spaces = _CountLeadingSpaces(row, column, std::min(run.End(), end));
+                    const auto text = row.GlyphAt(column);
+                    for (til::CoordType i = 0; i < spaces; ++i)
                     {
-                        color = newAttr;
-                        patternIds = thisPointPatterns;
-                        usingSoftFont = thisUsingSoftFont;
-                        break; // vend this run
+                        _clusterBuffer.emplace_back(std::wstring_view{ text.data() + i, 1 }, 1);
                     }
+                    column += spaces;
+                    cols += spaces;
+
+                    if (column >= end || column >= run.End())
+                    {
+                        continue;
+                    }
+
+                    // The run contains more than just spaces.
+                    color = runAttr;
+                    runDiffers = false;
+                    break; // vend this run
                 }
+            }
 
-                // Walk through the text data and turn it into rendering clusters.
-                // Keep the columnCount as we go to improve performance over digging it out of the vector at the end.
-                auto columnCount = it->Columns();
+            const auto glyph = row.GlyphAt(column);
+            const auto dbcsAttr = row.DbcsAttrAt(column);
 
-                // If we're on the first cluster to be added and it's marked as "trailing"
-                // (a.k.a. the right half of a two column character), then we need some special handling.
-                if (_clusterBuffer.empty() && it->DbcsAttr() == DbcsAttribute::Trailing)
+            if (runDiffers || checkGlyphs)
+            {
+                std::vector<size_t> thisPointPatterns;
+                auto thisUsingSoftFont = false;
+                if (checkPatterns)
+                {
+                    thisPointPatterns = _pData->GetPatternId({ target.x + column - columnBegin, target.y });
+                }
+                if (checkSoftFont)
                 {
-                    // Move left to the one so the whole character can be struck correctly.
-                    --screenPoint.x;
-                    // And tell the next function to trim off the left half of it.
-                    trimLeft = true;
-                    // And add one to the number of columns we expect it to take as we insert it.
-                    ++columnCount;
+                    thisUsingSoftFont = s_IsSoftFontChar(glyph, _firstSoftFontChar, _lastSoftFontChar);
                 }
 
-                if (columnCount > 1)
+                const auto changedPatternOrFont = patternIds != thisPointPatterns || usingSoftFont != thisUsingSoftFont;
+                if ((runDiffers && (!runBlankCompatible || !_IsAllSpaces(glyph))) || changedPatternOrFont)
                 {
-                    containsWideCharacter = true;
+                    color = run.Attr();
+                    runDiffers = false;
+                    patternIds = std::move(thisPointPatterns);
+                    usingSoftFont = thisUsingSoftFont;
+                    break; // vend this run
                 }
+            }
 
-                // Advance the cluster and column counts.
-                _clusterBuffer.emplace_back(it->Chars(), columnCount);
-                it += std::max(it->Columns(), 1); // prevent infinite loop for no visible columns
-                cols += columnCount;
+            // Keep the columnCount as we go to improve performance over digging it out of the vector at the end.
+            auto columnCount = dbcsAttr == DbcsAttribute::Leading ? 2 : 1;
 
-            } while (it);
+            // If we're on the first cluster to be added and it's marked as "trailing"
+            // (a.k.a. the right half of a two column character), then we need some special handling.
+            if (_clusterBuffer.empty() && dbcsAttr == DbcsAttribute::Trailing)
+            {
+                // Move left to the one so the whole character can be struck correctly.
+                --screenPoint.x;
+                // And tell the next function to trim off the left half of it.
+                trimLeft = true;
+                // And add one to the number of columns we expect it to take as we insert it.
+                columnCount = 2;
+                _clusterBuffer.emplace_back(glyph, columnCount);
+                ++column;
+            }
+            else
+            {
+                _clusterBuffer.emplace_back(glyph, columnCount);
+                column += columnCount;
+            }
+
+            if (columnCount > 1)
+            {
+                containsWideCharacter = true;
+            }
+
+            cols += columnCount;
+        } while (column < end);
 
-            // Do the painting.
-            THROW_IF_FAILED(pEngine->PaintBufferLine({ _clusterBuffer.data(), _clusterBuffer.size() }, screenPoint, trimLeft, lineWrapped));
+        // Do the painting.
+        _frame.PaintBufferLine({ _clusterBuffer.data(), _clusterBuffer.size() }, screenPoint, trimLeft, lineWrapped);
 
-            // If we're allowed to do grid drawing, draw that now too (since it will be coupled with the color data)
-            // We're only allowed to draw the grid lines under certain circumstances.
-            if (_pData->IsGridLineDrawingAllowed())
+        // If we're allowed to do grid drawing, draw that now too (since it will be coupled with the color data)
+        // We're only allowed to draw the grid lines under certain circumstances.
+        if (_pData->IsGridLineDrawingAllowed())
+        {
+            // See GH: 803
+            // If we found a wide character while we looped above, it's possible we skipped over the right half
+            // attribute that could have contained different line information than the left half.
+            if (containsWideCharacter)
             {
-                // See GH: 803
-                // If we found a wide character while we looped above, it's possible we skipped over the right half
-                // attribute that could have contained different line information than the left half.
-                if (containsWideCharacter)
-                {
-                    // Start from the original position in this run.
-                    auto lineIt = currentRunItStart;
-                    // Start from the original target in this run.
-                    auto lineTarget = currentRunTargetStart;
-
-                    // We need to go through the iterators again to ensure we get the lines associated with each
-                    // exact column. The code above will condense two-column characters into one, but it is possible
-                    // (like with the IME) that the line drawing characters will vary from the left to right half
-                    // of a wider character.
-                    // We could theoretically pre-pass for this in the loop above to be more efficient about walking
-                    // the iterator, but I fear it would make the code even more confusing than it already is.
-                    // Do that in the future if some WPR trace points you to this spot as super bad.
-                    for (til::CoordType colsPainted = 0; colsPainted < cols; ++colsPainted, ++lineIt, ++lineTarget.x)
-                    {
-                        auto lines = lineIt->TextAttr();
-                        _PaintBufferOutputGridLineHelper(pEngine, lines, 1, lineTarget);
-                    }
-                }
-                else
+                // We need to go through the attribute runs again to ensure we get the lines associated with each
+                // exact column. The code above will condense two-column characters into one, but it is possible
+                // (like with the IME) that the line drawing characters will vary from the left to right half
+                // of a wider character.
+                const auto lineEnd = std::min<til::CoordType>(column, row.size());
+                for (auto lineRun = row.AttrRunAt(currentRunColumnStart); lineRun && lineRun.Begin() < lineEnd; ++lineRun)
                 {
-                    // If nothing exciting is going on, draw the lines in bulk.
-                    _PaintBufferOutputGridLineHelper(pEngine, currentRunColor, cols, screenPoint);
+                    const auto from = std::max(lineRun.Begin(), currentRunColumnStart);
+                    const auto to = std::min(lineRun.End(), lineEnd);
+                    const til::point lineTarget{ target.x + from - columnBegin, target.y };
+                    _PaintBufferOutputGridLineHelper(lineRun.Attr(), gsl::narrow_cast<size_t>(to - from), lineTarget);
                 }
             }
+            else
+            {
+                // If nothing exciting is going on, draw the lines in bulk.
+                _PaintBufferOutputGridLineHelper(currentRunColor, cols, screenPoint);
+            }
         }
     }
 }
@@ -976,8 +1256,7 @@ IRenderEngine::GridLineSet Renderer::s_GetGridlines(const TextAttribute& textAtt
 // - coordTarget - The X/Y coordinate position in the buffer which we're attempting to start rendering from.
 // Return Value:
 // - <none>
-void Renderer::_PaintBufferOutputGridLineHelper(_In_ IRenderEngine* const pEngine,
-                                                const TextAttribute textAttribute,
+void Renderer::_PaintBufferOutputGridLineHelper(const TextAttribute textAttribute,
                                                 const size_t cchLine,
                                                 const til::point coordTarget)
 {
@@ -1006,7 +1285,7 @@ void Renderer::_PaintBufferOutputGridLineHelper(_In_ IRenderEngine* const pEngin
         // Get the current foreground color to render the lines.
         const auto rgb = _renderSettings.GetAttributeColors(textAttribute).first;
         // Draw the lines
-        LOG_IF_FAILED(pEngine->PaintBufferGridLines(lines, rgb, cchLine, coordTarget));
+        _frame.PaintBufferGridLines(lines, rgb, cchLine, coordTarget);
     }
 }
 
@@ -1077,15 +1356,15 @@ void Renderer::_PaintBufferOutputGridLineHelper(_In_ IRenderEngine* const pEngin
 // Routine Description:
 // - Paint helper to draw the cursor within the buffer.
 // Arguments:
-// - engine - The render engine that we're targeting.
+// - <none>
 // Return Value:
 // - <none>
-void Renderer::_PaintCursor(_In_ IRenderEngine* const pEngine)
+void Renderer::_PaintCursor()
 {
     const auto cursorInfo = _GetCursorInfo();
     if (cursorInfo.has_value())
     {
-        LOG_IF_FAILED(pEngine->PaintCursor(cursorInfo.value()));
+        _frame.PaintCursor(cursorInfo.value());
     }
 }
 
@@ -1097,14 +1376,14 @@ void Renderer::_PaintCursor(_In_ IRenderEngine* const pEngine)
 //     before PaintCursor is called, so it can draw the cursor underneath the
 //     text.
 // Arguments:
-// - engine - The render engine that we're targeting.
+// - <none>
 // Return Value:
-// - S_OK if the engine prepared successfully, or a relevant error via HRESULT.
-[[nodiscard]] HRESULT Renderer::_PrepareRenderInfo(_In_ IRenderEngine* const pEngine)
+// - <none>
+void Renderer::_PrepareRenderInfo()
 {
     RenderFrameInfo info;
     info.cursorInfo = _GetCursorInfo();
-    return pEngine->PrepareRenderInfo(info);
+    _frame.PrepareRenderInfo(std::move(info));
 }
 
 // Routine Description:
@@ -1139,9 +1418,9 @@ void Renderer::_PaintOverlay(IRenderEngine& engine,
                     const til::point target{ viewDirty.left, iRow };
                     const auto source = target - overlay.origin;
 
-                    auto it = overlay.buffer.GetCellLineDataAt(source);
+                    const auto& row = overlay.buffer.GetRowByOffset(source.y);
 
-                    _PaintBufferOutputHelper(&engine, it, target, false);
+                    _PaintBufferOutputHelper(row, source.x, row.size(), target, false);
                 }
             }
         }
@@ -1192,7 +1471,7 @@ void Renderer::_PaintSelection(_In_ IRenderEngine* const pEngine)
             {
                 if (const auto rectCopy = rect & dirtyRect)
                 {
-                    LOG_IF_FAILED(pEngine->PaintSelection(rectCopy));
+                    _frame.PaintSelection(rectCopy);
                 }
             }
         }
@@ -19,6 +19,7 @@ Author(s):
 #include "../inc/IRenderEngine.hpp"
 #include "../inc/RenderSettings.hpp"
 
+#include "FrameSnapshot.hpp"
 #include "thread.hpp"
 
 #include "../../buffer/out/textBuffer.hpp"
@@ -36,6 +37,15 @@ namespace Microsoft::Console::Render
     class Renderer
     {
     public:
+        // How long the console lock was held by PaintFrame(), per painted frame.
+        struct PaintLockStatistics
+        {
+            std::chrono::nanoseconds last{};
+            std::chrono::nanoseconds peak{};
+            std::chrono::nanoseconds total{};
+            uint64_t frames = 0;
+        };
+
         Renderer(const RenderSettings& renderSettings,
                  IRenderData* pData,
                  _In_reads_(cEngines) IRenderEngine** const pEngine,
@@ -47,6 +57,7 @@ namespace Microsoft::Console::Render
         [[nodiscard]] HRESULT PaintFrame();
 
         void NotifyPaintFrame() noexcept;
+        void NotifyInput() noexcept;
         void TriggerSystemRedraw(const til::rect* const prcDirtyClient);
         void TriggerRedraw(const Microsoft::Console::Types::Viewport& region);
         void TriggerRedraw(const til::point* const pcoord);
@@ -90,27 +101,68 @@ namespace Microsoft::Console::Render
 
         void UpdateLastHoveredInterval(const std::optional<interval_tree::IntervalTree<til::point, size_t>::interval>& newInterval);
 
+        PaintLockStatistics GetPaintLockStatistics() const noexcept;
+        RenderThread::FrameStatistics GetFrameStatistics() const;
+
     private:
+        // An engine invalidation. It only borrows the selection rects and the text.
+        struct Invalidation
+        {
+            enum class Kind : uint8_t
+            {
+                Region,
+                Cursor,
+                System,
+                Selection,
+                Scroll,
+                Viewport,
+                All,
+                Title,
+                NewText,
+            };
+
+            Kind kind{};
+            til::rect rect; // Region, Cursor, System
+            til::inclusive_rect viewport; // Viewport
+            til::point delta; // Scroll, Viewport
+            const std::vector<til::rect>* rects = nullptr; // Selection
+            std::wstring_view text; // Title, NewText
+        };
+
+        // An invalidation that arrived while an engine was painted without holding the console lock,
+        // with copies of what it borrowed. They're applied in order before the next frame is painted.
+        struct PendingInvalidation
+        {
+            Invalidation invalidation;
+            std::vector<til::rect> rects;
+            std::wstring text;
+        };
+
         static IRenderEngine::GridLineSet s_GetGridlines(const TextAttribute& textAttribute) noexcept;
         static bool s_IsSoftFontChar(const std::wstring_view& v, const size_t firstSoftFontChar, const size_t lastSoftFontChar);
 
         [[nodiscard]] HRESULT _PaintFrameForEngine(_In_ IRenderEngine* const pEngine) noexcept;
+        void _InvalidateEngines(const Invalidation& invalidation);
+        static void s_ApplyInvalidation(IRenderEngine& engine, const Invalidation& invalidation) noexcept;
+        void _ApplyPendingInvalidations();
+        void _WaitForUnlockedPaint() const noexcept;
+        void _RecordPaintLockTime(const std::chrono::nanoseconds duration) noexcept;
         bool _CheckViewportAndScroll();
-        [[nodiscard]] HRESULT _PaintBackground(_In_ IRenderEngine* const pEngine);
+        void _PaintBackground();
         void _PaintBufferOutput(_In_ IRenderEngine* const pEngine);
-        void _PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine, TextBufferCellIterator it, const til::point target, const bool lineWrapped);
-        void _PaintBufferOutputGridLineHelper(_In_ IRenderEngine* const pEngine, const TextAttribute textAttribute, const size_t cchLine, const til::point coordTarget);
+        void _PaintBufferOutputHelper(const ROW& row, const til::CoordType columnBegin, const til::CoordType columnEnd, const til::point target, const bool lineWrapped);
+        void _PaintBufferOutputGridLineHelper(const TextAttribute textAttribute, const size_t cchLine, const til::point coordTarget);
         void _PaintSelection(_In_ IRenderEngine* const pEngine);
-        void _PaintCursor(_In_ IRenderEngine* const pEngine);
+        void _PaintCursor();
         void _PaintOverlays(_In_ IRenderEngine* const pEngine);
         void _PaintOverlay(IRenderEngine& engine, const RenderOverlay& overlay);
         [[nodiscard]] HRESULT _UpdateDrawingBrushes(_In_ IRenderEngine* const pEngine, const TextAttribute attr, const bool usingSoftFont, const bool isSettingDefaultBrushes);
         [[nodiscard]] HRESULT _PerformScrolling(_In_ IRenderEngine* const pEngine);
         std::vector<til::rect> _GetSelectionRects() const;
         void _ScrollPreviousSelection(const til::point delta);
-        [[nodiscard]] HRESULT _PaintTitle(IRenderEngine* const pEngine);
+        void _PaintTitle();
         [[nodiscard]] std::optional<CursorOptions> _GetCursorInfo();
-        [[nodiscard]] HRESULT _PrepareRenderInfo(_In_ IRenderEngine* const pEngine);
+        void _PrepareRenderInfo();
 
         const RenderSettings& _renderSettings;
         std::array<IRenderEngine*, 2> _engines{};
@@ -121,6 +173,16 @@ namespace Microsoft::Console::Render
         std::optional<interval_tree::IntervalTree<til::point, size_t>::interval> _hoveredInterval;
         Microsoft::Console::Types::Viewport _viewport;
         std::vector<Cluster> _clusterBuffer;
+        FrameSnapshot _frame;
+        // True while an engine is painted without holding the console lock.
+        std::atomic<bool> _unlockedPainting{ false };
+        std::mutex _pendingInvalidationsLock;
+        std::vector<PendingInvalidation> _pendingInvalidations;
+        std::atomic<bool> _hasPendingInvalidations{ false };
+        std::atomic<int64_t> _paintLockTimeLast{ 0 };
+        std::atomic<int64_t> _paintLockTimePeak{ 0 };
+        std::atomic<int64_t> _paintLockTimeTotal{ 0 };
+        std::atomic<uint64_t> _paintLockFrames{ 0 };
         std::vector<til::rect> _previousSelection;
         std::function<void()> _pfnBackgroundColorChanged;
         std::function<void()> _pfnFrameColorChanged;
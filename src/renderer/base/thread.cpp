@@ -10,15 +10,32 @@
 
 using namespace Microsoft::Console::Render;
 
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
 RenderThread::RenderThread() :
     _pRenderer(nullptr),
     _hThread(nullptr),
     _hEvent(nullptr),
     _hPaintCompletedEvent(nullptr),
+    _hInputEvent(nullptr),
+    _hFrameTimer(nullptr),
     _fKeepRunning(true),
     _hPaintEnabledEvent(nullptr),
     _fNextFrameRequested(false),
-    _fWaiting(false)
+    _fWaiting(false),
+    _refreshInterval(std::chrono::nanoseconds{ std::chrono::seconds{ 1 } } / 60),
+    _frameInterval(_refreshInterval),
+    _lastFrameStart(),
+    _saturatedFrames(0),
+    _inputTimestamp(0),
+    _skippedFrames(0),
+    _paintedFrames(0),
+    _pacedFrames(0),
+    _inputFrames(0),
+    _inputLatency(),
+    _inputLatencyCount(0)
 {
 }
 
@@ -51,6 +68,18 @@ RenderThread::~RenderThread()
         CloseHandle(_hPaintCompletedEvent);
         _hPaintCompletedEvent = nullptr;
     }
+
+    if (_hInputEvent)
+    {
+        CloseHandle(_hInputEvent);
+        _hInputEvent = nullptr;
+    }
+
+    if (_hFrameTimer)
+    {
+        CloseHandle(_hFrameTimer);
+        _hFrameTimer = nullptr;
+    }
 }
 
 // Method Description:
@@ -120,6 +149,45 @@ RenderThread::~RenderThread()
         }
     }
 
+    if (SUCCEEDED(hr))
+    {
+        auto hInputEvent = CreateEventW(nullptr,
+                                        FALSE, // auto reset event
+                                        FALSE, // initially unsignaled
+                                        nullptr);
+
+        if (hInputEvent == nullptr)
+        {
+            hr = HRESULT_FROM_WIN32(GetLastError());
+        }
+        else
+        {
+            _hInputEvent = hInputEvent;
+        }
+    }
+
+    if (SUCCEEDED(hr))
+    {
+        // High resolution timers are only supported since Windows 10 1803.
+        // Before that, we fall back to a regular one, which has the
+        // resolution of the system timer (usually ~15.6ms).
+        _hFrameTimer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+        if (!_hFrameTimer)
+        {
+            _hFrameTimer = CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+        }
+
+        // Cap the frame rate to the refresh rate of the display. If there's
+        // none (or it reports the hardware default of 0 or 1), we use 60 Hz.
+        DEVMODEW dm{};
+        dm.dmSize = sizeof(dm);
+        if (EnumDisplaySettingsW(nullptr, ENUM_CURRENT_SETTINGS, &dm) && dm.dmDisplayFrequency > 1)
+        {
+            _refreshInterval = std::chrono::nanoseconds{ std::chrono::seconds{ 1 } } / dm.dmDisplayFrequency;
+            _frameInterval = _refreshInterval;
+        }
+    }
+
     if (SUCCEEDED(hr))
     {
         auto hThread = CreateThread(nullptr, // non-inheritable security attributes
@@ -208,27 +276,194 @@ DWORD WINAPI RenderThread::_ThreadProc()
             ResetEvent(_hEvent);
         }
 
+        const auto wait = _WaitForNextFrame();
+
+        // Painting might have been disabled while we were waiting. In that case
+        // the frame is painted once it gets enabled again.
+        if (_fKeepRunning && WaitForSingleObject(_hPaintEnabledEvent, 0) != WAIT_OBJECT_0)
+        {
+            _fNextFrameRequested.store(true, std::memory_order_release);
+            continue;
+        }
+
         ResetEvent(_hPaintCompletedEvent);
 
+        const auto frameStart = std::chrono::steady_clock::now();
+        const auto inputTimestamp = _inputTimestamp.exchange(0, std::memory_order_relaxed);
+        _lastFrameStart = frameStart;
+
         _pRenderer->WaitUntilCanRender();
         LOG_IF_FAILED(_pRenderer->PaintFrame());
 
+        _FramePainted(frameStart, inputTimestamp, wait);
+
         SetEvent(_hPaintCompletedEvent);
     }
 
     return S_OK;
 }
 
+// Method Description:
+// - Paces the frames. Returns right away if the frame most likely contains
+//      the echo of some input, or if we're shutting down. Otherwise we wait
+//      until _frameInterval has passed since the previous frame started, so
+//      that we don't paint more frames than the display can show (or, while
+//      the output is saturated, fewer than that). Input that arrives while
+//      we're waiting ends the wait early.
+// Arguments:
+// - <none>
+// Return Value:
+// - Whether and why we waited.
+RenderThread::FrameWait RenderThread::_WaitForNextFrame() noexcept
+{
+    if (!_fKeepRunning)
+    {
+        return FrameWait::None;
+    }
+
+    // Any input that arrives from now on wakes us up.
+    ResetEvent(_hInputEvent);
+
+    const auto now = std::chrono::steady_clock::now();
+    const auto inputTimestamp = _inputTimestamp.load(std::memory_order_relaxed);
+    if (inputTimestamp != 0 && now - std::chrono::steady_clock::time_point{ std::chrono::steady_clock::duration{ inputTimestamp } } <= INPUT_ECHO_TIMEOUT)
+    {
+        return FrameWait::Input;
+    }
+
+    const auto remaining = _lastFrameStart + _frameInterval - now;
+    if (remaining <= std::chrono::nanoseconds::zero())
+    {
+        return FrameWait::None;
+    }
+
+    // The due time is relative (negative) and in 100ns units.
+    LARGE_INTEGER dueTime;
+    dueTime.QuadPart = -std::max<LONGLONG>(1, std::chrono::duration_cast<std::chrono::nanoseconds>(remaining).count() / 100);
+
+    if (_hFrameTimer && SetWaitableTimer(_hFrameTimer, &dueTime, 0, nullptr, nullptr, FALSE))
+    {
+        const std::array handles{ _hFrameTimer, _hInputEvent };
+        const auto result = WaitForMultipleObjects(gsl::narrow_cast<DWORD>(handles.size()), handles.data(), FALSE, INFINITE);
+        return result == WAIT_OBJECT_0 + 1 ? FrameWait::Input : FrameWait::Paced;
+    }
+
+    const auto ms = std::chrono::ceil<std::chrono::milliseconds>(remaining).count();
+    const auto result = WaitForSingleObject(_hInputEvent, gsl::narrow_cast<DWORD>(ms));
+    return result == WAIT_OBJECT_0 ? FrameWait::Input : FrameWait::Paced;
+}
+
+// Method Description:
+// - Updates the frame interval and statistics after a frame has been painted.
+//      If another paint was already requested during this one, the output is
+//      saturating us: after SATURATED_FRAMES_BEFORE_BACKOFF such frames in a
+//      row we halve the frame rate, down to 1/MAX_BACKOFF_FACTOR of the
+//      refresh rate. As soon as a frame finishes with nothing else to paint,
+//      we go back to the refresh rate.
+// Arguments:
+// - frameStart - When the frame started.
+// - inputTimestamp - The value of _inputTimestamp when the frame started.
+// - wait - How _WaitForNextFrame() paced the frame.
+// Return Value:
+// - <none>
+void RenderThread::_FramePainted(const std::chrono::steady_clock::time_point frameStart, const int64_t inputTimestamp, const FrameWait wait) noexcept
+{
+    const auto frameEnd = std::chrono::steady_clock::now();
+
+    const std::scoped_lock lock{ _statisticsLock };
+
+    if (_fNextFrameRequested.load(std::memory_order_acquire))
+    {
+        if (++_saturatedFrames >= SATURATED_FRAMES_BEFORE_BACKOFF)
+        {
+            _saturatedFrames = 0;
+            _frameInterval = std::min(_frameInterval * 2, _refreshInterval * MAX_BACKOFF_FACTOR);
+        }
+    }
+    else
+    {
+        _saturatedFrames = 0;
+        _frameInterval = _refreshInterval;
+    }
+
+    _paintedFrames++;
+
+    if (wait == FrameWait::Paced)
+    {
+        _pacedFrames++;
+    }
+    else if (wait == FrameWait::Input)
+    {
+        _inputFrames++;
+    }
+
+    if (inputTimestamp != 0)
+    {
+        const std::chrono::steady_clock::time_point inputTime{ std::chrono::steady_clock::duration{ inputTimestamp } };
+        if (frameStart - inputTime <= INPUT_ECHO_TIMEOUT)
+        {
+            til::at(_inputLatency, _inputLatencyCount % MAX_LATENCY_SAMPLES) = frameEnd - inputTime;
+            _inputLatencyCount++;
+        }
+    }
+}
+
 void RenderThread::NotifyPaint() noexcept
 {
     if (_fWaiting.load(std::memory_order_acquire))
     {
         SetEvent(_hEvent);
     }
-    else
+    else if (_fNextFrameRequested.exchange(true, std::memory_order_acq_rel))
+    {
+        // The previous request hasn't been picked up yet and gets folded into the same frame.
+        _skippedFrames.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+// Method Description:
+// - Tells us that input arrived. The frame after it most likely contains the
+//      input's echo and is painted right away, instead of being paced.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void RenderThread::NotifyInput() noexcept
+{
+    // Only the oldest input is kept, since the frame after it is the one we want to measure.
+    auto expected = int64_t{ 0 };
+    const auto now = std::chrono::steady_clock::now().time_since_epoch().count();
+    _inputTimestamp.compare_exchange_strong(expected, now, std::memory_order_relaxed);
+
+    if (_hInputEvent)
+    {
+        SetEvent(_hInputEvent);
+    }
+}
+
+// Method Description:
+// - Returns the number of painted and skipped frames, and the latency of the
+//      most recent frames that followed input.
+RenderThread::FrameStatistics RenderThread::GetFrameStatistics() const
+{
+    FrameStatistics stats;
+    stats.skippedFrames = _skippedFrames.load(std::memory_order_relaxed);
+
+    const std::scoped_lock lock{ _statisticsLock };
+
+    stats.paintedFrames = _paintedFrames;
+    stats.pacedFrames = _pacedFrames;
+    stats.inputFrames = _inputFrames;
+    stats.frameInterval = _frameInterval;
+
+    const auto count = std::min(_inputLatencyCount, MAX_LATENCY_SAMPLES);
+    stats.inputLatency.reserve(count);
+    for (auto i = _inputLatencyCount - count; i < _inputLatencyCount; ++i)
     {
-        _fNextFrameRequested.store(true, std::memory_order_release);
+        stats.inputLatency.push_back(til::at(_inputLatency, i % MAX_LATENCY_SAMPLES));
     }
+
+    return stats;
 }
 
 void RenderThread::EnablePainting() noexcept
@@ -21,30 +21,90 @@ namespace Microsoft::Console::Render
     class RenderThread
     {
     public:
+        // The frame rate is halved after this many frames in a row, for which
+        // another paint was requested before the previous one finished.
+        static constexpr uint32_t SATURATED_FRAMES_BEFORE_BACKOFF = 30;
+        // How far below the display's refresh rate we go while saturated.
+        static constexpr uint32_t MAX_BACKOFF_FACTOR = 4;
+        // Frames are painted right away if input arrived less than this long ago,
+        // since they most likely contain its echo.
+        static constexpr std::chrono::milliseconds INPUT_ECHO_TIMEOUT{ 250 };
+        static constexpr size_t MAX_LATENCY_SAMPLES = 64;
+
+        struct FrameStatistics
+        {
+            uint64_t paintedFrames = 0;
+            // Paint requests that arrived while another one was still pending.
+            uint64_t skippedFrames = 0;
+            // Frames that waited for the frame interval to pass.
+            uint64_t pacedFrames = 0;
+            // Frames that skipped (or cut short) that wait, because they followed input.
+            uint64_t inputFrames = 0;
+            // The current time between two frames, when not following input.
+            std::chrono::nanoseconds frameInterval{};
+            // Time from input arriving until the next frame was painted, oldest first.
+            std::vector<std::chrono::nanoseconds> inputLatency;
+        };
+
         RenderThread();
         ~RenderThread();
 
         [[nodiscard]] HRESULT Initialize(Renderer* const pRendererParent) noexcept;
 
         void NotifyPaint() noexcept;
+        void NotifyInput() noexcept;
         void EnablePainting() noexcept;
         void DisablePainting() noexcept;
         void WaitForPaintCompletionAndDisable(const DWORD dwTimeoutMs) noexcept;
 
+        FrameStatistics GetFrameStatistics() const;
+
     private:
         static DWORD WINAPI s_ThreadProc(_In_ LPVOID lpParameter);
         DWORD WINAPI _ThreadProc();
 
+        enum class FrameWait : uint8_t
+        {
+            None, // The frame interval had already passed.
+            Paced, // We waited for the frame interval to pass.
+            Input, // We didn't wait for it, because input arrived.
+        };
+
+        FrameWait _WaitForNextFrame() noexcept;
+        void _FramePainted(const std::chrono::steady_clock::time_point frameStart, const int64_t inputTimestamp, const FrameWait wait) noexcept;
+
         HANDLE _hThread;
         HANDLE _hEvent;
 
         HANDLE _hPaintEnabledEvent;
         HANDLE _hPaintCompletedEvent;
 
+        HANDLE _hInputEvent;
+        HANDLE _hFrameTimer;
+
         Renderer* _pRenderer; // Non-ownership pointer
 
         bool _fKeepRunning;
         std::atomic<bool> _fNextFrameRequested;
         std::atomic<bool> _fWaiting;
+
+        // Only accessed by the render thread, except for _frameInterval,
+        // which is also read by GetFrameStatistics() under _statisticsLock.
+        std::chrono::nanoseconds _refreshInterval;
+        std::chrono::nanoseconds _frameInterval;
+        std::chrono::steady_clock::time_point _lastFrameStart;
+        uint32_t _saturatedFrames;
+
+        // The steady_clock time at which the oldest input not followed by a frame
+        // arrived, or 0 if there is none.
+        std::atomic<int64_t> _inputTimestamp;
+        std::atomic<uint64_t> _skippedFrames;
+
+        mutable std::mutex _statisticsLock;
+        uint64_t _paintedFrames;
+        uint64_t _pacedFrames;
+        uint64_t _inputFrames;
+        std::array<std::chrono::nanoseconds, MAX_LATENCY_SAMPLES> _inputLatency;
+        size_t _inputLatencyCount;
     };
 }
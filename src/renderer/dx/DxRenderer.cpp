@@ -1490,10 +1490,6 @@ CATCH_RETURN()
 // - See https://docs.microsoft.com/en-us/windows/uwp/gaming/reduce-latency-with-dxgi-1-3-swap-chains.
 void DxEngine::WaitUntilCanRender() noexcept
 {
-    // Throttle the DxEngine a bit down to ~60 FPS.
-    // This improves throughput for rendering complex or colored text.
-    Sleep(8);
-
     if (_swapChainFrameLatencyWaitableObject)
     {
         WaitForSingleObjectEx(_swapChainFrameLatencyWaitableObject.get(), 100, true);
@@ -38,6 +38,7 @@ namespace Microsoft::Console::Render
         [[nodiscard]] HRESULT StartPaint() noexcept override;
         [[nodiscard]] HRESULT EndPaint() noexcept override;
         [[nodiscard]] HRESULT Present() noexcept override;
+        [[nodiscard]] bool SupportsUnlockedPainting() noexcept override;
 
         [[nodiscard]] HRESULT ScrollFrame() noexcept override;
 
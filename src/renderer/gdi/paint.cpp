@@ -261,6 +261,18 @@ bool GdiEngine::FontHasWesternScript(HDC hdc)
     return S_FALSE;
 }
 
+// Routine Description:
+// - Apart from SetHwnd() during startup, we're only ever called through the Renderer,
+//   which serializes its calls with our painting. We don't look at the IRenderData either.
+// Arguments:
+// - <none>
+// Return Value:
+// - true, since the Renderer may paint us without holding the console lock.
+[[nodiscard]] bool GdiEngine::SupportsUnlockedPainting() noexcept
+{
+    return true;
+}
+
 // Routine Description:
 // - Fills the given rectangle with the background color on the drawing context.
 // Arguments:
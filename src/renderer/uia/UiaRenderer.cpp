@@ -4,6 +4,7 @@
 #include "precomp.h"
 
 #include "UiaRenderer.hpp"
+#include "../../buffer/out/textBuffer.hpp"
 
 #pragma hdrstop
 
@@ -18,6 +19,7 @@ UiaEngine::UiaEngine(IUiaEventDispatcher* dispatcher) :
     _isPainting{ false },
     _selectionChanged{ false },
     _textBufferChanged{ false },
+    _textBufferMaybeChanged{ false },
     _cursorChanged{ false },
     _isEnabled{ true },
     _prevSelection{},
@@ -52,14 +54,23 @@ UiaEngine::UiaEngine(IUiaEventDispatcher* dispatcher) :
 
 // Routine Description:
 // - Notifies us that the console has changed the character region specified.
-// - NOTE: This typically triggers on cursor or text buffer changes
+// - NOTE: This typically triggers on cursor or text buffer changes, but also on
+//   hyperlink hovers, search highlights, etc. which don't change any text.
+//   UpdateDrawingBrushes() decides whether the text in the region really changed.
 // Arguments:
 // - psrRegion - Character region (til::rect) that has been changed
 // Return Value:
 // - S_OK, else an appropriate HRESULT for failing to allocate or write.
-[[nodiscard]] HRESULT UiaEngine::Invalidate(const til::rect* const /*psrRegion*/) noexcept
+[[nodiscard]] HRESULT UiaEngine::Invalidate(const til::rect* const psrRegion) noexcept
 {
-    _textBufferChanged = true;
+    if (!psrRegion)
+    {
+        _textBufferChanged = true;
+        return S_OK;
+    }
+
+    _invalidatedRegion |= *psrRegion;
+    _textBufferMaybeChanged = true;
     return S_OK;
 }
 
@@ -206,7 +217,7 @@ CATCH_LOG_RETURN_HR(E_FAIL);
     RETURN_HR_IF(S_FALSE, !_isEnabled);
 
     // add more events here
-    const auto somethingToDo = _selectionChanged || _textBufferChanged || _cursorChanged || !_queuedOutput.empty();
+    const auto somethingToDo = _selectionChanged || _textBufferChanged || _textBufferMaybeChanged || _cursorChanged || !_queuedOutput.empty();
 
     // If there's nothing to do, quick return
     RETURN_HR_IF(S_FALSE, !somethingToDo);
@@ -235,13 +246,6 @@ CATCH_LOG_RETURN_HR(E_FAIL);
     return S_OK;
 }
 
-// RenderEngineBase defines a WaitUntilCanRender() that sleeps for 8ms to throttle rendering.
-// But UiaEngine is never the only engine running. Overriding this function prevents
-// us from sleeping 16ms per frame, when the other engine also sleeps for 8ms.
-void UiaEngine::WaitUntilCanRender() noexcept
-{
-}
-
 // Routine Description:
 // - Used to perform longer running presentation steps outside the lock so the
 //      other threads can continue.
@@ -388,23 +392,51 @@ void UiaEngine::WaitUntilCanRender() noexcept
 
 // Routine Description:
 // - Updates the default brush colors used for drawing
-//  For UIA, this doesn't mean anything. So do nothing.
+//  For UIA, colors don't mean anything. But the Renderer sets the default brushes once
+//  at the start of each frame while holding the console lock, which is when we check
+//  whether the rows passed to Invalidate() changed since the previous frame.
+//  Only then do automation clients get told that the text changed.
 // Arguments:
 // - textAttributes - <unused>
 // - renderSettings - <unused>
-// - pData - <unused>
+// - pData - The console data to check the invalidated rows against
 // - usingSoftFont - <unused>
-// - isSettingDefaultBrushes - <unused>
+// - isSettingDefaultBrushes - Whether this is the call at the start of the frame
 // Return Value:
-// - S_FALSE since we do nothing
+// - S_FALSE since we don't draw anything
 [[nodiscard]] HRESULT UiaEngine::UpdateDrawingBrushes(const TextAttribute& /*textAttributes*/,
                                                       const RenderSettings& /*renderSettings*/,
-                                                      const gsl::not_null<IRenderData*> /*pData*/,
+                                                      const gsl::not_null<IRenderData*> pData,
                                                       const bool /*usingSoftFont*/,
-                                                      const bool /*isSettingDefaultBrushes*/) noexcept
+                                                      const bool isSettingDefaultBrushes) noexcept
+try
 {
+    if (!isSettingDefaultBrushes)
+    {
+        return S_FALSE;
+    }
+
+    const auto& buffer = pData->GetTextBuffer();
+    const auto viewportTop = pData->GetViewport().Top();
+    const auto firstRow = buffer.GetFirstRowIndex();
+
+    if (_textBufferMaybeChanged && !_textBufferChanged)
+    {
+        // Rows keep their generation when they move to another offset,
+        // so the invalidated rows need to be at the same offsets as before.
+        _textBufferChanged = firstRow != _textFirstRow ||
+                             viewportTop != _textViewportTop ||
+                             buffer.RowsChangedSince(viewportTop + _invalidatedRegion.top, viewportTop + _invalidatedRegion.bottom - 1, _textGeneration);
+    }
+
+    _textBufferMaybeChanged = false;
+    _invalidatedRegion = {};
+    _textGeneration = buffer.GetGeneration();
+    _textFirstRow = firstRow;
+    _textViewportTop = viewportTop;
     return S_FALSE;
 }
+CATCH_RETURN();
 
 // Routine Description:
 // - Updates the font used for drawing
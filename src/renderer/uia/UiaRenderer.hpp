@@ -36,7 +36,6 @@ namespace Microsoft::Console::Render
         // IRenderEngine Members
         [[nodiscard]] HRESULT StartPaint() noexcept override;
         [[nodiscard]] HRESULT EndPaint() noexcept override;
-        void WaitUntilCanRender() noexcept override;
         [[nodiscard]] HRESULT Present() noexcept override;
         [[nodiscard]] HRESULT PrepareForTeardown(_Out_ bool* const pForcePaint) noexcept override;
         [[nodiscard]] HRESULT ScrollFrame() noexcept override;
@@ -69,6 +68,7 @@ namespace Microsoft::Console::Render
         bool _isPainting;
         bool _selectionChanged;
         bool _textBufferChanged;
+        bool _textBufferMaybeChanged;
         bool _cursorChanged;
         std::wstring _newOutput;
         std::wstring _queuedOutput;
@@ -77,5 +77,12 @@ namespace Microsoft::Console::Render
 
         std::vector<til::rect> _prevSelection;
         til::rect _prevCursorRegion;
+
+        // The region passed to Invalidate() and what it's compared against in UpdateDrawingBrushes().
+        // See TextBuffer::RowsChangedSince().
+        til::rect _invalidatedRegion;
+        uint64_t _textGeneration = 0;
+        til::CoordType _textFirstRow = 0;
+        til::CoordType _textViewportTop = 0;
     };
 }
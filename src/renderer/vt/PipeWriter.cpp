@@ -0,0 +1,210 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "PipeWriter.hpp"
+
+#pragma hdrstop
+
+using namespace Microsoft::Console::Render;
+
+// Routine Description:
+// - Creates a new pipe writer and starts its thread.
+// - NOTE: Will throw if the thread can't be created. Caller must catch.
+// Arguments:
+// - pipe - The pipe to write to. It's owned by the caller and must outlive us.
+// Return Value:
+// - An instance of VtPipeWriter.
+VtPipeWriter::VtPipeWriter(const HANDLE pipe) :
+    _pipe{ pipe }
+{
+    // 0 is the right value, https://blogs.msdn.microsoft.com/oldnewthing/20040223-00/?p=40503
+    DWORD dwThreadId = 0;
+    _hThread.reset(CreateThread(nullptr, 0, s_WriterThreadProc, this, 0, &dwThreadId));
+    THROW_LAST_ERROR_IF(!_hThread);
+    LOG_IF_FAILED(SetThreadDescription(_hThread.get(), L"ConPTY Output Writer Thread"));
+}
+
+// Routine Description:
+// - Writes everything that's still queued and stops the writer thread.
+VtPipeWriter::~VtPipeWriter()
+{
+    {
+        const std::scoped_lock lock{ _mutex };
+        _exitRequested = true;
+    }
+    _wakeWriter.notify_one();
+    WaitForSingleObject(_hThread.get(), INFINITE);
+}
+
+// Routine Description:
+// - Queues the given buffer for writing and returns, unless more than the
+//      high-water mark is now waiting behind the write in progress. In that
+//      case it waits until the writer thread picked it up.
+// - The buffer is swapped with an unused one if possible, so that its
+//      capacity gets reused instead of allocating a new one for each frame.
+// Arguments:
+// - buffer - The bytes to write. Will be empty afterwards.
+// Return Value:
+// - S_OK, or the error of a previous WriteFile call.
+[[nodiscard]] HRESULT VtPipeWriter::Submit(std::string& buffer) noexcept
+try
+{
+    std::unique_lock lock{ _mutex };
+
+    if (SUCCEEDED(_result) && !buffer.empty())
+    {
+        if (_queued.empty())
+        {
+            _queued.swap(buffer);
+        }
+        else
+        {
+            _queued.append(buffer);
+        }
+        _wakeWriter.notify_one();
+
+        if (_queued.size() > _highWaterMark)
+        {
+            _Stall(lock, false);
+        }
+    }
+
+    buffer.clear();
+    return _result;
+}
+CATCH_RETURN();
+
+// Routine Description:
+// - Waits until everything that was submitted has been written.
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK, or the error of a previous WriteFile call.
+[[nodiscard]] HRESULT VtPipeWriter::Drain() noexcept
+try
+{
+    std::unique_lock lock{ _mutex };
+
+    if (SUCCEEDED(_result) && (!_queued.empty() || _inFlight != 0))
+    {
+        _Stall(lock, true);
+    }
+
+    return _result;
+}
+CATCH_RETURN();
+
+// Routine Description:
+// - Sets the number of bytes that may be queued behind the write in progress,
+//      before Submit() starts to wait for the terminal to catch up.
+// Arguments:
+// - bytes - The new high-water mark.
+// Return Value:
+// - <none>
+void VtPipeWriter::SetHighWaterMark(const size_t bytes) noexcept
+{
+    const std::scoped_lock lock{ _mutex };
+    _highWaterMark = bytes;
+}
+
+VtPipeWriter::Statistics VtPipeWriter::GetStatistics() const
+{
+    const std::scoped_lock lock{ _mutex };
+    return _stats;
+}
+
+// Routine Description:
+// - Blocks the caller until the writer thread caught up, or failed.
+// Arguments:
+// - lock - The held lock on _mutex.
+// - drain - If true, waits until everything has been written. Otherwise,
+//      waits until no more than the high-water mark is queued.
+// Return Value:
+// - <none>
+void VtPipeWriter::_Stall(std::unique_lock<std::mutex>& lock, const bool drain)
+{
+    const auto beg = std::chrono::steady_clock::now();
+
+    _wakeSubmitter.wait(lock, [&]() {
+        if (FAILED(_result))
+        {
+            return true;
+        }
+        return drain ? _queued.empty() && _inFlight == 0 : _queued.size() <= _highWaterMark;
+    });
+
+    _stats.stalls++;
+    _stats.stallTime += std::chrono::steady_clock::now() - beg;
+}
+
+// Function Description:
+// - Static function used for initializing an instance's ThreadProc.
+// Arguments:
+// - lpParameter - A pointer to the VtPipeWriter instance that should be called.
+// Return Value:
+// - The return value of the underlying instance's _WriterThread
+DWORD WINAPI VtPipeWriter::s_WriterThreadProc(_In_ LPVOID lpParameter) noexcept
+{
+    const auto pInstance = static_cast<VtPipeWriter*>(lpParameter);
+    pInstance->_WriterThread();
+    return S_OK;
+}
+
+// Method Description:
+// - The ThreadProc for the writer thread. Takes everything that's queued and
+//      writes it to the pipe in a single WriteFile call, until asked to exit.
+//      On exit, everything still queued is written first.
+// - After a failed write, the error is kept for Submit() to return and
+//      nothing is written anymore.
+void VtPipeWriter::_WriterThread() noexcept
+{
+    // The buffer we're writing from. It's swapped with _queued, so that the
+    //      two of them (and the VT engine's) are reused for the entire session.
+    std::string writing;
+    std::unique_lock lock{ _mutex };
+
+    for (;;)
+    {
+        _wakeWriter.wait(lock, [&]() { return !_queued.empty() || _exitRequested; });
+        if (_queued.empty())
+        {
+            break;
+        }
+
+        writing.clear();
+        writing.swap(_queued);
+        _inFlight = writing.size();
+        lock.unlock();
+        _wakeSubmitter.notify_all();
+
+        const auto beg = std::chrono::steady_clock::now();
+        const auto fSuccess = !!WriteFile(_pipe, writing.data(), gsl::narrow_cast<DWORD>(writing.size()), nullptr, nullptr);
+        const auto error = fSuccess ? ERROR_SUCCESS : GetLastError();
+        const auto end = std::chrono::steady_clock::now();
+
+        lock.lock();
+        _inFlight = 0;
+        _stats.writes++;
+        _stats.writeTime += end - beg;
+
+        if (fSuccess)
+        {
+            _stats.bytesWritten += writing.size();
+        }
+        else
+        {
+            // If there wasn't an error in GLE, just use E_FAIL, so that
+            // Submit() doesn't keep queueing bytes nobody will write.
+            _result = error == ERROR_SUCCESS ? E_FAIL : HRESULT_FROM_WIN32(error);
+            _queued.clear();
+        }
+
+        _wakeSubmitter.notify_all();
+
+        if (!fSuccess)
+        {
+            break;
+        }
+    }
+}
@@ -0,0 +1,74 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- PipeWriter.hpp
+
+Abstract:
+- Writes the output of the VT engine to the conpty pipe on a thread of its own.
+- WriteFile on the pipe blocks until the terminal has read what we wrote. Doing
+  that on the render thread stalls the paint, and with it everyone waiting for
+  the console lock. Instead, the VT engine hands each frame to this class and
+  carries on, while the previous frame drains. It only blocks once more than
+  the high-water mark is queued behind the write in progress.
+--*/
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+
+namespace Microsoft::Console::Render
+{
+    class VtPipeWriter
+    {
+    public:
+        // The number of bytes that may be queued behind the write in progress
+        // before Submit() waits for the terminal to catch up.
+        static constexpr size_t DEFAULT_HIGH_WATER_MARK = 256 * 1024;
+
+        struct Statistics
+        {
+            uint64_t bytesWritten = 0;
+            uint64_t writes = 0;
+            // Time the writer thread spent blocked in WriteFile.
+            std::chrono::nanoseconds writeTime{};
+            // Number of times (and how long) the caller of Submit() or Drain()
+            // was blocked, because the terminal didn't read fast enough.
+            uint64_t stalls = 0;
+            std::chrono::nanoseconds stallTime{};
+        };
+
+        VtPipeWriter(const HANDLE pipe);
+        ~VtPipeWriter();
+
+        VtPipeWriter(const VtPipeWriter&) = delete;
+        VtPipeWriter& operator=(const VtPipeWriter&) = delete;
+
+        [[nodiscard]] HRESULT Submit(std::string& buffer) noexcept;
+        [[nodiscard]] HRESULT Drain() noexcept;
+        void SetHighWaterMark(const size_t bytes) noexcept;
+        Statistics GetStatistics() const;
+
+    private:
+        static DWORD WINAPI s_WriterThreadProc(_In_ LPVOID lpParameter) noexcept;
+        void _WriterThread() noexcept;
+        void _Stall(std::unique_lock<std::mutex>& lock, const bool drain);
+
+        HANDLE _pipe;
+        wil::unique_handle _hThread;
+
+        mutable std::mutex _mutex;
+        std::condition_variable _wakeWriter;
+        std::condition_variable _wakeSubmitter;
+
+        // The bytes waiting for the write in progress to finish, and the size of that write.
+        std::string _queued;
+        size_t _inFlight = 0;
+        size_t _highWaterMark = DEFAULT_HIGH_WATER_MARK;
+        HRESULT _result = S_OK;
+        bool _exitRequested = false;
+        Statistics _stats;
+    };
+}
@@ -19,18 +19,16 @@ Xterm256Engine::Xterm256Engine(_In_ wil::unique_hfile hPipe,
 //      color sequences.
 // Arguments:
 // - textAttributes - Text attributes to use for the colors and character rendition
-// - renderSettings - The color table and modes required for rendering
 // - pData - The interface to console data structures required for rendering
 // - usingSoftFont - Whether we're rendering characters from a soft font
 // - isSettingDefaultBrushes: indicates if we should change the background color of
 //      the window. Unused for VT
 // Return Value:
 // - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
-[[nodiscard]] HRESULT Xterm256Engine::UpdateDrawingBrushes(const TextAttribute& textAttributes,
-                                                           const RenderSettings& /*renderSettings*/,
-                                                           const gsl::not_null<IRenderData*> pData,
-                                                           const bool usingSoftFont,
-                                                           const bool isSettingDefaultBrushes) noexcept
+[[nodiscard]] HRESULT Xterm256Engine::_UpdateDrawingBrushes(const TextAttribute& textAttributes,
+                                                            const gsl::not_null<IRenderData*> pData,
+                                                            const bool usingSoftFont,
+                                                            const bool isSettingDefaultBrushes) noexcept
 {
     RETURN_HR_IF(S_FALSE, _passthrough && isSettingDefaultBrushes);
 
@@ -187,5 +185,7 @@ HRESULT Microsoft::Console::Render::Xterm256Engine::_UpdateHyperlinkAttr(const T
 // - S_OK if we wrote the sequences successfully, otherwise an appropriate HRESULT
 [[nodiscard]] HRESULT Xterm256Engine::ManuallyClearScrollback() noexcept
 {
+    // Not every terminal limits ED 3 to the scrollback.
+    _ForgetShadowFrame();
     return _ClearScrollback();
 }
@@ -64,6 +64,7 @@ XtermEngine::XtermEngine(_In_ wil::unique_hfile hPipe,
         //      the screen on the first paint, just to make sure that the
         //      terminal's state is consistent with what we'll be rendering.
         RETURN_IF_FAILED(_ClearScreen());
+        _ForgetShadowFrame();
         _clearedAllThisFrame = true;
         _firstPaint = false;
     }
@@ -137,18 +138,16 @@ XtermEngine::XtermEngine(_In_ wil::unique_hfile hPipe,
 //      16-color attributes.
 // Arguments:
 // - textAttributes - Text attributes to use for the colors and character rendition
-// - renderSettings - The color table and modes required for rendering
 // - pData - The interface to console data structures required for rendering
 // - usingSoftFont - Whether we're rendering characters from a soft font
 // - isSettingDefaultBrushes: indicates if we should change the background color of
 //      the window. Unused for VT
 // Return Value:
 // - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
-[[nodiscard]] HRESULT XtermEngine::UpdateDrawingBrushes(const TextAttribute& textAttributes,
-                                                        const RenderSettings& /*renderSettings*/,
-                                                        const gsl::not_null<IRenderData*> /*pData*/,
-                                                        const bool /*usingSoftFont*/,
-                                                        const bool /*isSettingDefaultBrushes*/) noexcept
+[[nodiscard]] HRESULT XtermEngine::_UpdateDrawingBrushes(const TextAttribute& textAttributes,
+                                                         const gsl::not_null<IRenderData*> /*pData*/,
+                                                         const bool /*usingSoftFont*/,
+                                                         const bool /*isSettingDefaultBrushes*/) noexcept
 {
     // The base xterm mode only knows about 16 colors
     RETURN_IF_FAILED(VtEngine::_16ColorUpdateDrawingBrushes(textAttributes));
@@ -354,6 +353,7 @@ try
     if (_scrollDelta.x != 0)
     {
         // No easy way to shift left-right. Everything needs repainting.
+        _ForgetShadowFrame();
         return InvalidateAll();
     }
     if (_scrollDelta.y == 0)
@@ -398,6 +398,8 @@ try
         RETURN_IF_FAILED(_InsertLine(absDy));
     }
 
+    _ScrollShadowFrame(dy);
+
     // Restore our wrap state.
     _wrappedRow = oldWrappedRow;
     _delayedEolWrap = oldDelayedEolWrap;
@@ -509,8 +511,14 @@ CATCH_RETURN();
                                                    const bool /*trimLeft*/,
                                                    const bool lineWrapped) noexcept
 {
-    return _fUseAsciiOnly ?
-               VtEngine::_PaintAsciiBufferLine(clusters, coord) :
+    if (_fUseAsciiOnly)
+    {
+        RETURN_IF_FAILED(_ApplyDeferredDrawingBrushes());
+        return VtEngine::_PaintAsciiBufferLine(clusters, coord);
+    }
+
+    return _shadowFrameDiffing ?
+               VtEngine::_PaintShadowedBufferLine(clusters, coord, lineWrapped) :
                VtEngine::_PaintUtf8BufferLine(clusters, coord, lineWrapped);
 }
 
@@ -523,6 +531,9 @@ CATCH_RETURN();
 // - S_OK or suitable HRESULT error from either conversion or writing pipe.
 [[nodiscard]] HRESULT XtermEngine::WriteTerminalW(const std::wstring_view wstr) noexcept
 {
+    // We don't know what this string does to the terminal's contents.
+    _ForgetShadowFrame();
+
     RETURN_IF_FAILED(_fUseAsciiOnly ?
                          VtEngine::_WriteTerminalAscii(wstr) :
                          VtEngine::_WriteTerminalUtf8(wstr));
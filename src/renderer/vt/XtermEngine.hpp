@@ -38,11 +38,6 @@ namespace Microsoft::Console::Render
 
         [[nodiscard]] HRESULT PaintCursor(const CursorOptions& options) noexcept override;
 
-        [[nodiscard]] virtual HRESULT UpdateDrawingBrushes(const TextAttribute& textAttributes,
-                                                           const RenderSettings& renderSettings,
-                                                           const gsl::not_null<IRenderData*> pData,
-                                                           const bool usingSoftFont,
-                                                           const bool isSettingDefaultBrushes) noexcept override;
         [[nodiscard]] HRESULT PaintBufferLine(const std::span<const Cluster> clusters,
                                               const til::point coord,
                                               const bool trimLeft,
@@ -70,6 +65,10 @@ namespace Microsoft::Console::Render
         Tribool _lastCursorIsVisible;
         bool _nextCursorIsVisible;
 
+        [[nodiscard]] HRESULT _UpdateDrawingBrushes(const TextAttribute& textAttributes,
+                                                    const gsl::not_null<IRenderData*> pData,
+                                                    const bool usingSoftFont,
+                                                    const bool isSettingDefaultBrushes) noexcept override;
         [[nodiscard]] HRESULT _MoveCursor(const til::point coord) noexcept override;
 
         [[nodiscard]] HRESULT _DoUpdateTitle(const std::wstring_view newTitle) noexcept override;
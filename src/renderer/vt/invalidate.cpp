@@ -136,5 +136,14 @@ CATCH_RETURN();
 [[nodiscard]] HRESULT VtEngine::PrepareForTeardown(_Out_ bool* const pForcePaint) noexcept
 {
     *pForcePaint = true;
+
+    // The process exits right after the final frame. Everything we wrote
+    // before it, and the frame itself, need to reach the terminal first.
+    _drainOnFlush = true;
+    if (_writer)
+    {
+        LOG_IF_FAILED(_writer->Drain());
+    }
+
     return S_OK;
 }
@@ -61,6 +61,7 @@ using namespace Microsoft::Console::Types;
 
     _invalidMap.reset_all();
 
+    _deferredBrushes.pending = false;
     _scrollDelta = { 0, 0 };
     _clearedAllThisFrame = false;
     _cursorMoved = false;
@@ -232,6 +233,56 @@ using namespace Microsoft::Console::Types;
     return S_OK;
 }
 
+// Routine Description:
+// - Write a VT sequence to change the current colors of text. If shadow frame
+//      diffing is enabled, the sequence is only written once text actually gets
+//      painted with these attributes. See _PaintShadowedBufferLine.
+// Arguments:
+// - textAttributes - Text attributes to use for the colors and character rendition
+// - renderSettings - The color table and modes required for rendering. Unused for VT
+// - pData - The interface to console data structures required for rendering
+// - usingSoftFont - Whether we're rendering characters from a soft font
+// - isSettingDefaultBrushes: indicates if we should change the background color of
+//      the window.
+// Return Value:
+// - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
+[[nodiscard]] HRESULT VtEngine::UpdateDrawingBrushes(const TextAttribute& textAttributes,
+                                                     const RenderSettings& /*renderSettings*/,
+                                                     const gsl::not_null<IRenderData*> pData,
+                                                     const bool usingSoftFont,
+                                                     const bool isSettingDefaultBrushes) noexcept
+{
+    _shadowBrushes = textAttributes;
+
+    // The default brushes are set before ScrollFrame(), which relies on them,
+    // so those are always written immediately.
+    if (_shadowFrameDiffing && !isSettingDefaultBrushes)
+    {
+        _deferredBrushes = { textAttributes, pData, usingSoftFont, true };
+        return S_OK;
+    }
+
+    _deferredBrushes.pending = false;
+    return _UpdateDrawingBrushes(textAttributes, pData, usingSoftFont, isSettingDefaultBrushes);
+}
+
+// Routine Description:
+// - Writes the brushes that UpdateDrawingBrushes() deferred, if any.
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
+[[nodiscard]] HRESULT VtEngine::_ApplyDeferredDrawingBrushes() noexcept
+{
+    if (!_deferredBrushes.pending)
+    {
+        return S_OK;
+    }
+
+    _deferredBrushes.pending = false;
+    return _UpdateDrawingBrushes(_deferredBrushes.attributes, _deferredBrushes.pData, _deferredBrushes.usingSoftFont, false);
+}
+
 // Routine Description:
 // - Write a VT sequence to change the current colors of text. Writes true RGB
 //      color sequences.
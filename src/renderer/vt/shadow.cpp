@@ -0,0 +1,290 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "vtrenderer.hpp"
+
+#pragma hdrstop
+
+using namespace Microsoft::Console::Render;
+
+// Routine Description:
+// - Draws one line of the buffer to the screen, but only the parts of it that
+//      differ from what we previously sent to the terminal. Applications like
+//      vim or htop frequently redraw (and thus invalidate) everything, even if
+//      most of it is unchanged. We keep a copy of the cells we've sent, and
+//      compare each cluster against it. The clusters that still match are
+//      skipped with a cursor movement instead of being written again.
+//   Since a cursor movement isn't free either, a gap of up to
+//      SHADOW_FRAME_MAX_REPAINT_GAP unchanged columns between two changed ones
+//      is simply painted again. That's about the length of a CUF sequence.
+//   The changed spans are painted with _PaintUtf8BufferLine, so they get the
+//      same ECH/EL optimizations as without the shadow frame.
+// Arguments:
+// - clusters - text and column widths to be written
+// - coord - character coordinate target to render within viewport
+// - lineWrapped: true if this run we're painting is the end of a line that
+//   wrapped. If we're not painting the last column of a wrapped line, then this
+//   will be false.
+// Return Value:
+// - S_OK or suitable HRESULT error from writing pipe.
+[[nodiscard]] HRESULT VtEngine::_PaintShadowedBufferLine(const std::span<const Cluster> clusters,
+                                                         const til::point coord,
+                                                         const bool lineWrapped) noexcept
+try
+{
+    if (coord.y < _virtualTop)
+    {
+        return S_OK;
+    }
+
+    // Line renditions change how columns map to cells, and in passthrough mode the
+    // client writes to the terminal behind our back. In either case we don't know
+    // what the terminal displays, so we paint everything like we usually would.
+    const auto rowTracked = !_passthrough && !_usingLineRenditions &&
+                            coord.y >= 0 && coord.y < _shadowSize.height &&
+                            coord.x >= 0;
+    if (!rowTracked || clusters.empty())
+    {
+        RETURN_IF_FAILED(_ApplyDeferredDrawingBrushes());
+        RETURN_IF_FAILED(_PaintUtf8BufferLine(clusters, coord, lineWrapped));
+        _ForgetShadowRow(coord.y);
+        return S_OK;
+    }
+
+    const auto paintSpan = [&](const size_t begin, const size_t end, const til::CoordType column, const bool wrapped) {
+        const auto span = clusters.subspan(begin, end - begin);
+        const til::point target{ column, coord.y };
+        RETURN_IF_FAILED(_ApplyDeferredDrawingBrushes());
+        RETURN_IF_FAILED(_PaintUtf8BufferLine(span, target, wrapped));
+        _RecordShadowCells(span, target);
+        return S_OK;
+    };
+
+    // GH#5113: If the previous row wrapped into this one, the first cluster must
+    // be written, so that the terminal wraps the line instead of us moving the
+    // cursor there. Similarly, the last cluster of a wrapped row is always
+    // written, to put the terminal into the delayed EOL wrap state.
+    const auto continuesWrappedRow = coord.x == 0 && _wrappedRow.has_value() && _wrappedRow.value() + 1 == coord.y;
+    const auto last = clusters.size() - 1;
+
+    // [spanBegin, spanEnd) is the range of clusters we still need to paint. spanEnd is 0 if there are none.
+    size_t spanBegin = 0;
+    size_t spanEnd = 0;
+    til::CoordType spanColumn = 0;
+    til::CoordType spanEndColumn = 0;
+    auto column = coord.x;
+
+    for (size_t i = 0; i <= last; ++i)
+    {
+        const auto& cluster = til::at(clusters, i);
+        const auto forced = (i == 0 && continuesWrappedRow) || (i == last && lineWrapped);
+
+        if (forced || !_ShadowCellsMatch(cluster, { column, coord.y }))
+        {
+            if (spanEnd != 0 && column - spanEndColumn > SHADOW_FRAME_MAX_REPAINT_GAP)
+            {
+                RETURN_IF_FAILED(paintSpan(spanBegin, spanEnd, spanColumn, false));
+                spanEnd = 0;
+            }
+            if (spanEnd == 0)
+            {
+                spanBegin = i;
+                spanColumn = column;
+            }
+            spanEnd = i + 1;
+            spanEndColumn = column + cluster.GetColumns();
+        }
+
+        column += cluster.GetColumns();
+    }
+
+    if (spanEnd != 0)
+    {
+        RETURN_IF_FAILED(paintSpan(spanBegin, spanEnd, spanColumn, lineWrapped && spanEnd == clusters.size()));
+    }
+
+    return S_OK;
+}
+CATCH_RETURN();
+
+// Routine Description:
+// - Returns true if the terminal already displays the given cluster at the given
+//      position, in the attributes the renderer last asked us to paint with.
+// Arguments:
+// - cluster - the text and column count to look for
+// - coord - character coordinate of the cluster's leftmost cell
+// Return Value:
+// - true if the cluster doesn't need to be written again.
+bool VtEngine::_ShadowCellsMatch(const Cluster& cluster, const til::point coord) const noexcept
+{
+    const auto text = cluster.GetText();
+    const auto columns = cluster.GetColumns();
+
+    // We only keep clusters of up to 2 code units (= a surrogate pair). Anything
+    // longer, like a combining sequence, is simply always written.
+    if (text.empty() || text.size() > 2 || columns < 1 || columns > 2 || coord.x + columns > _shadowSize.width)
+    {
+        return false;
+    }
+
+    const auto offset = gsl::narrow_cast<size_t>(coord.y * _shadowSize.width + coord.x);
+    const auto& cell = til::at(_shadowCells, offset);
+    if (cell.length != gsl::narrow_cast<uint8_t>(text.size()) ||
+        cell.columns != columns ||
+        cell.attributes != _shadowBrushes ||
+        !std::equal(text.begin(), text.end(), cell.text.begin()))
+    {
+        return false;
+    }
+
+    if (columns == 2)
+    {
+        const auto& trailer = til::at(_shadowCells, offset + 1);
+        return trailer.length != 0 && trailer.columns == 0 && trailer.attributes == _shadowBrushes;
+    }
+
+    return true;
+}
+
+// Routine Description:
+// - Records that the given clusters were written to the terminal.
+// Arguments:
+// - clusters - text and column widths that were written
+// - coord - character coordinate of the first cluster
+// Return Value:
+// - <none>
+void VtEngine::_RecordShadowCells(const std::span<const Cluster> clusters, const til::point coord) noexcept
+{
+    const auto width = _shadowSize.width;
+    if (coord.y < 0 || coord.y >= _shadowSize.height || coord.x < 0 || coord.x >= width)
+    {
+        return;
+    }
+
+    const auto row = std::span{ _shadowCells }.subspan(gsl::narrow_cast<size_t>(coord.y * width), gsl::narrow_cast<size_t>(width));
+    auto x = coord.x;
+
+    // Overwriting either half of a wide glyph erases all of it.
+    if (x > 0 && til::at(row, x).columns == 0)
+    {
+        til::at(row, x - 1).length = 0;
+    }
+
+    for (const auto& cluster : clusters)
+    {
+        if (x >= width)
+        {
+            break;
+        }
+
+        const auto text = cluster.GetText();
+        const auto columns = cluster.GetColumns();
+        auto& cell = til::at(row, x);
+
+        if (!text.empty() && text.size() <= 2 && columns >= 1 && columns <= 2 && x + columns <= width)
+        {
+            cell.attributes = _shadowBrushes;
+            cell.text = {};
+            std::copy(text.begin(), text.end(), cell.text.begin());
+            cell.length = gsl::narrow_cast<uint8_t>(text.size());
+            cell.columns = gsl::narrow_cast<uint8_t>(columns);
+
+            if (columns == 2)
+            {
+                til::at(row, x + 1) = { _shadowBrushes, {}, 1, 0 };
+            }
+        }
+        else
+        {
+            for (auto end = std::min(x + std::max(columns, 1), width); x < end; ++x)
+            {
+                til::at(row, x).length = 0;
+            }
+            continue;
+        }
+
+        x += columns;
+    }
+
+    if (x < width && til::at(row, x).columns == 0)
+    {
+        til::at(row, x).length = 0;
+    }
+}
+
+// Routine Description:
+// - Resizes the shadow frame to the given size. Its contents are unknown afterwards.
+// Arguments:
+// - size - the new size of the terminal's viewport
+// Return Value:
+// - <none>
+void VtEngine::_ResizeShadowFrame(const til::size size) noexcept
+try
+{
+    _shadowSize = _shadowFrameDiffing ? size : til::size{};
+    _shadowCells.clear();
+    _shadowCells.resize(_shadowSize.area<size_t>());
+}
+catch (...)
+{
+    LOG_CAUGHT_EXCEPTION();
+    _shadowFrameDiffing = false;
+    _shadowSize = {};
+    _shadowCells.clear();
+}
+
+// Routine Description:
+// - Shifts the shadow frame like ScrollFrame() shifted the terminal's viewport.
+//      The rows that scrolled into view are unknown.
+// Arguments:
+// - delta - the number of rows the contents moved down. Negative if they moved up.
+// Return Value:
+// - <none>
+void VtEngine::_ScrollShadowFrame(const til::CoordType delta) noexcept
+{
+    const auto rows = std::min(std::abs(delta), _shadowSize.height);
+    const auto shift = gsl::narrow_cast<ptrdiff_t>(rows) * _shadowSize.width;
+    const auto beg = _shadowCells.begin();
+    const auto end = _shadowCells.end();
+
+    if (delta < 0)
+    {
+        std::move(beg + shift, end, beg);
+        std::fill(end - shift, end, ShadowCell{});
+    }
+    else if (delta > 0)
+    {
+        std::move_backward(beg, end - shift, end);
+        std::fill(beg, beg + shift, ShadowCell{});
+    }
+}
+
+// Routine Description:
+// - Marks a row of the shadow frame as unknown, so that it'll be painted in full next time.
+// Arguments:
+// - row - the viewport row to forget
+// Return Value:
+// - <none>
+void VtEngine::_ForgetShadowRow(const til::CoordType row) noexcept
+{
+    if (row >= 0 && row < _shadowSize.height)
+    {
+        const auto beg = _shadowCells.begin() + gsl::narrow_cast<ptrdiff_t>(row) * _shadowSize.width;
+        std::fill(beg, beg + _shadowSize.width, ShadowCell{});
+    }
+}
+
+// Routine Description:
+// - Marks the entire shadow frame as unknown. This needs to be called whenever
+//      we write something to the terminal that changes its contents in a way
+//      that we don't track, like clearing the screen.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void VtEngine::_ForgetShadowFrame() noexcept
+{
+    std::fill(_shadowCells.begin(), _shadowCells.end(), ShadowCell{});
+}
@@ -65,6 +65,13 @@ VtEngine::VtEngine(_In_ wil::unique_hfile pipe,
     // member is only defined when UNIT_TESTING is.
     _usingTestCallback = false;
 #endif
+
+    // Frames are written to the pipe on a thread of their own, so that a
+    // terminal that's slow to read doesn't stall the paint. See PipeWriter.hpp.
+    if (_hFile)
+    {
+        _writer = std::make_unique<VtPipeWriter>(_hFile.get());
+    }
 }
 
 // Method Description:
@@ -136,15 +143,37 @@ CATCH_RETURN();
     CATCH_RETURN();
 }
 
+// Method Description:
+// - Hands the buffered output to the writer thread. This only blocks if the
+//      terminal fell behind by more than the high-water mark, or if we're
+//      tearing down, in which case everything needs to be written before the
+//      process exits.
+// - If a previous write failed, the pipe is closed, which will eventually
+//      close the console as well.
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK or suitable HRESULT error from writing pipe.
 [[nodiscard]] HRESULT VtEngine::_Flush() noexcept
 {
-    if (_hFile)
+    if (_writer)
     {
-        auto fSuccess = !!WriteFile(_hFile.get(), _buffer.data(), gsl::narrow_cast<DWORD>(_buffer.size()), nullptr, nullptr);
-        _buffer.clear();
-        if (!fSuccess)
+        const auto bytes = _buffer.size();
+        const auto beg = std::chrono::steady_clock::now();
+
+        auto hr = _writer->Submit(_buffer);
+        if (SUCCEEDED(hr) && _drainOnFlush)
         {
-            _exitResult = HRESULT_FROM_WIN32(GetLastError());
+            hr = _writer->Drain();
+        }
+
+        _trace.TraceFlush(bytes, std::chrono::steady_clock::now() - beg);
+
+        if (FAILED(hr))
+        {
+            _exitResult = hr;
+            // The writer thread must be gone before the handle it writes to is.
+            _writer.reset();
             _hFile.reset();
             if (_terminalOwner)
             {
@@ -161,6 +190,8 @@ CATCH_RETURN();
 // - Wrapper for _Write.
 [[nodiscard]] HRESULT VtEngine::WriteTerminalUtf8(const std::string_view str) noexcept
 {
+    // We don't know what this string does to the terminal's contents.
+    _ForgetShadowFrame();
     return _Write(str);
 }
 
@@ -298,6 +329,9 @@ CATCH_RETURN();
             }
         }
 
+        // The terminal may have reflowed its contents in any way it likes.
+        _ResizeShadowFrame(newSize);
+
         _resized = true;
     }
 
@@ -503,6 +537,47 @@ void VtEngine::SetPassthroughMode(const bool passthrough) noexcept
     _passthrough = passthrough;
 }
 
+// Method Description:
+// - Configure the renderer to keep a copy of the last frame it sent to the
+//   terminal. Cells that are invalidated, but still match that copy, aren't
+//   written again. This avoids re-sending the unchanged parts of a screen that
+//   a client application redraws in full. See _PaintShadowedBufferLine.
+// Arguments:
+// - enabled - True to turn on shadow frame diffing. False otherwise.
+// Return Value:
+// - <none>
+void VtEngine::SetShadowFrameDiffing(const bool enabled)
+{
+    _shadowFrameDiffing = enabled;
+    _deferredBrushes.pending = false;
+    _ResizeShadowFrame(_lastViewport.Dimensions());
+}
+
+// Method Description:
+// - Sets how many bytes of output may wait behind the write that's currently
+//   in progress, before painting blocks until the terminal caught up. A larger
+//   value lets conhost keep serving clients while a slow terminal reads the
+//   previous frames, at the cost of the terminal lagging further behind.
+// Arguments:
+// - bytes - The new high-water mark.
+// Return Value:
+// - <none>
+void VtEngine::SetOutputHighWaterMark(const size_t bytes) noexcept
+{
+    if (_writer)
+    {
+        _writer->SetHighWaterMark(bytes);
+    }
+}
+
+// Method Description:
+// - Returns how much was written to the pipe so far, and how long writing it
+//   took and blocked the renderer. Empty if we aren't writing to a pipe.
+VtPipeWriter::Statistics VtEngine::GetOutputStatistics() const
+{
+    return _writer ? _writer->GetStatistics() : VtPipeWriter::Statistics{};
+}
+
 void VtEngine::SetLookingForDSRCallback(std::function<void(bool)> pfnLooking) noexcept
 {
     _pfnSetLookingForDSR = pfnLooking;
@@ -549,6 +624,7 @@ HRESULT VtEngine::RequestWin32Input() noexcept
 
 HRESULT VtEngine::SwitchScreenBuffer(const bool useAltBuffer) noexcept
 {
+    _ForgetShadowFrame();
     RETURN_IF_FAILED(_SwitchScreenBuffer(useAltBuffer));
     RETURN_IF_FAILED(_Flush());
     return S_OK;
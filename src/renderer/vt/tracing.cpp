@@ -229,6 +229,24 @@ void RenderTracing::TraceEndPaint() const
 #endif UNIT_TESTING
 }
 
+// Function Description:
+// - Logs how many bytes a frame had, and for how long handing them to the
+//      writer thread blocked the renderer (because the terminal didn't keep up).
+void RenderTracing::TraceFlush(const size_t bytes, const std::chrono::nanoseconds blocked) const
+{
+#ifndef UNIT_TESTING
+    TraceLoggingWrite(g_hConsoleVtRendererTraceProvider,
+                      "VtEngine_TraceFlush",
+                      TraceLoggingUInt64(gsl::narrow_cast<uint64_t>(bytes), "bytes"),
+                      TraceLoggingInt64(gsl::narrow_cast<int64_t>(std::chrono::duration_cast<std::chrono::microseconds>(blocked).count()), "blockedMicroseconds"),
+                      TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                      TraceLoggingKeyword(TIL_KEYWORD_TRACE));
+#else
+    UNREFERENCED_PARAMETER(bytes);
+    UNREFERENCED_PARAMETER(blocked);
+#endif UNIT_TESTING
+}
+
 void RenderTracing::TraceLastText(const til::point lastTextPos) const
 {
 #ifndef UNIT_TESTING
@@ -16,6 +16,7 @@ Abstract:
 #include <TraceLoggingProvider.h>
 #include <telemetry/ProjectTelemetry.h>
 #include "../../types/inc/Viewport.hpp"
+#include <chrono>
 
 TRACELOGGING_DECLARE_PROVIDER(g_hConsoleVtRendererTraceProvider);
 
@@ -46,5 +47,6 @@ namespace Microsoft::Console::VirtualTerminal
                              const bool cursorMoved,
                              const std::optional<til::CoordType>& wrappedRow) const;
         void TraceEndPaint() const;
+        void TraceFlush(const size_t bytes, const std::chrono::nanoseconds blocked) const;
     };
 }
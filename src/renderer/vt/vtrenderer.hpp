@@ -18,6 +18,7 @@ Author(s):
 #include "../inc/RenderEngineBase.hpp"
 #include "../../types/inc/Viewport.hpp"
 #include "tracing.hpp"
+#include "PipeWriter.hpp"
 #include <string>
 #include <functional>
 
@@ -28,6 +29,7 @@ namespace TerminalCoreUnitTests
     class ConptyRoundtripTests;
 };
 class ScreenBufferTests;
+class ConptyOutputBenchmarks;
 #endif
 
 namespace Microsoft::Console::VirtualTerminal
@@ -42,6 +44,8 @@ namespace Microsoft::Console::Render
     public:
         // See _PaintUtf8BufferLine for explanation of this value.
         static const size_t ERASE_CHARACTER_STRING_LENGTH = 8;
+        // See _PaintShadowedBufferLine for explanation of this value.
+        static constexpr til::CoordType SHADOW_FRAME_MAX_REPAINT_GAP = 4;
         static const til::point INVALID_COORDS;
 
         VtEngine(_In_ wil::unique_hfile hPipe,
@@ -65,6 +69,11 @@ namespace Microsoft::Console::Render
         [[nodiscard]] HRESULT PaintBufferGridLines(GridLineSet lines, COLORREF color, size_t cchLine, til::point coordTarget) noexcept override;
         [[nodiscard]] HRESULT PaintSelection(const til::rect& rect) noexcept override;
         [[nodiscard]] HRESULT PaintCursor(const CursorOptions& options) noexcept override;
+        [[nodiscard]] HRESULT UpdateDrawingBrushes(const TextAttribute& textAttributes,
+                                                   const RenderSettings& renderSettings,
+                                                   const gsl::not_null<IRenderData*> pData,
+                                                   const bool usingSoftFont,
+                                                   const bool isSettingDefaultBrushes) noexcept override;
         [[nodiscard]] HRESULT UpdateFont(const FontInfoDesired& FontInfoDesired, _Out_ FontInfo& FontInfo) noexcept override;
         [[nodiscard]] HRESULT UpdateDpi(int iDpi) noexcept override;
         [[nodiscard]] HRESULT UpdateViewport(const til::inclusive_rect& srNewViewport) noexcept override;
@@ -84,6 +93,9 @@ namespace Microsoft::Console::Render
         void EndResizeRequest();
         void SetResizeQuirk(const bool resizeQuirk);
         void SetPassthroughMode(const bool passthrough) noexcept;
+        void SetShadowFrameDiffing(const bool enabled);
+        void SetOutputHighWaterMark(const size_t bytes) noexcept;
+        VtPipeWriter::Statistics GetOutputStatistics() const;
         void SetLookingForDSRCallback(std::function<void(bool)> pfnLooking) noexcept;
         void SetTerminalCursorTextPosition(const til::point coordCursor) noexcept;
         [[nodiscard]] virtual HRESULT ManuallyClearScrollback() noexcept;
@@ -93,6 +105,8 @@ namespace Microsoft::Console::Render
 
     protected:
         wil::unique_hfile _hFile;
+        std::unique_ptr<VtPipeWriter> _writer;
+        bool _drainOnFlush{ false };
         std::string _buffer;
 
         std::string _formatBuffer;
@@ -141,6 +155,33 @@ namespace Microsoft::Console::Render
         bool _passthrough{ false };
         std::optional<TextColor> _newBottomLineBG{ std::nullopt };
 
+        // What we believe the terminal currently displays, one cell at a time.
+        // Only maintained while shadow frame diffing is enabled. See shadow.cpp.
+        struct ShadowCell
+        {
+            TextAttribute attributes;
+            std::array<wchar_t, 2> text{};
+            // 0 if we don't know what the terminal displays in this cell.
+            uint8_t length = 0;
+            // 0 for the trailing half of a wide glyph.
+            uint8_t columns = 0;
+        };
+
+        // With shadow frame diffing, brushes are only written once text is painted with them.
+        struct DeferredBrushes
+        {
+            TextAttribute attributes;
+            IRenderData* pData = nullptr;
+            bool usingSoftFont = false;
+            bool pending = false;
+        };
+
+        bool _shadowFrameDiffing{ false };
+        til::size _shadowSize;
+        std::vector<ShadowCell> _shadowCells;
+        TextAttribute _shadowBrushes;
+        DeferredBrushes _deferredBrushes;
+
         [[nodiscard]] HRESULT _WriteFill(const size_t n, const char c) noexcept;
         [[nodiscard]] HRESULT _Write(std::string_view const str) noexcept;
         [[nodiscard]] HRESULT _Flush() noexcept;
@@ -208,6 +249,11 @@ namespace Microsoft::Console::Render
         [[nodiscard]] HRESULT _RequestFocusEventMode() noexcept;
 
         [[nodiscard]] virtual HRESULT _MoveCursor(const til::point coord) noexcept = 0;
+        [[nodiscard]] virtual HRESULT _UpdateDrawingBrushes(const TextAttribute& textAttributes,
+                                                            const gsl::not_null<IRenderData*> pData,
+                                                            const bool usingSoftFont,
+                                                            const bool isSettingDefaultBrushes) noexcept = 0;
+        [[nodiscard]] HRESULT _ApplyDeferredDrawingBrushes() noexcept;
         [[nodiscard]] HRESULT _RgbUpdateDrawingBrushes(const TextAttribute& textAttributes) noexcept;
         [[nodiscard]] HRESULT _16ColorUpdateDrawingBrushes(const TextAttribute& textAttributes) noexcept;
 
@@ -223,6 +269,16 @@ namespace Microsoft::Console::Render
         [[nodiscard]] HRESULT _PaintAsciiBufferLine(const std::span<const Cluster> clusters,
                                                     const til::point coord) noexcept;
 
+        [[nodiscard]] HRESULT _PaintShadowedBufferLine(const std::span<const Cluster> clusters,
+                                                       const til::point coord,
+                                                       const bool lineWrapped) noexcept;
+        bool _ShadowCellsMatch(const Cluster& cluster, const til::point coord) const noexcept;
+        void _RecordShadowCells(const std::span<const Cluster> clusters, const til::point coord) noexcept;
+        void _ResizeShadowFrame(const til::size size) noexcept;
+        void _ScrollShadowFrame(const til::CoordType delta) noexcept;
+        void _ForgetShadowRow(const til::CoordType row) noexcept;
+        void _ForgetShadowFrame() noexcept;
+
         [[nodiscard]] HRESULT _WriteTerminalUtf8(const std::wstring_view str) noexcept;
         [[nodiscard]] HRESULT _WriteTerminalAscii(const std::wstring_view str) noexcept;
         [[nodiscard]] HRESULT _WriteTerminalDrcs(const std::wstring_view str) noexcept;
@@ -237,6 +293,7 @@ namespace Microsoft::Console::Render
         friend class VtRendererTest;
         friend class ConptyOutputTests;
         friend class ScreenBufferTests;
+        friend class ConptyOutputBenchmarks;
         friend class TerminalCoreUnitTests::ConptyRoundtripTests;
 #endif
 
@@ -135,7 +135,7 @@ bool ConsoleWaitBlock::Notify(const WaitTerminationReason TerminationReason)
     DWORD dwControlKeyState;
     auto fIsUnicode = true;
 
-    std::deque<std::unique_ptr<IInputEvent>> outEvents;
+    std::vector<INPUT_RECORD> outRecords;
     // TODO: MSFT 14104228 - get rid of this void* and get the data
     // out of the read wait object properly.
     void* pOutputData = nullptr;
@@ -148,7 +148,7 @@ bool ConsoleWaitBlock::Notify(const WaitTerminationReason TerminationReason)
     {
         auto a = &(_WaitReplyMessage.u.consoleMsgL1.GetConsoleInput);
         fIsUnicode = !!a->Unicode;
-        pOutputData = &outEvents;
+        pOutputData = &outRecords;
         break;
     }
     case API_NUMBER_READCONSOLE:
@@ -192,16 +192,8 @@ bool ConsoleWaitBlock::Notify(const WaitTerminationReason TerminationReason)
             }
 
             const auto pRecordBuffer = static_cast<INPUT_RECORD* const>(buffer);
-            a->NumRecords = static_cast<ULONG>(outEvents.size());
-            for (size_t i = 0; i < a->NumRecords; ++i)
-            {
-                if (outEvents.empty())
-                {
-                    break;
-                }
-                pRecordBuffer[i] = outEvents.front()->ToInputRecord();
-                outEvents.pop_front();
-            }
+            a->NumRecords = static_cast<ULONG>(outRecords.size());
+            std::copy(outRecords.begin(), outRecords.end(), pRecordBuffer);
         }
         else if (API_NUMBER_READCONSOLE == _WaitReplyMessage.msgHeader.ApiNumber)
         {
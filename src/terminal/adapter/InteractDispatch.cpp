@@ -62,7 +62,9 @@ bool InteractDispatch::WriteCtrlKey(const KeyEvent& event)
 
 // Method Description:
 // - Writes a string of input to the host. The string is converted to keystrokes
-//      that will faithfully represent the input by CharToKeyEvents.
+//      that will faithfully represent the input by StringToInputRecords.
+//  The keystrokes are written to the input buffer in a single batch, so that
+//      a long string (like a paste) wakes up a waiting client only once.
 // Arguments:
 // - string : a string to write to the console.
 // Return Value:
@@ -72,18 +74,11 @@ bool InteractDispatch::WriteString(const std::wstring_view string)
     if (!string.empty())
     {
         const auto codepage = _api.GetConsoleOutputCP();
-        std::deque<std::unique_ptr<IInputEvent>> keyEvents;
+        std::vector<INPUT_RECORD> records;
+        StringToInputRecords(string, codepage, records);
 
-        for (const auto& wch : string)
-        {
-            auto convertedEvents = CharToKeyEvents(wch, codepage);
-
-            std::move(convertedEvents.begin(),
-                      convertedEvents.end(),
-                      std::back_inserter(keyEvents));
-        }
-
-        WriteInput(keyEvents);
+        const auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        gci.GetActiveInputBuffer()->Write(records);
     }
     return true;
 }
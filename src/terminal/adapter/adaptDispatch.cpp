@@ -101,24 +101,47 @@ void AdaptDispatch::_WriteToBuffer(const std::wstring_view string)
             }
         }
 
-        const OutputCellIterator it(std::wstring_view{ stringPosition, string.cend() }, attributes);
-        if (_modes.test(Mode::InsertReplace))
+        const std::wstring_view remaining{ stringPosition, string.cend() };
+        til::CoordType charsWritten = 0;
+        til::CoordType cellsWritten = 0;
+        if (!_modes.test(Mode::InsertReplace))
         {
-            // If insert-replace mode is enabled, we first measure how many cells
-            // the string will occupy, and scroll the target area right by that
-            // amount to make space for the incoming text.
-            auto measureIt = it;
-            while (measureIt && measureIt.GetCellDistance(it) < lineWidth)
+            // Printable ASCII is always exactly 1 cell per character, which allows us to skip
+            // the OutputCellIterator and write entire runs in bulk. WriteAsciiRun() stops at
+            // the first character that isn't printable ASCII and anything from there on is
+            // written by WriteGlyphs() below, so the string is only scanned once.
+            charsWritten = textBuffer.WriteAsciiRun(remaining, cursorPosition, attributes, wrapAtEOL, lineWidth - 1);
+            cellsWritten = charsWritten;
+        }
+        if (charsWritten == 0)
+        {
+            if (_modes.test(Mode::InsertReplace))
             {
-                measureIt++;
+                // If insert-replace mode is enabled, we first measure how many cells
+                // the string will occupy, and scroll the target area right by that
+                // amount to make space for the incoming text. A glyph is at most
+                // 2 characters long, so we only need to measure 2x the line width.
+                std::vector<GlyphRun> runs;
+                MeasureGlyphRuns(remaining.substr(0, gsl::narrow_cast<size_t>(lineWidth) * 2), runs);
+                til::CoordType cellCount = 0;
+                for (const auto& run : runs)
+                {
+                    if (cellCount >= lineWidth)
+                    {
+                        break;
+                    }
+                    // Take as many glyphs as are needed to cover the rest of the line.
+                    const auto remainingCells = gsl::narrow_cast<size_t>(lineWidth - cellCount);
+                    const auto glyphCount = std::min(run.glyphCount, (remainingCells + run.glyphWidth - 1) / run.glyphWidth);
+                    cellCount += gsl::narrow_cast<til::CoordType>(glyphCount * run.glyphWidth);
+                }
+                const auto row = cursorPosition.y;
+                _ScrollRectHorizontally(textBuffer, { cursorPosition.x, row, lineWidth, row + 1 }, cellCount);
             }
-            const auto row = cursorPosition.y;
-            const auto cellCount = measureIt.GetCellDistance(it);
-            _ScrollRectHorizontally(textBuffer, { cursorPosition.x, row, lineWidth, row + 1 }, cellCount);
+            charsWritten = gsl::narrow_cast<til::CoordType>(textBuffer.WriteGlyphs(remaining, cursorPosition, attributes, cellsWritten, wrapAtEOL, lineWidth - 1));
         }
-        const auto itEnd = textBuffer.WriteLine(it, cursorPosition, wrapAtEOL, lineWidth - 1);
 
-        if (itEnd.GetInputDistance(it) == 0)
+        if (charsWritten == 0)
         {
             // If we haven't written anything out because there wasn't enough space,
             // we move the cursor to the end of the line so that it's forced to wrap.
@@ -132,12 +155,11 @@ void AdaptDispatch::_WriteToBuffer(const std::wstring_view string)
         }
         else
         {
-            const auto cellCount = itEnd.GetCellDistance(it);
-            const auto changedRect = til::rect{ cursorPosition, til::size{ cellCount, 1 } };
+            const auto changedRect = til::rect{ cursorPosition, til::size{ cellsWritten, 1 } };
             _api.NotifyAccessibilityChange(changedRect);
 
-            stringPosition += itEnd.GetInputDistance(it);
-            cursorPosition.x += cellCount;
+            stringPosition += charsWritten;
+            cursorPosition.x += cellsWritten;
         }
 
         if (cursorPosition.x >= lineWidth)
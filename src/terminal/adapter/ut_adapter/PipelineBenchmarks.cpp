@@ -0,0 +1,513 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include <wextestclass.h>
+#include "../../inc/consoletaeftemplates.hpp"
+#include "../../parser/OutputStateMachineEngine.hpp"
+#include "../../../renderer/inc/DummyRenderer.hpp"
+
+#include "adaptDispatch.hpp"
+
+#include <chrono>
+#include <new>
+
+#include <til/unicode.h>
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+using namespace Microsoft::Console::VirtualTerminal;
+
+namespace
+{
+    // See AllocationCounter.
+    std::atomic<bool> g_countAllocations{ false };
+    std::atomic<size_t> g_allocations{ 0 };
+}
+
+// This test binary replaces the global allocation functions, so that the benchmarks below can
+// count allocations in release builds as well. Everything the pipeline allocates goes through
+// here, because it is statically linked into this binary. Allocations are only counted while an
+// AllocationCounter is alive, and otherwise these behave like the default implementation.
+void* __cdecl operator new(size_t size)
+{
+    if (g_countAllocations.load(std::memory_order_relaxed))
+    {
+        g_allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    while (true)
+    {
+        if (const auto ptr = malloc(size ? size : 1))
+        {
+            return ptr;
+        }
+
+        const auto handler = std::get_new_handler();
+        if (!handler)
+        {
+            throw std::bad_alloc{};
+        }
+        handler();
+    }
+}
+
+void __cdecl operator delete(void* ptr) noexcept
+{
+    free(ptr);
+}
+
+void __cdecl operator delete(void* ptr, size_t) noexcept
+{
+    free(ptr);
+}
+
+namespace
+{
+    // Counts the calls to the global operator new while it's alive, so that the benchmarks below
+    // can report allocations per character. The array and nothrow forms of operator new are
+    // counted too, since their default implementations call the one above.
+    class AllocationCounter final
+    {
+    public:
+        AllocationCounter() noexcept
+        {
+            g_allocations.store(0, std::memory_order_relaxed);
+            g_countAllocations.store(true, std::memory_order_relaxed);
+        }
+
+        ~AllocationCounter()
+        {
+            g_countAllocations.store(false, std::memory_order_relaxed);
+        }
+
+        AllocationCounter(const AllocationCounter&) = delete;
+        AllocationCounter& operator=(const AllocationCounter&) = delete;
+
+        size_t Count() const noexcept
+        {
+            return g_allocations.load(std::memory_order_relaxed);
+        }
+    };
+
+    // A minimal ITerminalApi implementation without any of the logging and verification
+    // that TestGetSet in adapterTest.cpp does. It behaves like Terminal does:
+    // The viewport follows the cursor and the buffer is cycled once it's full.
+    class HeadlessTerminalApi final : public ITerminalApi
+    {
+    public:
+        HeadlessTerminalApi(const til::size viewportSize, const til::CoordType scrollback) :
+            _textBuffer{ std::make_unique<TextBuffer>(til::size{ viewportSize.width, viewportSize.height + scrollback }, TextAttribute{}, 0, false, _renderer) },
+            _viewport{ til::point{ 0, 0 }, viewportSize }
+        {
+        }
+
+        void ReturnResponse(const std::wstring_view /*response*/) override
+        {
+        }
+
+        StateMachine& GetStateMachine() override
+        {
+            return *_stateMachine;
+        }
+
+        TextBuffer& GetTextBuffer() override
+        {
+            return *_textBuffer;
+        }
+
+        til::rect GetViewport() const override
+        {
+            return _viewport;
+        }
+
+        void SetViewportPosition(const til::point position) override
+        {
+            _viewport = til::rect{ position, _viewport.size() };
+        }
+
+        bool IsVtInputEnabled() const override
+        {
+            return false;
+        }
+
+        void SetTextAttributes(const TextAttribute& attrs) override
+        {
+            _textBuffer->SetCurrentAttributes(attrs);
+        }
+
+        void SetAutoWrapMode(const bool wrapAtEOL) override
+        {
+            _autoWrapMode = wrapAtEOL;
+        }
+
+        bool GetAutoWrapMode() const override
+        {
+            return _autoWrapMode;
+        }
+
+        void SetScrollingRegion(const til::inclusive_rect& /*scrollMargins*/) override
+        {
+        }
+
+        void WarningBell() override
+        {
+        }
+
+        bool GetLineFeedMode() const override
+        {
+            return false;
+        }
+
+        void LineFeed(const bool withReturn, const bool wrapForced) override
+        {
+            auto& cursor = _textBuffer->GetCursor();
+            auto position = cursor.GetPosition();
+
+            _textBuffer->GetRowByOffset(position.y).SetWrapForced(wrapForced);
+
+            position.y++;
+            if (withReturn)
+            {
+                position.x = 0;
+            }
+
+            if (position.y >= _textBuffer->GetSize().Height())
+            {
+                _textBuffer->IncrementCircularBuffer();
+                position.y--;
+            }
+            cursor.SetPosition(position);
+
+            if (position.y >= _viewport.bottom)
+            {
+                const auto height = _viewport.height();
+                _viewport.top = position.y - height + 1;
+                _viewport.bottom = _viewport.top + height;
+            }
+        }
+
+        void SetWindowTitle(const std::wstring_view /*title*/) override
+        {
+        }
+
+        void UseAlternateScreenBuffer() override
+        {
+        }
+
+        void UseMainScreenBuffer() override
+        {
+        }
+
+        CursorType GetUserDefaultCursorStyle() const override
+        {
+            return CursorType::Legacy;
+        }
+
+        void ShowWindow(bool /*showOrHide*/) override
+        {
+        }
+
+        void SetConsoleOutputCP(const unsigned int /*codepage*/) override
+        {
+        }
+
+        unsigned int GetConsoleOutputCP() const override
+        {
+            return CP_UTF8;
+        }
+
+        void SetBracketedPasteMode(const bool /*enabled*/) override
+        {
+        }
+
+        std::optional<bool> GetBracketedPasteMode() const override
+        {
+            return {};
+        }
+
+        void CopyToClipboard(const std::wstring_view /*content*/) override
+        {
+        }
+
+        void SetTaskbarProgress(const DispatchTypes::TaskbarState /*state*/, const size_t /*progress*/) override
+        {
+        }
+
+        void SetWorkingDirectory(const std::wstring_view /*uri*/) override
+        {
+        }
+
+        void PlayMidiNote(const int /*noteNumber*/, const int /*velocity*/, const std::chrono::microseconds /*duration*/) override
+        {
+        }
+
+        bool ResizeWindow(const til::CoordType /*width*/, const til::CoordType /*height*/) override
+        {
+            return false;
+        }
+
+        bool IsConsolePty() const override
+        {
+            return false;
+        }
+
+        void NotifyAccessibilityChange(const til::rect& /*changedRect*/) override
+        {
+        }
+
+        void MarkPrompt(const DispatchTypes::ScrollMark& /*mark*/) override
+        {
+        }
+
+        void MarkCommandStart() override
+        {
+        }
+
+        void MarkOutputStart() override
+        {
+        }
+
+        void MarkCommandFinish(std::optional<unsigned int> /*error*/) override
+        {
+        }
+
+        DummyRenderer _renderer;
+        TerminalInput _terminalInput{ nullptr };
+        std::unique_ptr<TextBuffer> _textBuffer;
+        StateMachine* _stateMachine = nullptr;
+        til::rect _viewport;
+        bool _autoWrapMode = true;
+    };
+
+    enum class Workload
+    {
+        Ascii,
+        Sgr,
+        Tui,
+        Unicode,
+        Margins,
+    };
+
+    // Generates a deterministic stream of output that's representative of the given kind of application.
+    std::wstring generateWorkload(const Workload workload, const til::size viewportSize)
+    {
+        static constexpr std::wstring_view words[]{
+            L"lorem", L"ipsum", L"dolor", L"sit", L"amet", L"consectetur", L"adipiscing", L"elit", L"sed", L"do", L"eiusmod", L"tempor"
+        };
+        static constexpr std::wstring_view unicodeWords[]{
+            L"\x65E5\x672C\x8A9E", L"\x4E2D\x6587", L"\xD55C\xAD6D\xC5B4", L"\xD83D\xDE00", L"\xD83D\xDC4D\xD83C\xDFFD", L"e\x0301", L"\x0627\x0644\x0639\x0631\x0628\x064A\x0629", L"na\x00EFve"
+        };
+        static constexpr size_t targetSize = 1024 * 1024;
+
+        uint32_t seed = 0x12345678;
+        const auto random = [&](size_t max) -> size_t {
+            // xorshift32
+            seed ^= seed << 13;
+            seed ^= seed >> 17;
+            seed ^= seed << 5;
+            return seed % max;
+        };
+
+        std::wstring text;
+        text.reserve(targetSize + 4096);
+
+        switch (workload)
+        {
+        case Workload::Ascii:
+            // Plain text, like `cat` of a large log file.
+            while (text.size() < targetSize)
+            {
+                const auto lineLength = random(gsl::narrow_cast<size_t>(viewportSize.width));
+                const auto lineBegin = text.size();
+                while (text.size() - lineBegin < lineLength)
+                {
+                    text.append(til::at(words, random(std::size(words))));
+                    text.push_back(L' ');
+                }
+                text.append(L"\r\n");
+            }
+            break;
+        case Workload::Sgr:
+            // Colored logs, where every few words change the foreground color.
+            while (text.size() < targetSize)
+            {
+                fmt::format_to(std::back_inserter(text), FMT_COMPILE(L"\x1b[2m{:02}:{:02}:{:02}\x1b[m "), random(24), random(60), random(60));
+                switch (random(4))
+                {
+                case 0:
+                    text.append(L"\x1b[1;31mERROR\x1b[m ");
+                    break;
+                case 1:
+                    text.append(L"\x1b[33mWARN\x1b[39m  ");
+                    break;
+                default:
+                    text.append(L"\x1b[32mINFO\x1b[39m  ");
+                    break;
+                }
+                for (auto i = random(12); i > 0; --i)
+                {
+                    fmt::format_to(std::back_inserter(text), FMT_COMPILE(L"\x1b[38;5;{}m{}\x1b[38;2;{};{};{}m "), random(256), til::at(words, random(std::size(words))), random(256), random(256), random(256));
+                }
+                text.append(L"\x1b[m\r\n");
+            }
+            break;
+        case Workload::Tui:
+            // Cursor addressed full-screen applications like htop or vim: A status bar,
+            // a number of rows being rewritten in place and the cursor being moved around.
+            while (text.size() < targetSize)
+            {
+                static constexpr std::wstring_view header{ L" PID USER      PRI  NI  VIRT   RES S CPU% MEM%" };
+                text.append(L"\x1b[?25l\x1b[H\x1b[7m");
+                text.append(header);
+                text.append(gsl::narrow_cast<size_t>(viewportSize.width) - header.size(), L' ');
+                text.append(L"\x1b[27m");
+                for (til::CoordType y = 2; y <= viewportSize.height; ++y)
+                {
+                    if (random(3) == 0)
+                    {
+                        continue;
+                    }
+                    fmt::format_to(std::back_inserter(text),
+                                   FMT_COMPILE(L"\x1b[{};1H\x1b[{}m{:>5} root       20   0 {:>5}M {:>5}M S {:>4}.{} \x1b[1m{}\x1b[m\x1b[K"),
+                                   y,
+                                   y % 2 ? 36 : 37,
+                                   random(65536),
+                                   random(10000),
+                                   random(10000),
+                                   random(100),
+                                   random(10),
+                                   til::at(words, random(std::size(words))));
+                }
+                fmt::format_to(std::back_inserter(text), FMT_COMPILE(L"\x1b[{};{}H\x1b[?25h"), random(gsl::narrow_cast<size_t>(viewportSize.height)) + 1, random(gsl::narrow_cast<size_t>(viewportSize.width)) + 1);
+            }
+            break;
+        case Workload::Unicode:
+            // CJK and emoji heavy text, with some combining marks and RTL text sprinkled in.
+            while (text.size() < targetSize)
+            {
+                for (auto i = random(24); i > 0; --i)
+                {
+                    text.append(til::at(unicodeWords, random(std::size(unicodeWords))));
+                    text.push_back(L' ');
+                }
+                text.append(L"\r\n");
+            }
+            break;
+        case Workload::Margins:
+            // Scrolling within margins, like a pager or a chat client with a fixed header and footer.
+            fmt::format_to(std::back_inserter(text), FMT_COMPILE(L"\x1b[H\x1b[2J\x1b[3;{}r"), viewportSize.height - 2);
+            while (text.size() < targetSize)
+            {
+                fmt::format_to(std::back_inserter(text), FMT_COMPILE(L"\x1b[{};1H"), viewportSize.height - 2);
+                for (auto i = random(8) + 1; i > 0; --i)
+                {
+                    text.append(L"\n");
+                    text.append(til::at(words, random(std::size(words))));
+                    text.push_back(L' ');
+                    text.append(til::at(words, random(std::size(words))));
+                }
+                switch (random(3))
+                {
+                case 0:
+                    // Reverse index at the top margin scrolls the region down.
+                    text.append(L"\x1b[3;1H\x1bM\x1bM");
+                    break;
+                case 1:
+                    fmt::format_to(std::back_inserter(text), FMT_COMPILE(L"\x1b[{};1H\x1b[{}L"), random(8) + 3, random(3) + 1);
+                    break;
+                default:
+                    fmt::format_to(std::back_inserter(text), FMT_COMPILE(L"\x1b[{};1H\x1b[{}M"), random(8) + 3, random(3) + 1);
+                    break;
+                }
+            }
+            text.append(L"\x1b[r");
+            break;
+        }
+
+        return text;
+    }
+
+    size_t utf8Length(const std::wstring_view& text) noexcept
+    {
+        size_t length = 0;
+        for (const auto ch : text)
+        {
+            if (ch < 0x80)
+            {
+                length += 1;
+            }
+            else if (ch < 0x800 || til::is_surrogate(ch))
+            {
+                // A surrogate pair is 4 bytes in UTF-8, which is 2 bytes for each half.
+                length += 2;
+            }
+            else
+            {
+                length += 3;
+            }
+        }
+        return length;
+    }
+}
+
+// These benchmarks push recorded-like output through the same pipeline that conhost and
+// Terminal use, minus the actual rendering: StateMachine, OutputStateMachineEngine,
+// AdaptDispatch and TextBuffer. Run them before and after changes to the hot path.
+class PipelineBenchmarks
+{
+    TEST_CLASS(PipelineBenchmarks);
+
+    TEST_METHOD(Throughput)
+    {
+        BEGIN_TEST_METHOD_PROPERTIES()
+            TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+            TEST_METHOD_PROPERTY(L"Data:workload", L"{0, 1, 2, 3, 4}")
+        END_TEST_METHOD_PROPERTIES()
+
+        static constexpr std::wstring_view workloadNames[]{ L"ASCII", L"SGR", L"TUI", L"CJK/emoji", L"margins" };
+        static constexpr til::size viewportSize{ 120, 30 };
+        static constexpr size_t iterations = 8;
+
+        int workload;
+        VERIFY_SUCCEEDED(TestData::TryGetValue(L"workload", workload));
+
+        const auto text = generateWorkload(static_cast<Workload>(workload), viewportSize);
+        const auto bytes = utf8Length(text);
+
+        HeadlessTerminalApi api{ viewportSize, 1000 };
+        auto& renderer = api._renderer;
+        auto dispatch = std::make_unique<AdaptDispatch>(api, renderer, renderer._renderSettings, api._terminalInput);
+        auto engine = std::make_unique<OutputStateMachineEngine>(std::move(dispatch));
+        StateMachine stateMachine{ std::move(engine) };
+        api._stateMachine = &stateMachine;
+
+        // The first pass warms up the caches and grows any buffers to their steady state size.
+        stateMachine.ProcessString(text);
+
+        size_t allocations = 0;
+        const auto beg = std::chrono::steady_clock::now();
+        {
+            const AllocationCounter counter;
+            for (size_t i = 0; i < iterations; ++i)
+            {
+                stateMachine.ProcessString(text);
+            }
+            allocations = counter.Count();
+        }
+        const auto end = std::chrono::steady_clock::now();
+
+        const auto seconds = std::chrono::duration<double>(end - beg).count();
+        const auto totalChars = static_cast<double>(iterations * text.size());
+        const auto totalBytes = static_cast<double>(iterations * bytes);
+
+        Log::Comment(String().Format(L"%s: %.1f MB/s, %.2f ns/char",
+                                     til::at(workloadNames, workload).data(),
+                                     totalBytes / seconds / 1e6,
+                                     seconds * 1e9 / totalChars));
+        Log::Comment(String().Format(L"%.4f allocations/char", allocations / totalChars));
+
+        VERIFY_IS_TRUE(api._textBuffer->GetCursor().GetPosition().y < api._textBuffer->GetSize().Height());
+    }
+};
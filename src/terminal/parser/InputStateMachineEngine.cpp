@@ -107,6 +107,64 @@ void InputStateMachineEngine::SetLookingForDSR(const bool looking) noexcept
     _lookingForDSR = looking;
 }
 
+// Method Description:
+// - Writes the text that was collected since the start of a bracketed paste
+//      (or the last flush) to the input buffer, as a single string.
+//   This is called by the VtInputThread after each chunk of input, so that
+//      a long paste doesn't sit here until it's complete.
+//   If the paste is still unfinished, the next key that isn't text ends it.
+//      See _FlushPendingPasteBeforeKey().
+// Arguments:
+// - <none>
+// Return Value:
+// - true iff we successfully wrote the pending text, or there was none.
+bool InputStateMachineEngine::FlushPendingPaste()
+{
+    _bracketedPasteFlushed = _inBracketedPaste;
+    return _WritePendingPaste();
+}
+
+// Method Description:
+// - Writes the text collected during a bracketed paste to the input buffer.
+// Arguments:
+// - <none>
+// Return Value:
+// - true iff we successfully wrote the pending text, or there was none.
+bool InputStateMachineEngine::_WritePendingPaste()
+{
+    if (_pendingPaste.empty())
+    {
+        return true;
+    }
+
+    const auto success = _pDispatch->WriteString(_pendingPaste);
+    _pendingPaste.clear();
+    return success;
+}
+
+// Method Description:
+// - Called before anything but text is dispatched. The pending text of a
+//      bracketed paste is written first, to keep the input in order.
+//   Keys like these may be part of a paste that arrives in one piece. But if
+//      the VtInputThread already had to flush the paste at the end of a read,
+//      a key arriving afterwards means that we missed the end of the paste (or
+//      that it never came). We end it then, so that we don't treat all of the
+//      following input as pasted text, in which a ^C doesn't interrupt the client.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void InputStateMachineEngine::_FlushPendingPasteBeforeKey()
+{
+    _WritePendingPaste();
+
+    if (_bracketedPasteFlushed)
+    {
+        _inBracketedPaste = false;
+        _bracketedPasteFlushed = false;
+    }
+}
+
 // Method Description:
 // - Triggers the Execute action to indicate that the listener should
 //      immediately respond to a C0 control character.
@@ -116,6 +174,14 @@ void InputStateMachineEngine::SetLookingForDSR(const bool looking) noexcept
 // - true iff we successfully dispatched the sequence.
 bool InputStateMachineEngine::ActionExecute(const wchar_t wch)
 {
+    // Control characters in a bracketed paste are part of the pasted text.
+    // In particular, a ^C mustn't interrupt the client.
+    if (_inBracketedPaste)
+    {
+        _pendingPaste.push_back(wch);
+        return true;
+    }
+
     return _DoControlCharacter(wch, false);
 }
 
@@ -220,6 +286,8 @@ bool InputStateMachineEngine::_DoControlCharacter(const wchar_t wch, const bool
 // - true iff we successfully dispatched the sequence.
 bool InputStateMachineEngine::ActionExecuteFromEscape(const wchar_t wch)
 {
+    _FlushPendingPasteBeforeKey();
+
     if (_pDispatch->IsVtInputEnabled() && _pfnFlushToInputQueue)
     {
         return _pfnFlushToInputQueue();
@@ -237,6 +305,12 @@ bool InputStateMachineEngine::ActionExecuteFromEscape(const wchar_t wch)
 // - true iff we successfully dispatched the sequence.
 bool InputStateMachineEngine::ActionPrint(const wchar_t wch)
 {
+    if (_inBracketedPaste)
+    {
+        _pendingPaste.push_back(wch);
+        return true;
+    }
+
     short vkey = 0;
     DWORD modifierState = 0;
     auto success = _GenerateKeyFromChar(wch, vkey, modifierState);
@@ -260,6 +334,11 @@ bool InputStateMachineEngine::ActionPrintString(const std::wstring_view string)
     {
         return true;
     }
+    if (_inBracketedPaste)
+    {
+        _pendingPaste.append(string);
+        return true;
+    }
     return _pDispatch->WriteString(string);
 }
 
@@ -272,6 +351,8 @@ bool InputStateMachineEngine::ActionPrintString(const std::wstring_view string)
 // - true iff we successfully dispatched the sequence.
 bool InputStateMachineEngine::ActionPassThroughString(const std::wstring_view string)
 {
+    _WritePendingPaste();
+
     if (_pDispatch->IsVtInputEnabled())
     {
         // Synthesize string into key events that we'll write to the buffer
@@ -299,6 +380,8 @@ bool InputStateMachineEngine::ActionPassThroughString(const std::wstring_view st
 // - true iff we successfully dispatched the sequence.
 bool InputStateMachineEngine::ActionEscDispatch(const VTID id)
 {
+    _FlushPendingPasteBeforeKey();
+
     if (_pDispatch->IsVtInputEnabled() && _pfnFlushToInputQueue)
     {
         return _pfnFlushToInputQueue();
@@ -357,6 +440,8 @@ bool InputStateMachineEngine::ActionVt52EscDispatch(const VTID /*id*/, const VTP
 // - true iff we successfully dispatched the sequence.
 bool InputStateMachineEngine::ActionCsiDispatch(const VTID id, const VTParameters parameters)
 {
+    _FlushPendingPasteBeforeKey();
+
     // GH#4999 - If the client was in VT input mode, but we received a
     // win32-input-mode sequence, then _don't_ passthrough the sequence to the
     // client. It's impossibly unlikely that the client actually wanted
@@ -422,10 +507,22 @@ bool InputStateMachineEngine::ActionCsiDispatch(const VTID id, const VTParameter
         success = success && _WriteSingleKey(vkey, modifierState);
         break;
     case CsiActionCodes::Generic:
-        success = _GetGenericVkey(parameters.at(0), vkey);
+    {
+        // A bracketed paste is written as a single string once it ends (or
+        // we run out of input), instead of dispatching it key by key.
+        const GenericKeyIdentifiers identifier = parameters.at(0);
+        if (identifier == GenericKeyIdentifiers::BracketedPasteStart ||
+            identifier == GenericKeyIdentifiers::BracketedPasteEnd)
+        {
+            _inBracketedPaste = identifier == GenericKeyIdentifiers::BracketedPasteStart;
+            success = true;
+            break;
+        }
+        success = _GetGenericVkey(identifier, vkey);
         modifierState = _GetGenericKeysModifierState(parameters);
         success = success && _WriteSingleKey(vkey, modifierState);
         break;
+    }
     case CsiActionCodes::CursorBackTab:
         success = _WriteSingleKey(VK_TAB, SHIFT_PRESSED);
         break;
@@ -481,6 +578,8 @@ IStateMachineEngine::StringHandler InputStateMachineEngine::ActionDcsDispatch(co
 // - true iff we successfully dispatched the sequence.
 bool InputStateMachineEngine::ActionSs3Dispatch(const wchar_t wch, const VTParameters /*parameters*/)
 {
+    _FlushPendingPasteBeforeKey();
+
     if (_pDispatch->IsVtInputEnabled() && _pfnFlushToInputQueue)
     {
         return _pfnFlushToInputQueue();
@@ -110,6 +110,8 @@ namespace Microsoft::Console::VirtualTerminal
         F10 = 21,
         F11 = 23,
         F12 = 24,
+        BracketedPasteStart = 200,
+        BracketedPasteEnd = 201,
     };
 
     enum class Ss3ActionCodes : wchar_t
@@ -134,6 +136,7 @@ namespace Microsoft::Console::VirtualTerminal
                                 const bool lookingForDSR);
 
         void SetLookingForDSR(const bool looking) noexcept;
+        bool FlushPendingPaste();
 
         bool ActionExecute(const wchar_t wch) override;
         bool ActionExecuteFromEscape(const wchar_t wch) override;
@@ -168,6 +171,12 @@ namespace Microsoft::Console::VirtualTerminal
         const std::unique_ptr<IInteractDispatch> _pDispatch;
         std::function<bool()> _pfnFlushToInputQueue;
         bool _lookingForDSR;
+        // Between the start and the end of a bracketed paste, text and control
+        // characters are collected here, and written as a single string.
+        bool _inBracketedPaste = false;
+        // Set once the VtInputThread flushed the unfinished paste at the end of a read.
+        bool _bracketedPasteFlushed = false;
+        std::wstring _pendingPaste;
         DWORD _mouseButtonState = 0;
         std::chrono::milliseconds _doubleClickTime;
         std::optional<til::point> _lastMouseClickPos{};
@@ -212,6 +221,9 @@ namespace Microsoft::Console::VirtualTerminal
 
         bool _DoControlCharacter(const wchar_t wch, const bool writeAlt);
 
+        bool _WritePendingPaste();
+        void _FlushPendingPasteBeforeKey();
+
 #ifdef UNIT_TESTING
         friend class InputEngineTest;
 #endif
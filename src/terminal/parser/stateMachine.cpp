@@ -379,6 +379,80 @@ static constexpr bool _isActionableFromGround(const wchar_t wch) noexcept
 
 #pragma warning(pop)
 
+// Routine Description:
+// - Finds the first character at or after the given offset that is actionable
+//   from the ground state (see _isActionableFromGround). This is the hot path
+//   for printable text, which is why it's vectorized where possible.
+// Arguments:
+// - string - The string to scan.
+// - offset - The index to start scanning at.
+// Return Value:
+// - The index of the first actionable character or string.size() if there's none.
+static size_t _findActionableFromGround(const std::wstring_view& string, size_t offset) noexcept
+{
+    const auto data = string.data();
+    const auto size = string.size();
+
+#pragma warning(push)
+#pragma warning(disable : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
+#pragma warning(disable : 26490) // Don't use reinterpret_cast (type.1).
+    // The vectorized code checks whether a character is
+    // * <= US (0x1F): saturating subtraction of 0x1F results in 0
+    // * within DEL (0x7F) to APC (0x9F): wrapping subtraction of 0x7F,
+    //   followed by a saturating subtraction of 0x20 results in 0
+    // Each matching character results in two set bits in the movemask,
+    // which is why the bit index returned by _BitScanForward must be halved.
+#ifdef __AVX2__
+    const auto c0 = _mm256_set1_epi16(AsciiChars::US);
+    const auto c1Base = _mm256_set1_epi16(AsciiChars::DEL);
+    const auto c1Range = _mm256_set1_epi16(0x9F - AsciiChars::DEL);
+    const auto zero = _mm256_setzero_si256();
+
+    for (; offset + 16 <= size; offset += 16)
+    {
+        const auto chars = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + offset));
+        const auto isC0 = _mm256_cmpeq_epi16(_mm256_subs_epu16(chars, c0), zero);
+        const auto isC1 = _mm256_cmpeq_epi16(_mm256_subs_epu16(_mm256_sub_epi16(chars, c1Base), c1Range), zero);
+        const auto mask = static_cast<unsigned long>(_mm256_movemask_epi8(_mm256_or_si256(isC0, isC1)));
+        unsigned long index;
+        if (_BitScanForward(&index, mask))
+        {
+            return offset + index / 2;
+        }
+    }
+#elif defined(_M_AMD64)
+    const auto c0 = _mm_set1_epi16(AsciiChars::US);
+    const auto c1Base = _mm_set1_epi16(AsciiChars::DEL);
+    const auto c1Range = _mm_set1_epi16(0x9F - AsciiChars::DEL);
+    const auto zero = _mm_setzero_si128();
+
+    for (; offset + 8 <= size; offset += 8)
+    {
+        const auto chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + offset));
+        const auto isC0 = _mm_cmpeq_epi16(_mm_subs_epu16(chars, c0), zero);
+        const auto isC1 = _mm_cmpeq_epi16(_mm_subs_epu16(_mm_sub_epi16(chars, c1Base), c1Range), zero);
+        const auto mask = static_cast<unsigned long>(_mm_movemask_epi8(_mm_or_si128(isC0, isC1)));
+        unsigned long index;
+        if (_BitScanForward(&index, mask))
+        {
+            return offset + index / 2;
+        }
+    }
+#endif
+
+    // Scalar fallback for the remainder (or everything on non-x64 platforms).
+    for (; offset < size; ++offset)
+    {
+        if (_isActionableFromGround(data[offset]))
+        {
+            return offset;
+        }
+    }
+#pragma warning(pop)
+
+    return size;
+}
+
 // Routine Description:
 // - Triggers the Execute action to indicate that the listener should immediately respond to a C0 control character.
 // Arguments:
@@ -1879,7 +1953,8 @@ void StateMachine::ProcessString(const std::wstring_view string)
             }
             else
             {
-                ++current; // Otherwise, add this char to the current run to be printed.
+                // Otherwise, add this char and all the printable ones following it to the current run to be printed.
+                current = _findActionableFromGround(string, current + 1);
             }
         }
     }
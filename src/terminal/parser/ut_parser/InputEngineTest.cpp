@@ -279,6 +279,8 @@ class Microsoft::Console::VirtualTerminal::InputEngineTest
     TEST_METHOD(TestWin32InputParsing);
     TEST_METHOD(TestWin32InputOptionals);
 
+    TEST_METHOD(BracketedPasteTest);
+
     friend class TestInteractDispatch;
 };
 
@@ -1617,3 +1619,78 @@ void InputEngineTest::TestWin32InputOptionals()
         }
     }
 }
+
+void InputEngineTest::BracketedPasteTest()
+{
+    // Collects the characters of the key down events of each write,
+    // and the virtual key codes of those that don't have any.
+    struct Write
+    {
+        std::wstring text;
+        std::vector<WORD> keys;
+    };
+    std::vector<Write> writes;
+    auto pfn = [&](std::deque<std::unique_ptr<IInputEvent>>& inEvents) {
+        auto& write = writes.emplace_back();
+        for (const auto& record : IInputEvent::ToInputRecords(inEvents))
+        {
+            const auto& keyEvent = record.Event.KeyEvent;
+            if (record.EventType == KEY_EVENT && keyEvent.bKeyDown)
+            {
+                if (keyEvent.uChar.UnicodeChar != UNICODE_NULL)
+                {
+                    write.text.push_back(keyEvent.uChar.UnicodeChar);
+                }
+                else
+                {
+                    write.keys.push_back(keyEvent.wVirtualKeyCode);
+                }
+            }
+        }
+    };
+
+    auto dispatch = std::make_unique<TestInteractDispatch>(pfn, &testState);
+    auto inputEngine = std::make_unique<InputStateMachineEngine>(std::move(dispatch));
+    auto engine = inputEngine.get();
+    StateMachine mach(std::move(inputEngine));
+    testState._expectSendCtrlC = false;
+
+    Log::Comment(L"A bracketed paste, including its control characters, should be written as a single string.");
+    Log::Comment(L"The ^C in it must not be written as a Ctrl+C key (WriteCtrlKey fails the test).");
+    mach.ProcessString(L"\x1b[200~ab\r\nc\x03\td\x1b[201~x");
+    VERIFY_ARE_EQUAL(2u, writes.size());
+    VERIFY_ARE_EQUAL(L"ab\r\nc\x03\td", writes.at(0).text);
+    VERIFY_ARE_EQUAL(L"x", writes.at(1).text);
+
+    Log::Comment(L"A paste that spans multiple reads is written once per read, when the VtInputThread flushes it.");
+    writes.clear();
+    mach.ProcessString(L"\x1b[200~ab\r");
+    VERIFY_ARE_EQUAL(0u, writes.size());
+    VERIFY_IS_TRUE(engine->FlushPendingPaste());
+    mach.ProcessString(L"cd\x1b[201~");
+    VERIFY_IS_TRUE(engine->FlushPendingPaste());
+    VERIFY_ARE_EQUAL(2u, writes.size());
+    VERIFY_ARE_EQUAL(L"ab\r", writes.at(0).text);
+    VERIFY_ARE_EQUAL(L"cd", writes.at(1).text);
+
+    Log::Comment(L"Keys that aren't text end the pending part of the paste, to keep the input in order.");
+    writes.clear();
+    mach.ProcessString(L"\x1b[200~ab\x1b[Acd\x1b[201~");
+    VERIFY_ARE_EQUAL(3u, writes.size());
+    VERIFY_ARE_EQUAL(L"ab", writes.at(0).text);
+    VERIFY_ARE_EQUAL(L"", writes.at(1).text);
+    VERIFY_ARE_EQUAL(1u, writes.at(1).keys.size());
+    VERIFY_ARE_EQUAL(WORD{ VK_UP }, writes.at(1).keys.at(0));
+    VERIFY_ARE_EQUAL(L"cd", writes.at(2).text);
+
+    Log::Comment(L"A key in a later read than the unfinished paste ends the paste mode.");
+    writes.clear();
+    mach.ProcessString(L"\x1b[200~ab");
+    VERIFY_IS_TRUE(engine->FlushPendingPaste());
+    mach.ProcessString(L"\x1b[Acd");
+    VERIFY_ARE_EQUAL(3u, writes.size(), L"cd must be written right away, instead of waiting for the next flush.");
+    VERIFY_ARE_EQUAL(L"ab", writes.at(0).text);
+    VERIFY_ARE_EQUAL(WORD{ VK_UP }, writes.at(1).keys.at(0));
+    VERIFY_ARE_EQUAL(L"cd", writes.at(2).text);
+    VERIFY_IS_FALSE(engine->_inBracketedPaste);
+}
@@ -5,6 +5,8 @@
 #include <wextestclass.h>
 #include "../../inc/consoletaeftemplates.hpp"
 
+#include <chrono>
+
 #include "stateMachine.hpp"
 #include "OutputStateMachineEngine.hpp"
 
@@ -244,6 +246,69 @@ class Microsoft::Console::VirtualTerminal::OutputEngineTest final
         VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::Ground);
     }
 
+    TEST_METHOD(TestGroundPrintThroughput)
+    {
+        BEGIN_TEST_METHOD_PROPERTIES()
+            TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+            TEST_METHOD_PROPERTY(L"Data:workload", L"{0, 1, 2}")
+        END_TEST_METHOD_PROPERTIES()
+
+        int workload;
+        VERIFY_SUCCEEDED_RETURN(TestData::TryGetValue(L"workload", workload));
+
+        // Synthesize a multi-megabyte capture that resembles what `cat`-ing a log
+        // looks like: mostly printable text, interspersed with control characters.
+        std::wstring line;
+        switch (workload)
+        {
+        case 0:
+            Log::Comment(L"Plain text build log.");
+            line = L"  Compiling src/terminal/parser/stateMachine.cpp (Release|x64) -> obj/stateMachine.obj\r\n";
+            break;
+        case 1:
+            Log::Comment(L"SGR colored build log.");
+            line = L"\x1b[1;32m  Compiling\x1b[m src/terminal/parser/\x1b[36mstateMachine.cpp\x1b[m (Release|x64)\r\n";
+            break;
+        case 2:
+            Log::Comment(L"Tab separated columns.");
+            line = L"drwxr-xr-x\t2\tuser\tgroup\t4096\tJan 01 00:00\tsrc\r\n";
+            break;
+        default:
+            VERIFY_FAIL(L"Unknown workload");
+            return;
+        }
+
+        std::wstring capture;
+        capture.reserve(4 * 1024 * 1024);
+        while (capture.size() + line.size() <= capture.capacity())
+        {
+            capture.append(line);
+        }
+
+        auto dispatch = std::make_unique<DummyDispatch>();
+        auto engine = std::make_unique<OutputStateMachineEngine>(std::move(dispatch));
+        StateMachine mach(std::move(engine));
+
+        // ConptyConnection reads the output in chunks of this size.
+        static constexpr size_t chunkSize = 128 * 1024;
+        static constexpr auto iterations = 10;
+
+        const auto start = std::chrono::steady_clock::now();
+        for (auto i = 0; i < iterations; ++i)
+        {
+            for (size_t offset = 0; offset < capture.size(); offset += chunkSize)
+            {
+                mach.ProcessString(std::wstring_view{ capture }.substr(offset, chunkSize));
+            }
+        }
+        const auto duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::Ground);
+
+        const auto megabytes = static_cast<double>(capture.size() * sizeof(wchar_t) * iterations) / (1024.0 * 1024.0);
+        Log::Comment(String().Format(L"Parsed %.1f MB in %.1f ms: %.1f MB/s", megabytes, duration * 1000.0, megabytes / duration));
+    }
+
     TEST_METHOD(TestCsiEntry)
     {
         auto dispatch = std::make_unique<DummyDispatch>();
@@ -154,6 +154,9 @@ class Microsoft::Console::VirtualTerminal::StateMachineTest
     TEST_METHOD(PassThroughUnhandled);
     TEST_METHOD(RunStorageBeforeEscape);
     TEST_METHOD(BulkTextPrint);
+    TEST_METHOD(BulkTextPrintStopsAtControlCharacters);
+    TEST_METHOD(BulkTextPrintStopsAtC1ControlCharacters);
+    TEST_METHOD(BulkTextPrintStopsAtVectorBoundaries);
     TEST_METHOD(PassThroughUnhandledSplitAcrossWrites);
 
     TEST_METHOD(DcsDataStringsReceivedByHandler);
@@ -229,6 +232,102 @@ void StateMachineTest::BulkTextPrint()
     VERIFY_ARE_EQUAL(String(L"12345 Hello World"), String(engine.printed.c_str()));
 }
 
+void StateMachineTest::BulkTextPrintStopsAtControlCharacters()
+{
+    auto enginePtr{ std::make_unique<TestStateMachineEngine>() };
+    // this dance is required because StateMachine presumes to take ownership of its engine.
+    auto& engine{ *enginePtr.get() };
+    StateMachine machine{ std::move(enginePtr) };
+
+    // The ground state scanner processes multiple characters at once.
+    // Place a control character at every offset of a string that's longer than
+    // the widest vector width, to ensure none of them is skipped over.
+    const std::wstring text{ L"The quick brown fox jumps over the lazy dog" };
+
+    for (const auto control : { L'\a', L'\x1f', L'\x7f' })
+    {
+        for (size_t i = 0; i <= text.size(); ++i)
+        {
+            auto input = text;
+            input.insert(i, 1, control);
+
+            engine.ResetTestState();
+            machine.ProcessString(input);
+
+            VERIFY_ARE_EQUAL(text, engine.printed);
+            VERIFY_ARE_EQUAL(std::wstring(1, control), engine.executed);
+        }
+    }
+}
+
+void StateMachineTest::BulkTextPrintStopsAtC1ControlCharacters()
+{
+    auto enginePtr{ std::make_unique<TestStateMachineEngine>() };
+    // this dance is required because StateMachine presumes to take ownership of its engine.
+    auto& engine{ *enginePtr.get() };
+    StateMachine machine{ std::move(enginePtr) };
+
+    // C1 controls are ignored unless C1 parsing was requested. If the scanner
+    // ran past one of them, it would end up in the printed text instead.
+    const std::wstring text{ L"The quick brown fox jumps over the lazy dog" };
+
+    for (const auto control : { L'\x80', L'\x85', L'\x9b', L'\x9f' })
+    {
+        for (size_t i = 0; i <= text.size(); ++i)
+        {
+            auto input = text;
+            input.insert(i, 1, control);
+
+            engine.ResetTestState();
+            machine.ProcessString(input);
+
+            VERIFY_ARE_EQUAL(text, engine.printed);
+            VERIFY_ARE_EQUAL(std::wstring{}, engine.executed);
+        }
+    }
+
+    Log::Comment(L"The characters right outside of the C0, DEL and C1 ranges are printable.");
+    const std::wstring printable{ L"a\x20b\x7ec\xa0d\xffe" };
+    engine.ResetTestState();
+    machine.ProcessString(printable);
+    VERIFY_ARE_EQUAL(printable, engine.printed);
+    VERIFY_ARE_EQUAL(std::wstring{}, engine.executed);
+}
+
+void StateMachineTest::BulkTextPrintStopsAtVectorBoundaries()
+{
+    auto enginePtr{ std::make_unique<TestStateMachineEngine>() };
+    // this dance is required because StateMachine presumes to take ownership of its engine.
+    auto& engine{ *enginePtr.get() };
+    StateMachine machine{ std::move(enginePtr) };
+
+    // The scanner processes 8 (SSE2) or 16 (AVX2) characters at a time, starting
+    // one past the first printable character. Make runs end right before, on and
+    // right after each of the block boundaries up to 64 characters, both with the
+    // end of the string and with a C0 or C1 control character.
+    for (size_t length = 1; length <= 66; ++length)
+    {
+        std::wstring run;
+        for (size_t i = 0; i < length; ++i)
+        {
+            run.push_back(static_cast<wchar_t>(L'a' + i % 26));
+        }
+
+        engine.ResetTestState();
+        machine.ProcessString(run);
+        VERIFY_ARE_EQUAL(run, engine.printed);
+        VERIFY_ARE_EQUAL(std::wstring{}, engine.executed);
+
+        for (const auto control : { L'\n', L'\x9c' })
+        {
+            engine.ResetTestState();
+            machine.ProcessString(run + control + L"xyz");
+            VERIFY_ARE_EQUAL(run + L"xyz", engine.printed);
+            VERIFY_ARE_EQUAL(std::wstring{ control == L'\n' ? L"\n" : L"" }, engine.executed);
+        }
+    }
+}
+
 void StateMachineTest::PassThroughUnhandledSplitAcrossWrites()
 {
     auto enginePtr{ std::make_unique<TestStateMachineEngine>() };
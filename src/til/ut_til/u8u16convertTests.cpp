@@ -4,6 +4,8 @@
 #include "precomp.h"
 #include "WexTestClass.h"
 
+#include <chrono>
+
 using namespace WEX::Common;
 using namespace WEX::Logging;
 using namespace WEX::TestExecution;
@@ -17,6 +19,9 @@ class Utf8Utf16ConvertTests
     TEST_METHOD(TestU8ToU16Partials);
     TEST_METHOD(TestU16ToU8Partials);
     TEST_METHOD(TestU8ToU16OneByOne);
+    TEST_METHOD(TestU8ToU16InvalidSequences);
+    TEST_METHOD(TestU8ToU16MixedVectorBoundaries);
+    TEST_METHOD(TestU8ToU16Throughput);
 };
 
 void Utf8Utf16ConvertTests::TestU8ToU16()
@@ -191,3 +196,114 @@ void Utf8Utf16ConvertTests::TestU8ToU16OneByOne()
     VERIFY_SUCCEEDED(til::u8u16(u8String1_4, u16Out1, state));
     VERIFY_ARE_EQUAL(u16StringComp1, u16Out1);
 }
+
+void Utf8Utf16ConvertTests::TestU8ToU16InvalidSequences()
+{
+    static constexpr std::pair<std::string_view, std::wstring_view> testData[]{
+        { "\x80", L"\xFFFD" }, // lone continuation byte
+        { "\xC0\xAF", L"\xFFFD\xFFFD" }, // overlong encoding of '/'
+        { "\xE0\x80\xAF", L"\xFFFD\xFFFD\xFFFD" }, // overlong 3 byte sequence
+        { "\xED\xA0\x80", L"\xFFFD\xFFFD\xFFFD" }, // encoded surrogate
+        { "\xF4\x90\x80\x80", L"\xFFFD\xFFFD\xFFFD\xFFFD" }, // beyond U+10FFFF
+        { "\xF5", L"\xFFFD" }, // invalid lead byte
+        { "\xE2\x82" "a", L"\xFFFD" L"a" }, // truncated sequence is a single maximal subpart
+        { "\xF0\x9F\x93z", L"\xFFFDz" },
+        { "a\xFF" "b", L"a\xFFFD" L"b" },
+    };
+
+    for (const auto& [input, expected] : testData)
+    {
+        std::wstring u16Out{};
+        VERIFY_SUCCEEDED(til::u8u16(input, u16Out));
+        VERIFY_ARE_EQUAL(std::wstring{ expected }, u16Out);
+    }
+}
+
+void Utf8Utf16ConvertTests::TestU8ToU16MixedVectorBoundaries()
+{
+    // The ASCII fast path converts up to 32 bytes at once.
+    // Place a multibyte character at every offset of a longer ASCII string
+    // to ensure that the transition between the two paths is seamless.
+    const std::string ascii(80, 'a');
+    const std::string euro{ "\xE2\x82\xAC" }; // EURO SIGN
+
+    for (size_t i = 0; i <= ascii.size(); ++i)
+    {
+        auto u8String = ascii;
+        u8String.insert(i, euro);
+
+        auto expected = std::wstring(ascii.size(), L'a');
+        expected.insert(i, 1, L'\x20AC');
+
+        std::wstring u16Out{};
+        VERIFY_SUCCEEDED(til::u8u16(u8String, u16Out));
+        VERIFY_ARE_EQUAL(expected, u16Out);
+    }
+}
+
+void Utf8Utf16ConvertTests::TestU8ToU16Throughput()
+{
+    BEGIN_TEST_METHOD_PROPERTIES()
+        TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+        TEST_METHOD_PROPERTY(L"Data:corpus", L"{0, 1, 2}")
+    END_TEST_METHOD_PROPERTIES()
+
+    int corpus;
+    VERIFY_SUCCEEDED_RETURN(TestData::TryGetValue(L"corpus", corpus));
+
+    // Similar to the en.txt and zh.txt corpora in src\tools\U8U16Test.
+    std::string_view line;
+    switch (corpus)
+    {
+    case 0:
+        Log::Comment(L"ASCII");
+        line = "The quick brown fox jumps over the lazy dog. 0123456789\r\n";
+        break;
+    case 1:
+        Log::Comment(L"CJK");
+        line = "\xE6\x95\x8F\xE6\x8D\xB7\xE7\x9A\x84\xE6\xA3\x95\xE8\x89\xB2\xE7\x8B\x90\xE7\x8B\xB8\xE8\xB7\xB3\xE8\xBF\x87\xE4\xBA\x86\xE9\x82\xA3\xE5\x8F\xAA\xE6\x87\x92\xE7\x8B\x97 0123456789\r\n";
+        break;
+    case 2:
+        Log::Comment(L"Emoji");
+        line = "\xF0\x9F\xA6\x8A jumps \xF0\x9F\x90\xB6 \xF0\x9F\x98\x80\xF0\x9F\x98\x81\xF0\x9F\x98\x82\xF0\x9F\x98\x83 ok \xE2\x9C\x85\r\n";
+        break;
+    default:
+        VERIFY_FAIL(L"Unknown corpus");
+        return;
+    }
+
+    std::string u8String;
+    u8String.reserve(8 * 1024 * 1024);
+    while (u8String.size() + line.size() <= u8String.capacity())
+    {
+        u8String.append(line);
+    }
+
+    // ConptyConnection reads the output in chunks of this size.
+    static constexpr size_t chunkSize = 128 * 1024;
+    const auto megabytes = static_cast<double>(u8String.size()) / (1024.0 * 1024.0);
+
+    const auto measure = [&](auto&& func) {
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t offset = 0; offset < u8String.size(); offset += chunkSize)
+        {
+            func(std::string_view{ u8String }.substr(offset, chunkSize));
+        }
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    std::wstring u16Out;
+    til::u8state state{};
+    const auto tilDuration = measure([&](const std::string_view& chunk) {
+        THROW_IF_FAILED(til::u8u16(chunk, u16Out, state));
+    });
+
+    std::wstring u16Reference;
+    u16Reference.resize(chunkSize);
+    const auto platformDuration = measure([&](const std::string_view& chunk) {
+        MultiByteToWideChar(CP_UTF8, 0, chunk.data(), gsl::narrow_cast<int>(chunk.size()), u16Reference.data(), gsl::narrow_cast<int>(u16Reference.size()));
+    });
+
+    Log::Comment(String().Format(L"til::u8u16:          %.1f MB/s", megabytes / tilDuration));
+    Log::Comment(String().Format(L"MultiByteToWideChar: %.1f MB/s", megabytes / platformDuration));
+}
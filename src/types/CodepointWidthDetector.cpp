@@ -4,6 +4,8 @@
 #include "precomp.h"
 #include "inc/CodepointWidthDetector.hpp"
 
+#include <til/unicode.h>
+
 namespace
 {
     // used to store range data in CodepointWidthDetector's internal map
@@ -323,6 +325,125 @@ namespace
         UnicodeRange{ 0xf0000, 0xffffd, 1 },
         UnicodeRange{ 0x100000, 0x10fffd, 1 },
     };
+
+    // s_wideAndAmbiguousTable is compact, but it needs a binary search for every lookup.
+    // The following turns it into a two-stage lookup table at compile time. This way
+    // Generate-CodepointWidthsFromUCD.ps1 (and unicode_width_overrides.xml) remain
+    // the only source of truth and regenerating the ranges above regenerates this too.
+    //
+    // Unicode is split into pages of 256 codepoints. s_pageTable maps each page to a block
+    // in s_blockTable, which stores the WidthClass of each codepoint in 2 bits.
+    // Most pages are entirely narrow, wide or ambiguous and share one of the first
+    // 3 "uniform" blocks. Only pages with mixed widths get a block of their own.
+    enum WidthClass : uint8_t
+    {
+        WidthClassNarrow = 0,
+        WidthClassWide = 1,
+        WidthClassAmbiguous = 2,
+        // Only used while classifying pages. Never stored in s_blockTable.
+        WidthClassMixed = 3,
+    };
+
+    static constexpr size_t s_pageBits = 8;
+    static constexpr size_t s_pageSize = size_t{ 1 } << s_pageBits;
+    static constexpr size_t s_pageCount = 0x110000 / s_pageSize;
+    // Each uint32_t in s_blockTable stores the 2-bit WidthClass of 16 codepoints.
+    static constexpr size_t s_wordsPerBlock = s_pageSize / 16;
+    static constexpr size_t s_uniformBlockCount = 3;
+
+    constexpr uint8_t widthClassOf(const UnicodeRange& range) noexcept
+    {
+        return range.isAmbiguous ? WidthClassAmbiguous : WidthClassWide;
+    }
+
+    // Returns the WidthClass of each page, or WidthClassMixed if its codepoints differ in width.
+    constexpr std::array<uint8_t, s_pageCount> classifyPages() noexcept
+    {
+        std::array<uint8_t, s_pageCount> pages{};
+        for (const auto& range : s_wideAndAmbiguousTable)
+        {
+            const size_t lower = range.lowerBound;
+            const size_t upper = range.upperBound;
+            for (auto page = lower >> s_pageBits; page <= upper >> s_pageBits; ++page)
+            {
+                const auto pageBeg = page << s_pageBits;
+                const auto pageEnd = pageBeg + s_pageSize - 1;
+                // The ranges don't overlap. If one covers an entire page, it's the only one in it.
+                til::at(pages, page) = lower <= pageBeg && upper >= pageEnd ? widthClassOf(range) : WidthClassMixed;
+            }
+        }
+        return pages;
+    }
+
+    static constexpr auto s_pageClasses = classifyPages();
+    static constexpr size_t s_blockCount = s_uniformBlockCount + std::count(s_pageClasses.begin(), s_pageClasses.end(), WidthClassMixed);
+    static_assert(s_blockCount <= 256, "s_pageTable stores block indices as uint8_t");
+
+    constexpr std::array<uint8_t, s_pageCount> buildPageTable() noexcept
+    {
+        std::array<uint8_t, s_pageCount> table{};
+        auto nextBlock = gsl::narrow_cast<uint8_t>(s_uniformBlockCount);
+        for (size_t page = 0; page < s_pageCount; ++page)
+        {
+            // The index of each uniform block is identical to its WidthClass.
+            const auto widthClass = til::at(s_pageClasses, page);
+            til::at(table, page) = widthClass == WidthClassMixed ? nextBlock++ : widthClass;
+        }
+        return table;
+    }
+
+    static constexpr auto s_pageTable = buildPageTable();
+
+    constexpr std::array<uint32_t, s_blockCount * s_wordsPerBlock> buildBlockTable() noexcept
+    {
+        std::array<uint32_t, s_blockCount * s_wordsPerBlock> table{};
+        for (size_t i = 0; i < s_wordsPerBlock; ++i)
+        {
+            til::at(table, WidthClassWide * s_wordsPerBlock + i) = 0x55555555;
+            til::at(table, WidthClassAmbiguous * s_wordsPerBlock + i) = 0xAAAAAAAA;
+        }
+        for (const auto& range : s_wideAndAmbiguousTable)
+        {
+            const size_t lower = range.lowerBound;
+            const size_t upper = range.upperBound;
+            const uint32_t widthClass = widthClassOf(range);
+            for (auto page = lower >> s_pageBits; page <= upper >> s_pageBits; ++page)
+            {
+                const size_t block = til::at(s_pageTable, page);
+                if (block < s_uniformBlockCount)
+                {
+                    continue;
+                }
+                const auto beg = std::max(lower, page << s_pageBits);
+                const auto end = std::min(upper, ((page + 1) << s_pageBits) - 1);
+                for (auto cp = beg; cp <= end; ++cp)
+                {
+                    const auto offset = cp & (s_pageSize - 1);
+                    til::at(table, block * s_wordsPerBlock + offset / 16) |= widthClass << (offset % 16 * 2);
+                }
+            }
+        }
+        return table;
+    }
+
+    static constexpr auto s_blockTable = buildBlockTable();
+
+    constexpr uint8_t lookupWidthClass(const char32_t codepoint) noexcept
+    {
+        const size_t block = til::at(s_pageTable, codepoint >> s_pageBits);
+        const auto offset = codepoint & (s_pageSize - 1);
+        const auto word = til::at(s_blockTable, block * s_wordsPerBlock + offset / 16);
+        return gsl::narrow_cast<uint8_t>((word >> (offset % 16 * 2)) & 3);
+    }
+
+    static_assert(lookupWidthClass(0x00a1) == WidthClassAmbiguous);
+    static_assert(lookupWidthClass(0x00a2) == WidthClassNarrow);
+    static_assert(lookupWidthClass(0x306a) == WidthClassWide);
+    static_assert(lookupWidthClass(0x1f922) == WidthClassWide);
+    static_assert(lookupWidthClass(0x2fffd) == WidthClassWide);
+    static_assert(lookupWidthClass(0x2fffe) == WidthClassNarrow);
+    static_assert(lookupWidthClass(0x10fffd) == WidthClassAmbiguous);
+    static_assert(lookupWidthClass(0x10ffff) == WidthClassNarrow);
 }
 
 // Routine Description:
@@ -374,23 +495,120 @@ bool CodepointWidthDetector::IsWide(const std::wstring_view& glyph) noexcept
     return GetWidth(glyph) == CodepointWidth::Wide;
 }
 
+// Routine Description:
+// - measures an entire UTF-16 string in a single pass, instead of calling GetWidth() for each glyph.
+//   ASCII spans are always narrow and are skipped over in bulk without any lookups.
+// Arguments:
+// - text - the utf16 encoded string to measure
+// - runs - receives the measured glyphs. New runs are appended, merging with the last existing
+//   one if possible. The sum of all TextLength() equals the length of the given text.
+// Return Value:
+// - <none>
+void CodepointWidthDetector::MeasureGlyphRuns(const std::wstring_view& text, std::vector<GlyphRun>& runs)
+{
+    const auto append = [&](const size_t count, const size_t length, const uint8_t width) {
+        if (!runs.empty() && runs.back().glyphLength == length && runs.back().glyphWidth == width)
+        {
+            runs.back().glyphCount += count;
+        }
+        else
+        {
+            runs.emplace_back(GlyphRun{ count, gsl::narrow_cast<uint8_t>(length), width });
+        }
+    };
+
+    const auto end = text.end();
+    auto it = text.begin();
+
+    while (it != end)
+    {
+        const auto asciiBeg = it;
+        for (; it != end && *it < 0x80; ++it)
+        {
+        }
+        if (it != asciiBeg)
+        {
+            append(gsl::narrow_cast<size_t>(it - asciiBeg), 1, 1);
+        }
+
+        const auto otherBeg = it;
+        for (; it != end && *it >= 0x80; ++it)
+        {
+        }
+        // Surrogate pairs consist of 2 non-ASCII characters and so they're never split up here.
+        for (const auto& glyph : til::utf16_iterator{ std::wstring_view{ otherBeg, it } })
+        {
+            append(1, glyph.size(), GetWidth(glyph) == CodepointWidth::Wide ? 2 : 1);
+        }
+    }
+}
+
+// Routine Description:
+// - returns the number of columns the given UTF-16 string occupies.
+//   Same as summing up the Columns() of all runs returned by MeasureGlyphRuns(), but without allocating.
+// Arguments:
+// - text - the utf16 encoded string to measure
+// Return Value:
+// - the width of the text in columns
+size_t CodepointWidthDetector::MeasureColumns(const std::wstring_view& text) noexcept
+{
+    const auto end = text.end();
+    auto it = text.begin();
+    size_t columns = 0;
+
+    while (it != end)
+    {
+        const auto asciiBeg = it;
+        for (; it != end && *it < 0x80; ++it)
+        {
+        }
+        columns += gsl::narrow_cast<size_t>(it - asciiBeg);
+
+        const auto otherBeg = it;
+        for (; it != end && *it >= 0x80; ++it)
+        {
+        }
+        for (const auto& glyph : til::utf16_iterator{ std::wstring_view{ otherBeg, it } })
+        {
+            columns += GetWidth(glyph) == CodepointWidth::Wide ? 2 : 1;
+        }
+    }
+
+    return columns;
+}
+
 // GetWidth's slow-path for non-ASCII characters. Returns the number of columns the codepoint takes up in the terminal.
 uint8_t CodepointWidthDetector::_lookupGlyphWidth(const char32_t codepoint, const std::wstring_view& glyph) noexcept
+{
+    switch (_lookupWidthClass(codepoint))
+    {
+    case WidthClassWide:
+        return 2;
+    case WidthClassAmbiguous:
+        return _checkFallbackViaCache(codepoint, glyph);
+    default:
+        return 1;
+    }
+}
+
+// Returns the WidthClass of the given codepoint in O(1) via the s_pageTable/s_blockTable.
+// codepoint must be less than 0x110000.
+uint8_t CodepointWidthDetector::_lookupWidthClass(const char32_t codepoint) noexcept
+{
+    return lookupWidthClass(codepoint);
+}
+
+// Same as _lookupWidthClass, but via a binary search over s_wideAndAmbiguousTable.
+// This is how lookups used to work and it's only kept around to test and benchmark the lookup table against.
+uint8_t CodepointWidthDetector::_lookupWidthClassViaRanges(const char32_t codepoint) noexcept
 {
 #pragma warning(suppress : 26447) // The function is declared 'noexcept' but calls function 'lower_bound<...>()' which may throw exceptions (f.6).
     const auto it = std::lower_bound(s_wideAndAmbiguousTable.begin(), s_wideAndAmbiguousTable.end(), codepoint);
-    uint8_t width = 1;
-
     if (it != s_wideAndAmbiguousTable.end() && codepoint >= it->lowerBound && codepoint <= it->upperBound)
     {
-        width = 2;
-        if (it->isAmbiguous)
-        {
-            width = _checkFallbackViaCache(codepoint, glyph);
-        }
+        return widthClassOf(*it);
     }
-
-    return width;
+    return WidthClassNarrow;
 }
 
 // Call the function specified via SetFallbackMethod() to turn CodepointWidth::Ambiguous into Narrow/Wide.
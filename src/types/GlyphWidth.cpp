@@ -25,6 +25,20 @@ bool IsGlyphFullWidth(const wchar_t wch) noexcept
     return wch < 0x80 ? false : IsGlyphFullWidth({ &wch, 1 });
 }
 
+// Function Description:
+// - measures an entire string of text at once. See CodepointWidthDetector::MeasureGlyphRuns
+void MeasureGlyphRuns(const std::wstring_view& text, std::vector<GlyphRun>& runs)
+{
+    widthDetector.MeasureGlyphRuns(text, runs);
+}
+
+// Function Description:
+// - returns the number of columns a string of text occupies. See CodepointWidthDetector::MeasureColumns
+size_t MeasureGlyphColumns(const std::wstring_view& text) noexcept
+{
+    return widthDetector.MeasureColumns(text);
+}
+
 // Function Description:
 // - Sets a function that should be used by the global CodepointWidthDetector
 //      as the fallback mechanism for determining a particular glyph's width,
@@ -21,6 +21,8 @@ class CodepointWidthDetector final
 public:
     CodepointWidth GetWidth(const std::wstring_view& glyph) noexcept;
     bool IsWide(const std::wstring_view& glyph) noexcept;
+    void MeasureGlyphRuns(const std::wstring_view& text, std::vector<GlyphRun>& runs);
+    size_t MeasureColumns(const std::wstring_view& text) noexcept;
     void SetFallbackMethod(std::function<bool(const std::wstring_view&)> pfnFallback) noexcept;
     void NotifyFontChanged() noexcept;
 
@@ -31,6 +33,8 @@ public:
 private:
     uint8_t _lookupGlyphWidth(char32_t codepoint, const std::wstring_view& glyph) noexcept;
     uint8_t _checkFallbackViaCache(char32_t codepoint, const std::wstring_view& glyph) noexcept;
+    static uint8_t _lookupWidthClass(char32_t codepoint) noexcept;
+    static uint8_t _lookupWidthClassViaRanges(char32_t codepoint) noexcept;
 
     std::unordered_map<char32_t, uint8_t> _fallbackCache;
     std::function<bool(const std::wstring_view&)> _pfnFallbackMethod;
@@ -12,10 +12,13 @@ Abstract:
 
 #include <functional>
 #include <string_view>
+#include <vector>
 
 #include "convert.hpp"
 
 bool IsGlyphFullWidth(const std::wstring_view& glyph) noexcept;
 bool IsGlyphFullWidth(const wchar_t wch) noexcept;
+void MeasureGlyphRuns(const std::wstring_view& text, std::vector<GlyphRun>& runs);
+size_t MeasureGlyphColumns(const std::wstring_view& text) noexcept;
 void SetGlyphWidthFallback(std::function<bool(const std::wstring_view&)> pfnFallback) noexcept;
 void NotifyGlyphWidthFontChanged() noexcept;
@@ -24,6 +24,25 @@ enum class CodepointWidth : BYTE
     Wide,
 };
 
+// A run of consecutive glyphs which all share the same length in UTF-16 code units
+// and the same width in columns. See CodepointWidthDetector::MeasureGlyphRuns.
+struct GlyphRun
+{
+    size_t glyphCount = 0;
+    uint8_t glyphLength = 0; // 1, or 2 for surrogate pairs
+    uint8_t glyphWidth = 0; // 1 or 2 columns
+
+    constexpr size_t TextLength() const noexcept
+    {
+        return glyphCount * glyphLength;
+    }
+
+    constexpr size_t Columns() const noexcept
+    {
+        return glyphCount * glyphWidth;
+    }
+};
+
 [[nodiscard]] std::wstring ConvertToW(const UINT codepage,
                                       const std::string_view source);
 